@@ -0,0 +1,258 @@
+#ifndef MAPNIK_BENCH_SYNTHETIC_DATA_HPP
+#define MAPNIK_BENCH_SYNTHETIC_DATA_HPP
+
+// mapnik
+#include <mapnik/memory_datasource.hpp>
+#include <mapnik/feature.hpp>
+#include <mapnik/feature_factory.hpp>
+#include <mapnik/geometry.hpp>
+#include <mapnik/image.hpp>
+#include <mapnik/raster.hpp>
+#include <mapnik/unicode.hpp>
+#include <mapnik/map.hpp>
+#include <mapnik/layer.hpp>
+
+// stl
+#include <cmath>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+
+// Deterministic synthetic datasets used by the rendering scenario benchmarks.
+// All generators work in spherical mercator metres and use a fixed seed so
+// every run renders exactly the same features.
+namespace benchmark { namespace synthetic {
+
+using datasource_ptr = std::shared_ptr<mapnik::memory_datasource>;
+
+// 20 x 20 km around null island: about one z11 tile, 64 z16 tiles across
+static const mapnik::box2d<double> default_extent(-10000.0, -10000.0, 10000.0, 10000.0);
+
+inline datasource_ptr make_datasource()
+{
+    mapnik::parameters params;
+    params["type"] = "memory";
+    return std::make_shared<mapnik::memory_datasource>(params);
+}
+
+inline mapnik::value_unicode_string to_unicode(std::string const& str)
+{
+    static const mapnik::transcoder tr("utf-8");
+    return tr.transcode(str.c_str());
+}
+
+// jittered street grid: motorways, primary and residential roads with names
+inline datasource_ptr roads(mapnik::box2d<double> const& extent, double density = 1.0, unsigned seed = 1)
+{
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> jitter(-15.0, 15.0);
+    auto ds = make_datasource();
+    auto ctx = std::make_shared<mapnik::context_type>();
+    ctx->push("class");
+    ctx->push("name");
+    ctx->push("ref");
+    int lines = static_cast<int>(std::max(2.0, 120 * std::sqrt(density)));
+    double dx = extent.width() / lines;
+    double dy = extent.height() / lines;
+    mapnik::value_integer id = 0;
+    for (int dir = 0; dir < 2; ++dir)
+    {
+        for (int i = 1; i < lines; ++i)
+        {
+            std::string cls = (i % 16 == 0) ? "motorway" : (i % 4 == 0) ? "primary" : "residential";
+            // every grid line is split into blocks, as in real road networks
+            for (int j = 0; j < lines; ++j)
+            {
+                mapnik::geometry::line_string<double> line;
+                line.reserve(9);
+                for (int k = 0; k <= 8; ++k)
+                {
+                    double along = (j + k / 8.0);
+                    double x = dir == 0 ? extent.minx() + along * dx : extent.minx() + i * dx;
+                    double y = dir == 0 ? extent.miny() + i * dy : extent.miny() + along * dy;
+                    line.emplace_back(x + jitter(gen), y + jitter(gen));
+                }
+                mapnik::feature_ptr feature(mapnik::feature_factory::create(ctx, ++id));
+                feature->put("class", to_unicode(cls));
+                feature->put("name", to_unicode((dir == 0 ? "East Street " : "North Avenue ") + std::to_string(i)));
+                if (cls == "motorway") feature->put("ref", to_unicode("A" + std::to_string(i / 16)));
+                else feature->put("ref", mapnik::value_null());
+                feature->set_geometry(std::move(line));
+                ds->push(feature);
+            }
+        }
+    }
+    return ds;
+}
+
+// small rotated rectangles clustered in blocks, with heights for extrusion
+inline datasource_ptr buildings(mapnik::box2d<double> const& extent, double density = 1.0, unsigned seed = 2)
+{
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> ux(extent.minx(), extent.maxx());
+    std::uniform_real_distribution<double> uy(extent.miny(), extent.maxy());
+    std::uniform_real_distribution<double> size(6.0, 30.0);
+    std::uniform_real_distribution<double> angle(0.0, 3.14159265358979323846);
+    std::uniform_int_distribution<int> height(3, 60);
+    auto ds = make_datasource();
+    auto ctx = std::make_shared<mapnik::context_type>();
+    ctx->push("height");
+    ctx->push("type");
+    static const char * types[] = { "residential", "commercial", "industrial", "school" };
+    int count = static_cast<int>(60000 * density);
+    for (int i = 0; i < count; ++i)
+    {
+        double cx = ux(gen);
+        double cy = uy(gen);
+        double w = size(gen);
+        double h = size(gen);
+        double a = angle(gen);
+        double ca = std::cos(a);
+        double sa = std::sin(a);
+        mapnik::geometry::linear_ring<double> ring;
+        ring.reserve(5);
+        double corners[4][2] = {{-w, -h}, {w, -h}, {w, h}, {-w, h}};
+        for (auto const& c : corners)
+        {
+            ring.emplace_back(cx + c[0] * ca - c[1] * sa, cy + c[0] * sa + c[1] * ca);
+        }
+        ring.push_back(ring.front());
+        mapnik::geometry::polygon<double> poly;
+        poly.push_back(std::move(ring));
+        mapnik::feature_ptr feature(mapnik::feature_factory::create(ctx, i + 1));
+        feature->put("height", mapnik::value_integer(height(gen)));
+        feature->put("type", to_unicode(types[i % 4]));
+        feature->set_geometry(std::move(poly));
+        ds->push(feature);
+    }
+    return ds;
+}
+
+// large, many-vertex areas (some with holes) for fills, patterns and comp-ops
+inline datasource_ptr landuse(mapnik::box2d<double> const& extent, double density = 1.0, unsigned seed = 3)
+{
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> ux(extent.minx(), extent.maxx());
+    std::uniform_real_distribution<double> uy(extent.miny(), extent.maxy());
+    std::uniform_real_distribution<double> radius(100.0, 1500.0);
+    std::uniform_real_distribution<double> wobble(0.8, 1.2);
+    auto ds = make_datasource();
+    auto ctx = std::make_shared<mapnik::context_type>();
+    ctx->push("kind");
+    static const char * kinds[] = { "park", "forest", "residential", "water" };
+    int count = static_cast<int>(400 * density);
+    for (int i = 0; i < count; ++i)
+    {
+        double cx = ux(gen);
+        double cy = uy(gen);
+        double r = radius(gen);
+        mapnik::geometry::polygon<double> poly;
+        mapnik::geometry::linear_ring<double> exterior;
+        int vertices = 256;
+        exterior.reserve(vertices + 1);
+        for (int k = 0; k < vertices; ++k)
+        {
+            double a = 2 * 3.14159265358979323846 * k / vertices;
+            double rr = r * wobble(gen);
+            exterior.emplace_back(cx + rr * std::cos(a), cy + rr * std::sin(a));
+        }
+        exterior.push_back(exterior.front());
+        poly.push_back(std::move(exterior));
+        if (i % 3 == 0)
+        {
+            mapnik::geometry::linear_ring<double> hole;
+            for (int k = vertices; k >= 0; k -= 4)
+            {
+                double a = 2 * 3.14159265358979323846 * k / vertices;
+                hole.emplace_back(cx + 0.3 * r * std::cos(a), cy + 0.3 * r * std::sin(a));
+            }
+            poly.push_back(std::move(hole));
+        }
+        mapnik::feature_ptr feature(mapnik::feature_factory::create(ctx, i + 1));
+        feature->put("kind", to_unicode(kinds[i % 4]));
+        feature->set_geometry(std::move(poly));
+        ds->push(feature);
+    }
+    return ds;
+}
+
+// points of interest with names of varying length for labels and markers
+inline datasource_ptr pois(mapnik::box2d<double> const& extent, double density = 1.0, unsigned seed = 4)
+{
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> ux(extent.minx(), extent.maxx());
+    std::uniform_real_distribution<double> uy(extent.miny(), extent.maxy());
+    std::uniform_int_distribution<int> rank(1, 10);
+    auto ds = make_datasource();
+    auto ctx = std::make_shared<mapnik::context_type>();
+    ctx->push("kind");
+    ctx->push("name");
+    ctx->push("rank");
+    static const char * kinds[] = { "shop", "cafe", "school", "station", "pharmacy" };
+    static const char * words[] = { "Central", "Old Town", "Riverside", "Hill", "Market",
+                                    "Garden", "Königs", "Saint-Étienne", "Harbour", "Lake" };
+    int count = static_cast<int>(20000 * density);
+    for (int i = 0; i < count; ++i)
+    {
+        std::string name = std::string(words[i % 10]) + " " + kinds[i % 5];
+        if (i % 3 == 0) name += " " + std::string(words[(i / 10) % 10]);
+        mapnik::feature_ptr feature(mapnik::feature_factory::create(ctx, i + 1));
+        feature->put("kind", to_unicode(kinds[i % 5]));
+        feature->put("name", to_unicode(name));
+        feature->put("rank", mapnik::value_integer(rank(gen)));
+        feature->set_geometry(mapnik::geometry::point<double>(ux(gen), uy(gen)));
+        ds->push(feature);
+    }
+    return ds;
+}
+
+// smooth RGBA hillshade-like raster covering the extent
+inline datasource_ptr raster(mapnik::box2d<double> const& extent, unsigned size = 1024)
+{
+    mapnik::image_rgba8 image(size, size);
+    for (unsigned y = 0; y < size; ++y)
+    {
+        for (unsigned x = 0; x < size; ++x)
+        {
+            double v = 0.5 + 0.25 * std::sin(x * 0.031) * std::cos(y * 0.027)
+                + 0.25 * std::sin((x + y) * 0.0071);
+            std::uint8_t c = static_cast<std::uint8_t>(std::max(0.0, std::min(255.0, v * 255.0)));
+            image(x, y) = (255u << 24) | (c << 16) | (c << 8) | c;
+        }
+    }
+    auto ds = make_datasource();
+    auto ctx = std::make_shared<mapnik::context_type>();
+    mapnik::feature_ptr feature(mapnik::feature_factory::create(ctx, 1));
+    feature->set_raster(std::make_shared<mapnik::raster>(extent, std::move(image), 1.0));
+    ds->push(feature);
+    return ds;
+}
+
+// attach generated datasources to map layers by layer name; layers named
+// `<dataset>-<suffix>` (e.g. `roads-labels`) share the dataset's datasource
+inline void attach(mapnik::Map & map, mapnik::box2d<double> const& extent, double density = 1.0)
+{
+    std::map<std::string, datasource_ptr> cache;
+    for (auto & lyr : map.layers())
+    {
+        std::string name = lyr.name().substr(0, lyr.name().find('-'));
+        auto itr = cache.find(name);
+        if (itr == cache.end())
+        {
+            datasource_ptr ds;
+            if (name == "roads") ds = roads(extent, density);
+            else if (name == "buildings") ds = buildings(extent, density);
+            else if (name == "landuse") ds = landuse(extent, density);
+            else if (name == "pois") ds = pois(extent, density);
+            else if (name == "raster") ds = raster(extent);
+            else continue;
+            itr = cache.emplace(name, ds).first;
+        }
+        lyr.set_datasource(itr->second);
+    }
+}
+
+}}
+
+#endif // MAPNIK_BENCH_SYNTHETIC_DATA_HPP
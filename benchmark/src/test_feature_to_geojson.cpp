@@ -0,0 +1,88 @@
+#include "bench_framework.hpp"
+#include "synthetic_data.hpp"
+
+// mapnik
+#include <mapnik/query.hpp>
+#include <mapnik/util/feature_to_geojson.hpp>
+#include <mapnik/json/feature_generator_grammar.hpp>
+
+// Serializes the synthetic roads and points of interest to GeoJSON, as a
+// feature-info request returning many query results does, with the
+// streaming geojson_writer behind util::to_geojson and with the Boost.Spirit
+// Karma feature_generator_grammar it replaced.
+class test_feature_to_geojson : public benchmark::test_case
+{
+    std::vector<mapnik::feature_ptr> features_;
+    bool karma_;
+public:
+    test_feature_to_geojson(mapnik::parameters const& params, bool karma)
+     : test_case(params),
+       features_(),
+       karma_(karma)
+    {
+        double density = *params.get<mapnik::value_double>("density", 0.1);
+        mapnik::query q(benchmark::synthetic::default_extent);
+        for (auto const& ds : { benchmark::synthetic::roads(benchmark::synthetic::default_extent, density),
+                                benchmark::synthetic::pois(benchmark::synthetic::default_extent, density) })
+        {
+            auto fs = ds->features(q);
+            for (auto feature = fs->next(); feature; feature = fs->next())
+            {
+                features_.push_back(feature);
+            }
+        }
+    }
+
+    bool serialize(std::string & json) const
+    {
+        using sink_type = std::back_insert_iterator<std::string>;
+        static const mapnik::json::feature_generator_grammar<sink_type, mapnik::feature_impl> grammar;
+        json.clear();
+        for (auto const& feature : features_)
+        {
+            if (karma_)
+            {
+                sink_type sink(json);
+                if (!boost::spirit::karma::generate(sink, grammar, *feature)) return false;
+            }
+            else if (!mapnik::util::to_geojson(json, *feature))
+            {
+                return false;
+            }
+            json += '\n';
+        }
+        return true;
+    }
+
+    bool validate() const
+    {
+        std::string json;
+        return !features_.empty() && serialize(json) && !json.empty();
+    }
+
+    bool operator()() const
+    {
+        std::string json;
+        for (std::size_t i = 0; i < iterations_; ++i)
+        {
+            if (!serialize(json)) return false;
+        }
+        return true;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    mapnik::parameters params;
+    benchmark::handle_args(argc,argv,params);
+    int return_value = 0;
+    {
+        test_feature_to_geojson test_runner(params, true);
+        return_value = return_value | run(test_runner,"feature to geojson (karma)");
+    }
+    {
+        test_feature_to_geojson test_runner(params, false);
+        return_value = return_value | run(test_runner,"feature to geojson (geojson_writer)");
+    }
+    return return_value;
+}
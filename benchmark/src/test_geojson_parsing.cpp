@@ -0,0 +1,130 @@
+#include "bench_framework.hpp"
+#include "synthetic_data.hpp"
+
+// mapnik
+#include <mapnik/query.hpp>
+#include <mapnik/feature_factory.hpp>
+#include <mapnik/util/feature_to_geojson.hpp>
+#include <mapnik/json/json_grammar_config.hpp>
+#include <mapnik/json/feature_grammar_x3.hpp>
+#include <mapnik/json/extract_bounding_boxes_x3.hpp>
+#include <mapnik/json/feature_builder.hpp>
+
+// Decodes a large FeatureCollection (the synthetic roads, buildings and
+// points of interest) the way the geojson plugin does: locate the features
+// and their bounding boxes, then parse every feature. Runs with the Spirit X3
+// grammars, with the hand-written feature_builder and with feature_builder
+// only decoding the one property a style would ask for.
+class test_geojson_parsing : public benchmark::test_case
+{
+public:
+    enum mode_type { x3, builder, builder_filtered };
+private:
+    using boxes_type = std::vector<std::pair<mapnik::box2d<double>, std::pair<std::uint64_t, std::uint64_t>>>;
+    std::string json_;
+    mode_type mode_;
+    std::set<std::string> names_;
+public:
+    test_geojson_parsing(mapnik::parameters const& params, mode_type mode)
+     : test_case(params),
+       json_(),
+       mode_(mode),
+       names_({"class"})
+    {
+        double density = *params.get<mapnik::value_double>("density", 0.1);
+        mapnik::query q(benchmark::synthetic::default_extent);
+        json_ = "{\"type\":\"FeatureCollection\",\"features\":[";
+        bool first = true;
+        for (auto const& ds : { benchmark::synthetic::roads(benchmark::synthetic::default_extent, density),
+                                benchmark::synthetic::buildings(benchmark::synthetic::default_extent, density),
+                                benchmark::synthetic::pois(benchmark::synthetic::default_extent, density) })
+        {
+            auto fs = ds->features(q);
+            for (auto feature = fs->next(); feature; feature = fs->next())
+            {
+                std::string str;
+                if (!mapnik::util::to_geojson(str, *feature)) continue;
+                if (!first) json_ += ",\n";
+                json_ += str;
+                first = false;
+            }
+        }
+        json_ += "]}";
+    }
+
+    std::size_t parse() const
+    {
+        static const mapnik::transcoder tr("utf8");
+        char const* start = json_.c_str();
+        char const* end = start + json_.size();
+        char const* itr = start;
+        boxes_type boxes;
+        if (mode_ == x3) mapnik::json::extract_bounding_boxes(itr, end, boxes);
+        else mapnik::json::scan_bounding_boxes(itr, end, boxes);
+        if (itr != end) return 0;
+
+        auto ctx = std::make_shared<mapnik::context_type>();
+        std::size_t count = 0;
+        for (auto const& item : boxes)
+        {
+            char const* feature_start = start + item.second.first;
+            char const* feature_end = feature_start + item.second.second;
+            mapnik::feature_ptr feature(mapnik::feature_factory::create(ctx, ++count));
+            if (mode_ == x3)
+            {
+                namespace x3 = boost::spirit::x3;
+                using space_type = mapnik::json::grammar::space_type;
+#if BOOST_VERSION >= 106700
+                auto grammar = x3::with<mapnik::json::grammar::transcoder_tag>(tr)
+                    [x3::with<mapnik::json::grammar::feature_tag>(*feature)
+                     [ mapnik::json::feature_grammar() ]];
+#else
+                auto grammar = x3::with<mapnik::json::grammar::transcoder_tag>(std::ref(tr))
+                    [x3::with<mapnik::json::grammar::feature_tag>(std::ref(*feature))
+                     [ mapnik::json::feature_grammar() ]];
+#endif
+                if (!x3::phrase_parse(feature_start, feature_end, grammar, space_type())) return 0;
+            }
+            else
+            {
+                mapnik::json::build_feature(feature_start, feature_end, *feature, tr,
+                                            mode_ == builder_filtered ? &names_ : nullptr);
+            }
+        }
+        return count;
+    }
+
+    bool validate() const
+    {
+        return !json_.empty() && parse() > 0;
+    }
+
+    bool operator()() const
+    {
+        for (std::size_t i = 0; i < iterations_; ++i)
+        {
+            if (parse() == 0) return false;
+        }
+        return true;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    mapnik::parameters params;
+    benchmark::handle_args(argc,argv,params);
+    int return_value = 0;
+    {
+        test_geojson_parsing test_runner(params, test_geojson_parsing::x3);
+        return_value = return_value | run(test_runner,"geojson parsing (x3)");
+    }
+    {
+        test_geojson_parsing test_runner(params, test_geojson_parsing::builder);
+        return_value = return_value | run(test_runner,"geojson parsing (feature_builder)");
+    }
+    {
+        test_geojson_parsing test_runner(params, test_geojson_parsing::builder_filtered);
+        return_value = return_value | run(test_runner,"geojson parsing (feature_builder, one property)");
+    }
+    return return_value;
+}
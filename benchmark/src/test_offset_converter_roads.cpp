@@ -0,0 +1,89 @@
+#include "bench_framework.hpp"
+#include "synthetic_data.hpp"
+
+// mapnik
+#include <mapnik/query.hpp>
+#include <mapnik/geometry.hpp>
+#include <mapnik/vertex_adapters.hpp>
+#include <mapnik/offset_converter.hpp>
+
+// Offsets every road of the synthetic street grid, the way a line symbolizer
+// with `offset` renders a road layer: many short, bent lines instead of one
+// long straight path. Runs once with per-converter storage and once with all
+// converters reusing the same scratch buffers, as the renderers do.
+class test_offset_roads : public benchmark::test_case
+{
+    std::vector<mapnik::geometry::line_string<double>> roads_;
+    double offset_;
+    bool shared_buffers_;
+public:
+    test_offset_roads(mapnik::parameters const& params, bool shared_buffers)
+     : test_case(params),
+       roads_(),
+       offset_(*params.get<mapnik::value_double>("offset", 10.0)),
+       shared_buffers_(shared_buffers)
+    {
+        double density = *params.get<mapnik::value_double>("density", 1.0);
+        auto ds = benchmark::synthetic::roads(benchmark::synthetic::default_extent, density);
+        mapnik::query q(benchmark::synthetic::default_extent);
+        auto fs = ds->features(q);
+        for (auto feature = fs->next(); feature; feature = fs->next())
+        {
+            auto const& geom = feature->get_geometry();
+            if (geom.is<mapnik::geometry::line_string<double>>())
+            {
+                roads_.push_back(geom.get<mapnik::geometry::line_string<double>>());
+            }
+        }
+    }
+
+    bool validate() const
+    {
+        return !roads_.empty() && offset_all() > 0;
+    }
+
+    std::size_t offset_all() const
+    {
+        mapnik::offset_converter_buffers buffers;
+        std::size_t count = 0;
+        for (auto const& line : roads_)
+        {
+            mapnik::geometry::line_string_vertex_adapter<double> va(line);
+            mapnik::offset_converter<mapnik::geometry::line_string_vertex_adapter<double>> off_path(va);
+            off_path.set_offset(offset_);
+            if (shared_buffers_) off_path.set_buffers(buffers);
+            double x, y;
+            while (off_path.vertex(&x, &y) != mapnik::SEG_END)
+            {
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    bool operator()() const
+    {
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < iterations_; ++i)
+        {
+            count += offset_all();
+        }
+        return count > 0;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    mapnik::parameters params;
+    benchmark::handle_args(argc,argv,params);
+    int return_value = 0;
+    {
+        test_offset_roads test_runner(params, false);
+        return_value = return_value | run(test_runner,"offset roads");
+    }
+    {
+        test_offset_roads test_runner(params, true);
+        return_value = return_value | run(test_runner,"offset roads (shared buffers)");
+    }
+    return return_value;
+}
@@ -0,0 +1,118 @@
+#include "bench_framework.hpp"
+#include "synthetic_data.hpp"
+#include <mapnik/map.hpp>
+#include <mapnik/image_util.hpp>
+#include <mapnik/load_map.hpp>
+#include <mapnik/agg_renderer.hpp>
+#include <mapnik/request.hpp>
+#include <mapnik/datasource_cache.hpp>
+#include <mapnik/font_engine_freetype.hpp>
+#include <stdexcept>
+
+// Renders one of the synthetic scenarios in benchmark/data/scenarios at a
+// given web mercator zoom level, e.g.
+//
+//   ./benchmark/out/test_rendering_scenarios --scenario roads --zoom 15 \
+//       --iterations 20 --threads 4
+//
+// All threads share one loaded map and one copy of the generated data.
+class test : public benchmark::test_case
+{
+    std::string xml_;
+    mapnik::box2d<double> extent_;
+    mapnik::value_integer width_;
+    mapnik::value_integer height_;
+    double scale_factor_;
+    std::string preview_;
+    std::shared_ptr<mapnik::Map> m_;
+public:
+    test(mapnik::parameters const& params)
+     : test_case(params),
+       xml_(),
+       extent_(),
+       width_(*params.get<mapnik::value_integer>("width",256)),
+       height_(*params.get<mapnik::value_integer>("height",256)),
+       scale_factor_(*params.get<mapnik::value_double>("scale_factor",1.0)),
+       preview_(*params.get<std::string>("preview","")),
+       m_(std::make_shared<mapnik::Map>(width_,height_))
+    {
+        boost::optional<std::string> map = params.get<std::string>("map");
+        boost::optional<std::string> scenario = params.get<std::string>("scenario");
+        if (map) xml_ = *map;
+        else if (scenario) xml_ = "benchmark/data/scenarios/" + *scenario + ".xml";
+        else throw std::runtime_error("please provide a --scenario <name> or --map <path to xml> arg");
+
+        mapnik::value_integer zoom = *params.get<mapnik::value_integer>("zoom",15);
+        double density = *params.get<mapnik::value_double>("density",1.0);
+        if (zoom < 0 || zoom > 24) throw std::runtime_error("--zoom must be within 0..24");
+
+        mapnik::load_map(*m_,xml_,true);
+        benchmark::synthetic::attach(*m_, benchmark::synthetic::default_extent, density);
+
+        // a fixed, off-centre window so tiles do not line up with the data grid
+        double const merc_max_extent = 20037508.342789244;
+        double res = 2.0 * merc_max_extent / (256.0 * (1 << zoom));
+        double cx = 1234.5;
+        double cy = -678.9;
+        extent_.init(cx - 0.5 * width_ * res, cy - 0.5 * height_ * res,
+                     cx + 0.5 * width_ * res, cy + 0.5 * height_ * res);
+    }
+
+    void render(mapnik::image_rgba8 & im) const
+    {
+        mapnik::request req(width_, height_, extent_);
+        req.set_buffer_size(m_->buffer_size());
+        mapnik::attributes vars;
+        mapnik::agg_renderer<mapnik::image_rgba8> ren(*m_,req,vars,im,scale_factor_,0,0);
+        ren.apply();
+    }
+
+    bool validate() const
+    {
+        mapnik::image_rgba8 im(width_,height_);
+        render(im);
+        if (!preview_.empty()) {
+            std::clog << "preview available at " << preview_ << "\n";
+            mapnik::save_to_file(im,preview_);
+        }
+        return !mapnik::is_solid(im);
+    }
+
+    bool operator()() const
+    {
+        if (!preview_.empty()) {
+            return false;
+        }
+        for (unsigned i=0;i<iterations_;++i)
+        {
+            mapnik::image_rgba8 im(width_,height_);
+            render(im);
+        }
+        return true;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    int return_value = 0;
+    try
+    {
+        mapnik::parameters params;
+        benchmark::handle_args(argc,argv,params);
+        boost::optional<std::string> name = params.get<std::string>("name");
+        std::string test_name = name ? *name : "scenario " + *params.get<std::string>("scenario", "custom")
+            + " z" + *params.get<std::string>("zoom", "15");
+        mapnik::freetype_engine::register_fonts("./fonts/",true);
+        mapnik::datasource_cache::instance().register_datasources("./plugins/input/");
+        {
+            test test_runner(params);
+            return_value = run(test_runner,test_name);
+        }
+    }
+    catch (std::exception const& ex)
+    {
+        std::clog << ex.what() << "\n";
+        return -1;
+    }
+    return return_value;
+}
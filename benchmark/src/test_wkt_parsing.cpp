@@ -0,0 +1,89 @@
+#include "bench_framework.hpp"
+#include "synthetic_data.hpp"
+
+// mapnik
+#include <mapnik/query.hpp>
+#include <mapnik/wkt/wkt_factory.hpp>
+#include <mapnik/wkt/wkt_grammar_x3.hpp>
+#include <mapnik/util/geometry_to_wkt.hpp>
+
+// Parses the synthetic roads, buildings and landuse as WKT, one string per
+// feature, the way the csv plugin reads a `wkt` column. Runs with the Spirit
+// X3 grammar and with the hand-written reader behind from_wkt.
+class test_wkt_parsing : public benchmark::test_case
+{
+    std::vector<std::string> wkts_;
+    bool x3_;
+public:
+    test_wkt_parsing(mapnik::parameters const& params, bool x3)
+     : test_case(params),
+       wkts_(),
+       x3_(x3)
+    {
+        double density = *params.get<mapnik::value_double>("density", 0.1);
+        mapnik::query q(benchmark::synthetic::default_extent);
+        for (auto const& ds : { benchmark::synthetic::roads(benchmark::synthetic::default_extent, density),
+                                benchmark::synthetic::buildings(benchmark::synthetic::default_extent, density),
+                                benchmark::synthetic::landuse(benchmark::synthetic::default_extent, density) })
+        {
+            auto fs = ds->features(q);
+            for (auto feature = fs->next(); feature; feature = fs->next())
+            {
+                std::string wkt;
+                if (mapnik::util::to_wkt(wkt, feature->get_geometry())) wkts_.push_back(std::move(wkt));
+            }
+        }
+    }
+
+    std::size_t parse() const
+    {
+        namespace x3 = boost::spirit::x3;
+        std::size_t count = 0;
+        for (auto const& wkt : wkts_)
+        {
+            mapnik::geometry::geometry<double> geom;
+            if (x3_)
+            {
+                auto itr = wkt.begin();
+                auto end = wkt.end();
+                if (!x3::phrase_parse(itr, end, mapnik::wkt_grammar(), x3::ascii::space, geom) || itr != end) return 0;
+            }
+            else if (!mapnik::from_wkt(wkt, geom))
+            {
+                return 0;
+            }
+            ++count;
+        }
+        return count;
+    }
+
+    bool validate() const
+    {
+        return !wkts_.empty() && parse() == wkts_.size();
+    }
+
+    bool operator()() const
+    {
+        for (std::size_t i = 0; i < iterations_; ++i)
+        {
+            if (parse() == 0) return false;
+        }
+        return true;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    mapnik::parameters params;
+    benchmark::handle_args(argc,argv,params);
+    int return_value = 0;
+    {
+        test_wkt_parsing test_runner(params, true);
+        return_value = return_value | run(test_runner,"wkt parsing (x3)");
+    }
+    {
+        test_wkt_parsing test_runner(params, false);
+        return_value = return_value | run(test_runner,"wkt parsing (from_wkt)");
+    }
+    return return_value;
+}
@@ -51,6 +51,9 @@ if env['SVG_RENDERER']:
 if env['GRID_RENDERER']:
     subdirs.append('grid')
 
+if env['MVT_RENDERER']:
+    subdirs.append('mvt')
+
 if 'install' in COMMAND_LINE_TARGETS:
     for subdir in subdirs:
         pathdir = os.path.join(base,subdir,'*.hpp')
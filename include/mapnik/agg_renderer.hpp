@@ -54,6 +54,7 @@ namespace mapnik {
   struct marker;
   class proj_transform;
   struct rasterizer;
+  class building_geometry;
   struct rgba8_t;
   template<typename T> class image;
 }
@@ -219,6 +220,32 @@ private:
     gamma_method_enum gamma_method_;
     double gamma_;
     renderer_common common_;
+    // consecutive polygons with the same resolved fill are accumulated in
+    // the rasterizer and swept once, see process(polygon_symbolizer)
+    struct polygon_batch
+    {
+        unsigned fill = 0;
+        double opacity = 1.0;
+        double gamma = 1.0;
+        gamma_method_enum gamma_method = GAMMA_POWER;
+        composite_mode_e comp_op = src_over;
+        buffer_type * buffer = nullptr;
+        std::size_t size = 0;
+    };
+    polygon_batch polygon_batch_;
+    // extruded buildings are collected and drawn back to front, see
+    // process(building_symbolizer)
+    struct building_batch
+    {
+        double gamma = 1.0;
+        gamma_method_enum gamma_method = GAMMA_POWER;
+        buffer_type * buffer = nullptr;
+        std::unique_ptr<building_geometry> geometry;
+    };
+    building_batch building_batch_;
+    void flush_polygon_batch();
+    void flush_building_batch();
+    void flush_batches();
     void setup(Map const & m, buffer_type & pixmap);
 };
 
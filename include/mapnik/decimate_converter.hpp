@@ -0,0 +1,156 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2017 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+#ifndef MAPNIK_DECIMATE_CONVERTER_HPP
+#define MAPNIK_DECIMATE_CONVERTER_HPP
+
+// mapnik
+#include <mapnik/vertex.hpp>
+
+// stl
+#include <cmath>
+
+namespace mapnik
+{
+
+// Drops consecutive line_to vertices falling into the same square cell
+// of a screen-space grid. Meant to run after the view transform, where
+// vertices closer together than a fraction of a pixel cannot change the
+// rasterized result in any visible way. Vertices are compared against the
+// last emitted vertex; once a vertex leaves that cell it is emitted and the
+// dropped run before it is discarded. Only a run reaching the end of a
+// sub-path (move_to, close or end) has its last vertex emitted, so sub-path
+// end points (and line caps) stay where they are.
+template <typename Geometry>
+struct decimate_converter
+{
+    static constexpr double default_cell_size = 0.25; // pixels
+
+    decimate_converter(Geometry & geom)
+        : geom_(geom),
+          cell_size_(default_cell_size),
+          last_x_(0),
+          last_y_(0),
+          pending_(false),
+          pending_x_(0),
+          pending_y_(0),
+          queued_(false),
+          queued_cmd_(SEG_END),
+          queued_x_(0),
+          queued_y_(0) {}
+
+    void set_cell_size(double cell_size)
+    {
+        cell_size_ = cell_size;
+    }
+
+    double cell_size() const
+    {
+        return cell_size_;
+    }
+
+    unsigned type() const
+    {
+        return static_cast<unsigned>(geom_.type());
+    }
+
+    void rewind(unsigned pos)
+    {
+        pending_ = false;
+        queued_ = false;
+        geom_.rewind(pos);
+    }
+
+    unsigned vertex(double * x, double * y)
+    {
+        if (queued_)
+        {
+            queued_ = false;
+            return emit(queued_cmd_, queued_x_, queued_y_, x, y);
+        }
+        double vx, vy;
+        unsigned cmd;
+        while ((cmd = geom_.vertex(&vx, &vy)) == SEG_LINETO)
+        {
+            double cx = std::floor(vx / cell_size_);
+            double cy = std::floor(vy / cell_size_);
+            if (cx == last_x_ && cy == last_y_)
+            {
+                pending_ = true;
+                pending_x_ = vx;
+                pending_y_ = vy;
+                continue;
+            }
+            last_x_ = cx;
+            last_y_ = cy;
+            pending_ = false;
+            *x = vx;
+            *y = vy;
+            return cmd;
+        }
+        if (pending_)
+        {
+            // flush the end of the run before the move_to, close or end
+            pending_ = false;
+            queued_ = true;
+            queued_cmd_ = cmd;
+            queued_x_ = vx;
+            queued_y_ = vy;
+            *x = pending_x_;
+            *y = pending_y_;
+            return SEG_LINETO;
+        }
+        return emit(cmd, vx, vy, x, y);
+    }
+
+private:
+    unsigned emit(unsigned cmd, double vx, double vy, double * x, double * y)
+    {
+        if (cmd == SEG_MOVETO)
+        {
+            last_x_ = std::floor(vx / cell_size_);
+            last_y_ = std::floor(vy / cell_size_);
+        }
+        *x = vx;
+        *y = vy;
+        return cmd;
+    }
+
+    Geometry & geom_;
+    double cell_size_;
+    double last_x_;
+    double last_y_;
+    bool pending_;
+    double pending_x_;
+    double pending_y_;
+    bool queued_;
+    unsigned queued_cmd_;
+    double queued_x_;
+    double queued_y_;
+};
+
+template <typename Geometry>
+constexpr double decimate_converter<Geometry>::default_cell_size;
+
+}
+
+#endif // MAPNIK_DECIMATE_CONVERTER_HPP
@@ -26,6 +26,7 @@
 // mapnik
 #include <mapnik/feature.hpp>
 #include <mapnik/value/types.hpp>
+#include <mapnik/util/arena.hpp>
 
 // boost
 //#include <boost/pool/pool_alloc.hpp>
@@ -40,6 +41,15 @@ struct feature_factory
         //return boost::allocate_shared<feature_impl>(boost::fast_pool_allocator<feature_impl>(),fid);
         return std::make_shared<feature_impl>(ctx,fid);
     }
+
+    // allocate feature and its control block from a monotonic arena
+    // falls back to the default heap when no arena is supplied
+    static std::shared_ptr<feature_impl> create (context_ptr const& ctx, mapnik::value_integer fid,
+                                                 util::arena_ptr const& arena)
+    {
+        if (!arena) return std::make_shared<feature_impl>(ctx,fid);
+        return std::allocate_shared<feature_impl>(util::arena_allocator<feature_impl>(arena),ctx,fid);
+    }
 };
 }
 
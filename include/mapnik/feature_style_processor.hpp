@@ -28,6 +28,7 @@
 #include <mapnik/featureset.hpp>
 #include <mapnik/config.hpp>
 #include <mapnik/feature_style_processor_context.hpp>
+#include <mapnik/util/arena.hpp>
 
 // stl
 #include <vector>
@@ -58,6 +59,14 @@ public:
     explicit feature_style_processor(Map const& m,
                                      double scale_factor = 1.0);
 
+    /*!
+     * \brief whether every layer is read once and its features replayed to
+     * each style, as with cache-features="true" on a layer with several
+     * active styles. Processors hide this to return true when they must see
+     * the same feature objects across styles.
+     */
+    static constexpr bool always_cache_features() { return false; }
+
     /*!
      * \brief apply renderer to all map layers.
      */
@@ -121,6 +130,9 @@ private:
     void render_submaterials(layer_rendering_material const & mat, Processor & p);
 
     Map const& m_;
+    // shared by the queries of all layers, datasources that support it
+    // allocate their features from it (see query::get_arena)
+    util::arena_ptr arena_;
 };
 }
 
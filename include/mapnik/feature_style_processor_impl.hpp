@@ -45,8 +45,11 @@
 #include <mapnik/util/featureset_buffer.hpp>
 #include <mapnik/util/variant.hpp>
 #include <mapnik/symbolizer_dispatch.hpp>
+#include <mapnik/instrumentation.hpp>
 
 // stl
+#include <array>
+#include <memory>
 #include <vector>
 #include <stdexcept>
 
@@ -76,7 +79,8 @@ struct layer_rendering_material
 
 template <typename Processor>
 feature_style_processor<Processor>::feature_style_processor(Map const& m, double scale_factor)
-    : m_(m)
+    : m_(m),
+      arena_(std::make_shared<util::monotonic_arena>())
 {
     // https://github.com/mapnik/mapnik/issues/1100
     if (scale_factor <= 0)
@@ -218,6 +222,7 @@ void feature_style_processor<Processor>::apply_to_layer(layer const& lay,
         render_material(mat,p);
         render_submaterials(mat, p);
 
+        instrumentation::stage_scope composite_scope(instrumentation::stage::composite);
         p.end_layer_processing(mat.lay_);
     }
 }
@@ -234,6 +239,7 @@ void feature_style_processor<Processor>::prepare_layer(layer_rendering_material
                                                        int buffer_size,
                                                        std::set<std::string>& names)
 {
+    instrumentation::stage_scope setup_scope(instrumentation::stage::setup);
     layer const& lay = mat.lay_;
 
     std::vector<std::string> const& style_names = lay.styles();
@@ -415,6 +421,7 @@ void feature_style_processor<Processor>::prepare_layer(layer_rendering_material
 
     query q(layer_ext,res,scale_denom,extent);
     q.set_variables(p.variables());
+    q.set_arena(arena_);
 
     if (p.attribute_collection_policy() == COLLECT_ALL)
     {
@@ -440,9 +447,11 @@ void feature_style_processor<Processor>::prepare_layer(layer_rendering_material
         q.add_property_name(group_by);
     }
 
-    bool cache_features = lay.cache_features() && active_styles.size() > 1;
+    bool cache_features = Processor::always_cache_features() ||
+        (lay.cache_features() && active_styles.size() > 1);
 
     std::vector<featureset_ptr> & featureset_ptr_list = mat.featureset_ptr_list_;
+    instrumentation::stage_scope query_scope(instrumentation::stage::query);
     if (!group_by.empty() || cache_features)
     {
         featureset_ptr_list.push_back(ds->features_with_context(q,current_ctx));
@@ -469,6 +478,7 @@ void feature_style_processor<Processor>::render_submaterials(layer_rendering_mat
             render_material(mat, p);
             render_submaterials(mat, p);
 
+            instrumentation::stage_scope composite_scope(instrumentation::stage::composite);
             p.end_layer_processing(mat.lay_);
         }
     }
@@ -498,7 +508,8 @@ void feature_style_processor<Processor>::render_material(layer_rendering_materia
 
     proj_transform prj_trans(mat.proj0_,mat.proj1_);
 
-    bool cache_features = lay.cache_features() && active_styles.size() > 1;
+    bool cache_features = Processor::always_cache_features() ||
+        (lay.cache_features() && active_styles.size() > 1);
 
     datasource_ptr ds = lay.datasource();
     std::string group_by = lay.group_by();
@@ -553,11 +564,14 @@ void feature_style_processor<Processor>::render_material(layer_rendering_materia
         if (features)
         {
             // Cache all features into the memory_datasource before rendering.
-            feature_ptr feature;
-            while ((feature = features->next()))
+            std::array<feature_ptr, featureset_batch_size> batch;
+            std::size_t count;
+            while ((count = features->next_batch(batch.data(), batch.size())) > 0)
             {
-
-                cache->push(feature);
+                for (std::size_t n = 0; n < count; ++n)
+                {
+                    cache->push(std::move(batch[n]));
+                }
             }
         }
         std::size_t i = 0;
@@ -595,6 +609,9 @@ void feature_style_processor<Processor>::render_style(
     featureset_ptr features,
     proj_transform const& prj_trans)
 {
+    // lazily evaluated featuresets are iterated here, so datasource
+    // reads are charged to the style stage rather than the query stage
+    instrumentation::stage_scope style_scope(instrumentation::stage::style);
     p.start_style_processing(*style);
     if (!features)
     {
@@ -602,69 +619,75 @@ void feature_style_processor<Processor>::render_style(
         return;
     }
     mapnik::attributes vars = p.variables();
-    feature_ptr feature;
     bool was_painted = false;
-    while ((feature = features->next()))
+    std::array<feature_ptr, featureset_batch_size> batch;
+    std::size_t count;
+    while ((count = features->next_batch(batch.data(), batch.size())) > 0)
     {
-        bool do_else = true;
-        bool do_also = false;
-        for (rule const* r : rc.get_if_rules() )
+        for (std::size_t n = 0; n < count; ++n)
         {
-            expression_ptr const& expr = r->get_filter();
-            value_type result = util::apply_visitor(evaluate<feature_impl,value_type,attributes>(*feature,vars),*expr);
-            if (result.to_bool())
+            feature_ptr feature = std::move(batch[n]);
+            bool do_else = true;
+            bool do_also = false;
+            for (rule const* r : rc.get_if_rules() )
             {
-                was_painted = true;
-                do_else=false;
-                do_also=true;
-                rule::symbolizers const& symbols = r->get_symbolizers();
-                if(!p.process(symbols,*feature,prj_trans))
+                expression_ptr const& expr = r->get_filter();
+                value_type result = util::apply_visitor(evaluate<feature_impl,value_type,attributes>(*feature,vars),*expr);
+                if (result.to_bool())
                 {
-                    for (symbolizer const& sym : symbols)
+                    was_painted = true;
+                    do_else=false;
+                    do_also=true;
+                    rule::symbolizers const& symbols = r->get_symbolizers();
+                    if(!p.process(symbols,*feature,prj_trans))
                     {
-                        util::apply_visitor(symbolizer_dispatch<Processor>(p,*feature,prj_trans),sym);
+                        for (symbolizer const& sym : symbols)
+                        {
+                            util::apply_visitor(symbolizer_dispatch<Processor>(p,*feature,prj_trans),sym);
+                        }
+                    }
+                    if (style->get_filter_mode() == FILTER_FIRST)
+                    {
+                        // Stop iterating over rules and proceed with next feature.
+                        do_also=false;
+                        break;
                     }
-                }
-                if (style->get_filter_mode() == FILTER_FIRST)
-                {
-                    // Stop iterating over rules and proceed with next feature.
-                    do_also=false;
-                    break;
                 }
             }
-        }
-        if (do_else)
-        {
-            for( rule const* r : rc.get_else_rules() )
+            if (do_else)
             {
-                was_painted = true;
-                rule::symbolizers const& symbols = r->get_symbolizers();
-                if(!p.process(symbols,*feature,prj_trans))
+                for( rule const* r : rc.get_else_rules() )
                 {
-                    for (symbolizer const& sym : symbols)
+                    was_painted = true;
+                    rule::symbolizers const& symbols = r->get_symbolizers();
+                    if(!p.process(symbols,*feature,prj_trans))
                     {
-                        util::apply_visitor(symbolizer_dispatch<Processor>(p,*feature,prj_trans),sym);
+                        for (symbolizer const& sym : symbols)
+                        {
+                            util::apply_visitor(symbolizer_dispatch<Processor>(p,*feature,prj_trans),sym);
+                        }
                     }
                 }
             }
-        }
-        if (do_also)
-        {
-            for( rule const* r : rc.get_also_rules() )
+            if (do_also)
             {
-                was_painted = true;
-                rule::symbolizers const& symbols = r->get_symbolizers();
-                if(!p.process(symbols,*feature,prj_trans))
+                for( rule const* r : rc.get_also_rules() )
                 {
-                    for (symbolizer const& sym : symbols)
+                    was_painted = true;
+                    rule::symbolizers const& symbols = r->get_symbolizers();
+                    if(!p.process(symbols,*feature,prj_trans))
                     {
-                        util::apply_visitor(symbolizer_dispatch<Processor>(p,*feature,prj_trans),sym);
+                        for (symbolizer const& sym : symbols)
+                        {
+                            util::apply_visitor(symbolizer_dispatch<Processor>(p,*feature,prj_trans),sym);
+                        }
                     }
                 }
             }
         }
     }
     p.painted(p.painted() | was_painted);
+    instrumentation::stage_scope composite_scope(instrumentation::stage::composite);
     p.end_style_processing(*style);
 }
 
@@ -27,7 +27,8 @@
 #include <mapnik/config.hpp>
 #include <mapnik/util/noncopyable.hpp>
 
-// boost
+// stl
+#include <cstddef>
 #include <memory>
 
 namespace mapnik {
@@ -38,9 +39,27 @@ using feature_ptr = std::shared_ptr<feature_impl>;
 struct MAPNIK_DECL Featureset : private util::noncopyable
 {
     virtual feature_ptr next() = 0;
+
+    // Fill `features` with up to `size` features and return how many were
+    // written; zero means the featureset is exhausted, any other count may
+    // be smaller than `size`. Featuresets override this to avoid a virtual
+    // call per feature and to read ahead; the default forwards to next().
+    virtual std::size_t next_batch(feature_ptr * features, std::size_t size)
+    {
+        std::size_t count = 0;
+        while (count < size && (features[count] = next()))
+        {
+            ++count;
+        }
+        return count;
+    }
+
     virtual ~Featureset() {}
 };
 
+// number of features the renderers request per next_batch() call
+constexpr std::size_t featureset_batch_size = 64;
+
 struct MAPNIK_DECL invalid_featureset final : Featureset
 {
     feature_ptr next()
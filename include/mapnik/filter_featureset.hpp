@@ -48,6 +48,30 @@ public:
         return feature;
     }
 
+    std::size_t next_batch(feature_ptr * features, std::size_t size)
+    {
+        // filter in place, reading on until a batch has a match
+        std::size_t count = 0;
+        while (count == 0)
+        {
+            std::size_t read = fs_->next_batch(features, size);
+            if (read == 0) break;
+            for (std::size_t i = 0; i < read; ++i)
+            {
+                if (filter_.pass(*features[i]))
+                {
+                    if (i != count) features[count] = std::move(features[i]);
+                    ++count;
+                }
+            }
+            for (std::size_t i = count; i < read; ++i)
+            {
+                features[i].reset();
+            }
+        }
+        return count;
+    }
+
 private:
     featureset_ptr fs_;
     filter_type filter_;
@@ -28,6 +28,10 @@
 #include <mapnik/geometry.hpp>
 #include <mapnik/geom_util.hpp>
 
+// stl
+#include <algorithm>
+#include <limits>
+
 namespace mapnik {
 
 namespace detail {
@@ -155,6 +159,103 @@ struct hit_test_visitor
     double tol_;
 };
 
+// Distance from x,y to the nearest part of a geometry. Polygons are only
+// hit from inside: zero inside (even-odd over all rings, so holes are
+// excluded), infinity outside, whatever the tolerance. Used to rank hits.
+struct hit_distance_visitor
+{
+    hit_distance_visitor(double x, double y)
+     : x_(x),
+       y_(y) {}
+
+    double operator() (geometry::geometry_empty const& ) const
+    {
+        return std::numeric_limits<double>::infinity();
+    }
+
+    double operator() (geometry::point<double> const& pt) const
+    {
+        return distance(pt.x, pt.y, x_, y_);
+    }
+
+    double operator() (geometry::multi_point<double> const& points) const
+    {
+        double result = std::numeric_limits<double>::infinity();
+        for (auto const& pt : points)
+        {
+            result = std::min(result, distance(pt.x, pt.y, x_, y_));
+        }
+        return result;
+    }
+
+    double operator() (geometry::line_string<double> const& line) const
+    {
+        if (line.size() == 1) return distance(line.front().x, line.front().y, x_, y_);
+        double result = std::numeric_limits<double>::infinity();
+        for (std::size_t i = 1; i < line.size(); ++i)
+        {
+            result = std::min(result, point_to_segment_distance(x_, y_, line[i - 1].x, line[i - 1].y,
+                                                                line[i].x, line[i].y));
+        }
+        return result;
+    }
+
+    double operator() (geometry::multi_line_string<double> const& lines) const
+    {
+        double result = std::numeric_limits<double>::infinity();
+        for (auto const& line : lines)
+        {
+            result = std::min(result, operator()(line));
+        }
+        return result;
+    }
+
+    double operator() (geometry::polygon<double> const& poly) const
+    {
+        bool inside = false;
+        for (auto const& ring : poly)
+        {
+            std::size_t num_points = ring.size();
+            if (num_points == 0) continue;
+            // rings are implicitly closed
+            for (std::size_t i = 0, j = num_points - 1; i < num_points; j = i++)
+            {
+                auto const& pt0 = ring[j];
+                auto const& pt1 = ring[i];
+                if (pip(pt0.x, pt0.y, pt1.x, pt1.y, x_, y_)) inside = !inside;
+            }
+        }
+        return inside ? 0.0 : std::numeric_limits<double>::infinity();
+    }
+
+    double operator() (geometry::multi_polygon<double> const& polygons) const
+    {
+        for (auto const& poly : polygons)
+        {
+            if (operator()(poly) == 0.0) return 0.0;
+        }
+        return std::numeric_limits<double>::infinity();
+    }
+
+    double operator() (geometry::geometry_collection<double> const& collection) const
+    {
+        double result = std::numeric_limits<double>::infinity();
+        for (auto const& geom : collection)
+        {
+            result = std::min(result, mapnik::util::apply_visitor(*this, geom));
+        }
+        return result;
+    }
+
+    double x_;
+    double y_;
+};
+
+}
+
+inline double hit_distance(mapnik::geometry::geometry<double> const& geom, double x, double y)
+{
+    return mapnik::util::apply_visitor(detail::hit_distance_visitor(x, y), geom);
 }
 
 inline bool hit_test(mapnik::geometry::geometry<double> const& geom, double x, double y, double tol)
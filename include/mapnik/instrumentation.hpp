@@ -0,0 +1,181 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2017 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+#ifndef MAPNIK_INSTRUMENTATION_HPP
+#define MAPNIK_INSTRUMENTATION_HPP
+
+// mapnik
+#include <mapnik/config.hpp>
+
+// stl
+#include <cstdint>
+#include <iosfwd>
+#include <mutex>
+#ifdef MAPNIK_INSTRUMENTATION
+#include <chrono>
+#endif
+
+// Allocation and lock contention instrumentation.
+//
+// Compiled in with `ENABLE_INSTRUMENTATION=True` (defines MAPNIK_INSTRUMENTATION)
+// and switched on at runtime with `instrumentation::set_enabled(true)`.
+// Without the build flag every type below is an empty inline shim, so the
+// hooks in the render path cost nothing.
+
+namespace mapnik { namespace instrumentation {
+
+// render stages allocations are attributed to
+enum class stage : unsigned
+{
+    other = 0,      // outside any render stage
+    setup,          // map/layer preparation, projections, query setup
+    query,          // datasource features() and featureset iteration
+    style,          // rule evaluation and symbolizer processing
+    composite,      // style/layer compositing and image filters
+    count
+};
+
+// global locks whose wait time is recorded
+enum class lock_site : unsigned
+{
+    marker_cache = 0,
+    mapped_memory_cache,
+    datasource_cache,
+    freetype_engine,
+    projection,
+    pool,
+    label_anchor_cache,
+    lazy_datasource,
+    count
+};
+
+struct stage_stats
+{
+    std::uint64_t allocations = 0;
+    std::uint64_t bytes = 0;
+};
+
+struct lock_stats
+{
+    std::uint64_t acquisitions = 0;
+    std::uint64_t contended = 0;
+    std::uint64_t wait_ns = 0;
+    std::uint64_t max_wait_ns = 0;
+};
+
+struct snapshot
+{
+    stage_stats stages[static_cast<unsigned>(stage::count)];
+    lock_stats locks[static_cast<unsigned>(lock_site::count)];
+};
+
+MAPNIK_DECL char const* stage_name(stage s);
+MAPNIK_DECL char const* lock_site_name(lock_site s);
+
+#ifdef MAPNIK_INSTRUMENTATION
+
+MAPNIK_DECL void set_enabled(bool enabled);
+MAPNIK_DECL bool enabled();
+// totals since start (or last reset) across all threads
+MAPNIK_DECL snapshot get_snapshot();
+MAPNIK_DECL void reset();
+// human readable report in the same layout as MAPNIK_STATS timers
+MAPNIK_DECL void report(std::ostream & out);
+
+namespace detail {
+MAPNIK_DECL stage enter_stage(stage s);
+MAPNIK_DECL void leave_stage(stage previous);
+MAPNIK_DECL void record_lock(lock_site site, bool contended, std::uint64_t wait_ns);
+}
+
+// RAII scope attributing heap allocations on this thread to a render stage;
+// nested scopes are exclusive: the inner stage is charged, not the outer one
+class stage_scope
+{
+public:
+    explicit stage_scope(stage s)
+        : previous_(detail::enter_stage(s)) {}
+    ~stage_scope() { detail::leave_stage(previous_); }
+    stage_scope(stage_scope const&) = delete;
+    stage_scope& operator=(stage_scope const&) = delete;
+private:
+    stage previous_;
+};
+
+// drop-in replacement for std::lock_guard recording acquisitions,
+// contention and time spent waiting for the mutex
+template <typename Mutex>
+class lock_guard
+{
+public:
+    lock_guard(Mutex & mutex, lock_site site)
+        : mutex_(mutex)
+    {
+        if (!enabled())
+        {
+            mutex_.lock();
+            return;
+        }
+        if (mutex_.try_lock())
+        {
+            detail::record_lock(site, false, 0);
+            return;
+        }
+        auto start = std::chrono::steady_clock::now();
+        mutex_.lock();
+        auto wait = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        detail::record_lock(site, true, static_cast<std::uint64_t>(wait.count()));
+    }
+    ~lock_guard() { mutex_.unlock(); }
+    lock_guard(lock_guard const&) = delete;
+    lock_guard& operator=(lock_guard const&) = delete;
+private:
+    Mutex & mutex_;
+};
+
+#else
+
+inline void set_enabled(bool) {}
+inline bool enabled() { return false; }
+inline snapshot get_snapshot() { return snapshot(); }
+inline void reset() {}
+MAPNIK_DECL void report(std::ostream & out);
+
+class stage_scope
+{
+public:
+    explicit stage_scope(stage) {}
+};
+
+template <typename Mutex>
+class lock_guard : public std::lock_guard<Mutex>
+{
+public:
+    lock_guard(Mutex & mutex, lock_site)
+        : std::lock_guard<Mutex>(mutex) {}
+};
+
+#endif
+
+}}
+
+#endif // MAPNIK_INSTRUMENTATION_HPP
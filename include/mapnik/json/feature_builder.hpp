@@ -0,0 +1,57 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2017 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+#ifndef MAPNIK_JSON_FEATURE_BUILDER_HPP
+#define MAPNIK_JSON_FEATURE_BUILDER_HPP
+
+// mapnik
+#include <mapnik/feature.hpp>
+#include <mapnik/unicode.hpp>
+#include <mapnik/geometry.hpp>
+
+// stl
+#include <set>
+#include <string>
+
+namespace mapnik { namespace json {
+
+// Hand-written GeoJSON decoding on top of json_tokenizer. Coordinates are
+// emitted straight into the geometry containers instead of going through the
+// intermediate `positions` of the Spirit X3 grammars, and properties missing
+// from `names` (when given) are skipped without being decoded.
+// All functions throw std::runtime_error on malformed input.
+
+void build_feature(char const* start, char const* end, feature_impl & feature,
+                   mapnik::transcoder const& tr,
+                   std::set<std::string> const* names = nullptr);
+
+void build_geometry(char const* start, char const* end, mapnik::geometry::geometry<double> & geom);
+
+// Locate the features of a FeatureCollection and compute their bounding boxes.
+// Boxes is a sequence of (box, (offset, size)) pairs, offsets are relative to
+// `start`, which is left pointing past the collection on return.
+template <typename Boxes>
+void scan_bounding_boxes(char const*& start, char const* end, Boxes & boxes);
+
+}}
+
+#endif // MAPNIK_JSON_FEATURE_BUILDER_HPP
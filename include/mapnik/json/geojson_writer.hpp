@@ -0,0 +1,79 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2017 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+#ifndef MAPNIK_JSON_GEOJSON_WRITER_HPP
+#define MAPNIK_JSON_GEOJSON_WRITER_HPP
+
+// mapnik
+#include <mapnik/geometry.hpp>
+#include <mapnik/value/types.hpp>
+// stl
+#include <string>
+
+namespace mapnik {
+
+class feature_impl;
+namespace value_adl_barrier { class value; }
+using value = value_adl_barrier::value;
+
+namespace json {
+
+// significant digits written for coordinates unless told otherwise, as
+// produced by the Karma geometry_generator_grammar
+static constexpr unsigned geojson_default_precision = 15;
+
+// Hand-rolled GeoJSON serializer appending straight to a std::string.
+// Coordinates are written in fixed notation rounded to `precision`
+// significant digits (1..17) with trailing zeros dropped, as the Karma
+// grammar did; values too large or small for the exact integer path are
+// rounded by printf and spelled out in fixed notation as well.
+// Property values are written as the Karma generators do, except that
+// keys and all control characters are escaped.
+//
+// The writer only appends, so callers serializing many features can keep
+// one writer and one output buffer for all of them.
+class geojson_writer
+{
+public:
+    explicit geojson_writer(std::string & out, unsigned precision = geojson_default_precision);
+
+    void write(feature_impl const& feature);
+    void write(geometry::geometry<double> const& geom);
+    void write(value const& val);
+    void write_number(double val);
+    void write_number(value_integer val);
+    void write_string(std::string const& str);
+
+    unsigned precision() const { return precision_; }
+    std::string & output() { return out_; }
+
+private:
+    void write_properties(feature_impl const& feature);
+
+    std::string & out_;
+    unsigned precision_;
+    std::string scratch_;
+};
+
+}}
+
+#endif // MAPNIK_JSON_GEOJSON_WRITER_HPP
@@ -0,0 +1,335 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2017 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+#ifndef MAPNIK_JSON_JSON_TOKENIZER_HPP
+#define MAPNIK_JSON_JSON_TOKENIZER_HPP
+
+// mapnik
+#include <mapnik/value/types.hpp>
+#include <mapnik/util/decimal.hpp>
+
+// stl
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace mapnik { namespace json {
+
+// Hand-written JSON tokenizer over a contiguous character range. Tokens are
+// consumed in place: strings are decoded into caller-provided buffers (which
+// keep their capacity between calls), numbers are converted without copying
+// and values that are not needed can be skipped without allocating at all.
+// Every malformed input throws std::runtime_error.
+class json_tokenizer
+{
+public:
+    json_tokenizer(char const* start, char const* end)
+        : cur_(start),
+          end_(end) {}
+
+    char const* position() const { return cur_; }
+
+    // next significant character or '\0' at the end of input
+    char peek()
+    {
+        skip_whitespace();
+        return cur_ != end_ ? *cur_ : '\0';
+    }
+
+    void skip_whitespace()
+    {
+        while (cur_ != end_ && is_space(*cur_)) ++cur_;
+    }
+
+    bool consume(char c)
+    {
+        skip_whitespace();
+        if (cur_ != end_ && *cur_ == c)
+        {
+            ++cur_;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c)
+    {
+        if (!consume(c)) error("unexpected character");
+    }
+
+    // 'true', 'false' and 'null'
+    bool consume_literal(char const* literal)
+    {
+        skip_whitespace();
+        std::size_t length = std::strlen(literal);
+        if (static_cast<std::size_t>(end_ - cur_) >= length
+            && std::memcmp(cur_, literal, length) == 0)
+        {
+            cur_ += length;
+            return true;
+        }
+        return false;
+    }
+
+    // decode a double-quoted string into `str` (UTF-8)
+    void read_string(std::string & str)
+    {
+        expect('"');
+        str.clear();
+        for (;;)
+        {
+            char const* chunk = cur_;
+            while (cur_ != end_ && *cur_ != '"' && *cur_ != '\\') ++cur_;
+            str.append(chunk, cur_);
+            if (cur_ == end_) error("unterminated string");
+            if (*cur_++ == '"') return;
+            read_escape(str);
+        }
+    }
+
+    void skip_string()
+    {
+        expect('"');
+        for (;;)
+        {
+            while (cur_ != end_ && *cur_ != '"' && *cur_ != '\\') ++cur_;
+            if (cur_ == end_) error("unterminated string");
+            if (*cur_++ == '"') return;
+            if (cur_ == end_) error("unterminated string");
+            ++cur_;
+        }
+    }
+
+    // returns true when the number is an integer that fits into value_integer
+    bool read_number(value_integer & integer, double & real)
+    {
+        return parse_number(&integer, real);
+    }
+
+    double read_double()
+    {
+        double real;
+        parse_number(nullptr, real);
+        return real;
+    }
+
+    // validate and skip any JSON value
+    void skip_value()
+    {
+        switch (peek())
+        {
+        case '"':
+            skip_string();
+            break;
+        case '{':
+            ++cur_;
+            if (!consume('}'))
+            {
+                do
+                {
+                    skip_string();
+                    expect(':');
+                    skip_value();
+                }
+                while (consume(','));
+                expect('}');
+            }
+            break;
+        case '[':
+            ++cur_;
+            if (!consume(']'))
+            {
+                do
+                {
+                    skip_value();
+                }
+                while (consume(','));
+                expect(']');
+            }
+            break;
+        case 't':
+            if (!consume_literal("true")) error("invalid literal");
+            break;
+        case 'f':
+            if (!consume_literal("false")) error("invalid literal");
+            break;
+        case 'n':
+            if (!consume_literal("null")) error("invalid literal");
+            break;
+        default:
+            read_double();
+            break;
+        }
+    }
+
+    [[noreturn]] void error(char const* what) const
+    {
+        throw std::runtime_error(std::string("JSON parse error: ") + what);
+    }
+
+private:
+    static bool is_space(char c)
+    {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+    }
+
+    bool parse_number(value_integer * integer, double & real)
+    {
+        skip_whitespace();
+        char const* begin = cur_;
+        util::decimal num;
+        if (!util::scan_decimal(cur_, end_, num)) error("invalid number");
+        if (integer && num.integral && !num.truncated)
+        {
+            using limits = std::numeric_limits<value_integer>;
+            std::uint64_t max = static_cast<std::uint64_t>(limits::max());
+            if (num.significand <= max)
+            {
+                *integer = num.negative ? -static_cast<value_integer>(num.significand)
+                                        : static_cast<value_integer>(num.significand);
+                return true;
+            }
+            if (num.negative && num.significand == max + 1)
+            {
+                *integer = limits::min();
+                return true;
+            }
+        }
+        if (!util::decimal_to_double(num, begin, cur_, real)) error("invalid number");
+        return false;
+    }
+
+    unsigned read_hex(int count)
+    {
+        if (end_ - cur_ < count) error("invalid escape sequence");
+        unsigned value = 0;
+        for (int i = 0; i < count; ++i)
+        {
+            char c = *cur_++;
+            value <<= 4;
+            if (c >= '0' && c <= '9') value |= static_cast<unsigned>(c - '0');
+            else if (c >= 'a' && c <= 'f') value |= static_cast<unsigned>(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F') value |= static_cast<unsigned>(c - 'A' + 10);
+            else error("invalid escape sequence");
+        }
+        return value;
+    }
+
+    static void append_utf8(std::string & str, std::uint32_t cp)
+    {
+        if (cp < 0x80)
+        {
+            str += static_cast<char>(cp);
+        }
+        else if (cp < 0x800)
+        {
+            str += static_cast<char>(0xC0 | (cp >> 6));
+            str += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+        else if (cp < 0x10000)
+        {
+            str += static_cast<char>(0xE0 | (cp >> 12));
+            str += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            str += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+        else if (cp < 0x110000)
+        {
+            str += static_cast<char>(0xF0 | (cp >> 18));
+            str += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            str += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            str += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+
+    // escapes accepted by unicode_string_grammar_x3, which is a superset of JSON
+    void read_escape(std::string & str)
+    {
+        if (cur_ == end_) error("unterminated string");
+        char c = *cur_++;
+        switch (c)
+        {
+        case '"': str += '"'; break;
+        case '\\': str += '\\'; break;
+        case '/': str += '/'; break;
+        case 'b': str += '\b'; break;
+        case 'f': str += '\f'; break;
+        case 'n': str += '\n'; break;
+        case 'r': str += '\r'; break;
+        case 't': str += '\t'; break;
+        case ' ': str += ' '; break;
+        case '\t': str += '\t'; break;
+        case '0': str += '\0'; break;
+        case 'a': str += '\a'; break;
+        case 'v': str += '\v'; break;
+        case 'e': str += '\x1B'; break;
+        case '_': append_utf8(str, 0xA0); break;
+        case 'N': append_utf8(str, 0x85); break;
+        case 'L': append_utf8(str, 0x2028); break;
+        case 'P': append_utf8(str, 0x2029); break;
+        case 'x': str += static_cast<char>(read_hex(2)); break;
+        case 'U': append_utf8(str, read_hex(8)); break;
+        case 'u':
+        {
+            std::uint32_t cp = read_hex(4);
+            if (cp >= 0xD800 && cp < 0xDC00)
+            {
+                // surrogate pair
+                if (end_ - cur_ >= 6 && cur_[0] == '\\' && cur_[1] == 'u')
+                {
+                    cur_ += 2;
+                    std::uint32_t low = read_hex(4);
+                    if (low >= 0xDC00 && low < 0xE000)
+                    {
+                        append_utf8(str, 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00));
+                    }
+                    else if (low < 0xD800 || low >= 0xE000)
+                    {
+                        append_utf8(str, low);
+                    }
+                }
+            }
+            else if (cp < 0xDC00 || cp >= 0xE000)
+            {
+                append_utf8(str, cp);
+            }
+            break;
+        }
+        case '\r':
+            // line continuation
+            if (cur_ != end_ && *cur_ == '\n') ++cur_;
+            break;
+        case '\n':
+            break;
+        default:
+            error("invalid escape sequence");
+        }
+    }
+
+    char const* cur_;
+    char const* end_;
+};
+
+}}
+
+#endif // MAPNIK_JSON_JSON_TOKENIZER_HPP
@@ -0,0 +1,130 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2017 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+#ifndef MAPNIK_LABEL_ANCHOR_CACHE_HPP
+#define MAPNIK_LABEL_ANCHOR_CACHE_HPP
+
+// mapnik
+#include <mapnik/config.hpp>
+#include <mapnik/geometry/point.hpp>
+#include <mapnik/geometry/polygon.hpp>
+#include <mapnik/symbolizer_enumerations.hpp>
+#include <mapnik/value/types.hpp>
+#include <mapnik/util/noncopyable.hpp>
+
+// stl
+#include <string>
+#include <unordered_map>
+#ifdef MAPNIK_THREADSAFE
+#include <mutex>
+#endif
+
+namespace mapnik {
+
+// Label anchors of polygons for INTERIOR_PLACEMENT and POLYLABEL_PLACEMENT,
+// kept in map coordinates and keyed by layer, feature id and geometry.
+//
+// Both searches stop at a precision relative to the polygon size, so an
+// anchor found in map coordinates is valid at every zoom level and can be
+// shared by all tiles rendered from a map (see Map::set_label_anchor_cache).
+// An anchor is reused when it was computed with a scale factor no larger
+// than the requested one. Anchors can also be filled in up front by calling
+// anchor() for every feature in an offline pass.
+//
+// Anchors are in the map srs: clear the cache when the srs or the layer
+// data change.
+class MAPNIK_DECL label_anchor_cache : private util::noncopyable
+{
+public:
+    struct key_type
+    {
+        std::string layer;
+        value_integer feature_id;
+        std::size_t geometry_hash;
+        label_placement_enum placement;
+
+        bool operator==(key_type const& rhs) const
+        {
+            return feature_id == rhs.feature_id &&
+                geometry_hash == rhs.geometry_hash &&
+                placement == rhs.placement &&
+                layer == rhs.layer;
+        }
+    };
+
+    // `max_size` of zero keeps every anchor; otherwise new anchors are not
+    // stored once the cache is full
+    explicit label_anchor_cache(std::size_t max_size = 0);
+
+    // Anchor of `poly`, given in map coordinates, either from the cache or
+    // computed and stored.
+    bool anchor(key_type const& key,
+                geometry::polygon<double> const& poly,
+                double scale_factor,
+                geometry::point<double> & pt);
+
+    bool find(key_type const& key, double scale_factor, geometry::point<double> & pt) const;
+    void insert(key_type const& key, double scale_factor, geometry::point<double> const& pt);
+
+    std::size_t size() const;
+    void clear();
+
+    // hash of the vertices, for key_type::geometry_hash
+    static std::size_t hash(geometry::polygon<double> const& poly);
+
+    // Anchor of `poly` in map coordinates (y pointing up). The search runs
+    // with y flipped so it matches the search in screen coordinates up to
+    // scale and translation.
+    static bool compute(label_placement_enum placement,
+                        geometry::polygon<double> const& poly,
+                        double scale_factor,
+                        geometry::point<double> & pt);
+
+private:
+    struct key_hash
+    {
+        std::size_t operator()(key_type const& key) const;
+    };
+
+    struct entry
+    {
+        geometry::point<double> pt;
+        double scale_factor;
+    };
+
+    std::size_t max_size_;
+    std::unordered_map<key_type, entry, key_hash> anchors_;
+#ifdef MAPNIK_THREADSAFE
+    mutable std::mutex mutex_;
+#endif
+};
+
+// cache and current layer the text symbolizer helpers look anchors up in
+struct label_anchor_context
+{
+    label_anchor_cache * cache = nullptr;
+    std::string layer;
+};
+
+}
+
+#endif // MAPNIK_LABEL_ANCHOR_CACHE_HPP
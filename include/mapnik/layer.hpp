@@ -193,6 +193,66 @@ public:
      */
     std::string const& group_by() const;
 
+    /*!
+     * @param size Set the screen-space size in pixels below which polygon
+     *        and line features are not rendered (0 disables culling).
+     *        Only honoured by the AGG renderer.
+     */
+    void set_minimum_feature_size(double size);
+
+    /*!
+     * @return the minimum screen-space feature size in pixels.
+     */
+    double minimum_feature_size() const;
+
+    /*!
+     * @param dot Set whether culled features are drawn as a single pixel
+     *        dot instead, to keep the coverage of dense layers.
+     */
+    void set_minimum_feature_dot(bool dot);
+
+    /*!
+     * @return whether culled features are drawn as a single pixel dot.
+     */
+    bool minimum_feature_dot() const;
+
+    /*!
+     * @param decimation Set whether consecutive vertices falling into the
+     *        same sub-pixel cell are dropped after the view transform.
+     *        Only honoured by the AGG renderer.
+     */
+    void set_vertex_decimation(bool decimation);
+
+    /*!
+     * @return whether vertex decimation is enabled for this layer.
+     */
+    bool vertex_decimation() const;
+
+    /*!
+     * @param batching Set whether consecutive polygons sharing a fill are
+     *        rasterized in one pass (AGG renderer only). Batched polygons
+     *        use the non-zero fill rule and overlapping translucent members
+     *        are blended once, so output can differ from per-feature fills.
+     */
+    void set_polygon_batching(bool batching);
+
+    /*!
+     * @return whether polygon batching is enabled for this layer.
+     */
+    bool polygon_batching() const;
+
+    /*!
+     * @param batching Set whether building symbolizers are collected and
+     *        drawn back to front when the batch is flushed (AGG renderer
+     *        only), instead of one feature at a time in datasource order.
+     */
+    void set_building_batching(bool batching);
+
+    /*!
+     * @return whether building batching is enabled for this layer.
+     */
+    bool building_batching() const;
+
     /*!
      * @brief Attach a datasource for this layer.
      *
@@ -233,6 +293,11 @@ private:
     bool clear_label_cache_;
     bool cache_features_;
     std::string group_by_;
+    double minimum_feature_size_;
+    bool minimum_feature_dot_;
+    bool vertex_decimation_;
+    bool polygon_batching_;
+    bool building_batching_;
     std::vector<std::string> styles_;
     std::vector<layer> layers_;
     datasource_ptr ds_;
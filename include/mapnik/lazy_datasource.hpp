@@ -0,0 +1,83 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2017 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+#ifndef MAPNIK_LAZY_DATASOURCE_HPP
+#define MAPNIK_LAZY_DATASOURCE_HPP
+
+// mapnik
+#include <mapnik/config.hpp>
+#include <mapnik/datasource.hpp>
+
+// stl
+#include <future>
+#include <memory>
+#ifdef MAPNIK_THREADSAFE
+#include <mutex>
+#endif
+
+namespace mapnik {
+
+class Map;
+
+// Proxy for a datasource that is only created, through datasource_cache,
+// the first time it is queried. Plugins open connections, read files and
+// build indexes in their constructors; deferring that keeps loading a map
+// with many layers cheap and only pays for the layers actually rendered.
+//
+// load_map creates a lazy_datasource for every <Datasource> with the
+// parameter `lazy` set to true (a datasource template can set it for all
+// layers). Errors creating the datasource are thrown from the first query
+// instead of from load_map, and creation is retried on the next query.
+class MAPNIK_DECL lazy_datasource : public datasource
+{
+public:
+    explicit lazy_datasource(parameters const& params);
+
+    // the wrapped datasource, created on first use
+    datasource_ptr get() const;
+    bool initialized() const;
+
+    datasource_t type() const;
+    processor_context_ptr get_context(feature_style_context_map & ctx) const;
+    featureset_ptr features_with_context(query const& q, processor_context_ptr ctx) const;
+    boost::optional<datasource_geometry_t> get_geometry_type() const;
+    featureset_ptr features(query const& q) const;
+    featureset_ptr features_at_point(coord2d const& pt, double tol = 0) const;
+    box2d<double> envelope() const;
+    layer_descriptor get_descriptor() const;
+
+private:
+    mutable datasource_ptr ds_;
+#ifdef MAPNIK_THREADSAFE
+    mutable std::mutex mutex_;
+#endif
+};
+
+// Creates the lazy datasources of all layers of `map` on a background
+// thread. The returned future must be kept alive while warming up (its
+// destructor waits for the thread); creation errors are logged and left
+// to surface on the first query.
+MAPNIK_DECL std::future<void> warm_up_datasources(Map const& map);
+
+}
+
+#endif // MAPNIK_LAZY_DATASOURCE_HPP
@@ -29,6 +29,7 @@
 #include <mapnik/font_set.hpp>
 #include <mapnik/enumeration.hpp>
 #include <mapnik/geometry/box2d.hpp>
+#include <mapnik/coord.hpp>
 #include <mapnik/params.hpp>
 #include <mapnik/well_known_srs.hpp>
 #include <mapnik/image_compositing.hpp>
@@ -50,9 +51,23 @@ namespace mapnik
 
 struct Featureset;
 using featureset_ptr = std::shared_ptr<Featureset>;
+class feature_impl;
+using feature_ptr = std::shared_ptr<feature_impl>;
 class feature_type_style;
 class view_transform;
 class layer;
+class label_anchor_cache;
+
+// A feature found by Map::query_map_points. `point` indexes the queried
+// points, `layer` the map layers and `distance` is in pixels, zero when the
+// point lies inside a polygon.
+struct point_query_hit
+{
+    std::size_t point;
+    unsigned layer;
+    double distance;
+    feature_ptr feature;
+};
 
 class MAPNIK_DECL Map : boost::equality_comparable<Map>
 {
@@ -103,6 +118,7 @@ private:
     boost::optional<std::string> font_directory_;
     freetype_engine::font_file_mapping_type font_file_mapping_;
     freetype_engine::font_memory_cache_type font_memory_cache_;
+    std::shared_ptr<label_anchor_cache> label_anchor_cache_;
 
 public:
 
@@ -452,6 +468,23 @@ public:
      */
     featureset_ptr query_map_point(unsigned index, double x, double y) const;
 
+    /*!
+     * @brief Query several Map layers for features at many points at once
+     *
+     * Each layer is queried once for the area around all points, then
+     * every candidate is tested exactly against the points in pixel space:
+     * polygons must contain the point (the tolerance does not apply to
+     * them), points and lines must be within `tolerance` pixels.
+     *
+     * @param layers The indexes of the layers to query.
+     * @param points The locations in the coordinates of the pixmap or map surface.
+     * @param tolerance The search radius in pixels.
+     * @return The hits ordered by point, then nearest first.
+     */
+    std::vector<point_query_hit> query_map_points(std::vector<unsigned> const& layers,
+                                                  std::vector<coord2d> const& points,
+                                                  double tolerance = 3.0) const;
+
     ~Map();
 
     inline void set_aspect_fix_mode(aspect_fix_mode afm) { aspectFixMode_ = afm; }
@@ -502,6 +535,20 @@ public:
         return font_memory_cache_;
     }
 
+    /*!
+     * @brief Set the cache of interior and polylabel text anchors shared by
+     *        every render of this map and of its copies.
+     */
+    void set_label_anchor_cache(std::shared_ptr<label_anchor_cache> cache)
+    {
+        label_anchor_cache_ = std::move(cache);
+    }
+
+    std::shared_ptr<label_anchor_cache> const& get_label_anchor_cache() const
+    {
+        return label_anchor_cache_;
+    }
+
 private:
     friend void swap(Map & rhs, Map & lhs);
     void fixAspectRatio();
@@ -28,6 +28,9 @@
 #include <mapnik/util/singleton.hpp>
 #include <mapnik/util/noncopyable.hpp>
 
+#include <cstddef>
+#include <cstdint>
+#include <list>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -45,16 +48,71 @@ namespace mapnik
 
 using mapped_region_ptr = std::shared_ptr<boost::interprocess::mapped_region>;
 
+// how a mapped file is going to be read, passed on to the kernel when the
+// file is mapped
+enum class mapped_access : std::uint8_t
+{
+    normal,
+    random,     // looked up through an index: no read-ahead
+    sequential, // read front to back once
+    will_need   // small and read in full (spatial indexes): page in up front
+};
+
+// Cache of read-only file mappings shared by the plugins.
+//
+// The cache is unbounded by default. With set_max_size() it keeps at most
+// that many mapped bytes and unmaps the least recently used files; a file
+// still referenced outside the cache is never evicted, so the limit can be
+// exceeded while all mappings are in use.
 class MAPNIK_DECL mapped_memory_cache :
         public singleton<mapped_memory_cache, CreateStatic>,
         private util::noncopyable
 {
     friend class CreateStatic<mapped_memory_cache>;
-    std::unordered_map<std::string,mapped_region_ptr> cache_;
 public:
+    struct stats_type
+    {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::uint64_t evictions = 0;
+        std::size_t size = 0;  // cached mappings
+        std::size_t bytes = 0; // cached mapped bytes
+    };
+
     bool insert(std::string const& key, mapped_region_ptr);
-    boost::optional<mapped_region_ptr> find(std::string const& key, bool update_cache = false);
+    boost::optional<mapped_region_ptr> find(std::string const& key, bool update_cache = false,
+                                            mapped_access access = mapped_access::normal);
+    bool remove(std::string const& key);
     void clear();
+
+    // zero means unbounded
+    void set_max_size(std::size_t bytes);
+    std::size_t max_size() const;
+
+    // ask for transparent huge pages on new mappings where supported
+    void set_huge_pages(bool huge_pages);
+    bool huge_pages() const;
+
+    stats_type stats() const;
+
+private:
+    mapped_memory_cache();
+
+    struct entry
+    {
+        mapped_region_ptr region;
+        std::size_t size;
+        std::list<std::string>::iterator lru;
+    };
+
+    bool insert_impl(std::string const& key, mapped_region_ptr const& region);
+    void evict();
+
+    std::unordered_map<std::string, entry> cache_;
+    std::list<std::string> lru_; // most recently used first
+    std::size_t max_size_;
+    bool huge_pages_;
+    stats_type stats_;
 };
 
 extern template class MAPNIK_DECL singleton<mapped_memory_cache, CreateStatic>;
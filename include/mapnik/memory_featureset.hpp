@@ -90,6 +90,16 @@ public:
         return feature_ptr();
     }
 
+    std::size_t next_batch(feature_ptr * features, std::size_t size)
+    {
+        std::size_t count = 0;
+        while (count < size && (features[count] = memory_featureset::next()))
+        {
+            ++count;
+        }
+        return count;
+    }
+
 private:
     box2d<double> bbox_;
     std::deque<feature_ptr>::const_iterator pos_;
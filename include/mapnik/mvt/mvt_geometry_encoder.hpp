@@ -0,0 +1,244 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2017 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+#ifndef MAPNIK_MVT_GEOMETRY_ENCODER_HPP
+#define MAPNIK_MVT_GEOMETRY_ENCODER_HPP
+
+// mapnik
+#include <mapnik/geometry/box2d.hpp>
+#include <mapnik/vertex.hpp>
+
+// stl
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace mapnik { namespace mvt {
+
+// geometry types and commands of the vector tile specification, version 2
+enum geom_type : std::uint32_t
+{
+    GEOM_UNKNOWN = 0,
+    GEOM_POINT = 1,
+    GEOM_LINESTRING = 2,
+    GEOM_POLYGON = 3
+};
+
+enum command_type : std::uint32_t
+{
+    CMD_MOVE_TO = 1,
+    CMD_LINE_TO = 2,
+    CMD_CLOSE_PATH = 7
+};
+
+inline std::uint32_t command_integer(command_type id, std::uint32_t count)
+{
+    return (id & 0x7) | (count << 3);
+}
+
+inline std::uint32_t zigzag(std::int32_t n)
+{
+    return (static_cast<std::uint32_t>(n) << 1) ^ static_cast<std::uint32_t>(n >> 31);
+}
+
+// Encodes the vertex streams of one feature into vector tile geometry
+// commands. Vertices in screen coordinates are scaled to the tile grid and
+// rounded, repeated points are dropped and the remaining points are delta
+// and zigzag encoded as the path is read. Rings are closed with ClosePath
+// and oriented as the specification requires: exterior rings clockwise,
+// interior rings counter-clockwise in tile coordinates (y down). Rings that
+// collapse on the grid are dropped, together with their holes.
+//
+// Every add_path() call for polygons must hold one polygon: the first ring
+// is its exterior. Points outside `point_clip` (tile units) are skipped;
+// lines and polygons are expected to be clipped already.
+class geometry_encoder
+{
+public:
+    geometry_encoder(double scale, box2d<double> const& point_clip)
+        : scale_(scale),
+          point_clip_(point_clip),
+          type_(GEOM_UNKNOWN),
+          commands_(),
+          points_(),
+          part_(),
+          cursor_x_(0),
+          cursor_y_(0),
+          ring_index_(0),
+          skip_rings_(false) {}
+
+    void begin(geom_type type)
+    {
+        type_ = type;
+        commands_.clear();
+        points_.clear();
+        cursor_x_ = 0;
+        cursor_y_ = 0;
+    }
+
+    template <typename Path>
+    void add_path(Path & path)
+    {
+        part_.clear();
+        ring_index_ = 0;
+        skip_rings_ = false;
+        path.rewind(0);
+        double x, y;
+        unsigned cmd;
+        while ((cmd = path.vertex(&x, &y)) != SEG_END)
+        {
+            if (cmd == SEG_MOVETO)
+            {
+                end_part();
+                add_vertex(x, y);
+            }
+            else if (cmd == SEG_LINETO)
+            {
+                add_vertex(x, y);
+            }
+            else if ((cmd & 0x0f) == (SEG_CLOSE & 0x0f))
+            {
+                end_part();
+            }
+        }
+        end_part();
+    }
+
+    // flushes pending points, returns false if nothing was encoded
+    bool finish()
+    {
+        if (type_ == GEOM_POINT && !points_.empty())
+        {
+            commands_.push_back(command_integer(CMD_MOVE_TO, static_cast<std::uint32_t>(points_.size())));
+            for (auto const& pt : points_) emit(pt);
+            points_.clear();
+        }
+        return !commands_.empty();
+    }
+
+    geom_type type() const
+    {
+        return type_;
+    }
+
+    std::vector<std::uint32_t> const& commands() const
+    {
+        return commands_;
+    }
+
+private:
+    struct grid_point
+    {
+        std::int32_t x;
+        std::int32_t y;
+        bool operator==(grid_point const& rhs) const { return x == rhs.x && y == rhs.y; }
+    };
+
+    void add_vertex(double x, double y)
+    {
+        x *= scale_;
+        y *= scale_;
+        if (type_ == GEOM_POINT)
+        {
+            if (point_clip_.contains(x, y))
+            {
+                points_.push_back(snap(x, y));
+            }
+            return;
+        }
+        grid_point pt = snap(x, y);
+        if (part_.empty() || !(part_.back() == pt)) part_.push_back(pt);
+    }
+
+    static grid_point snap(double x, double y)
+    {
+        return grid_point { static_cast<std::int32_t>(std::lround(x)),
+                            static_cast<std::int32_t>(std::lround(y)) };
+    }
+
+    void emit(grid_point const& pt)
+    {
+        commands_.push_back(zigzag(pt.x - cursor_x_));
+        commands_.push_back(zigzag(pt.y - cursor_y_));
+        cursor_x_ = pt.x;
+        cursor_y_ = pt.y;
+    }
+
+    void emit_part(bool close)
+    {
+        commands_.push_back(command_integer(CMD_MOVE_TO, 1));
+        emit(part_.front());
+        commands_.push_back(command_integer(CMD_LINE_TO, static_cast<std::uint32_t>(part_.size() - 1)));
+        for (std::size_t i = 1; i < part_.size(); ++i) emit(part_[i]);
+        if (close) commands_.push_back(command_integer(CMD_CLOSE_PATH, 1));
+    }
+
+    void end_part()
+    {
+        if (part_.empty()) return;
+        if (type_ == GEOM_LINESTRING)
+        {
+            if (part_.size() > 1) emit_part(false);
+        }
+        else if (type_ == GEOM_POLYGON)
+        {
+            bool exterior = ring_index_++ == 0;
+            if (part_.size() > 1 && part_.front() == part_.back()) part_.pop_back();
+            std::int64_t area = part_.size() > 2 ? signed_area() : 0;
+            if (exterior) skip_rings_ = (area == 0);
+            if (area != 0 && !skip_rings_)
+            {
+                if ((area > 0) != exterior) std::reverse(part_.begin() + 1, part_.end());
+                emit_part(true);
+            }
+        }
+        part_.clear();
+    }
+
+    // twice the area, positive for clockwise rings in tile coordinates
+    std::int64_t signed_area() const
+    {
+        std::int64_t area = 0;
+        for (std::size_t i = 0, j = part_.size() - 1; i < part_.size(); j = i++)
+        {
+            area += static_cast<std::int64_t>(part_[j].x) * part_[i].y
+                - static_cast<std::int64_t>(part_[i].x) * part_[j].y;
+        }
+        return area;
+    }
+
+    double scale_;
+    box2d<double> point_clip_;
+    geom_type type_;
+    std::vector<std::uint32_t> commands_;
+    std::vector<grid_point> points_;
+    std::vector<grid_point> part_;
+    std::int32_t cursor_x_;
+    std::int32_t cursor_y_;
+    unsigned ring_index_;
+    bool skip_rings_;
+};
+
+}}
+
+#endif // MAPNIK_MVT_GEOMETRY_ENCODER_HPP
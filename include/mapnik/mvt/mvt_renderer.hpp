@@ -0,0 +1,179 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2017 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+#ifndef MAPNIK_MVT_RENDERER_HPP
+#define MAPNIK_MVT_RENDERER_HPP
+
+// mapnik
+#include <mapnik/config.hpp>
+#include <mapnik/feature_style_processor.hpp>
+#include <mapnik/util/noncopyable.hpp>
+#include <mapnik/rule.hpp>              // for rule, symbolizers
+#include <mapnik/geometry/box2d.hpp>     // for box2d
+#include <mapnik/renderer_common.hpp>
+#include <mapnik/symbolizer_base.hpp>
+#include <mapnik/value.hpp>
+
+// stl
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// fwd declarations to speed up compile
+namespace mapnik {
+  class Map;
+  class feature_impl;
+  class feature_type_style;
+  class layer;
+  class proj_transform;
+  class request;
+}
+
+namespace mapnik {
+
+// Encodes the features matched by the map's styles as a Mapbox Vector Tile
+// (specification version 2) instead of drawing them.
+//
+// Every map layer becomes a tile layer of the same name, layers sharing a
+// name are merged. A feature is written once if any active rule of the
+// layer's styles matches it, whatever its symbolizers; all of its non-null
+// attributes are encoded. Each layer is read once and its features are
+// replayed to every style (see always_cache_features), so features are told
+// apart by identity rather than by their possibly repeated ids. Geometries are clipped to the tile plus
+// the layer (or map) buffer, optionally simplified, snapped to a grid of
+// `tile_extent` units across the rendered area and delta/zigzag encoded.
+//
+// The encoded tile is appended to `output` by apply().
+class MAPNIK_DECL mvt_renderer : public feature_style_processor<mvt_renderer>,
+                                 private util::noncopyable
+{
+public:
+    using processor_impl_type = mvt_renderer;
+    static constexpr unsigned default_tile_extent = 4096;
+
+    mvt_renderer(Map const& m, std::string & output, double scale_factor = 1.0);
+    mvt_renderer(Map const& m, request const& req, attributes const& vars,
+                 std::string & output, double scale_factor = 1.0);
+    ~mvt_renderer();
+
+    // grid units across the rendered area (default 4096)
+    void set_tile_extent(unsigned extent) { tile_extent_ = extent; }
+    unsigned tile_extent() const { return tile_extent_; }
+    // Douglas-Peucker tolerance in pixels, 0 (default) disables it
+    void set_simplify_tolerance(double tolerance) { simplify_tolerance_ = tolerance; }
+    double simplify_tolerance() const { return simplify_tolerance_; }
+
+    // keeps the features of a layer alive while all its styles are applied
+    static constexpr bool always_cache_features() { return true; }
+
+    void start_map_processing(Map const& map);
+    void end_map_processing(Map const& map);
+    void start_layer_processing(layer const& lay, box2d<double> const& query_extent);
+    void end_layer_processing(layer const& lay);
+    void start_style_processing(feature_type_style const& st);
+    void end_style_processing(feature_type_style const& /*st*/) {}
+
+    // the symbolizers only decide whether a feature is encoded
+    bool process(rule::symbolizers const& syms,
+                 mapnik::feature_impl & feature,
+                 proj_transform const& prj_trans);
+
+    bool painted() const
+    {
+        return painted_;
+    }
+
+    void painted(bool _painted)
+    {
+        painted_ = _painted;
+    }
+
+    inline eAttributeCollectionPolicy attribute_collection_policy() const
+    {
+        return COLLECT_ALL;
+    }
+
+    inline double scale_factor() const
+    {
+        return common_.scale_factor_;
+    }
+
+    inline attributes const& variables() const
+    {
+        return common_.vars_;
+    }
+
+private:
+    struct value_hash
+    {
+        std::size_t operator()(value const& val) const;
+    };
+
+    struct value_equal
+    {
+        bool operator()(value const& lhs, value const& rhs) const;
+    };
+
+    struct tile_layer
+    {
+        explicit tile_layer(std::string const& _name);
+        std::string name;
+        // encoded Feature messages
+        std::string features;
+        std::size_t feature_count;
+        std::unordered_map<std::string, std::uint32_t> key_index;
+        std::unordered_map<value, std::uint32_t, value_hash, value_equal> value_index;
+        std::vector<std::string> keys;
+        std::vector<value> values;
+    };
+
+    std::uint32_t key_index(std::string const& key);
+    std::uint32_t value_index(value const& val);
+
+    std::string & output_;
+    renderer_common common_;
+    unsigned tile_extent_;
+    double simplify_tolerance_;
+    bool painted_;
+    int buffer_size_;
+    // carries the simplify tolerance to the vertex converters
+    symbolizer_base geometry_sym_;
+    // std::deque keeps current_ valid while layers are added
+    std::deque<tile_layer> layers_;
+    tile_layer * current_;
+    int layer_buffer_size_;
+    // clipping box in the layer srs, computed with the first feature
+    box2d<double> clipping_extent_;
+    bool has_clipping_extent_;
+    // features already passed to process() in the current pass over the
+    // styles of the layer (one per group-by value), all of them kept alive
+    // by the feature cache
+    feature_type_style const* first_style_;
+    std::unordered_set<feature_impl const*> seen_features_;
+};
+
+}
+
+#endif // MAPNIK_MVT_RENDERER_HPP
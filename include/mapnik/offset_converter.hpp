@@ -27,7 +27,6 @@
 #include <mapnik/debug.hpp>
 #endif
 #include <mapnik/config.hpp>
-#include <mapnik/util/math.hpp>
 #include <mapnik/vertex.hpp>
 #include <mapnik/vertex_cache.hpp>
 
@@ -42,6 +41,17 @@ namespace mapnik
 
 static constexpr double offset_converter_default_threshold = 5.0;
 
+// Vertex storage for offset_converter. Sharing one instance between the
+// converters created for consecutive features (see set_buffers) lets them
+// reuse its capacity instead of allocating per path; it must not be shared
+// by converters in use at the same time.
+struct offset_converter_buffers
+{
+    std::vector<vertex2d> points;
+    std::vector<vertex2d> close_points;
+    std::vector<vertex2d> vertices;
+};
+
 template <typename Geometry>
 struct offset_converter
 {
@@ -51,8 +61,9 @@ struct offset_converter
         : geom_(geom)
         , offset_(0.0)
         , threshold_(offset_converter_default_threshold)
-        , half_turn_segments_(16)
         , status_(initial)
+        , pos_(0)
+        , buffers_(nullptr)
         , pre_first_(vertex2d::no_init)
         , pre_(vertex2d::no_init)
         , cur_(vertex2d::no_init)
@@ -88,6 +99,12 @@ struct offset_converter
         }
     }
 
+    void set_buffers(offset_converter_buffers & buffers)
+    {
+        buffers_ = &buffers;
+        reset();
+    }
+
     void set_threshold(double val)
     {
         threshold_ = val;
@@ -108,15 +125,17 @@ struct offset_converter
             init_vertices();
         }
 
-        if (pos_ >= vertices_.size())
+        std::vector<vertex2d> const& output = vertices();
+
+        if (pos_ >= output.size())
         {
             return SEG_END;
         }
 
         pre_ = (pos_ ? cur_ : pre_first_);
-        cur_ = vertices_.at(pos_++);
+        cur_ = output[pos_++];
 
-        if (pos_ == vertices_.size())
+        if (pos_ == output.size())
         {
             return output_vertex(x, y);
         }
@@ -126,11 +145,11 @@ struct offset_converter
         double t = 1.0;
         double vt, ut;
 
-        for (size_t i = pos_; i+1 < vertices_.size(); ++i)
+        for (size_t i = pos_; i+1 < output.size(); ++i)
         {
             //break; // uncomment this to see all the curls
 
-            vertex2d const& u0 = vertices_[i];
+            vertex2d const& u0 = output[i];
 
             // End or beginning of a line or ring must not be filtered out
             // to not to join lines or rings together.
@@ -139,7 +158,7 @@ struct offset_converter
                 break;
             }
 
-            vertex2d const& u1 = vertices_[i+1];
+            vertex2d const& u1 = output[i+1];
             double const dx = u0.x - cur_.x;
             double const dy = u0.y - cur_.y;
 
@@ -170,7 +189,7 @@ struct offset_converter
     void reset()
     {
         geom_.rewind(0);
-        vertices_.clear();
+        vertices().clear();
         status_ = initial;
         pos_ = 0;
     }
@@ -182,20 +201,69 @@ struct offset_converter
 
 private:
 
-    static double explement_reflex_angle(double angle)
+    // unit vector along a segment
+    struct direction
     {
-        if (angle > util::pi)
+        double x;
+        double y;
+        bool zero_length;
+    };
+
+    static direction direction_of(double dx, double dy)
+    {
+        double length = std::sqrt(dx * dx + dy * dy);
+        if (length > 0.0)
         {
-            return angle - util::tau;
+            return { dx / length, dy / length, false };
         }
-        else if (angle < -util::pi)
+        // zero length segments point along +x, or -x for a negative zero
+        return { std::copysign(1.0, dx), 0.0, true };
+    }
+
+    static direction rotate(direction const& d, double cos_a, double sin_a)
+    {
+        return { d.x * cos_a - d.y * sin_a, d.x * sin_a + d.y * cos_a, false };
+    }
+
+    static double cross(direction const& a, direction const& b)
+    {
+        return a.x * b.y - a.y * b.x;
+    }
+
+    static double dot(direction const& a, direction const& b)
+    {
+        return a.x * b.x + a.y * b.y;
+    }
+
+    // tan of half the turn from `a` to `b`
+    static double half_turn_tan(direction const& a, direction const& b)
+    {
+        double cos_d = dot(a, b);
+        double sin_d = cross(a, b);
+        if (cos_d >= 0.0)
         {
-            return angle + util::tau;
+            return sin_d / (1.0 + cos_d);
         }
-        else
+        if (sin_d != 0.0)
         {
-            return angle;
+            // same value, without the cancellation in 1 + cos
+            return (1.0 - cos_d) / sin_d;
         }
+        // the segments double back on each other exactly: an unbounded
+        // tangent, turning counterclockwise from the lower half plane
+        bool ccw = a.y < 0.0 || (a.y == 0.0 && a.x > 0.0);
+        return ccw ? 1e16 : -1e16;
+    }
+
+    // Whether the turn from `a` to `b` is on the outside of the offset
+    // (a reflex joint angle) and gets bulged: the turn is away from the
+    // offset side. Straight and exactly reversed joints, and joints with a
+    // zero length segment, are inside turns.
+    bool outside_turn(direction const& a, direction const& b) const
+    {
+        if (a.zero_length || b.zero_length) return false;
+        double turn = cross(a, b);
+        return offset_ < 0.0 ? turn > 0.0 : turn < 0.0;
     }
 
     static bool intersection(vertex2d const& u1, vertex2d const& u2, double* ut,
@@ -244,55 +312,35 @@ private:
         return false;
     }
 
-    double joint_angle(double x1x0, double y1y0, double x1x2, double y1y2) const
-    {
-        double dot = x1x0 * x1x2 + y1y0 * y1y2; // dot product
-        double det = x1x0 * y1y2 - y1y0 * x1x2; // determinant
-        double angle = std::atan2(det, dot); // atan2(y, x) or atan2(sin, cos)
-        // angle in [-tau/2; tau/2]
-
-        if (offset_ > 0.0)
-        {
-            angle = util::tau - angle; // angle in [tau/2; tau*3/2]
-        }
-        else if (angle < 0)
-        {
-            angle += util::tau; // angle in [tau/2; tau]
-            // angle may now be equal to tau, because if the original angle
-            // is very small, the addition cancels it (epsilon + tau == tau)
-        }
-        if (angle >= util::tau)
-        {
-            angle -= util::tau;
-        }
-        return angle;
-    }
+    // rotation between the vertices of the arcs rounding outside turns
+    static constexpr double bulge_step_cos = 0.98078528040323044913; // cos(pi / 16)
+    static constexpr double bulge_step_sin = 0.19509032201612826785; // sin(pi / 16)
 
     /**
-     *  @brief  Translate (vx, vy) by rotated (dx, dy).
+     *  @brief  Translate (vx, vy) by `distance` along `d`.
      */
-    static void displace(vertex2d & v, double dx, double dy, double a)
+    static void displace(vertex2d & v, double distance, direction const& d)
     {
-        v.x += dx * std::cos(a) - dy * std::sin(a);
-        v.y += dx * std::sin(a) + dy * std::cos(a);
+        v.x += distance * d.x;
+        v.y += distance * d.y;
     }
 
     /**
-     *  @brief  Translate (vx, vy) by rotated (0, -offset).
+     *  @brief  Translate (vx, vy) by (0, -offset) rotated to `d`.
      */
-    void displace(vertex2d & v, double a) const
+    void displace(vertex2d & v, direction const& d) const
     {
-        v.x -= offset_ * std::sin(a);
-        v.y += offset_ * std::cos(a);
+        v.x -= offset_ * d.y;
+        v.y += offset_ * d.x;
     }
 
     /**
-     *  @brief  (vx, vy) := (ux, uy) + rotated (0, -offset)
+     *  @brief  (vx, vy) := (ux, uy) + (0, -offset) rotated to `d`
      */
-    void displace(vertex2d & v, vertex2d const& u, double a) const
+    void displace(vertex2d & v, vertex2d const& u, direction const& d) const
     {
-        v.x = u.x - offset_ * std::sin(a);
-        v.y = u.y + offset_ * std::cos(a);
+        v.x = u.x - offset_ * d.y;
+        v.y = u.y + offset_ * d.x;
         v.cmd = u.cmd;
     }
 
@@ -304,11 +352,11 @@ private:
         return 0;
     }
 
-    void displace2(vertex2d & v1, vertex2d const& v0, vertex2d const& v2, double a, double b) const
+    void displace2(vertex2d & v1, vertex2d const& v0, vertex2d const& v2, direction const& a, direction const& b) const
     {
-        double sa = offset_ * std::sin(a);
-        double ca = offset_ * std::cos(a);
-        double h = std::tan(0.5 * (b - a));
+        double sa = offset_ * a.y;
+        double ca = offset_ * a.x;
+        double h = half_turn_tan(a, b);
         double hsa = h * sa;
         double hca = h * ca;
         double abs_offset = std::abs(offset_);
@@ -371,14 +419,19 @@ private:
         {
             return status_;
         }
+        offset_converter_buffers & buffers = this->buffers();
+        std::vector<vertex2d> & points = buffers.points;
+        std::vector<vertex2d> & close_points = buffers.close_points;
+        points.clear();
+        close_points.clear();
+        buffers.vertices.clear();
+
         vertex2d v0(vertex2d::no_init);
         vertex2d v1(vertex2d::no_init);
         vertex2d v2(vertex2d::no_init);
         vertex2d w(vertex2d::no_init);
         vertex2d start(vertex2d::no_init);
         vertex2d start_v2(vertex2d::no_init);
-        std::vector<vertex2d> points;
-        std::vector<vertex2d> close_points;
         bool is_polygon = false;
         std::size_t cpt = 0;
         v0.cmd = geom_.vertex(&v0.x, &v0.y);
@@ -432,52 +485,37 @@ private:
             return status_ = process;
         }
 
-        double angle_a = 0;
-        // The vector parts from v1 to v0.
-        double v_x1x0 = 0;
-        double v_y1y0 = 0;
+        // Segment directions are computed once, as unit vectors, and serve
+        // both joints of the segment; the offset and join geometry derive
+        // from them without per-vertex trigonometry.
+        direction dir_a = { 1.0, 0.0, false };
         // The vector parts from v1 to v2;
         double v_x1x2 = v2.x - v1.x;
         double v_y1y2 = v2.y - v1.y;
 
         if (is_polygon)
         {
-            v_x1x0 = close_points[cpt].x - v1.x;
-            v_y1y0 = close_points[cpt].y - v1.y;
+            dir_a = direction_of(v1.x - close_points[cpt].x, v1.y - close_points[cpt].y);
             cpt++;
-            angle_a = std::atan2(-v_y1y0, -v_x1x0);
         }
-        double angle_b = std::atan2(v_y1y2, v_x1x2);
-        // Angle between the two vectors
-        double curve_angle;
+        direction dir_b = direction_of(v_x1x2, v_y1y2);
 
         if (!is_polygon)
         {
             // first vertex
-            displace(v1, angle_b);
+            displace(v1, dir_b);
             push_vertex(v1);
         }
         else
         {
-            double joint_angle = this->joint_angle(v_x1x0, v_y1y0, v_x1x2, v_y1y2);
-            int bulge_steps = 0;
-
-            if (std::abs(joint_angle) > util::pi)
+            if (outside_turn(dir_a, dir_b))
             {
-                curve_angle = explement_reflex_angle(angle_b - angle_a);
-                // Bulge steps should be determined by the inverse of the joint angle.
-                double half_turns = half_turn_segments_ * std::fabs(curve_angle);
-                bulge_steps = 1 + static_cast<int>(std::floor(half_turns / util::pi));
-            }
-
-            if (bulge_steps == 0)
-            {
-                displace2(v1, v0, v2, angle_a, angle_b);
+                displace(v1, dir_b);
                 push_vertex(v1);
             }
             else
             {
-                displace(v1, angle_b);
+                displace2(v1, v0, v2, dir_a, dir_b);
                 push_vertex(v1);
             }
         }
@@ -489,7 +527,7 @@ private:
         if (!is_polygon)
         {
             pre_first_ = v1;
-            displace(pre_first_, -2 * std::fabs(offset_), 0, angle_b);
+            displace(pre_first_, -2 * std::fabs(offset_), dir_b);
             start_ = pre_first_;
         }
         else
@@ -516,6 +554,7 @@ private:
                     {
                         v_x1x2 = v1.x - close_points[cpt].x;
                         v_y1y2 = v1.y - close_points[cpt].y;
+                        dir_b = direction_of(v_x1x2, v_y1y2);
                         cpt++;
                     }
                     start_v2.x = v2.x;
@@ -541,45 +580,28 @@ private:
                 v2.y = start_.y;
             }
 
-            // Switch the previous vector's direction as the origin has changed
-            v_x1x0 = -v_x1x2;
-            v_y1y0 = -v_y1y2;
-            // Calculate new angle_a
-            angle_a = std::atan2(v_y1y2, v_x1x2);
+            // The previous segment's direction leads into this joint
+            dir_a = dir_b;
 
             // Calculate the new vector
             v_x1x2 = v2.x - v1.x;
             v_y1y2 = v2.y - v1.y;
-            // Calculate the new angle_b
-            angle_b = std::atan2(v_y1y2, v_x1x2);
+            dir_b = direction_of(v_x1x2, v_y1y2);
 
-            double joint_angle = this->joint_angle(v_x1x0, v_y1y0, v_x1x2, v_y1y2);
-            int bulge_steps = 0;
-
-            if (std::abs(joint_angle) > util::pi)
-            {
-                curve_angle = explement_reflex_angle(angle_b - angle_a);
-                // Bulge steps should be determined by the inverse of the joint angle.
-                double half_turns = half_turn_segments_ * std::fabs(curve_angle);
-                bulge_steps = 1 + static_cast<int>(std::floor(half_turns / util::pi));
-            }
+            bool const bulge = outside_turn(dir_a, dir_b);
 
             #ifdef MAPNIK_LOG
-            if (bulge_steps == 0)
+            if (!bulge)
             {
                 // inside turn (sharp/obtuse angle)
                 MAPNIK_LOG_DEBUG(ctrans) << "offset_converter:"
-                    << " Sharp joint [<< inside turn "
-                    << static_cast<int>(util::degrees(joint_angle))
-                    << " degrees >>]";
+                    << " Sharp joint [<< inside turn, cos " << dot(dir_a, dir_b) << " >>]";
             }
             else
             {
                 // outside turn (reflex angle)
                 MAPNIK_LOG_DEBUG(ctrans) << "offset_converter:"
-                    << " Bulge joint >)) outside turn "
-                    << static_cast<int>(util::degrees(joint_angle))
-                    << " degrees ((< with " << bulge_steps << " segments";
+                    << " Bulge joint >)) outside turn, cos " << dot(dir_a, dir_b) << " ((<";
             }
             #endif
             tmp_prev.cmd = v1.cmd;
@@ -588,36 +610,43 @@ private:
 
             if (v1.cmd == SEG_MOVETO)
             {
-                if (bulge_steps == 0)
+                if (!bulge)
                 {
-                    displace2(v1, v0, v2, angle_a, angle_b);
+                    displace2(v1, v0, v2, dir_a, dir_b);
                     push_vertex(v1);
                 }
                 else
                 {
-                    displace(v1, angle_b);
+                    displace(v1, dir_b);
                     push_vertex(v1);
                 }
             }
             else
             {
-                if (bulge_steps == 0)
+                if (!bulge)
                 {
-                    displace2(v1, v0, v2, angle_a, angle_b);
+                    displace2(v1, v0, v2, dir_a, dir_b);
                     push_vertex(v1);
                 }
                 else
                 {
-                    displace(w, v1, angle_a);
+                    displace(w, v1, dir_a);
                     w.cmd = SEG_LINETO;
                     push_vertex(w);
-                    for (int s = 0; ++s < bulge_steps;)
+                    // round the joint with an arc of pi/16 steps from `dir_a`
+                    // until `dir_b` is less than a step (plus some slack
+                    // against rounding) away
+                    double const turn = cross(dir_a, dir_b) < 0.0 ? -1.0 : 1.0;
+                    double const sin_step = turn * bulge_step_sin;
+                    direction d = rotate(dir_a, bulge_step_cos, sin_step);
+                    while (turn * cross(d, dir_b) > 1e-9 || dot(d, dir_b) < 0.0)
                     {
-                        displace(w, v1, angle_a + (curve_angle * s) / bulge_steps);
+                        displace(w, v1, d);
                         w.cmd = SEG_LINETO;
                         push_vertex(w);
+                        d = rotate(d, bulge_step_cos, sin_step);
                     }
-                    displace(v1, angle_b);
+                    displace(v1, dir_b);
                     push_vertex(v1);
                 }
             }
@@ -629,7 +658,7 @@ private:
         // last vertex
         if (!is_polygon)
         {
-            displace(v1, angle_b);
+            displace(v1, dir_b);
             push_vertex(v1);
         }
         // initialization finished
@@ -649,16 +678,26 @@ private:
 
     void push_vertex(vertex2d const& v)
     {
-        vertices_.push_back(v);
+        buffers().vertices.push_back(v);
+    }
+
+    offset_converter_buffers & buffers()
+    {
+        return buffers_ ? *buffers_ : own_buffers_;
+    }
+
+    std::vector<vertex2d> & vertices()
+    {
+        return buffers().vertices;
     }
 
     Geometry &              geom_;
     double                  offset_;
     double                  threshold_;
-    unsigned                half_turn_segments_;
     status                  status_;
     size_t                  pos_;
-    std::vector<vertex2d>   vertices_;
+    offset_converter_buffers * buffers_;
+    offset_converter_buffers own_buffers_;
     vertex2d                start_;
     vertex2d                pre_first_;
     vertex2d                pre_;
@@ -42,6 +42,7 @@ using rgba_hash_table = std::unordered_map<unsigned int, unsigned char>;
 #pragma GCC diagnostic pop
 
 // stl
+#include <cstdint>
 #include <vector>
 #include <tuple>
 
@@ -127,17 +128,29 @@ public:
     inline std::vector<rgb>& palette() { return rgb_pal_;}
     inline std::vector<unsigned>& alpha_table() { return alpha_pal_;}
 
+    // Index of the closest palette color (euclidean distance in RGBA).
+    // The palette is immutable once parsed, so concurrent calls are safe.
     unsigned char quantize(unsigned c) const;
+    // quantize() for `width` consecutive pixels
+    void quantize_row(unsigned const* row, std::uint8_t * out, unsigned width) const;
 
     bool valid() const;
     std::string to_string() const;
 
 private:
     void parse(std::string const& pal, palette_type type);
+    void build_lookup();
+    unsigned char nearest(unsigned c) const;
+
+    // 4 bits per channel of the RGBA lookup cells
+    static constexpr unsigned cell_bits = 4;
 
 private:
     std::vector<rgba> sorted_pal_;
-    mutable rgba_hash_table color_hashmap_;
+    // palette entries that can be closest to some color of a lookup cell:
+    // cell_entries_[cell_offsets_[cell] .. cell_offsets_[cell + 1])
+    std::vector<std::uint32_t> cell_offsets_;
+    std::vector<std::uint8_t> cell_entries_;
 
     unsigned colors_;
     std::vector<rgb> rgb_pal_;
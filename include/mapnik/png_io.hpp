@@ -557,6 +557,23 @@ void save_as_png8_oct(T1 & file,
     }
 }
 
+namespace detail {
+
+template <typename T>
+void quantize_row(T const& tree, std::uint32_t const* row, std::uint8_t * out, unsigned width)
+{
+    for (unsigned x = 0; x < width; ++x)
+    {
+        out[x] = tree.quantize(row[x]);
+    }
+}
+
+inline void quantize_row(rgba_palette const& pal, std::uint32_t const* row, std::uint8_t * out, unsigned width)
+{
+    pal.quantize_row(row, out, width);
+}
+
+}
 
 template <typename T1, typename T2, typename T3>
 void save_as_png8(T1 & file,
@@ -577,10 +594,7 @@ void save_as_png8(T1 & file,
         {
             mapnik::image_rgba8::pixel_type const * row = image.get_row(y);
             mapnik::image_gray8::pixel_type  * row_out = reduced_image.get_row(y);
-            for (unsigned x = 0; x < width; ++x)
-            {
-                row_out[x] = tree.quantize(row[x]);
-            }
+            detail::quantize_row(tree, row, row_out, width);
         }
         save_as_png(file, palette, reduced_image, width, height, 8, alpha_table, opts);
     }
@@ -599,15 +613,15 @@ void save_as_png8(T1 & file,
         unsigned image_width  = ((width + 7) >> 1) & ~3U; // 4-bit image, round up to 32-bit boundary
         unsigned image_height = height;
         image_gray8 reduced_image(image_width, image_height);
+        std::vector<std::uint8_t> indices(width);
         for (unsigned y = 0; y < height; ++y)
         {
             mapnik::image_rgba8::pixel_type const * row = image.get_row(y);
             mapnik::image_gray8::pixel_type  * row_out = reduced_image.get_row(y);
-            std::uint8_t index = 0;
+            detail::quantize_row(tree, row, indices.data(), width);
             for (unsigned x = 0; x < width; ++x)
             {
-
-                index = tree.quantize(row[x]);
+                std::uint8_t index = indices[x];
                 if (x%2 == 0)
                 {
                     index = index<<4;
@@ -25,6 +25,7 @@
 
 // mapnik
 #include <mapnik/util/noncopyable.hpp>
+#include <mapnik/instrumentation.hpp>
 
 // boost
 #include <memory>
@@ -69,7 +70,7 @@ public:
     HolderType borrowObject()
     {
 #ifdef MAPNIK_THREADSAFE
-        std::lock_guard<std::mutex> lock(mutex_);
+        instrumentation::lock_guard<std::mutex> lock(mutex_, instrumentation::lock_site::pool);
 #endif
 
         typename ContType::iterator itr=pool_.begin();
@@ -104,7 +105,7 @@ public:
     unsigned size() const
     {
 #ifdef MAPNIK_THREADSAFE
-        std::lock_guard<std::mutex> lock(mutex_);
+        instrumentation::lock_guard<std::mutex> lock(mutex_, instrumentation::lock_site::pool);
 #endif
         return pool_.size();
     }
@@ -112,7 +113,7 @@ public:
     unsigned max_size() const
     {
 #ifdef MAPNIK_THREADSAFE
-        std::lock_guard<std::mutex> lock(mutex_);
+        instrumentation::lock_guard<std::mutex> lock(mutex_, instrumentation::lock_site::pool);
 #endif
         return maxSize_;
     }
@@ -120,7 +121,7 @@ public:
     void set_max_size(unsigned size)
     {
 #ifdef MAPNIK_THREADSAFE
-        std::lock_guard<std::mutex> lock(mutex_);
+        instrumentation::lock_guard<std::mutex> lock(mutex_, instrumentation::lock_site::pool);
 #endif
         maxSize_ = std::max(maxSize_,size);
     }
@@ -128,7 +129,7 @@ public:
     unsigned initial_size() const
     {
 #ifdef MAPNIK_THREADSAFE
-        std::lock_guard<std::mutex> lock(mutex_);
+        instrumentation::lock_guard<std::mutex> lock(mutex_, instrumentation::lock_site::pool);
 #endif
         return initialSize_;
     }
@@ -136,7 +137,7 @@ public:
     void set_initial_size(unsigned size)
     {
 #ifdef MAPNIK_THREADSAFE
-        std::lock_guard<std::mutex> lock(mutex_);
+        instrumentation::lock_guard<std::mutex> lock(mutex_, instrumentation::lock_site::pool);
 #endif
         if (size > initialSize_)
         {
@@ -0,0 +1,98 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2017 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+#ifndef MAPNIK_PYRAMID_SEEDER_HPP
+#define MAPNIK_PYRAMID_SEEDER_HPP
+
+// mapnik
+#include <mapnik/config.hpp>
+#include <mapnik/attribute.hpp>
+#include <mapnik/geometry/box2d.hpp>
+#include <mapnik/image.hpp>
+#include <mapnik/util/noncopyable.hpp>
+
+// stl
+#include <cstddef>
+#include <functional>
+
+namespace mapnik {
+
+class Map;
+
+// Renders tile pyramids (spherical mercator z/x/y tiles, map srs must be
+// EPSG:3857) depth-first, issuing one datasource query per layer for every
+// `query_depth` zoom levels instead of one per tile.
+//
+// At the first seeded zoom, and every `query_depth` levels below it, the
+// features of each cacheable layer intersecting the tile (plus the layer
+// buffer) are read once, with the attributes used by every rule active
+// within those levels, and kept in memory with a spatial index; the tile
+// and all its descendants down to the next query level are rendered from
+// them. Layer and rule scale denominators are honoured as usual.
+//
+// Only vector layers whose datasource parameters do not depend on the
+// render scale (no !scale_denominator!, !pixel_width! or !pixel_height!
+// tokens) are cached; other layers, and layers nested in layer groups, are
+// queried per tile.
+class MAPNIK_DECL pyramid_seeder : private util::noncopyable
+{
+public:
+    using callback_type = std::function<void(int z, int x, int y, image_rgba8 const& image)>;
+
+    explicit pyramid_seeder(Map const& map,
+                            unsigned tile_size = 256,
+                            double scale_factor = 1.0);
+
+    void set_variables(attributes const& vars) { vars_ = vars; }
+    // number of zoom levels rendered from one query (default 4)
+    void set_query_depth(unsigned depth) { query_depth_ = depth > 0 ? depth : 1; }
+    unsigned query_depth() const { return query_depth_; }
+
+    // render tile z/x/y and its descendants from `minzoom` to `maxzoom`;
+    // tiles above `minzoom` are only traversed. Returns the number of
+    // tiles passed to `callback`. Throws std::runtime_error if the map
+    // srs is not EPSG:3857.
+    std::size_t seed(int z, int x, int y, int minzoom, int maxzoom, callback_type const& callback);
+
+    // datasource queries issued for cached layers
+    std::size_t queries() const { return queries_; }
+
+    static box2d<double> tile_extent(int z, int x, int y);
+
+private:
+    std::size_t visit(int z, int x, int y, int minzoom, int maxzoom,
+                      Map * band_map, callback_type const& callback);
+    void make_band(Map & band_map, int z, int x, int y, int lastzoom);
+    void render(Map & map, int z, int x, int y, callback_type const& callback) const;
+    double scale_denominator(int z) const;
+
+    Map const& map_;
+    unsigned tile_size_;
+    double scale_factor_;
+    unsigned query_depth_;
+    attributes vars_;
+    std::size_t queries_;
+};
+
+}
+
+#endif // MAPNIK_PYRAMID_SEEDER_HPP
@@ -29,8 +29,12 @@
 #include <mapnik/make_unique.hpp>
 
 // stl
+#include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <new>
+#include <numeric>
+#include <thread>
 #include <vector>
 #include <type_traits>
 
@@ -123,6 +127,64 @@ public:
         do_insert_data(data, box, root_, depth);
     }
 
+    // Bulk loading: the target node of every item is resolved independently
+    // (optionally using several threads), items are then sorted by node path
+    // and appended in one pass. Item order within a node is preserved, so the
+    // resulting tree is identical to inserting items one by one.
+    template <typename Items, typename Extract>
+    void bulk_insert(Items const& items, Extract extract, unsigned num_threads = 1)
+    {
+        std::size_t size = items.size();
+        if (size == 0) return;
+        if (max_depth_ > max_key_depth)
+        {
+            for (auto const& item : items)
+            {
+                auto const& pair = extract(item);
+                insert(pair.first, pair.second);
+            }
+            return;
+        }
+        std::vector<std::uint64_t> keys(size);
+        num_threads = std::max(1u, std::min<unsigned>(num_threads, (size + min_chunk_size - 1) / min_chunk_size));
+        if (num_threads == 1)
+        {
+            for (std::size_t i = 0; i < size; ++i) keys[i] = path_key(extract(items[i]).second);
+        }
+        else
+        {
+            std::vector<std::thread> workers;
+            workers.reserve(num_threads);
+            std::size_t chunk = (size + num_threads - 1) / num_threads;
+            for (unsigned t = 0; t < num_threads; ++t)
+            {
+                std::size_t first = t * chunk;
+                std::size_t last = std::min(size, first + chunk);
+                workers.emplace_back([&, first, last]() {
+                        for (std::size_t i = first; i < last; ++i) keys[i] = path_key(extract(items[i]).second);
+                    });
+            }
+            for (auto & w : workers) w.join();
+        }
+        std::vector<std::size_t> order(size);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(),
+                         [&keys](std::size_t lhs, std::size_t rhs) { return keys[lhs] < keys[rhs]; });
+
+        std::uint64_t current_key = ~std::uint64_t(0);
+        node * current = root_;
+        for (auto index : order)
+        {
+            std::uint64_t key = keys[index];
+            if (key != current_key)
+            {
+                current = descend(key);
+                current_key = key;
+            }
+            current->cont_.push_back(extract(items[index]).first);
+        }
+    }
+
     query_iterator query_in_box(bbox_type const& box)
     {
         query_result_.clear();
@@ -187,6 +249,53 @@ public:
         write_node(out,root_);
     }
 private:
+    // node path is packed into 2 bits per level + 6 bits of depth
+    static constexpr unsigned max_key_depth = 29;
+    static constexpr std::size_t min_chunk_size = 4096;
+
+    std::uint64_t path_key(bbox_type const& box) const
+    {
+        std::uint64_t key = 0;
+        unsigned int level = 0;
+        unsigned int depth = 0;
+        bbox_type node_extent = root_->extent();
+        while (++depth < max_depth_)
+        {
+            bbox_type ext[4];
+            split_box(node_extent, ext);
+            int i = 0;
+            for (; i < 4; ++i)
+            {
+                if (ext[i].contains(box)) break;
+            }
+            if (i == 4) break;
+            key |= std::uint64_t(i) << (62 - 2 * level);
+            node_extent = ext[i];
+            ++level;
+        }
+        return key | level;
+    }
+
+    node * descend(std::uint64_t key)
+    {
+        unsigned int levels = static_cast<unsigned int>(key & 0x3f);
+        node * n = root_;
+        bbox_type node_extent = root_->extent();
+        for (unsigned int level = 0; level < levels; ++level)
+        {
+            int i = static_cast<int>((key >> (62 - 2 * level)) & 0x3);
+            if (!n->children_[i])
+            {
+                bbox_type ext[4];
+                split_box(node_extent, ext);
+                nodes_.push_back(std::make_unique<node>(ext[i]));
+                n->children_[i] = nodes_.back().get();
+            }
+            n = n->children_[i];
+            node_extent = n->extent();
+        }
+        return n;
+    }
 
     void query_node(bbox_type const& box, result_type & result, node * node_) const
     {
@@ -231,7 +340,7 @@ private:
         n->cont_.push_back(data);
     }
 
-    void split_box(bbox_type const& node_extent, bbox_type * ext)
+    void split_box(bbox_type const& node_extent, bbox_type * ext) const
     {
         typename bbox_type::value_type width = node_extent.width();
         typename bbox_type::value_type height = node_extent.height();
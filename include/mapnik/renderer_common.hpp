@@ -28,6 +28,7 @@
 #include <mapnik/geometry/box2d.hpp>     // for box2d
 #include <mapnik/view_transform.hpp>    // for view_transform
 #include <mapnik/attribute.hpp>
+#include <mapnik/label_anchor_cache.hpp>
 #include <mapnik/util/noncopyable.hpp>
 
 // fwd declarations to speed up compile
@@ -35,12 +36,14 @@ namespace mapnik {
   class label_collision_detector4;
   class Map;
   class request;
+  struct offset_converter_buffers;
+  class group_symbolizer_cache;
 //  class attributes;
 }
 
 namespace mapnik {
 
-struct renderer_common : private util::noncopyable
+struct MAPNIK_DECL renderer_common : private util::noncopyable
 {
     using detector_ptr = std::shared_ptr<label_collision_detector4>;
 
@@ -64,6 +67,19 @@ struct renderer_common : private util::noncopyable
     box2d<double> query_extent_;
     view_transform t_;
     detector_ptr detector_;
+    // per-layer geometry level-of-detail settings, see layer.hpp
+    double minimum_feature_size_;
+    bool minimum_feature_dot_;
+    bool vertex_decimation_;
+    bool polygon_batching_;
+    bool building_batching_;
+    // scratch storage reused by the offset converters of every feature
+    std::shared_ptr<offset_converter_buffers> offset_buffers_;
+    // group symbolizer layouts, created on first use
+    std::shared_ptr<group_symbolizer_cache> group_cache_;
+    // label anchors shared by the renders of a map, and the current layer
+    std::shared_ptr<label_anchor_cache> label_anchor_cache_;
+    label_anchor_context label_anchors_;
 
 protected:
     // it's desirable to keep this class implicitly noncopyable to prevent
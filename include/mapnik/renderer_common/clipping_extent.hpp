@@ -44,6 +44,24 @@ box2d<double> clipping_extent(T const& common)
     return common.query_extent_;
 }
 
+// Where a feature envelope lies relative to the clipping box. Clipping
+// converters are only needed for geometries crossing the box edge: fully
+// contained ones pass through the clipper unchanged and fully outside ones
+// produce no visible output, so both can skip per-vertex clipping.
+enum class clip_test
+{
+    outside,
+    inside,
+    intersects
+};
+
+inline clip_test test_clip_envelope(box2d<double> const& clip_box, box2d<double> const& envelope)
+{
+    if (!envelope.valid() || !clip_box.intersects(envelope)) return clip_test::outside;
+    if (clip_box.contains(envelope)) return clip_test::inside;
+    return clip_test::intersects;
+}
+
 } // namespace mapnik
 
 #endif // MAPNIK_CLIPPING_EXTENT_HPP
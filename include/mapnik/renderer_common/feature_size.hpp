@@ -0,0 +1,88 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2017 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+#ifndef MAPNIK_RENDERER_COMMON_FEATURE_SIZE_HPP
+#define MAPNIK_RENDERER_COMMON_FEATURE_SIZE_HPP
+
+// mapnik
+#include <mapnik/feature.hpp>
+#include <mapnik/geometry/box2d.hpp>
+#include <mapnik/proj_transform.hpp>
+#include <mapnik/symbolizer.hpp>
+#include <mapnik/view_transform.hpp>
+
+#pragma GCC diagnostic push
+#include <mapnik/warning_ignore_agg.hpp>
+#include "agg_trans_affine.h"
+#pragma GCC diagnostic pop
+
+// stl
+#include <algorithm>
+
+namespace mapnik {
+
+// Screen-space envelope of a feature when its footprint, grown by `padding`
+// pixels (e.g. the stroke width), stays below the layer's minimum feature
+// size; an invalid box when the feature must be rendered normally.
+template <typename T>
+box2d<double> culled_envelope(T const& common,
+                              symbolizer_base const& sym,
+                              feature_impl const& feature,
+                              proj_transform const& prj_trans,
+                              double padding = 0.0)
+{
+    if (common.minimum_feature_size_ <= 0.0) return box2d<double>();
+    box2d<double> env = feature.envelope();
+    if (!env.valid()) return box2d<double>();
+    if (!prj_trans.equal() && !prj_trans.backward(env)) return box2d<double>();
+    env = common.t_.forward(env);
+    auto transform = get_optional<transform_type>(sym, keys::geometry_transform);
+    if (transform)
+    {
+        agg::trans_affine tr;
+        evaluate_transform(tr, feature, common.vars_, *transform, common.scale_factor_);
+        env *= tr;
+    }
+    if (std::max(env.width(), env.height()) + padding >= common.minimum_feature_size_)
+    {
+        return box2d<double>();
+    }
+    return env;
+}
+
+// Adds a square of `size` pixels centred on the envelope to the rasterizer,
+// standing in for a culled feature
+template <typename Rasterizer>
+void add_culled_dot(Rasterizer & ras, box2d<double> const& env, double size = 1.0)
+{
+    coord<double, 2> c = env.center();
+    double half = std::max(size, 1.0) / 2.0;
+    ras.move_to_d(c.x - half, c.y - half);
+    ras.line_to_d(c.x + half, c.y - half);
+    ras.line_to_d(c.x + half, c.y + half);
+    ras.line_to_d(c.x - half, c.y + half);
+    ras.close_polygon();
+}
+
+} // namespace mapnik
+
+#endif // MAPNIK_RENDERER_COMMON_FEATURE_SIZE_HPP
@@ -27,14 +27,184 @@
 #include <mapnik/vertex_adapters.hpp>
 #include <mapnik/path.hpp>
 #include <mapnik/transform_path_adapter.hpp>
+#include <mapnik/vertex.hpp>
 
 #pragma GCC diagnostic push
 #include <mapnik/warning_ignore_agg.hpp>
 #include "agg_conv_transform.h"
 #pragma GCC diagnostic pop
 
+// stl
+#include <algorithm>
+#include <vector>
+
 namespace mapnik {
 
+// Screen space extrusions of any number of buildings, kept in one reusable
+// vertex buffer. Each building stores its roof, its walls as closed quads
+// all wound the same way (so one non-zero pass fills them without seams)
+// and the wall outlines.
+class building_geometry
+{
+public:
+    // vertex source over a slice of the buffer
+    class path
+    {
+    public:
+        path(vertex2d const* begin, vertex2d const* end)
+            : begin_(begin), end_(end), itr_(begin) {}
+
+        void rewind(unsigned) { itr_ = begin_; }
+
+        unsigned vertex(double * x, double * y)
+        {
+            if (itr_ == end_) return SEG_END;
+            *x = itr_->x;
+            *y = itr_->y;
+            return (itr_++)->cmd;
+        }
+    private:
+        vertex2d const* begin_;
+        vertex2d const* end_;
+        vertex2d const* itr_;
+    };
+
+    struct building
+    {
+        std::size_t roof;
+        std::size_t walls;
+        std::size_t frame;
+        std::size_t end;
+        double depth; // lowest screen y of the footprint
+        unsigned fill;
+        double opacity;
+    };
+
+    void clear()
+    {
+        vertices_.clear();
+        buildings_.clear();
+    }
+
+    bool empty() const { return buildings_.empty(); }
+
+    std::vector<building> const& buildings() const { return buildings_; }
+
+    // footprints reaching further down the screen are nearer to the viewer,
+    // drawing in this order lets front buildings occlude the ones behind
+    void sort_back_to_front()
+    {
+        std::stable_sort(buildings_.begin(), buildings_.end(),
+                         [](building const& lhs, building const& rhs) { return lhs.depth < rhs.depth; });
+    }
+
+    path roof(building const& b) const { return slice(b.roof, b.walls); }
+    path walls(building const& b) const { return slice(b.walls, b.frame); }
+    path frame(building const& b) const { return slice(b.frame, b.end); }
+
+    template <typename Geom>
+    void add(Geom & poly, double height, unsigned fill, double opacity)
+    {
+        building b;
+        b.roof = vertices_.size();
+        b.depth = 0.0;
+        b.fill = fill;
+        b.opacity = opacity;
+        bool first = true;
+        double x, y;
+        poly.rewind(0);
+        for (unsigned cm = poly.vertex(&x, &y); cm != SEG_END; cm = poly.vertex(&x, &y))
+        {
+            if (cm != SEG_CLOSE)
+            {
+                b.depth = first ? y : std::max(b.depth, y);
+                first = false;
+            }
+            vertices_.emplace_back(x, y - height, cm);
+        }
+        if (first) return; // empty footprint
+        b.walls = vertices_.size();
+        // walls and outlines are derived from the roof, one pass each so
+        // that both end up contiguous in the buffer
+        for_each_wall(b.roof, b.walls, height, [this, height](double x0, double y0, double x1, double y1) {
+            add_wall(x0, y0, x1, y1, height);
+        });
+        b.frame = vertices_.size();
+        for_each_wall(b.roof, b.walls, height, [this, height](double x0, double y0, double x1, double y1) {
+            vertices_.emplace_back(x0, y0, SEG_MOVETO);
+            vertices_.emplace_back(x1, y1, SEG_LINETO);
+            vertices_.emplace_back(x1, y1 - height, SEG_LINETO);
+            vertices_.emplace_back(x0, y0 - height, SEG_LINETO);
+        });
+        b.end = vertices_.size();
+        buildings_.push_back(b);
+    }
+
+private:
+    // appends the quad between a wall's base and its top edge with a
+    // non-positive signed area, whichever way the footprint ring runs
+    void add_wall(double x0, double y0, double x1, double y1, double height)
+    {
+        double const xs[4] = { x0, x1, x1, x0 };
+        double const ys[4] = { y0, y1, y1 - height, y0 - height };
+        double area = 0.0;
+        for (unsigned i = 0; i < 4; ++i)
+        {
+            unsigned j = (i + 1) % 4;
+            area += xs[i] * ys[j] - xs[j] * ys[i];
+        }
+        if (area > 0)
+        {
+            vertices_.emplace_back(xs[0], ys[0], SEG_MOVETO);
+            for (unsigned i = 3; i > 0; --i) vertices_.emplace_back(xs[i], ys[i], SEG_LINETO);
+        }
+        else
+        {
+            vertices_.emplace_back(xs[0], ys[0], SEG_MOVETO);
+            for (unsigned i = 1; i < 4; ++i) vertices_.emplace_back(xs[i], ys[i], SEG_LINETO);
+        }
+        vertices_.emplace_back(0, 0, SEG_CLOSE);
+    }
+
+    path slice(std::size_t begin, std::size_t end) const
+    {
+        return path(vertices_.data() + begin, vertices_.data() + end);
+    }
+
+    // calls `func` with the base of every wall of the roof in [begin, end);
+    // the buffer may grow meanwhile, so vertices are addressed by index
+    template <typename F>
+    void for_each_wall(std::size_t begin, std::size_t end, double height, F func)
+    {
+        double ring_begin_x = 0, ring_begin_y = 0;
+        double x0 = 0, y0 = 0;
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            vertex2d v = vertices_[i];
+            double x = v.x;
+            double y = v.y + height;
+            if (v.cmd == SEG_MOVETO)
+            {
+                ring_begin_x = x;
+                ring_begin_y = y;
+            }
+            else if (v.cmd == SEG_LINETO)
+            {
+                func(x0, y0, x, y);
+            }
+            else if (v.cmd == SEG_CLOSE)
+            {
+                func(x0, y0, ring_begin_x, ring_begin_y);
+            }
+            x0 = x;
+            y0 = y;
+        }
+    }
+
+    std::vector<vertex2d> vertices_;
+    std::vector<building> buildings_;
+};
+
 struct render_building_symbolizer
 {
     using vertex_adapter_type = geometry::polygon_vertex_adapter<double>;
@@ -68,6 +238,33 @@ struct render_building_symbolizer
         }
     }
 
+    // appends the extrusion of every polygon of the feature to `buildings`
+    static void apply(feature_impl const& feature,
+                      proj_transform const& prj_trans,
+                      view_transform const& view_trans,
+                      double height, unsigned fill, double opacity,
+                      building_geometry & buildings)
+    {
+        auto const& geom = feature.get_geometry();
+        if (geom.is<geometry::polygon<double>>())
+        {
+            auto const& poly = geom.get<geometry::polygon<double>>();
+            vertex_adapter_type va(poly);
+            transform_path_type transformed(view_trans, va, prj_trans);
+            buildings.add(transformed, height, fill, opacity);
+        }
+        else if (geom.is<geometry::multi_polygon<double>>())
+        {
+            auto const& multi_poly = geom.get<geometry::multi_polygon<double>>();
+            for (auto const& poly : multi_poly)
+            {
+                vertex_adapter_type va(poly);
+                transform_path_type transformed(view_trans, va, prj_trans);
+                buildings.add(transformed, height, fill, opacity);
+            }
+        }
+    }
+
 private:
     template <typename F>
     static void render_face(double x0, double y0, double x, double y, double height, F const& face_func, path_type & frame)
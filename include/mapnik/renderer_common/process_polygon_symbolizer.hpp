@@ -30,10 +30,13 @@
 
 #include <mapnik/feature.hpp>
 #include <mapnik/renderer_common/apply_vertex_converter.hpp>
+#include <mapnik/renderer_common/clipping_extent.hpp>
 
 namespace mapnik {
 
-template <typename vertex_converter_type, typename rasterizer_type, typename F>
+template <typename vertex_converter_type,
+          template <typename> class PolygonAdapter = geometry::polygon_vertex_adapter,
+          typename rasterizer_type, typename F>
 void render_polygon_symbolizer(polygon_symbolizer const &sym,
                                mapnik::feature_impl & feature,
                                proj_transform const& prj_trans,
@@ -51,17 +54,25 @@ void render_polygon_symbolizer(polygon_symbolizer const &sym,
     value_double smooth = get<value_double,keys::smooth>(sym, feature, common.vars_);
     value_double opacity = get<value_double,keys::fill_opacity>(sym, feature, common.vars_);
 
+    clip_test clip_result = clip_test::intersects;
+    if (prj_trans.equal() && clip)
+    {
+        clip_result = test_clip_envelope(clip_box, feature.envelope());
+        if (clip_result == clip_test::outside) return;
+    }
+
     vertex_converter_type converter(clip_box, sym, common.t_, prj_trans, tr,
                                     feature,common.vars_,common.scale_factor_);
 
-    if (prj_trans.equal() && clip) converter.template set<clip_poly_tag>();
+    if (prj_trans.equal() && clip && clip_result == clip_test::intersects) converter.template set<clip_poly_tag>();
     converter.template set<transform_tag>(); //always transform
     converter.template set<affine_transform_tag>();
+    if (common.vertex_decimation_) converter.template set<decimate_tag>(); // no-op unless listed in the converter type
     if (simplify_tolerance > 0.0) converter.template set<simplify_tag>(); // optional simplify converter
     if (smooth > 0.0) converter.template set<smooth_tag>(); // optional smooth converter
 
     using apply_vertex_converter_type = detail::apply_vertex_converter<vertex_converter_type, rasterizer_type>;
-    using vertex_processor_type = geometry::vertex_processor<apply_vertex_converter_type>;
+    using vertex_processor_type = geometry::vertex_processor<apply_vertex_converter_type, PolygonAdapter>;
     apply_vertex_converter_type apply(converter, ras);
     mapnik::util::apply_visitor(vertex_processor_type(apply),feature.get_geometry());
 
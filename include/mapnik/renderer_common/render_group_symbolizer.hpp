@@ -24,11 +24,22 @@
 #define MAPNIK_RENDERER_COMMON_RENDER_GROUP_SYMBOLIZER_HPP
 
 // mapnik
+#include <mapnik/feature.hpp>
+#include <mapnik/group/group_symbolizer_properties.hpp>
 #include <mapnik/pixel_position.hpp>
 #include <mapnik/renderer_common.hpp>
 #include <mapnik/renderer_common/render_thunk.hpp>
 #include <mapnik/symbolizer_base.hpp>
 #include <mapnik/text/glyph_positions.hpp>
+#include <mapnik/util/noncopyable.hpp>
+#include <mapnik/value.hpp>
+
+// stl
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace mapnik {
 
@@ -52,6 +63,69 @@ protected:
     pixel_position offset_;
 };
 
+// Sub features, layout and render thunks evaluated by render_group_symbolizer
+// for one combination of the values of the columns a group symbolizer
+// references. Features repeating the same values (e.g. highway shields with
+// the same ref and network) reuse them instead of running the group rules
+// and sub symbolizers again.
+//
+// Thunks use the renderer's font faces and are offset in place while being
+// rendered, so a cache belongs to a single renderer (see
+// renderer_common::group_cache_) and must not be shared between threads.
+class MAPNIK_DECL group_symbolizer_cache : private util::noncopyable
+{
+public:
+    // upper bound on cached layouts, the cache starts over once reached
+    static constexpr std::size_t max_layouts = 4096;
+
+    struct columns
+    {
+        // context of the sub features, holding every referenced column
+        context_ptr context;
+        std::vector<std::string> names;
+        // feature attribute copied to each name for every index in
+        // [start, end), empty for the bare `%` column
+        std::vector<std::string> attributes;
+        value_integer start;
+        value_integer end;
+    };
+
+    struct key
+    {
+        group_symbolizer const* sym;
+        box2d<double> clipping_extent;
+        // sub feature values, in the order of columns::attributes
+        std::vector<value> values;
+    };
+
+    struct layout
+    {
+        std::vector<std::pair<group_rule_ptr, feature_ptr>> matches;
+        std::vector<value_unicode_string> repeat_keys;
+        std::list<render_thunk_list> thunks;
+        std::vector<pixel_position> offsets;
+        std::vector<box2d<double>> offset_boxes;
+    };
+
+    columns const& get_columns(group_symbolizer const& sym);
+    layout const* find(key const& k) const;
+    layout const& insert(key && k, layout && l);
+
+private:
+    struct key_hash
+    {
+        std::size_t operator()(key const& k) const;
+    };
+
+    struct key_equal
+    {
+        bool operator()(key const& lhs, key const& rhs) const;
+    };
+
+    std::unordered_map<group_symbolizer const*, columns> columns_;
+    std::unordered_map<key, layout, key_hash, key_equal> layouts_;
+};
+
 MAPNIK_DECL
 void render_group_symbolizer(group_symbolizer const& sym,
                              feature_impl & feature,
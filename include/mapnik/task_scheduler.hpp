@@ -0,0 +1,167 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2017 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+#ifndef MAPNIK_TASK_SCHEDULER_HPP
+#define MAPNIK_TASK_SCHEDULER_HPP
+
+// mapnik
+#include <mapnik/config.hpp>
+#include <mapnik/util/noncopyable.hpp>
+
+// stl
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace mapnik {
+
+struct task_scheduler_options
+{
+    // number of worker threads, 0 for one per hardware thread
+    unsigned threads = 0;
+    // bind worker i to a single cpu (Linux only)
+    bool pin_threads = false;
+    // spread workers over NUMA nodes, bind each to its node's cpus and
+    // steal from workers on the same node first (Linux only)
+    bool numa_aware = false;
+};
+
+// Work-stealing thread pool for parallel work inside a render: layers,
+// image filters, encoders or plugins submit tasks to it instead of spawning
+// their own threads, which caps the number of threads a process uses.
+//
+// Every worker owns a task deque: it pops its own tasks LIFO while idle
+// workers steal from the other end. Tasks submitted from outside the pool
+// go to a shared queue. Threads waiting for a task_group run pending tasks
+// instead of blocking, so nested parallelism cannot deadlock even when
+// every worker, or every render thread calling into the pool, is waiting.
+//
+// Without MAPNIK_THREADSAFE the scheduler has no worker threads and tasks
+// run on the submitting or waiting thread.
+class MAPNIK_DECL task_scheduler : private util::noncopyable
+{
+public:
+    using task_type = std::function<void()>;
+
+    using options = task_scheduler_options;
+
+    explicit task_scheduler(options const& opts = options());
+    // runs all queued tasks, then joins the workers
+    ~task_scheduler();
+
+    // number of worker threads
+    unsigned size() const { return static_cast<unsigned>(workers_.size()); }
+
+    // queue a task; exceptions escaping it are logged and dropped, use
+    // task_group to observe them. Runs the task in place if there are no
+    // worker threads.
+    void submit(task_type task);
+
+    // run one queued task on the calling thread, returns false if none was
+    // available
+    bool run_pending();
+
+    // process-wide scheduler, created on first use
+    static task_scheduler & global();
+    // options for the process-wide scheduler; throws std::runtime_error if
+    // it has already been created
+    static void configure_global(options const& opts);
+
+private:
+    struct worker;
+
+    bool pop(task_type & task);
+    void worker_loop(unsigned index);
+
+    std::vector<std::unique_ptr<worker>> workers_;
+    std::mutex shared_mutex_;
+    std::deque<task_type> shared_queue_;
+    std::atomic<std::size_t> queued_;
+    std::mutex sleep_mutex_;
+    std::condition_variable sleep_cv_;
+    bool stop_;
+};
+
+// Set of tasks that can be waited for as a whole. The first exception
+// thrown by one of them is rethrown from wait().
+class MAPNIK_DECL task_group : private util::noncopyable
+{
+public:
+    explicit task_group(task_scheduler & scheduler = task_scheduler::global());
+    // waits for outstanding tasks, exceptions are dropped
+    ~task_group();
+
+    void run(task_scheduler::task_type task);
+    // helps running queued tasks until all tasks of this group finished
+    void wait();
+
+private:
+    void finished(std::exception_ptr error);
+
+    task_scheduler & scheduler_;
+    std::size_t pending_;
+    std::exception_ptr error_;
+    std::mutex mutex_;
+    std::condition_variable done_;
+};
+
+// Calls `func(begin, end)` for consecutive ranges of at most `grain`
+// indices covering [first, last), in parallel. The calling thread takes
+// part and returns once every range has been processed.
+template <typename Func>
+void parallel_for(task_scheduler & scheduler, std::size_t first, std::size_t last,
+                  std::size_t grain, Func const& func)
+{
+    if (first >= last) return;
+    grain = std::max<std::size_t>(grain, 1);
+    if (last - first <= grain || scheduler.size() == 0)
+    {
+        func(first, last);
+        return;
+    }
+    task_group group(scheduler);
+    std::size_t begin = first;
+    for (; last - begin > grain; begin += grain)
+    {
+        std::size_t end = begin + grain;
+        group.run([&func, begin, end]() { func(begin, end); });
+    }
+    func(begin, last);
+    group.wait();
+}
+
+template <typename Func>
+void parallel_for(std::size_t first, std::size_t last, std::size_t grain, Func const& func)
+{
+    parallel_for(task_scheduler::global(), first, last, grain, func);
+}
+
+}
+
+#endif // MAPNIK_TASK_SCHEDULER_HPP
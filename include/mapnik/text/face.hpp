@@ -40,10 +40,14 @@ extern "C"
 #pragma GCC diagnostic pop
 
 //stl
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
+struct hb_font_t;
+
 namespace mapnik
 {
 
@@ -74,13 +78,27 @@ public:
 
     inline bool is_color() const { return color_font_;}
 
+    // Whether the face's charmap maps the code point to a glyph. The
+    // coverage is read from the charmap on first use and kept with the face.
+    bool has_codepoint(std::uint32_t codepoint) const;
+
+    // HarfBuzz font for shaping at unscaled character size, created on
+    // first use and kept with the face.
+    hb_font_t * hb_font();
+
     ~font_face();
 
 private:
     bool init_color_font();
+    void init_coverage() const;
 
     FT_Face face_;
     const bool color_font_;
+    // faces are owned by a face_manager and, like FT_Face, only used by
+    // one thread at a time
+    mutable std::vector<std::pair<std::uint32_t, std::uint32_t>> coverage_;
+    mutable bool coverage_init_;
+    hb_font_t * hb_font_;
 };
 using face_ptr = std::shared_ptr<font_face>;
 
@@ -33,8 +33,10 @@
 #include <mapnik/font_engine_freetype.hpp>
 
 // stl
+#include <algorithm>
 #include <list>
 #include <type_traits>
+#include <vector>
 
 #pragma GCC diagnostic push
 #include <mapnik/warning_ignore.hpp>
@@ -42,6 +44,8 @@
 #include <harfbuzz/hb-ft.h>
 #include <unicode/uvernum.h>
 #include <unicode/uscript.h>
+#include <unicode/uchar.h>
+#include <unicode/utf16.h>
 #pragma GCC diagnostic pop
 
 namespace mapnik { namespace detail {
@@ -128,6 +132,66 @@ static hb_language_t script_to_language(hb_script_t script)
     }
 }
 
+// characters that belong to the cluster of the preceding base character:
+// combining marks, joiners and variation selectors
+static inline bool joins_previous(UChar32 c)
+{
+    return (U_GET_GC_MASK(c) & U_GC_M_MASK) != 0 ||
+        u_hasBinaryProperty(c, UCHAR_DEFAULT_IGNORABLE_CODE_POINT);
+}
+
+// range of a text item shaped with a single face
+struct face_run
+{
+    unsigned start;
+    unsigned end;
+    face_ptr face;
+};
+
+// Split [start, end) into runs of characters sharing the first face of the
+// set whose charmap covers them. Characters no face covers stay with the
+// preceding run and are shaped to .notdef.
+static inline std::vector<face_run> split_by_coverage(mapnik::value_unicode_string const& text,
+                                                      unsigned start, unsigned end,
+                                                      std::vector<face_ptr> const& faces)
+{
+    std::vector<face_run> runs;
+    UChar const* str = text.getBuffer();
+    unsigned i = start;
+    while (i < end)
+    {
+        unsigned char_start = i;
+        UChar32 c;
+        U16_NEXT(str, i, end, c);
+        face_ptr face;
+        if (!runs.empty() && joins_previous(c))
+        {
+            face = runs.back().face;
+        }
+        else
+        {
+            for (auto const& f : faces)
+            {
+                if (f->has_codepoint(static_cast<std::uint32_t>(c)))
+                {
+                    face = f;
+                    break;
+                }
+            }
+            if (!face) face = runs.empty() ? faces.front() : runs.back().face;
+        }
+        if (!runs.empty() && runs.back().face == face)
+        {
+            runs.back().end = i;
+        }
+        else
+        {
+            runs.push_back({char_start, i, face});
+        }
+    }
+    return runs;
+}
+
 } // ns detail
 
 struct harfbuzz_shaper
@@ -156,36 +220,29 @@ static void shape_text(text_line & line,
         face_set_ptr face_set = font_manager.get_face_set(text_item.format_->face_name, text_item.format_->fontset);
         double size = text_item.format_->text_size * scale_factor;
         face_set->set_unscaled_character_sizes();
-        std::size_t num_faces = face_set->size();
+        std::vector<face_ptr> faces(face_set->begin(), face_set->end());
+        if (faces.empty()) continue;
 
         font_feature_settings const& ff_settings = text_item.format_->ff_settings;
         int ff_count = safe_cast<int>(ff_settings.count());
+        auto script = detail::_icu_script_to_script(text_item.script);
+        auto language = detail::script_to_language(script);
+        bool rtl = text_item.dir == UBIDI_RTL;
 
-        // rendering information for a single glyph
-        struct glyph_face_info
-        {
-            face_ptr face;
-            hb_glyph_info_t glyph;
-            hb_glyph_position_t position;
-        };
-
-        // this table is filled with information for rendering each glyph, so that
-        // several font faces can be used in a single text_item
-        std::size_t pos = 0;
-        std::vector<std::vector<glyph_face_info>> glyphinfos;
+        // each run is shaped once with the face covering it; runs of a
+        // right-to-left item are laid out last to first
+        std::vector<detail::face_run> runs = detail::split_by_coverage(text, text_item.start, text_item.end, faces);
+        if (rtl) std::reverse(runs.begin(), runs.end());
 
-        glyphinfos.resize(text.length());
-        for (auto const& face : *face_set)
+        double max_glyph_height = 0;
+        for (auto const& run : runs)
         {
-            ++pos;
+            face_ptr const& face = run.face;
             hb_buffer_clear_contents(buffer.get());
-            hb_buffer_add_utf16(buffer.get(), detail::uchar_to_utf16(text.getBuffer()), text.length(), text_item.start, static_cast<int>(text_item.end - text_item.start));
-            hb_buffer_set_direction(buffer.get(), (text_item.dir == UBIDI_RTL) ? HB_DIRECTION_RTL : HB_DIRECTION_LTR);
+            hb_buffer_add_utf16(buffer.get(), detail::uchar_to_utf16(text.getBuffer()), text.length(), run.start, static_cast<int>(run.end - run.start));
+            hb_buffer_set_direction(buffer.get(), rtl ? HB_DIRECTION_RTL : HB_DIRECTION_LTR);
 
-            hb_font_t *font(hb_ft_font_create(face->get_face(), nullptr));
-            auto script = detail::_icu_script_to_script(text_item.script);
-            auto language = detail::script_to_language(script);
-            MAPNIK_LOG_DEBUG(harfbuzz_shaper) << "RUN:[" << text_item.start << "," << text_item.end << "]"
+            MAPNIK_LOG_DEBUG(harfbuzz_shaper) << "RUN:[" << run.start << "," << run.end << "]"
                                               << " LANGUAGE:" << ((language != nullptr) ? hb_language_to_string(language) : "unknown")
                                               << " SCRIPT:" << script << "(" << text_item.script << ") " << uscript_getShortName(text_item.script)
                                               << " FONT:" << face->family_name();
@@ -194,107 +251,37 @@ static void shape_text(text_line & line,
                 hb_buffer_set_language(buffer.get(), language); // set most common language for the run based script
             }
             hb_buffer_set_script(buffer.get(), script);
-
-            // https://github.com/mapnik/test-data-visual/pull/25
-#if HB_VERSION_MAJOR > 0
-#if HB_VERSION_ATLEAST(1, 0 , 5)
-            hb_ft_font_set_load_flags(font,FT_LOAD_DEFAULT | FT_LOAD_NO_HINTING);
-#endif
-#endif
-            hb_shape(font, buffer.get(), ff_settings.get_features(), ff_count);
-            hb_font_destroy(font);
+            hb_shape(face->hb_font(), buffer.get(), ff_settings.get_features(), ff_count);
 
             unsigned num_glyphs = hb_buffer_get_length(buffer.get());
             hb_glyph_info_t *glyphs = hb_buffer_get_glyph_infos(buffer.get(), &num_glyphs);
             hb_glyph_position_t *positions = hb_buffer_get_glyph_positions(buffer.get(), &num_glyphs);
 
-            unsigned cluster = 0;
-            bool in_cluster = false;
-            std::vector<unsigned> clusters;
-
             for (unsigned i = 0; i < num_glyphs; ++i)
             {
-                if (i == 0)
-                {
-                    cluster = glyphs[0].cluster;
-                    clusters.push_back(cluster);
-                }
-                if (cluster != glyphs[i].cluster)
-                {
-                    cluster = glyphs[i].cluster;
-                    clusters.push_back(cluster);
-                    in_cluster = false;
-                }
-                else if (i != 0)
-                {
-                    in_cluster = true;
-                }
-                if (glyphinfos.size() <= cluster)
-                {
-                    glyphinfos.resize(cluster + 1);
-                }
-                auto & c = glyphinfos[cluster];
-                if (c.empty())
-                {
-                    c.push_back({face, glyphs[i], positions[i]});
-                }
-                else if (c.front().glyph.codepoint == 0)
-                {
-                    c.front() = { face, glyphs[i], positions[i] };
-                }
-                else if (in_cluster)
-                {
-                    c.push_back({ face, glyphs[i], positions[i] });
-                }
-            }
-            bool all_set = true;
-            for (auto c_id : clusters)
-            {
-                auto const& c = glyphinfos[c_id];
-                if (c.empty() || c.front().glyph.codepoint == 0)
-                {
-                    all_set = false;
-                    break;
-                }
-            }
-            if (!all_set && (pos < num_faces))
-            {
-                //Try next font in fontset
-                continue;
-            }
-            double max_glyph_height = 0;
-            for (auto const& c_id : clusters)
-            {
-                auto const& c = glyphinfos[c_id];
-                for (auto const& info : c)
+                auto const& gpos = positions[i];
+                unsigned char_index = glyphs[i].cluster;
+                glyph_info g(glyphs[i].codepoint, char_index, text_item.format_);
+                g.face = face;
+                if (g.face->glyph_dimensions(g))
                 {
-                    auto const& gpos = info.position;
-                    auto const& glyph = info.glyph;
-                    unsigned char_index = glyph.cluster;
-                    glyph_info g(glyph.codepoint,char_index,text_item.format_);
-                    if (info.glyph.codepoint != 0) g.face = info.face;
-                    else g.face = face;
-                    if (g.face->glyph_dimensions(g))
+                    g.scale_multiplier = g.face->get_face()->units_per_EM > 0 ?
+                        (size / g.face->get_face()->units_per_EM) : (size / 2048.0) ;
+                    //Overwrite default advance with better value provided by HarfBuzz
+                    g.unscaled_advance = gpos.x_advance;
+                    g.offset.set(gpos.x_offset * g.scale_multiplier, gpos.y_offset * g.scale_multiplier);
+                    double tmp_height = g.height();
+                    if (g.face->is_color())
                     {
-                        g.scale_multiplier = g.face->get_face()->units_per_EM > 0 ?
-                            (size / g.face->get_face()->units_per_EM) : (size / 2048.0) ;
-                        //Overwrite default advance with better value provided by HarfBuzz
-                        g.unscaled_advance = gpos.x_advance;
-                        g.offset.set(gpos.x_offset * g.scale_multiplier, gpos.y_offset * g.scale_multiplier);
-                        double tmp_height = g.height();
-                        if (g.face->is_color())
-                        {
-                            tmp_height = g.ymax();
-                        }
-                        if (tmp_height > max_glyph_height) max_glyph_height = tmp_height;
-                        width_map[char_index] += g.advance();
-                        line.add_glyph(std::move(g), scale_factor);
+                        tmp_height = g.ymax();
                     }
+                    if (tmp_height > max_glyph_height) max_glyph_height = tmp_height;
+                    width_map[char_index] += g.advance();
+                    line.add_glyph(std::move(g), scale_factor);
                 }
             }
-            line.update_max_char_height(max_glyph_height);
-            break; //When we reach this point the current font had all glyphs.
         }
+        line.update_max_char_height(max_glyph_height);
     }
 }
 };
@@ -36,6 +36,7 @@ class feature_impl;
 class proj_transform;
 class view_transform;
 struct symbolizer_base;
+struct label_anchor_context;
 
 template <typename T>
 struct placement_finder_adapter
@@ -87,11 +88,14 @@ public:
                            unsigned height,
                            double scale_factor,
                            view_transform const& t,
-                           box2d<double> const& query_extent);
+                           box2d<double> const& query_extent,
+                           label_anchor_context const* anchors = nullptr);
 
 protected:
     void initialize_geometries() const;
     void initialize_points() const;
+    bool polygon_anchor(geometry::polygon<double> const& poly, label_placement_enum how_placed,
+                        pixel_position & pos) const;
 
     //Input
     symbolizer_base const& sym_;
@@ -102,6 +106,7 @@ protected:
     box2d<double> dims_;
     box2d<double> const& query_extent_;
     double scale_factor_;
+    label_anchor_context const* anchors_;
 
     //Processing
     // Remaining geometries to be processed.
@@ -140,7 +145,8 @@ public:
                            FaceManagerT & font_manager,
                            DetectorT & detector,
                            box2d<double> const& query_extent,
-                           agg::trans_affine const&);
+                           agg::trans_affine const&,
+                           label_anchor_context const* anchors = nullptr);
 
     template <typename FaceManagerT, typename DetectorT>
     text_symbolizer_helper(shield_symbolizer const& sym,
@@ -154,7 +160,8 @@ public:
                            FaceManagerT & font_manager,
                            DetectorT & detector,
                            box2d<double> const& query_extent,
-                           agg::trans_affine const&);
+                           agg::trans_affine const&,
+                           label_anchor_context const* anchors = nullptr);
 
     // Return all placements.
     placements_list const& get() const;
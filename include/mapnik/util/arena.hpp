@@ -0,0 +1,171 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2017 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+#ifndef MAPNIK_UTIL_ARENA_HPP
+#define MAPNIK_UTIL_ARENA_HPP
+
+// mapnik
+#include <mapnik/util/noncopyable.hpp>
+
+// stl
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace mapnik { namespace util {
+
+// Monotonic (bump pointer) arena. Memory is handed out from large blocks,
+// which makes it a good fit for short-lived objects sharing one lifetime,
+// e.g. features produced by a featureset during a single render. Single
+// allocations are never freed, but once every allocation has been released
+// the next one rewinds the arena to its first block, so a featureset that
+// streams features one at a time keeps reusing the same memory.
+//
+// NOTE: allocation is not thread-safe; an arena must only be allocated from
+// by one thread at a time. Releasing objects can happen from any thread.
+class monotonic_arena : private util::noncopyable
+{
+public:
+    static constexpr std::size_t default_block_size = 64 * 1024;
+
+    explicit monotonic_arena(std::size_t block_size = default_block_size)
+        : block_size_(block_size),
+          current_(nullptr),
+          end_(nullptr),
+          bytes_allocated_(0),
+          first_block_size_(0),
+          live_(0) {}
+
+    ~monotonic_arena()
+    {
+        for (auto * block : blocks_) ::operator delete(block);
+    }
+
+    void * allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t))
+    {
+        if (live_.load(std::memory_order_acquire) == 0 && bytes_allocated_ > 0) rewind();
+        std::uintptr_t ptr = align_up(reinterpret_cast<std::uintptr_t>(current_), alignment);
+        if (current_ == nullptr || ptr + size > reinterpret_cast<std::uintptr_t>(end_))
+        {
+            // oversized requests get a dedicated block
+            std::size_t block_size = std::max(block_size_, size + alignment);
+            grow(block_size);
+            ptr = align_up(reinterpret_cast<std::uintptr_t>(current_), alignment);
+        }
+        current_ = reinterpret_cast<char*>(ptr + size);
+        bytes_allocated_ += size;
+        live_.fetch_add(1, std::memory_order_relaxed);
+        return reinterpret_cast<void*>(ptr);
+    }
+
+    void deallocate(void *, std::size_t) noexcept
+    {
+        live_.fetch_sub(1, std::memory_order_release);
+    }
+
+    // bytes handed out since the arena was last rewound
+    std::size_t bytes_allocated() const { return bytes_allocated_; }
+    std::size_t blocks() const { return blocks_.size(); }
+    // allocations not released yet
+    std::size_t live() const { return live_.load(std::memory_order_relaxed); }
+
+private:
+    static std::uintptr_t align_up(std::uintptr_t ptr, std::size_t alignment)
+    {
+        return (ptr + alignment - 1) & ~static_cast<std::uintptr_t>(alignment - 1);
+    }
+
+    // keep the first block only, nothing points into the arena any more
+    void rewind()
+    {
+        for (std::size_t i = 1; i < blocks_.size(); ++i) ::operator delete(blocks_[i]);
+        blocks_.resize(1);
+        current_ = blocks_.front();
+        end_ = current_ + first_block_size_;
+        bytes_allocated_ = 0;
+    }
+
+    void grow(std::size_t size)
+    {
+        blocks_.reserve(blocks_.size() + 1);
+        char * block = static_cast<char*>(::operator new(size));
+        if (blocks_.empty()) first_block_size_ = size;
+        blocks_.push_back(block);
+        current_ = block;
+        end_ = block + size;
+    }
+
+    std::size_t block_size_;
+    std::vector<char*> blocks_;
+    char * current_;
+    char * end_;
+    std::size_t bytes_allocated_;
+    std::size_t first_block_size_;
+    std::atomic<std::size_t> live_;
+};
+
+using arena_ptr = std::shared_ptr<monotonic_arena>;
+
+// Standard allocator drawing from a shared monotonic_arena. The allocator
+// keeps the arena alive, so objects created with std::allocate_shared remain
+// valid for as long as anybody holds a reference to them.
+template <typename T>
+class arena_allocator
+{
+public:
+    using value_type = T;
+
+    explicit arena_allocator(arena_ptr arena)
+        : arena_(std::move(arena)) {}
+
+    template <typename U>
+    arena_allocator(arena_allocator<U> const& other)
+        : arena_(other.arena()) {}
+
+    T * allocate(std::size_t n)
+    {
+        return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T * p, std::size_t n) noexcept
+    {
+        arena_->deallocate(p, n * sizeof(T));
+    }
+
+    arena_ptr const& arena() const { return arena_; }
+
+    template <typename U>
+    bool operator==(arena_allocator<U> const& rhs) const { return arena_ == rhs.arena(); }
+    template <typename U>
+    bool operator!=(arena_allocator<U> const& rhs) const { return arena_ != rhs.arena(); }
+
+private:
+    arena_ptr arena_;
+};
+
+}}
+
+#endif // MAPNIK_UTIL_ARENA_HPP
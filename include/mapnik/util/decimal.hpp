@@ -0,0 +1,149 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2017 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+#ifndef MAPNIK_UTIL_DECIMAL_HPP
+#define MAPNIK_UTIL_DECIMAL_HPP
+
+// mapnik
+#include <mapnik/util/conversions.hpp>
+
+// stl
+#include <cstdint>
+
+namespace mapnik { namespace util {
+
+// Decimal number as scanned by the hand-written JSON and WKT readers: up to
+// 19 significant digits and a power of ten.
+struct decimal
+{
+    std::uint64_t significand = 0;
+    int exponent = 0;
+    bool negative = false;
+    bool truncated = false; // more than 19 significant digits
+    bool integral = true;   // neither fraction nor exponent
+};
+
+// Scan `[+-]digits[.digits][(e|E)[+-]digits]` at `itr`. With `bare_dot` the
+// forms `.5` and `5.` are accepted too, as Spirit's double_ does. On success
+// `itr` is left past the number, otherwise it is unchanged.
+inline bool scan_decimal(char const*& itr, char const* end, decimal & num, bool bare_dot = false)
+{
+    char const* cur = itr;
+    num = decimal();
+    if (cur != end && (*cur == '-' || *cur == '+'))
+    {
+        num.negative = (*cur++ == '-');
+    }
+    int significant = 0;
+    bool int_digits = false;
+    for (; cur != end && *cur >= '0' && *cur <= '9'; ++cur)
+    {
+        int_digits = true;
+        if (significant < 19)
+        {
+            num.significand = num.significand * 10 + static_cast<unsigned>(*cur - '0');
+            if (num.significand != 0) ++significant;
+        }
+        else
+        {
+            ++num.exponent;
+            num.truncated = true;
+        }
+    }
+    bool frac_digits = false;
+    if (cur != end && *cur == '.')
+    {
+        char const* dot = cur++;
+        for (; cur != end && *cur >= '0' && *cur <= '9'; ++cur)
+        {
+            frac_digits = true;
+            if (significant < 19)
+            {
+                num.significand = num.significand * 10 + static_cast<unsigned>(*cur - '0');
+                if (num.significand != 0) ++significant;
+                --num.exponent;
+            }
+            else
+            {
+                num.truncated = true;
+            }
+        }
+        if (!frac_digits && !(bare_dot && int_digits))
+        {
+            if (!bare_dot) return false;
+            cur = dot;
+        }
+        else
+        {
+            num.integral = false;
+        }
+    }
+    if (!int_digits && !frac_digits) return false;
+    if (cur != end && (*cur == 'e' || *cur == 'E'))
+    {
+        char const* exp = cur++;
+        bool negative = false;
+        if (cur != end && (*cur == '-' || *cur == '+'))
+        {
+            negative = (*cur++ == '-');
+        }
+        if (cur != end && *cur >= '0' && *cur <= '9')
+        {
+            int value = 0;
+            for (; cur != end && *cur >= '0' && *cur <= '9'; ++cur)
+            {
+                if (value < 100000) value = value * 10 + (*cur - '0');
+            }
+            num.exponent += negative ? -value : value;
+            num.integral = false;
+        }
+        else
+        {
+            cur = exp; // not an exponent
+        }
+    }
+    itr = cur;
+    return true;
+}
+
+// Exact when both the significand and the power of ten are representable as
+// doubles, otherwise the scanned text [begin, end) goes through string2double.
+inline bool decimal_to_double(decimal const& num, char const* begin, char const* end, double & result)
+{
+    static const double pow10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+    if (!num.truncated && num.significand <= (std::uint64_t(1) << 53)
+        && num.exponent >= -22 && num.exponent <= 22)
+    {
+        result = static_cast<double>(num.significand);
+        result = num.exponent < 0 ? result / pow10[-num.exponent] : result * pow10[num.exponent];
+        if (num.negative) result = -result;
+        return true;
+    }
+    return string2double(begin, end, result);
+}
+
+}}
+
+#endif // MAPNIK_UTIL_DECIMAL_HPP
@@ -25,12 +25,15 @@
 
 // mapnik
 #include <mapnik/feature.hpp>
+#include <mapnik/json/geojson_writer.hpp>
 // stl
 #include <string>
 
 namespace mapnik { namespace util {
 
-bool to_geojson(std::string & json, mapnik::feature_impl const& feat);
+// appends GeoJSON to `json`, coordinates rounded to `precision` significant digits
+bool to_geojson(std::string & json, mapnik::feature_impl const& feat,
+                unsigned precision = mapnik::json::geojson_default_precision);
 
 }}
 
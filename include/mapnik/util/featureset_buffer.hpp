@@ -50,6 +50,16 @@ public:
         return feature_ptr();
     }
 
+    std::size_t next_batch(feature_ptr * features, std::size_t size)
+    {
+        std::size_t count = 0;
+        while (count < size && pos_ != end_)
+        {
+            features[count++] = *pos_++;
+        }
+        return count;
+    }
+
     void push(feature_ptr const& feature)
     {
         features_.push_back(feature);
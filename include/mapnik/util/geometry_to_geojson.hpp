@@ -25,12 +25,15 @@
 
 // mapnik
 #include <mapnik/geometry.hpp>
+#include <mapnik/json/geojson_writer.hpp>
 
 #include <string>
 
 namespace mapnik { namespace util {
 
-bool to_geojson(std::string & json, mapnik::geometry::geometry<double> const& geom);
+// appends GeoJSON to `json`, coordinates rounded to `precision` significant digits
+bool to_geojson(std::string & json, mapnik::geometry::geometry<double> const& geom,
+                unsigned precision = mapnik::json::geojson_default_precision);
 
 }}
 
@@ -71,6 +71,27 @@ private:
     mutable bool start_loop_;
 };
 
+// Polygon adapter which emits exterior rings counter-clockwise and interior
+// rings clockwise regardless of their stored orientation, so that several
+// polygons can be rasterized together with the non-zero filling rule.
+template <typename T>
+struct oriented_polygon_vertex_adapter
+{
+    using coordinate_type = T;
+    oriented_polygon_vertex_adapter(polygon<T> const& poly);
+    void rewind(unsigned) const;
+    unsigned vertex(coordinate_type * x, coordinate_type * y) const;
+    geometry_types type () const;
+private:
+    void start_ring() const;
+    polygon<T> const& poly_;
+    mutable std::size_t rings_itr_;
+    mutable std::size_t current_index_;
+    mutable std::size_t end_index_;
+    mutable bool reversed_;
+    mutable bool start_loop_;
+};
+
 template <typename T>
 struct ring_vertex_adapter
 {
@@ -89,6 +110,7 @@ private:
 extern template struct MAPNIK_DECL point_vertex_adapter<double>;
 extern template struct MAPNIK_DECL line_string_vertex_adapter<double>;
 extern template struct MAPNIK_DECL polygon_vertex_adapter<double>;
+extern template struct MAPNIK_DECL oriented_polygon_vertex_adapter<double>;
 extern template struct MAPNIK_DECL ring_vertex_adapter<double>;
 
 template <typename T>
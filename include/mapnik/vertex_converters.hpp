@@ -37,6 +37,7 @@
 #include <mapnik/symbolizer_keys.hpp>
 #include <mapnik/symbolizer.hpp>
 #include <mapnik/extend_converter.hpp>
+#include <mapnik/decimate_converter.hpp>
 
 #pragma GCC diagnostic push
 #include <mapnik/warning_ignore_agg.hpp>
@@ -67,6 +68,7 @@ struct dash_tag {};
 struct affine_transform_tag {};
 struct offset_transform_tag {};
 struct extend_tag {};
+struct decimate_tag {};
 
 namespace  detail {
 
@@ -253,9 +255,20 @@ struct converter_traits<T,mapnik::offset_transform_tag>
         auto const& vars = args.vars;
         double offset = get<value_double, keys::offset>(sym, feat, vars);
         geom.set_offset(offset * args.scale_factor);
+        if (args.offset_buffers) geom.set_buffers(*args.offset_buffers);
     }
 };
 
+template <typename T>
+struct converter_traits<T, mapnik::decimate_tag>
+{
+    using geometry_type = T;
+    using conv_type = decimate_converter<geometry_type>;
+
+    template <typename Args>
+    static void setup(geometry_type &, Args const&) {}
+};
+
 template <typename T>
 struct converter_traits<T, mapnik::extend_tag>
 {
@@ -382,7 +395,8 @@ struct arguments : util::noncopyable
           affine_trans(_affine_trans),
           feature(_feature),
           vars(_vars),
-          scale_factor(_scale_factor) {}
+          scale_factor(_scale_factor),
+          offset_buffers(nullptr) {}
 
     box2d<double> const& bbox;
     symbolizer_base const& sym;
@@ -392,6 +406,7 @@ struct arguments : util::noncopyable
     feature_impl const& feature;
     attributes const& vars;
     double scale_factor;
+    offset_converter_buffers * offset_buffers;
 };
 
 }
@@ -436,6 +451,12 @@ struct vertex_converter : private util::noncopyable
         detail::converters_helper<dispatcher_type, ConverterTypes...>:: template set<Converter>(disp_, 0);
     }
 
+    // reuse the given storage in offset_transform_tag converters
+    void set_offset_buffers(offset_converter_buffers & buffers)
+    {
+        disp_.args_.offset_buffers = &buffers;
+    }
+
     dispatcher_type disp_;
 };
 
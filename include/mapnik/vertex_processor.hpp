@@ -27,7 +27,7 @@
 
 namespace mapnik { namespace geometry {
 
-template <typename T>
+template <typename T, template <typename> class PolygonAdapter = polygon_vertex_adapter>
 struct vertex_processor
 {
     using processor_type = T;
@@ -62,7 +62,7 @@ struct vertex_processor
     template <typename T1>
     void operator() (polygon<T1> const& poly) const
     {
-        polygon_vertex_adapter<T1> va(poly);
+        PolygonAdapter<T1> va(poly);
         proc_(va);
     }
 
@@ -91,7 +91,7 @@ struct vertex_processor
     {
         for ( auto const& poly : multi_poly)
         {
-            polygon_vertex_adapter<T1> va(poly);
+            PolygonAdapter<T1> va(poly);
             proc_(va);
         }
     }
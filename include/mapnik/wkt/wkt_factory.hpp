@@ -30,7 +30,11 @@
 
 namespace mapnik {
 
+// Parse a single WKT geometry, optionally surrounded by whitespace. Returns
+// false on malformed input. Accepts exactly what the Spirit X3 wkt_grammar()
+// accepts, but reads coordinates straight into the geometry containers.
 bool from_wkt(std::string const& wkt, mapnik::geometry::geometry<double> & geom);
+bool from_wkt(char const* start, char const* end, mapnik::geometry::geometry<double> & geom);
 
 }
 
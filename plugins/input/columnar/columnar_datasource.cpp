@@ -0,0 +1,210 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2017 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+#include "columnar_datasource.hpp"
+#include "columnar_featureset.hpp"
+
+// mapnik
+#include <mapnik/debug.hpp>
+#include <mapnik/util/file_io.hpp>
+#include <mapnik/util/fs.hpp>
+
+#if defined(MAPNIK_MEMORY_MAPPED_FILE)
+#pragma GCC diagnostic push
+#include <mapnik/warning_ignore.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#pragma GCC diagnostic pop
+#include <mapnik/mapped_memory_cache.hpp>
+#endif
+
+// stl
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+using mapnik::datasource;
+using mapnik::parameters;
+
+DATASOURCE_PLUGIN(columnar_datasource)
+
+namespace {
+
+mapnik::eAttributeType attribute_type(mapnik::columnar::column_type type)
+{
+    switch (type)
+    {
+    case mapnik::columnar::column_type::integer: return mapnik::Integer;
+    case mapnik::columnar::column_type::floating: return mapnik::Double;
+    case mapnik::columnar::column_type::boolean: return mapnik::Boolean;
+    default: break;
+    }
+    return mapnik::String;
+}
+
+}
+
+columnar_datasource::columnar_datasource(parameters const& params)
+    : datasource(params),
+      desc_(columnar_datasource::name(), "utf-8"),
+      filename_(),
+      file_()
+{
+    boost::optional<std::string> file = params.get<std::string>("file");
+    if (!file) throw mapnik::datasource_exception("Columnar Plugin: missing <file> parameter");
+
+    boost::optional<std::string> base = params.get<std::string>("base");
+    if (base)
+        filename_ = *base + "/" + *file;
+    else
+        filename_ = *file;
+
+    if (!mapnik::util::exists(filename_))
+    {
+        throw mapnik::datasource_exception("Columnar Plugin: could not open: '" + filename_ + "'");
+    }
+
+    try
+    {
+#if defined(MAPNIK_MEMORY_MAPPED_FILE)
+        // features are read through the tree: no read-ahead
+        boost::optional<mapnik::mapped_region_ptr> memory =
+            mapnik::mapped_memory_cache::instance().find(filename_, true, mapnik::mapped_access::random);
+        if (!memory)
+        {
+            throw std::runtime_error("could not create file mapping");
+        }
+        mapnik::mapped_region_ptr region = *memory;
+        file_ = std::make_shared<mapnik::columnar::columnar_file>(region,
+                                                                  static_cast<char const*>(region->get_address()),
+                                                                  region->get_size());
+#else
+        mapnik::util::file in(filename_);
+        if (!in.is_open())
+        {
+            throw std::runtime_error("could not open file");
+        }
+        auto buffer = std::make_shared<std::vector<char>>(in.size());
+        if (!buffer->empty() && std::fread(buffer->data(), buffer->size(), 1, in.get()) != 1)
+        {
+            throw std::runtime_error("could not read file");
+        }
+        file_ = std::make_shared<mapnik::columnar::columnar_file>(buffer, buffer->data(), buffer->size());
+#endif
+    }
+    catch (std::exception const& ex)
+    {
+        throw mapnik::datasource_exception("Columnar Plugin: '" + filename_ + "': " + ex.what());
+    }
+
+    for (std::uint32_t col = 0; col < file_->columns(); ++col)
+    {
+        desc_.add_descriptor(mapnik::attribute_descriptor(file_->column_name(col),
+                                                          attribute_type(file_->column(col).type)));
+    }
+}
+
+columnar_datasource::~columnar_datasource() {}
+
+const char * columnar_datasource::name()
+{
+    return "columnar";
+}
+
+mapnik::datasource::datasource_t columnar_datasource::type() const
+{
+    return datasource::Vector;
+}
+
+boost::optional<mapnik::datasource_geometry_t> columnar_datasource::get_geometry_type() const
+{
+    boost::optional<mapnik::datasource_geometry_t> result;
+    std::uint8_t type = file_->get_header().geometry_type;
+    if (type != 0) result = static_cast<mapnik::datasource_geometry_t>(type);
+    return result;
+}
+
+mapnik::box2d<double> columnar_datasource::envelope() const
+{
+    return file_->extent();
+}
+
+mapnik::layer_descriptor columnar_datasource::get_descriptor() const
+{
+    return desc_;
+}
+
+mapnik::featureset_ptr columnar_datasource::features(mapnik::query const& q) const
+{
+    std::vector<columnar_featureset::column_info> columns;
+    mapnik::context_ptr ctx = std::make_shared<mapnik::context_type>();
+    for (auto const& name : q.property_names())
+    {
+        bool found_name = false;
+        for (std::uint32_t col = 0; col < file_->columns(); ++col)
+        {
+            if (file_->column_name(col) == name)
+            {
+                columns.emplace_back(col, name);
+                ctx->push(name);
+                found_name = true;
+                break;
+            }
+        }
+        if (!found_name)
+        {
+            std::ostringstream s;
+            s << "Columnar Plugin: no attribute '" << name << "'. Valid attributes are: ";
+            for (std::uint32_t col = 0; col < file_->columns(); ++col)
+            {
+                if (col > 0) s << ",";
+                s << file_->column_name(col);
+            }
+            s << ".";
+            throw mapnik::datasource_exception(s.str());
+        }
+    }
+
+    mapnik::box2d<double> const& box = q.get_bbox();
+    if (file_->extent().intersects(box))
+    {
+        std::vector<std::uint64_t> index_array;
+        file_->query(box, index_array);
+        if (!index_array.empty())
+        {
+            return std::make_shared<columnar_featureset>(file_, std::move(index_array), std::move(columns), ctx);
+        }
+    }
+    return mapnik::make_invalid_featureset();
+}
+
+mapnik::featureset_ptr columnar_datasource::features_at_point(mapnik::coord2d const& pt, double tol) const
+{
+    mapnik::box2d<double> query_bbox(pt, pt);
+    query_bbox.pad(tol);
+    mapnik::query q(query_bbox);
+    for (auto const& attr : desc_.get_descriptors())
+    {
+        q.add_property_name(attr.get_name());
+    }
+    return features(q);
+}
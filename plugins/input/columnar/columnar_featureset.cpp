@@ -0,0 +1,95 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2017 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+// mapnik
+#include <mapnik/datasource.hpp>
+#include <mapnik/feature.hpp>
+#include <mapnik/feature_factory.hpp>
+
+#include "columnar_featureset.hpp"
+
+// stl
+#include <stdexcept>
+#include <string>
+
+columnar_featureset::columnar_featureset(std::shared_ptr<mapnik::columnar::columnar_file const> const& file,
+                                         std::vector<std::uint64_t> && features,
+                                         std::vector<column_info> && columns,
+                                         mapnik::context_ptr const& ctx)
+    : file_(file),
+      features_(std::move(features)),
+      itr_(features_.begin()),
+      columns_(std::move(columns)),
+      ctx_(ctx),
+      tr_("utf-8") {}
+
+columnar_featureset::~columnar_featureset() {}
+
+mapnik::feature_ptr columnar_featureset::next()
+{
+    using mapnik::columnar::column_type;
+    if (itr_ == features_.end()) return mapnik::feature_ptr();
+
+    std::uint64_t index = *itr_++;
+    mapnik::feature_ptr feature(mapnik::feature_factory::create(ctx_, file_->id(index)));
+    try
+    {
+        feature->set_geometry(file_->get_geometry(index));
+    }
+    catch (std::runtime_error const& ex)
+    {
+        throw mapnik::datasource_exception(std::string("Columnar Plugin: ") + ex.what());
+    }
+    for (auto const& col : columns_)
+    {
+        if (file_->is_null(col.first, index)) continue;
+        switch (file_->column(col.first).type)
+        {
+        case column_type::integer:
+            feature->put(col.second, static_cast<mapnik::value_integer>(file_->integer(col.first, index)));
+            break;
+        case column_type::floating:
+            feature->put(col.second, file_->floating(col.first, index));
+            break;
+        case column_type::boolean:
+            feature->put(col.second, file_->boolean(col.first, index));
+            break;
+        case column_type::string:
+        {
+            auto str = file_->string(col.first, index);
+            feature->put(col.second, tr_.transcode(str.first, static_cast<std::int32_t>(str.second)));
+            break;
+        }
+        }
+    }
+    return feature;
+}
+
+std::size_t columnar_featureset::next_batch(mapnik::feature_ptr * features, std::size_t size)
+{
+    std::size_t count = 0;
+    while (count < size && (features[count] = columnar_featureset::next()))
+    {
+        ++count;
+    }
+    return count;
+}
@@ -0,0 +1,61 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2017 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+#ifndef COLUMNAR_FEATURESET_HPP
+#define COLUMNAR_FEATURESET_HPP
+
+// mapnik
+#include <mapnik/feature.hpp>
+#include <mapnik/unicode.hpp>
+
+#include "columnar_file.hpp"
+
+// stl
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+class columnar_featureset : public mapnik::Featureset
+{
+public:
+    // index and name of a requested column
+    using column_info = std::pair<std::uint32_t, std::string>;
+
+    columnar_featureset(std::shared_ptr<mapnik::columnar::columnar_file const> const& file,
+                        std::vector<std::uint64_t> && features,
+                        std::vector<column_info> && columns,
+                        mapnik::context_ptr const& ctx);
+    virtual ~columnar_featureset();
+    mapnik::feature_ptr next();
+    std::size_t next_batch(mapnik::feature_ptr * features, std::size_t size);
+
+private:
+    std::shared_ptr<mapnik::columnar::columnar_file const> file_;
+    const std::vector<std::uint64_t> features_;
+    std::vector<std::uint64_t>::const_iterator itr_;
+    const std::vector<column_info> columns_;
+    mapnik::context_ptr ctx_;
+    const mapnik::transcoder tr_;
+};
+
+#endif // COLUMNAR_FEATURESET_HPP
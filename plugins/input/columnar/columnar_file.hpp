@@ -0,0 +1,467 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2017 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+#ifndef MAPNIK_COLUMNAR_FILE_HPP
+#define MAPNIK_COLUMNAR_FILE_HPP
+
+// mapnik
+#include <mapnik/datasource_geometry_type.hpp>
+#include <mapnik/geometry.hpp>
+#include <mapnik/geometry/box2d.hpp>
+#include <mapnik/value/types.hpp>
+
+// stl
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Mapnik columnar vector format (.mcol)
+//
+// A read-only layer format designed to be used straight from a memory
+// mapping. All sections are arrays of fixed size, 8 byte aligned records
+// in the byte order of the host that wrote the file:
+//
+//   header
+//   tree                packed Hilbert R-tree, node[header.nodes]
+//   ids                 int64[features]
+//   types               uint8[features], geometry::geometry_types
+//   feature_geometries  uint32[features + 1], first geometry of a feature
+//   geometry_parts      uint32[geometries + 1], first part (ring, line) of a geometry
+//   part_coords         uint64[parts + 1], first coordinate of a part
+//   coords              double[2 * coordinates], x/y interleaved
+//   column_table        column_entry[columns]
+//   column data         validity bitmaps, values, string dictionaries
+//
+// Features are stored in Hilbert order of their bounding box centres, so the
+// leaves of the tree are the feature boxes in file order. Multi geometries
+// have one geometry per member; a multi point is one geometry with one part.
+// String columns are dictionary encoded: uint32 codes index into a table of
+// UTF-8 strings.
+
+namespace mapnik { namespace columnar {
+
+static constexpr char magic[8] = { 'm', 'a', 'p', 'n', 'i', 'k', 'c', 'f' };
+static constexpr std::uint32_t byte_order_mark = 0x01020304;
+static constexpr std::uint32_t format_version = 1;
+
+enum class column_type : std::uint8_t
+{
+    integer = 0, // int64
+    floating = 1, // double
+    boolean = 2, // uint8
+    string = 3   // uint32 dictionary code
+};
+
+struct header
+{
+    char magic[8];
+    std::uint32_t byte_order;
+    std::uint32_t version;
+    std::uint64_t features;
+    std::uint32_t columns;
+    std::uint32_t node_size;
+    std::uint8_t geometry_type; // datasource_geometry_t, 0 if unknown
+    std::uint8_t reserved[7];
+    double extent[4];
+    std::uint64_t nodes;
+    // section offsets from the start of the file
+    std::uint64_t tree;
+    std::uint64_t ids;
+    std::uint64_t types;
+    std::uint64_t feature_geometries;
+    std::uint64_t geometry_parts;
+    std::uint64_t part_coords;
+    std::uint64_t coords;
+    std::uint64_t column_table;
+    std::uint64_t size;
+};
+
+struct node
+{
+    double minx;
+    double miny;
+    double maxx;
+    double maxy;
+    std::uint64_t index; // feature for leaves, first child otherwise
+};
+
+struct column_entry
+{
+    std::uint64_t name;      // offset of the UTF-8 name
+    std::uint32_t name_size;
+    column_type type;
+    std::uint8_t reserved[3];
+    std::uint64_t validity;  // bitmap of set values, 0 if no value is null
+    std::uint64_t values;
+    std::uint64_t dictionary;      // uint64[dictionary_size + 1] offsets into dictionary_data
+    std::uint64_t dictionary_size;
+    std::uint64_t dictionary_data;
+};
+
+static_assert(std::is_standard_layout<header>::value && sizeof(header) % 8 == 0, "header must be a padded pod");
+static_assert(std::is_standard_layout<node>::value && sizeof(node) == 40, "node must be a padded pod");
+static_assert(std::is_standard_layout<column_entry>::value && sizeof(column_entry) % 8 == 0, "column_entry must be a padded pod");
+
+// end of each level of a packed tree over `items` leaves, leaves first
+inline std::vector<std::uint64_t> level_bounds(std::uint64_t items, std::uint64_t node_size)
+{
+    std::vector<std::uint64_t> bounds;
+    if (items == 0) return bounds;
+    std::uint64_t count = items;
+    std::uint64_t nodes = items;
+    bounds.push_back(nodes);
+    do
+    {
+        count = (count + node_size - 1) / node_size;
+        nodes += count;
+        bounds.push_back(nodes);
+    }
+    while (count != 1);
+    return bounds;
+}
+
+// Read-only view of a columnar file in memory. The constructor checks the
+// header and the extent of every section; offsets inside the sections are
+// checked when a feature is read, so opening a file only touches its header
+// and the column table.
+class columnar_file
+{
+public:
+    // `storage` keeps the memory at `data` alive, e.g. a mapped region
+    columnar_file(std::shared_ptr<void const> storage, char const* data, std::size_t size)
+        : storage_(std::move(storage)),
+          data_(data),
+          size_(size),
+          header_(nullptr),
+          columns_(nullptr),
+          geometries_(0),
+          parts_(0),
+          coords_(0),
+          level_bounds_()
+    {
+        if (size_ < sizeof(header) || reinterpret_cast<std::uintptr_t>(data_) % 8 != 0)
+        {
+            throw std::runtime_error("not a columnar file");
+        }
+        header_ = reinterpret_cast<header const*>(data_);
+        if (std::memcmp(header_->magic, magic, sizeof(magic)) != 0)
+        {
+            throw std::runtime_error("not a columnar file");
+        }
+        if (header_->byte_order != byte_order_mark)
+        {
+            throw std::runtime_error("columnar file was written with a different byte order");
+        }
+        if (header_->version != format_version)
+        {
+            throw std::runtime_error("unsupported columnar file version " + std::to_string(header_->version));
+        }
+        if (header_->size != size_ || header_->node_size < 2)
+        {
+            throw std::runtime_error("truncated or corrupt columnar file");
+        }
+        if (header_->geometry_type > datasource_geometry_t::Collection)
+        {
+            throw std::runtime_error("corrupt columnar file: unknown geometry type "
+                                     + std::to_string(header_->geometry_type));
+        }
+        std::uint64_t features = header_->features;
+        level_bounds_ = level_bounds(features, header_->node_size);
+        if (header_->nodes != (level_bounds_.empty() ? 0 : level_bounds_.back()))
+        {
+            throw std::runtime_error("corrupt columnar file: invalid tree");
+        }
+        section<node>(header_->tree, header_->nodes);
+        section<std::int64_t>(header_->ids, features);
+        section<std::uint8_t>(header_->types, features);
+        geometries_ = section<std::uint32_t>(header_->feature_geometries, features + 1)[features];
+        parts_ = section<std::uint32_t>(header_->geometry_parts, geometries_ + 1)[geometries_];
+        coords_ = section<std::uint64_t>(header_->part_coords, parts_ + 1)[parts_];
+        section<double>(header_->coords, 2 * coords_);
+        columns_ = section<column_entry>(header_->column_table, header_->columns);
+        for (std::uint32_t i = 0; i < header_->columns; ++i)
+        {
+            column_entry const& col = columns_[i];
+            section<char>(col.name, col.name_size);
+            if (col.validity != 0) section<std::uint8_t>(col.validity, (features + 7) / 8);
+            switch (col.type)
+            {
+            case column_type::integer: section<std::int64_t>(col.values, features); break;
+            case column_type::floating: section<double>(col.values, features); break;
+            case column_type::boolean: section<std::uint8_t>(col.values, features); break;
+            case column_type::string:
+            {
+                section<std::uint32_t>(col.values, features);
+                std::uint64_t data_size = section<std::uint64_t>(col.dictionary, col.dictionary_size + 1)[col.dictionary_size];
+                section<char>(col.dictionary_data, data_size);
+                break;
+            }
+            default:
+                throw std::runtime_error("corrupt columnar file: unknown column type");
+            }
+        }
+    }
+
+    header const& get_header() const { return *header_; }
+    std::uint64_t size() const { return header_->features; }
+    std::uint32_t columns() const { return header_->columns; }
+    column_entry const& column(std::uint32_t col) const { return columns_[col]; }
+
+    box2d<double> extent() const
+    {
+        return box2d<double>(header_->extent[0], header_->extent[1], header_->extent[2], header_->extent[3]);
+    }
+
+    std::string column_name(std::uint32_t col) const
+    {
+        return std::string(data_ + columns_[col].name, columns_[col].name_size);
+    }
+
+    // features whose box intersects `box`, in file order
+    void query(box2d<double> const& box, std::vector<std::uint64_t> & result) const
+    {
+        if (header_->nodes == 0) return;
+        node const* nodes = at<node>(header_->tree);
+        std::uint64_t node_size = header_->node_size;
+        std::uint64_t items = header_->features;
+        std::vector<std::pair<std::uint64_t, std::size_t>> stack;
+        std::uint64_t index = header_->nodes - 1;
+        std::size_t level = level_bounds_.size() - 1;
+        while (true)
+        {
+            std::uint64_t end = std::min(index + node_size, level_bounds_[level]);
+            for (std::uint64_t pos = index; pos < end; ++pos)
+            {
+                node const& n = nodes[pos];
+                if (n.maxx < box.minx() || n.maxy < box.miny() ||
+                    n.minx > box.maxx() || n.miny > box.maxy()) continue;
+                if (index < items)
+                {
+                    if (n.index < items) result.push_back(n.index);
+                }
+                else if (level > 0 && n.index < level_bounds_[level - 1])
+                {
+                    stack.emplace_back(n.index, level - 1);
+                }
+            }
+            if (stack.empty()) break;
+            index = stack.back().first;
+            level = stack.back().second;
+            stack.pop_back();
+        }
+        std::sort(result.begin(), result.end());
+    }
+
+    value_integer id(std::uint64_t feature) const
+    {
+        return static_cast<value_integer>(at<std::int64_t>(header_->ids)[feature]);
+    }
+
+    geometry::geometry<double> get_geometry(std::uint64_t feature) const
+    {
+        using namespace mapnik::geometry;
+        std::uint32_t const* feature_geometries = at<std::uint32_t>(header_->feature_geometries);
+        std::uint32_t first = feature_geometries[feature];
+        std::uint32_t last = feature_geometries[feature + 1];
+        if (first > last || last > geometries_) corrupt();
+        switch (at<std::uint8_t>(header_->types)[feature])
+        {
+        case geometry_types::Point:
+        {
+            if (last != first + 1) corrupt();
+            auto coords = part(first, 0);
+            if (coords.first == coords.second) corrupt();
+            return point<double>(x(coords.first), y(coords.first));
+        }
+        case geometry_types::LineString:
+            if (last != first + 1) corrupt();
+            return read_line_string(first, 0);
+        case geometry_types::Polygon:
+            if (last != first + 1) corrupt();
+            return read_polygon(first);
+        case geometry_types::MultiPoint:
+        {
+            multi_point<double> multi;
+            if (last != first + 1) corrupt();
+            auto coords = part(first, 0);
+            multi.reserve(coords.second - coords.first);
+            for (std::uint64_t i = coords.first; i < coords.second; ++i)
+            {
+                multi.emplace_back(x(i), y(i));
+            }
+            return multi;
+        }
+        case geometry_types::MultiLineString:
+        {
+            multi_line_string<double> multi;
+            multi.reserve(last - first);
+            for (std::uint32_t i = first; i < last; ++i)
+            {
+                multi.push_back(read_line_string(i, 0));
+            }
+            return multi;
+        }
+        case geometry_types::MultiPolygon:
+        {
+            multi_polygon<double> multi;
+            multi.reserve(last - first);
+            for (std::uint32_t i = first; i < last; ++i)
+            {
+                multi.push_back(read_polygon(i));
+            }
+            return multi;
+        }
+        default:
+            // the writer never stores empty geometries or collections
+            break;
+        }
+        throw std::runtime_error("corrupt columnar file: unknown geometry type "
+                                 + std::to_string(at<std::uint8_t>(header_->types)[feature]));
+    }
+
+    bool is_null(std::uint32_t col, std::uint64_t feature) const
+    {
+        std::uint64_t validity = columns_[col].validity;
+        if (validity == 0) return false;
+        return (at<std::uint8_t>(validity)[feature / 8] & (1u << (feature % 8))) == 0;
+    }
+
+    std::int64_t integer(std::uint32_t col, std::uint64_t feature) const
+    {
+        return at<std::int64_t>(columns_[col].values)[feature];
+    }
+
+    double floating(std::uint32_t col, std::uint64_t feature) const
+    {
+        return at<double>(columns_[col].values)[feature];
+    }
+
+    bool boolean(std::uint32_t col, std::uint64_t feature) const
+    {
+        return at<std::uint8_t>(columns_[col].values)[feature] != 0;
+    }
+
+    // UTF-8 bytes of a string value, not nul terminated
+    std::pair<char const*, std::size_t> string(std::uint32_t col, std::uint64_t feature) const
+    {
+        column_entry const& entry = columns_[col];
+        std::uint32_t code = at<std::uint32_t>(entry.values)[feature];
+        if (code >= entry.dictionary_size) corrupt();
+        std::uint64_t const* offsets = at<std::uint64_t>(entry.dictionary);
+        std::uint64_t begin = offsets[code];
+        std::uint64_t end = offsets[code + 1];
+        if (begin > end || end > offsets[entry.dictionary_size]) corrupt();
+        return std::make_pair(data_ + entry.dictionary_data + begin, static_cast<std::size_t>(end - begin));
+    }
+
+private:
+    [[noreturn]] static void corrupt()
+    {
+        throw std::runtime_error("corrupt columnar file");
+    }
+
+    template <typename T>
+    T const* at(std::uint64_t offset) const
+    {
+        return reinterpret_cast<T const*>(data_ + offset);
+    }
+
+    // checks that `count` records of T at `offset` are inside the file
+    template <typename T>
+    T const* section(std::uint64_t offset, std::uint64_t count) const
+    {
+        if (offset % alignof(T) != 0 || offset > size_ ||
+            count > (size_ - offset) / sizeof(T))
+        {
+            corrupt();
+        }
+        return at<T>(offset);
+    }
+
+    // coordinate range of part `index` of geometry `geom`
+    std::pair<std::uint64_t, std::uint64_t> part(std::uint32_t geom, std::uint32_t index) const
+    {
+        std::uint32_t const* geometry_parts = at<std::uint32_t>(header_->geometry_parts);
+        std::uint32_t p = geometry_parts[geom] + index;
+        if (p >= geometry_parts[geom + 1] || p >= parts_) corrupt();
+        std::uint64_t const* part_coords = at<std::uint64_t>(header_->part_coords);
+        std::uint64_t first = part_coords[p];
+        std::uint64_t last = part_coords[p + 1];
+        if (first > last || last > coords_) corrupt();
+        return std::make_pair(first, last);
+    }
+
+    double x(std::uint64_t coord) const { return at<double>(header_->coords)[2 * coord]; }
+    double y(std::uint64_t coord) const { return at<double>(header_->coords)[2 * coord + 1]; }
+
+    geometry::line_string<double> read_line_string(std::uint32_t geom, std::uint32_t index) const
+    {
+        auto coords = part(geom, index);
+        geometry::line_string<double> line;
+        line.reserve(coords.second - coords.first);
+        for (std::uint64_t i = coords.first; i < coords.second; ++i)
+        {
+            line.emplace_back(x(i), y(i));
+        }
+        return line;
+    }
+
+    geometry::polygon<double> read_polygon(std::uint32_t geom) const
+    {
+        std::uint32_t const* geometry_parts = at<std::uint32_t>(header_->geometry_parts);
+        if (geometry_parts[geom] > geometry_parts[geom + 1]) corrupt();
+        std::uint32_t rings = geometry_parts[geom + 1] - geometry_parts[geom];
+        geometry::polygon<double> poly;
+        poly.reserve(rings);
+        for (std::uint32_t i = 0; i < rings; ++i)
+        {
+            auto coords = part(geom, i);
+            geometry::linear_ring<double> ring;
+            ring.reserve(coords.second - coords.first);
+            for (std::uint64_t j = coords.first; j < coords.second; ++j)
+            {
+                ring.emplace_back(x(j), y(j));
+            }
+            poly.push_back(std::move(ring));
+        }
+        return poly;
+    }
+
+    std::shared_ptr<void const> storage_;
+    char const* data_;
+    std::size_t size_;
+    header const* header_;
+    column_entry const* columns_;
+    std::uint64_t geometries_;
+    std::uint64_t parts_;
+    std::uint64_t coords_;
+    std::vector<std::uint64_t> level_bounds_;
+};
+
+}}
+
+#endif // MAPNIK_COLUMNAR_FILE_HPP
@@ -0,0 +1,493 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2017 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+#ifndef MAPNIK_COLUMNAR_WRITER_HPP
+#define MAPNIK_COLUMNAR_WRITER_HPP
+
+#include "columnar_file.hpp"
+
+// mapnik
+#include <mapnik/feature.hpp>
+#include <mapnik/feature_kv_iterator.hpp>
+#include <mapnik/value.hpp>
+#include <mapnik/geometry/envelope.hpp>
+#include <mapnik/geometry/geometry_type.hpp>
+#include <mapnik/util/geometry_to_ds_type.hpp>
+
+// stl
+#include <limits>
+#include <map>
+#include <numeric>
+#include <ostream>
+#include <unordered_map>
+
+namespace mapnik { namespace columnar {
+
+namespace detail {
+
+// position of (x, y) on a 16 bit Hilbert curve
+inline std::uint32_t hilbert(std::uint32_t x, std::uint32_t y)
+{
+    std::uint32_t a = x ^ y;
+    std::uint32_t b = 0xFFFF ^ a;
+    std::uint32_t c = 0xFFFF ^ (x | y);
+    std::uint32_t d = x & (y ^ 0xFFFF);
+
+    std::uint32_t A = a | (b >> 1);
+    std::uint32_t B = (a >> 1) ^ a;
+    std::uint32_t C = ((c >> 1) ^ (b & (d >> 1))) ^ c;
+    std::uint32_t D = ((a & (c >> 1)) ^ (d >> 1)) ^ d;
+
+    a = A; b = B; c = C; d = D;
+    A = ((a & (a >> 2)) ^ (b & (b >> 2)));
+    B = ((a & (b >> 2)) ^ (b & ((a ^ b) >> 2)));
+    C ^= ((a & (c >> 2)) ^ (b & (d >> 2)));
+    D ^= ((b & (c >> 2)) ^ ((a ^ b) & (d >> 2)));
+
+    a = A; b = B; c = C; d = D;
+    A = ((a & (a >> 4)) ^ (b & (b >> 4)));
+    B = ((a & (b >> 4)) ^ (b & ((a ^ b) >> 4)));
+    C ^= ((a & (c >> 4)) ^ (b & (d >> 4)));
+    D ^= ((b & (c >> 4)) ^ ((a ^ b) & (d >> 4)));
+
+    a = A; b = B; c = C; d = D;
+    C ^= ((a & (c >> 8)) ^ (b & (d >> 8)));
+    D ^= ((b & (c >> 8)) ^ ((a ^ b) & (d >> 8)));
+
+    a = C ^ (C >> 1);
+    b = D ^ (D >> 1);
+
+    std::uint32_t i0 = x ^ y;
+    std::uint32_t i1 = b | (0xFFFF ^ (i0 | a));
+
+    i0 = (i0 | (i0 << 8)) & 0x00FF00FF;
+    i0 = (i0 | (i0 << 4)) & 0x0F0F0F0F;
+    i0 = (i0 | (i0 << 2)) & 0x33333333;
+    i0 = (i0 | (i0 << 1)) & 0x55555555;
+
+    i1 = (i1 | (i1 << 8)) & 0x00FF00FF;
+    i1 = (i1 | (i1 << 4)) & 0x0F0F0F0F;
+    i1 = (i1 | (i1 << 2)) & 0x33333333;
+    i1 = (i1 | (i1 << 1)) & 0x55555555;
+
+    return (i1 << 1) | i0;
+}
+
+// file image assembled in memory, sections aligned to 8 bytes
+class buffer
+{
+public:
+    std::uint64_t size() const { return data_.size(); }
+
+    template <typename T>
+    std::uint64_t append(T const* values, std::size_t count)
+    {
+        align();
+        std::uint64_t offset = data_.size();
+        data_.append(reinterpret_cast<char const*>(values), count * sizeof(T));
+        return offset;
+    }
+
+    template <typename T>
+    std::uint64_t append(std::vector<T> const& values)
+    {
+        return append(values.data(), values.size());
+    }
+
+    void align()
+    {
+        data_.resize((data_.size() + 7) & ~std::size_t(7), '\0');
+    }
+
+    std::string & data() { return data_; }
+
+private:
+    std::string data_;
+};
+
+}
+
+// Collects features and writes them as a columnar file.
+//
+// Geometry collections and features without geometry are not stored. A
+// column holding integers and doubles is written as doubles, any other mix
+// of types as strings.
+class columnar_writer
+{
+public:
+    explicit columnar_writer(std::uint32_t node_size = 16)
+        : node_size_(std::max(node_size, 2u)) {}
+
+    // false if the feature was not stored
+    bool add(feature_impl const& feature)
+    {
+        geometry::geometry<double> const& geom = feature.get_geometry();
+        geometry::geometry_types type = geometry::geometry_type(geom);
+        if (type == geometry::geometry_types::Unknown ||
+            type == geometry::geometry_types::GeometryCollection)
+        {
+            return false;
+        }
+        box2d<double> box = geometry::envelope(geom);
+        if (!box.valid()) return false;
+
+        std::size_t index = items_.size();
+        items_.push_back(item{feature.id(), geom, box});
+        for (auto & column : values_)
+        {
+            column.emplace_back();
+        }
+        for (auto const& kv : feature)
+        {
+            std::string const& name = std::get<0>(kv);
+            auto itr = column_index_.find(name);
+            if (itr == column_index_.end())
+            {
+                itr = column_index_.emplace(name, names_.size()).first;
+                names_.push_back(name);
+                values_.emplace_back(items_.size());
+            }
+            values_[itr->second][index] = std::get<1>(kv);
+        }
+        return true;
+    }
+
+    std::size_t size() const { return items_.size(); }
+
+    void write(std::ostream & out) const
+    {
+        std::uint64_t features = items_.size();
+        header head;
+        std::memset(&head, 0, sizeof(head));
+        std::memcpy(head.magic, magic, sizeof(magic));
+        head.byte_order = byte_order_mark;
+        head.version = format_version;
+        head.features = features;
+        head.columns = static_cast<std::uint32_t>(names_.size());
+        head.node_size = node_size_;
+
+        box2d<double> extent;
+        for (auto const& it : items_)
+        {
+            if (extent.valid()) extent.expand_to_include(it.box);
+            else extent = it.box;
+        }
+        head.extent[0] = extent.minx();
+        head.extent[1] = extent.miny();
+        head.extent[2] = extent.maxx();
+        head.extent[3] = extent.maxy();
+        head.geometry_type = geometry_type();
+
+        // Hilbert order of the box centres
+        std::vector<std::uint32_t> keys(features);
+        double width = extent.width() > 0 ? extent.width() : 1.0;
+        double height = extent.height() > 0 ? extent.height() : 1.0;
+        for (std::size_t i = 0; i < features; ++i)
+        {
+            auto center = items_[i].box.center();
+            auto hx = static_cast<std::uint32_t>(0xFFFF * (center.x - extent.minx()) / width);
+            auto hy = static_cast<std::uint32_t>(0xFFFF * (center.y - extent.miny()) / height);
+            keys[i] = detail::hilbert(hx, hy);
+        }
+        std::vector<std::size_t> order(features);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&keys](std::size_t a, std::size_t b)
+                         { return keys[a] < keys[b]; });
+
+        detail::buffer buf;
+        buf.data().resize(sizeof(header));
+
+        // packed tree, leaves first
+        std::vector<std::uint64_t> bounds = level_bounds(features, node_size_);
+        std::vector<node> nodes;
+        nodes.reserve(bounds.empty() ? 0 : bounds.back());
+        for (std::size_t i = 0; i < features; ++i)
+        {
+            box2d<double> const& box = items_[order[i]].box;
+            nodes.push_back(node{box.minx(), box.miny(), box.maxx(), box.maxy(), i});
+        }
+        for (std::size_t level = 0; level + 1 < bounds.size(); ++level)
+        {
+            std::uint64_t begin = level == 0 ? 0 : bounds[level - 1];
+            for (std::uint64_t pos = begin; pos < bounds[level]; pos += node_size_)
+            {
+                node parent = nodes[pos];
+                parent.index = pos;
+                std::uint64_t end = std::min(pos + node_size_, bounds[level]);
+                for (std::uint64_t child = pos + 1; child < end; ++child)
+                {
+                    parent.minx = std::min(parent.minx, nodes[child].minx);
+                    parent.miny = std::min(parent.miny, nodes[child].miny);
+                    parent.maxx = std::max(parent.maxx, nodes[child].maxx);
+                    parent.maxy = std::max(parent.maxy, nodes[child].maxy);
+                }
+                nodes.push_back(parent);
+            }
+        }
+        head.nodes = nodes.size();
+        head.tree = buf.append(nodes);
+
+        // ids and geometries
+        std::vector<std::int64_t> ids;
+        std::vector<std::uint8_t> types;
+        geometry_arrays arrays;
+        ids.reserve(features);
+        types.reserve(features);
+        arrays.feature_geometries.reserve(features + 1);
+        for (std::size_t i : order)
+        {
+            ids.push_back(items_[i].id);
+            types.push_back(static_cast<std::uint8_t>(geometry::geometry_type(items_[i].geom)));
+            arrays.feature_geometries.push_back(checked(arrays.geometry_parts.size()));
+            util::apply_visitor(arrays, items_[i].geom);
+        }
+        arrays.feature_geometries.push_back(checked(arrays.geometry_parts.size()));
+        arrays.geometry_parts.push_back(checked(arrays.part_coords.size()));
+        arrays.part_coords.push_back(arrays.coords.size() / 2);
+        head.ids = buf.append(ids);
+        head.types = buf.append(types);
+        head.feature_geometries = buf.append(arrays.feature_geometries);
+        head.geometry_parts = buf.append(arrays.geometry_parts);
+        head.part_coords = buf.append(arrays.part_coords);
+        head.coords = buf.append(arrays.coords);
+
+        // attribute columns
+        std::vector<column_entry> entries;
+        for (std::size_t col = 0; col < names_.size(); ++col)
+        {
+            entries.push_back(write_column(buf, col, order));
+        }
+        head.column_table = buf.append(entries);
+
+        buf.align();
+        head.size = buf.size();
+        std::memcpy(&buf.data()[0], &head, sizeof(head));
+        out.write(buf.data().data(), static_cast<std::streamsize>(buf.data().size()));
+    }
+
+private:
+    struct item
+    {
+        value_integer id;
+        geometry::geometry<double> geom;
+        box2d<double> box;
+    };
+
+    struct geometry_arrays
+    {
+        std::vector<std::uint32_t> feature_geometries;
+        std::vector<std::uint32_t> geometry_parts;
+        std::vector<std::uint64_t> part_coords;
+        std::vector<double> coords;
+
+        template <typename Points>
+        void add_part(Points const& points)
+        {
+            part_coords.push_back(coords.size() / 2);
+            for (auto const& pt : points)
+            {
+                coords.push_back(pt.x);
+                coords.push_back(pt.y);
+            }
+        }
+
+        void operator() (geometry::point<double> const& pt)
+        {
+            geometry_parts.push_back(checked(part_coords.size()));
+            part_coords.push_back(coords.size() / 2);
+            coords.push_back(pt.x);
+            coords.push_back(pt.y);
+        }
+
+        void operator() (geometry::line_string<double> const& line)
+        {
+            geometry_parts.push_back(checked(part_coords.size()));
+            add_part(line);
+        }
+
+        void operator() (geometry::polygon<double> const& poly)
+        {
+            geometry_parts.push_back(checked(part_coords.size()));
+            for (auto const& ring : poly) add_part(ring);
+        }
+
+        void operator() (geometry::multi_point<double> const& multi)
+        {
+            geometry_parts.push_back(checked(part_coords.size()));
+            add_part(multi);
+        }
+
+        void operator() (geometry::multi_line_string<double> const& multi)
+        {
+            for (auto const& line : multi) (*this)(line);
+        }
+
+        void operator() (geometry::multi_polygon<double> const& multi)
+        {
+            for (auto const& poly : multi) (*this)(poly);
+        }
+
+        template <typename T>
+        void operator() (T const&) {}
+    };
+
+    static std::uint32_t checked(std::size_t count)
+    {
+        if (count > std::numeric_limits<std::uint32_t>::max())
+        {
+            throw std::runtime_error("too many geometries for a columnar file");
+        }
+        return static_cast<std::uint32_t>(count);
+    }
+
+    std::uint8_t geometry_type() const
+    {
+        boost::optional<datasource_geometry_t> result;
+        for (auto const& it : items_)
+        {
+            datasource_geometry_t type = util::to_ds_type(it.geom);
+            if (!result) result = type;
+            else if (*result != type) return static_cast<std::uint8_t>(datasource_geometry_t::Collection);
+        }
+        return result ? static_cast<std::uint8_t>(*result) : 0;
+    }
+
+    column_entry write_column(detail::buffer & buf, std::size_t col, std::vector<std::size_t> const& order) const
+    {
+        std::vector<value> const& values = values_[col];
+        std::size_t features = order.size();
+        column_entry entry;
+        std::memset(&entry, 0, sizeof(entry));
+        entry.name = buf.append(names_[col].data(), names_[col].size());
+        entry.name_size = static_cast<std::uint32_t>(names_[col].size());
+
+        bool integers = true;
+        bool numbers = true;
+        bool booleans = true;
+        bool nulls = false;
+        for (auto const& v : values)
+        {
+            if (v.is_null())
+            {
+                nulls = true;
+                continue;
+            }
+            bool is_integer = v.is<value_integer>();
+            integers = integers && is_integer;
+            numbers = numbers && (is_integer || v.is<value_double>());
+            booleans = booleans && v.is<value_bool>();
+        }
+        if (booleans && !integers) entry.type = column_type::boolean;
+        else if (integers) entry.type = column_type::integer;
+        else if (numbers) entry.type = column_type::floating;
+        else entry.type = column_type::string;
+
+        if (nulls)
+        {
+            std::vector<std::uint8_t> validity((features + 7) / 8, 0);
+            for (std::size_t i = 0; i < features; ++i)
+            {
+                if (!values[order[i]].is_null()) validity[i / 8] |= static_cast<std::uint8_t>(1u << (i % 8));
+            }
+            entry.validity = buf.append(validity);
+        }
+
+        switch (entry.type)
+        {
+        case column_type::integer:
+        {
+            std::vector<std::int64_t> data(features, 0);
+            for (std::size_t i = 0; i < features; ++i)
+            {
+                value const& v = values[order[i]];
+                if (!v.is_null()) data[i] = v.to_int();
+            }
+            entry.values = buf.append(data);
+            break;
+        }
+        case column_type::floating:
+        {
+            std::vector<double> data(features, 0.0);
+            for (std::size_t i = 0; i < features; ++i)
+            {
+                value const& v = values[order[i]];
+                if (!v.is_null()) data[i] = v.to_double();
+            }
+            entry.values = buf.append(data);
+            break;
+        }
+        case column_type::boolean:
+        {
+            std::vector<std::uint8_t> data(features, 0);
+            for (std::size_t i = 0; i < features; ++i)
+            {
+                value const& v = values[order[i]];
+                if (!v.is_null()) data[i] = v.to_bool() ? 1 : 0;
+            }
+            entry.values = buf.append(data);
+            break;
+        }
+        case column_type::string:
+        {
+            std::unordered_map<std::string, std::uint32_t> codes;
+            std::vector<std::uint64_t> offsets(1, 0);
+            std::string strings;
+            std::vector<std::uint32_t> data(features, 0);
+            for (std::size_t i = 0; i < features; ++i)
+            {
+                value const& v = values[order[i]];
+                if (v.is_null()) continue;
+                std::string str = v.to_string();
+                auto itr = codes.find(str);
+                if (itr == codes.end())
+                {
+                    itr = codes.emplace(str, checked(offsets.size() - 1)).first;
+                    strings += str;
+                    offsets.push_back(strings.size());
+                }
+                data[i] = itr->second;
+            }
+            if (offsets.size() == 1)
+            {
+                // every value is null: keep code 0 valid
+                offsets.push_back(0);
+            }
+            entry.values = buf.append(data);
+            entry.dictionary_size = offsets.size() - 1;
+            entry.dictionary = buf.append(offsets);
+            entry.dictionary_data = buf.append(strings.data(), strings.size());
+            break;
+        }
+        }
+        return entry;
+    }
+
+    std::uint32_t node_size_;
+    std::vector<item> items_;
+    std::vector<std::string> names_;
+    std::map<std::string, std::size_t> column_index_;
+    std::vector<std::vector<value>> values_;
+};
+
+}}
+
+#endif // MAPNIK_COLUMNAR_WRITER_HPP
@@ -125,7 +125,7 @@ csv_datasource::csv_datasource(parameters const& params)
         file_source_type in;
         mapnik::mapped_region_ptr mapped_region;
         boost::optional<mapnik::mapped_region_ptr> memory =
-            mapnik::mapped_memory_cache::instance().find(filename_, true);
+            mapnik::mapped_memory_cache::instance().find(filename_, true, mapnik::mapped_access::sequential);
         if (memory)
         {
             mapped_region = *memory;
@@ -53,7 +53,7 @@ csv_featureset::csv_featureset(std::string const& filename, locator_type const&
 {
 #if defined (MAPNIK_MEMORY_MAPPED_FILE)
     boost::optional<mapnik::mapped_region_ptr> memory =
-            mapnik::mapped_memory_cache::instance().find(filename, true);
+            mapnik::mapped_memory_cache::instance().find(filename, true, mapnik::mapped_access::sequential);
     if (memory)
     {
         mapped_region_ = *memory;
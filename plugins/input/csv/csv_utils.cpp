@@ -467,7 +467,7 @@ mapnik::geometry::geometry<double> extract_geometry(std::vector<std::string> con
     mapnik::geometry::geometry<double> geom;
     if (locator.type == geometry_column_locator::WKT)
     {
-        auto wkt_value = row.at(locator.index);
+        auto const& wkt_value = row.at(locator.index);
         if (mapnik::from_wkt(wkt_value, geom))
         {
             // correct orientations ..
@@ -481,7 +481,7 @@ mapnik::geometry::geometry<double> extract_geometry(std::vector<std::string> con
     else if (locator.type == geometry_column_locator::GEOJSON)
     {
 
-        auto json_value = row.at(locator.index);
+        auto const& json_value = row.at(locator.index);
         if (!mapnik::json::from_geojson(json_value, geom))
         {
             throw mapnik::datasource_exception("Failed to parse GeoJSON: '" + json_value + "'");
@@ -490,8 +490,8 @@ mapnik::geometry::geometry<double> extract_geometry(std::vector<std::string> con
     else if (locator.type == geometry_column_locator::LON_LAT)
     {
         double x, y;
-        auto long_value = row.at(locator.index);
-        auto lat_value = row.at(locator.index2);
+        auto const& long_value = row.at(locator.index);
+        auto const& lat_value = row.at(locator.index2);
         if (!mapnik::util::string2double(long_value,x))
         {
             throw mapnik::datasource_exception("Failed to parse Longitude: '" + long_value + "'");
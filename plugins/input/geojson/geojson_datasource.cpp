@@ -26,6 +26,8 @@
 #include "geojson_memory_index_featureset.hpp"
 #include <fstream>
 #include <algorithm>
+#include <set>
+#include <string>
 
 #pragma GCC diagnostic push
 #include <mapnik/warning_ignore.hpp>
@@ -53,7 +55,7 @@
 #include <mapnik/util/spatial_index.hpp>
 #include <mapnik/geom_util.hpp>
 #include <mapnik/json/parse_feature.hpp>
-#include <mapnik/json/extract_bounding_boxes_x3.hpp>
+#include <mapnik/json/feature_builder.hpp>
 
 #if defined(MAPNIK_MEMORY_MAPPED_FILE)
 #pragma GCC diagnostic push
@@ -160,7 +162,7 @@ geojson_datasource::geojson_datasource(parameters const& params)
         char const* end = (count == 1) ? start + file_buffer.length() : start;
 #else
         boost::optional<mapnik::mapped_region_ptr> mapped_region =
-            mapnik::mapped_memory_cache::instance().find(filename_, false);
+            mapnik::mapped_memory_cache::instance().find(filename_, false, mapnik::mapped_access::sequential);
         if (!mapped_region)
         {
             throw std::runtime_error("could not get file mapping for "+ filename_);
@@ -187,6 +189,19 @@ using boxes_type = std::vector<std::pair<box_type, std::pair<std::uint64_t, std:
 using base_iterator_type = char const*;
 const mapnik::transcoder geojson_datasource_static_tr("utf8");
 
+// properties the featuresets reading from the file decode, empty for all:
+// the descriptor only lists the properties of the features sampled, so a
+// query naming all of them (e.g. feature info) gets every property
+std::set<std::string> requested_properties(mapnik::layer_descriptor const& desc, mapnik::query const& q)
+{
+    std::set<std::string> const& names = q.property_names();
+    for (auto const& attr_info : desc.get_descriptors())
+    {
+        if (names.find(attr_info.get_name()) == names.end()) return names;
+    }
+    return std::set<std::string>();
+}
+
 }
 
 void geojson_datasource::initialise_descriptor(mapnik::feature_ptr const& feature)
@@ -273,7 +288,7 @@ void geojson_datasource::initialise_index(Iterator start, Iterator end)
     Iterator itr = start;
     try
     {
-        mapnik::json::extract_bounding_boxes(itr, end, boxes);
+        mapnik::json::scan_bounding_boxes(itr, end, boxes);
         if (itr != end || boxes.empty()) throw std::exception();
         // bulk insert initialise r-tree
         tree_ = std::make_unique<spatial_index_type>(boxes);
@@ -365,7 +380,7 @@ void geojson_datasource::parse_geojson(Iterator start, Iterator end)
     try
     {
         boxes_type boxes;
-        mapnik::json::extract_bounding_boxes(itr, end, boxes);
+        mapnik::json::scan_bounding_boxes(itr, end, boxes);
         if (itr != end || boxes.empty()) throw std::exception(); //ensure we've consumed all input and we extracted at least one bbox;
         for (auto const& item : boxes)
         {
@@ -586,14 +601,15 @@ mapnik::featureset_ptr geojson_datasource::features(mapnik::query const& q) cons
             }
             else
             {
-                return std::make_shared<geojson_memory_index_featureset>(filename_, std::move(index_array));
+                return std::make_shared<geojson_memory_index_featureset>(filename_, std::move(index_array),
+                                                                         requested_properties(desc_, q));
             }
         }
         else if (has_disk_index_)
         {
             auto const& bbox = q.get_bbox();
             mapnik::bounding_box_filter<float> const filter(mapnik::box2d<float>(bbox.minx(), bbox.miny(), bbox.maxx(), bbox.maxy()));
-            return std::make_shared<geojson_index_featureset>(filename_, filter);
+            return std::make_shared<geojson_index_featureset>(filename_, filter, requested_properties(desc_, q));
         }
     }
     // otherwise return an empty featureset
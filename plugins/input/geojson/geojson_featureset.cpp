@@ -51,3 +51,13 @@ mapnik::feature_ptr geojson_featureset::next()
     }
     return mapnik::feature_ptr();
 }
+
+std::size_t geojson_featureset::next_batch(mapnik::feature_ptr * features, std::size_t size)
+{
+    std::size_t count = 0;
+    while (count < size && (features[count] = geojson_featureset::next()))
+    {
+        ++count;
+    }
+    return count;
+}
@@ -27,15 +27,16 @@
 #include <mapnik/util/utf_conv_win.hpp>
 #include <mapnik/util/conversions.hpp>
 #include <mapnik/geometry/is_empty.hpp>
-#include <mapnik/json/parse_feature.hpp>
-#include <mapnik/json/json_grammar_config.hpp>
+#include <mapnik/json/feature_builder.hpp>
 // stl
 #include <string>
 #include <vector>
 #include <fstream>
 #include <algorithm>
 
-geojson_index_featureset::geojson_index_featureset(std::string const& filename, mapnik::bounding_box_filter<float> const& filter)
+geojson_index_featureset::geojson_index_featureset(std::string const& filename,
+                                                   mapnik::bounding_box_filter<float> const& filter,
+                                                   std::set<std::string> const& names)
     :
 #if defined(MAPNIK_MEMORY_MAPPED_FILE)
     //
@@ -44,12 +45,13 @@ geojson_index_featureset::geojson_index_featureset(std::string const& filename,
 #else
     file_(std::fopen(filename.c_str(),"rb"), std::fclose),
 #endif
-    ctx_(std::make_shared<mapnik::context_type>())
+    ctx_(std::make_shared<mapnik::context_type>()),
+    names_(names)
 {
 
 #if defined (MAPNIK_MEMORY_MAPPED_FILE)
     boost::optional<mapnik::mapped_region_ptr> memory =
-        mapnik::mapped_memory_cache::instance().find(filename, true);
+        mapnik::mapped_memory_cache::instance().find(filename, true, mapnik::mapped_access::random);
     if (memory)
     {
         mapped_region_ = *memory;
@@ -100,11 +102,21 @@ mapnik::feature_ptr geojson_index_featureset::next()
 #endif
         static const mapnik::transcoder tr("utf8");
         mapnik::feature_ptr feature(mapnik::feature_factory::create(ctx_, feature_id_++));
-        using mapnik::json::grammar::iterator_type;
-        mapnik::json::parse_feature(start, end, *feature, tr); // throw on failure
+        // only decode the properties the query asks for
+        mapnik::json::build_feature(start, end, *feature, tr, names_.empty() ? nullptr : &names_); // throw on failure
         // skip empty geometries
         if (mapnik::geometry::is_empty(feature->get_geometry())) continue;
         return feature;
     }
     return mapnik::feature_ptr();
 }
+
+std::size_t geojson_index_featureset::next_batch(mapnik::feature_ptr * features, std::size_t size)
+{
+    std::size_t count = 0;
+    while (count < size && (features[count] = geojson_index_featureset::next()))
+    {
+        ++count;
+    }
+    return count;
+}
@@ -39,14 +39,19 @@
 
 #include <deque>
 #include <cstdio>
+#include <set>
+#include <string>
 
 class geojson_index_featureset : public mapnik::Featureset
 {
     using value_type = mapnik::util::index_record;
 public:
-    geojson_index_featureset(std::string const& filename, mapnik::bounding_box_filter<float> const& filter);
+    geojson_index_featureset(std::string const& filename,
+                             mapnik::bounding_box_filter<float> const& filter,
+                             std::set<std::string> const& names);
     virtual ~geojson_index_featureset();
     mapnik::feature_ptr next();
+    std::size_t next_batch(mapnik::feature_ptr * features, std::size_t size);
 
 private:
 #if defined (MAPNIK_MEMORY_MAPPED_FILE)
@@ -60,6 +65,7 @@ private:
     mapnik::context_ptr ctx_;
     std::vector<value_type> positions_;
     std::vector<value_type>::iterator itr_;
+    std::set<std::string> const names_;
 };
 
 #endif // GEOJSON_INDEX_FEATURESE_HPP
@@ -27,14 +27,15 @@
 #include <mapnik/feature_factory.hpp>
 #include <mapnik/util/utf_conv_win.hpp>
 #include <mapnik/geometry/is_empty.hpp>
-#include <mapnik/json/parse_feature.hpp>
+#include <mapnik/json/feature_builder.hpp>
 
 // stl
 #include <string>
 #include <vector>
 
 geojson_memory_index_featureset::geojson_memory_index_featureset(std::string const& filename,
-                                                   array_type && index_array)
+                                                   array_type && index_array,
+                                                   std::set<std::string> const& names)
 :
 #ifdef _WINDOWS
     file_(_wfopen(mapnik::utf8_to_utf16(filename).c_str(), L"rb"), std::fclose),
@@ -44,7 +45,8 @@ geojson_memory_index_featureset::geojson_memory_index_featureset(std::string con
     index_array_(std::move(index_array)),
     index_itr_(index_array_.begin()),
     index_end_(index_array_.end()),
-    ctx_(std::make_shared<mapnik::context_type>())
+    ctx_(std::make_shared<mapnik::context_type>()),
+    names_(names)
 {
     if (!file_) throw std::runtime_error("Can't open " + filename);
 }
@@ -67,7 +69,8 @@ mapnik::feature_ptr geojson_memory_index_featureset::next()
         chr_iterator_type end = (count == 1) ? start + json.size() : start;
         static const mapnik::transcoder tr("utf8");
         mapnik::feature_ptr feature(mapnik::feature_factory::create(ctx_, feature_id_++));
-        mapnik::json::parse_feature(start, end, *feature, tr); // throw on failure
+        // only decode the properties the query asks for
+        mapnik::json::build_feature(start, end, *feature, tr, names_.empty() ? nullptr : &names_); // throw on failure
         // skip empty geometries
         if (mapnik::geometry::is_empty(feature->get_geometry()))
             continue;
@@ -75,3 +78,13 @@ mapnik::feature_ptr geojson_memory_index_featureset::next()
     }
     return mapnik::feature_ptr();
 }
+
+std::size_t geojson_memory_index_featureset::next_batch(mapnik::feature_ptr * features, std::size_t size)
+{
+    std::size_t count = 0;
+    while (count < size && (features[count] = geojson_memory_index_featureset::next()))
+    {
+        ++count;
+    }
+    return count;
+}
@@ -28,6 +28,8 @@
 
 #include <deque>
 #include <cstdio>
+#include <set>
+#include <string>
 
 class geojson_memory_index_featureset : public mapnik::Featureset
 {
@@ -36,9 +38,11 @@ public:
     using file_ptr = std::unique_ptr<std::FILE, int (*)(std::FILE *)>;
 
     geojson_memory_index_featureset(std::string const& filename,
-                             array_type && index_array);
+                             array_type && index_array,
+                             std::set<std::string> const& names);
     virtual ~geojson_memory_index_featureset();
     mapnik::feature_ptr next();
+    std::size_t next_batch(mapnik::feature_ptr * features, std::size_t size);
 
 private:
     file_ptr file_;
@@ -47,6 +51,7 @@ private:
     array_type::const_iterator index_itr_;
     array_type::const_iterator index_end_;
     mapnik::context_ptr ctx_;
+    std::set<std::string> const names_;
 };
 
 #endif // GEOJSON_MEMORY_INDEX_FEATURESET_HPP
@@ -232,6 +232,16 @@ feature_ptr postgis_featureset::next()
     return feature_ptr();
 }
 
+std::size_t postgis_featureset::next_batch(feature_ptr * features, std::size_t size)
+{
+    std::size_t count = 0;
+    while (count < size && (features[count] = postgis_featureset::next()))
+    {
+        ++count;
+    }
+    return count;
+}
+
 
 postgis_featureset::~postgis_featureset()
 {
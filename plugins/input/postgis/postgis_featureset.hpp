@@ -47,6 +47,7 @@ public:
                        bool key_field_as_attribute,
                        bool twkb_encoding);
     feature_ptr next();
+    std::size_t next_batch(feature_ptr * features, std::size_t size);
     ~postgis_featureset();
 
 private:
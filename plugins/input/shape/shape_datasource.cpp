@@ -64,6 +64,7 @@ shape_datasource::shape_datasource(parameters const& params)
       file_length_(0),
       indexed_(false),
       row_limit_(*params.get<mapnik::value_integer>("row_limit",0)),
+      use_arena_(*params.get<mapnik::boolean_type>("use_arena",false)),
       desc_(shape_datasource::name(), *params.get<std::string>("encoding","utf-8"))
 {
 #ifdef MAPNIK_STATS
@@ -230,6 +231,15 @@ layer_descriptor shape_datasource::get_descriptor() const
     return desc_;
 }
 
+mapnik::util::arena_ptr shape_datasource::make_arena(query const* q) const
+{
+    // an arena supplied with the query (e.g. one per render) takes precedence,
+    // otherwise each featureset gets its own when `use_arena` is enabled
+    if (q && q->get_arena()) return q->get_arena();
+    if (use_arena_) return std::make_shared<mapnik::util::monotonic_arena>();
+    return mapnik::util::arena_ptr();
+}
+
 featureset_ptr shape_datasource::features(query const& q) const
 {
 #ifdef MAPNIK_STATS
@@ -248,7 +258,8 @@ featureset_ptr shape_datasource::features(query const& q) const
                                                                             q.property_names(),
                                                                             desc_.get_encoding(),
                                                                             shape_name_,
-                                                                            row_limit_));
+                                                                            row_limit_,
+                                                                            make_arena(&q)));
     }
     else
     {
@@ -257,7 +268,8 @@ featureset_ptr shape_datasource::features(query const& q) const
                                                                   shape_name_,
                                                                   q.property_names(),
                                                                   desc_.get_encoding(),
-                                                                  row_limit_);
+                                                                  row_limit_,
+                                                                  make_arena(&q));
     }
 }
 
@@ -287,7 +299,8 @@ featureset_ptr shape_datasource::features_at_point(coord2d const& pt, double tol
                                                                         names,
                                                                         desc_.get_encoding(),
                                                                         shape_name_,
-                                                                        row_limit_));
+                                                                        row_limit_,
+                                                                        make_arena(nullptr)));
     }
     else
     {
@@ -296,7 +309,8 @@ featureset_ptr shape_datasource::features_at_point(coord2d const& pt, double tol
                                                                     shape_name_,
                                                                     names,
                                                                     desc_.get_encoding(),
-                                                                    row_limit_);
+                                                                    row_limit_,
+                                                                    make_arena(nullptr));
     }
 }
 
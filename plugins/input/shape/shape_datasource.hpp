@@ -32,6 +32,7 @@
 #include <mapnik/coord.hpp>
 #include <mapnik/feature_layer_desc.hpp>
 #include <mapnik/value/types.hpp>
+#include <mapnik/util/arena.hpp>
 
 // boost
 #include <boost/optional.hpp>
@@ -64,6 +65,7 @@ public:
     layer_descriptor get_descriptor() const;
 private:
     void init(shape_io& shape);
+    mapnik::util::arena_ptr make_arena(query const* q) const;
 
     datasource::datasource_t type_;
     std::string shape_name_;
@@ -72,6 +74,7 @@ private:
     box2d<double> extent_;
     bool indexed_;
     const int row_limit_;
+    const bool use_arena_;
     layer_descriptor desc_;
 };
 
@@ -29,6 +29,7 @@
 #include <mapnik/feature.hpp>
 #include <mapnik/unicode.hpp>
 #include <mapnik/value/types.hpp>
+#include <mapnik/util/arena.hpp>
 
 #include "shape_io.hpp"
 
@@ -50,9 +51,11 @@ public:
                      std::string const& shape_file,
                      std::set<std::string> const& attribute_names,
                      std::string const& encoding,
-                     int row_limit);
+                     int row_limit,
+                     mapnik::util::arena_ptr const& arena = mapnik::util::arena_ptr());
     virtual ~shape_featureset();
     feature_ptr next();
+    std::size_t next_batch(feature_ptr * features, std::size_t size);
 
 private:
     filterT filter_;
@@ -65,6 +68,7 @@ private:
     mapnik::value_integer row_limit_;
     mutable int count_;
     context_ptr ctx_;
+    mapnik::util::arena_ptr arena_;
 };
 
 #endif //SHAPE_FEATURESET_HPP
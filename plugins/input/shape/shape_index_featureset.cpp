@@ -47,7 +47,8 @@ shape_index_featureset<filterT>::shape_index_featureset(filterT const& filter,
                                                         std::set<std::string> const& attribute_names,
                                                         std::string const& encoding,
                                                         std::string const& shape_name,
-                                                        int row_limit)
+                                                        int row_limit,
+                                                        mapnik::util::arena_ptr const& arena)
     : filter_(filter),
       ctx_(std::make_shared<mapnik::context_type>()),
       shape_ptr_(std::move(shape_ptr)),
@@ -57,7 +58,8 @@ shape_index_featureset<filterT>::shape_index_featureset(filterT const& filter,
       attr_ids_(),
       row_limit_(row_limit),
       count_(0),
-      feature_bbox_()
+      feature_bbox_(),
+      arena_(arena)
 {
     shape_ptr_->shp().skip(100);
     setup_attributes(ctx_, attribute_names, shape_name, *shape_ptr_, attr_ids_);
@@ -111,7 +113,7 @@ feature_ptr shape_index_featureset<filterT>::next()
         shape_file::record_type record(shape_ptr_->reclength_ * 2);
         shape_ptr_->shp().read_record(record);
         int type = record.read_ndr_integer();
-        feature_ptr feature(feature_factory::create(ctx_, feature_id));
+        feature_ptr feature(feature_factory::create(ctx_, feature_id, arena_));
 
         switch (type)
         {
@@ -190,6 +192,34 @@ feature_ptr shape_index_featureset<filterT>::next()
 }
 
 
+template <typename filterT>
+std::size_t shape_index_featureset<filterT>::next_batch(feature_ptr * features, std::size_t size)
+{
+    // positions are sorted by offset: ask the kernel to page in the records
+    // of the whole batch up front instead of faulting them in one by one
+    std::size_t records = 0;
+    std::uint64_t last = 0;
+    for (auto itr = itr_; itr != positions_.end() && records < size; ++itr)
+    {
+        if (records == 0 || itr->offset != last)
+        {
+            last = itr->offset;
+            ++records;
+        }
+    }
+    if (records > 0)
+    {
+        shape_ptr_->shp().will_need(itr_->offset, last);
+    }
+
+    std::size_t count = 0;
+    while (count < size && (features[count] = shape_index_featureset<filterT>::next()))
+    {
+        ++count;
+    }
+    return count;
+}
+
 template <typename filterT>
 shape_index_featureset<filterT>::~shape_index_featureset() {}
 
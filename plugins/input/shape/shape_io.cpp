@@ -38,7 +38,7 @@ const std::string shape_io::INDEX = ".index";
 shape_io::shape_io(std::string const& shape_name, bool open_index)
     : type_(shape_null),
       shp_(shape_name + SHP),
-      shx_(shape_name + SHX),
+      shx_(shape_name + SHX, mapnik::mapped_access::random),
       dbf_(shape_name + DBF),
       reclength_(0),
       id_(0)
@@ -53,7 +53,7 @@ shape_io::shape_io(std::string const& shape_name, bool open_index)
     {
         try
         {
-            index_ = std::make_unique<shape_file>(shape_name + INDEX);
+            index_ = std::make_unique<shape_file>(shape_name + INDEX, mapnik::mapped_access::will_need);
         }
         catch (...)
         {
@@ -24,6 +24,7 @@
 #define SHAPEFILE_HPP
 
 // stl
+#include <algorithm>
 #include <cstring>
 #include <fstream>
 #include <stdexcept>
@@ -33,6 +34,7 @@
 #include <mapnik/global.hpp>
 #include <mapnik/util/utf_conv_win.hpp>
 #include <mapnik/geometry/box2d.hpp>
+#include <mapnik/mapped_memory_cache.hpp>
 
 #if defined(MAPNIK_MEMORY_MAPPED_FILE)
 #pragma GCC diagnostic push
@@ -40,7 +42,9 @@
 #include <boost/interprocess/mapped_region.hpp>
 #include <boost/interprocess/streams/bufferstream.hpp>
 #pragma GCC diagnostic pop
-#include <mapnik/mapped_memory_cache.hpp>
+#if !defined(_WINDOWS)
+#include <sys/mman.h>
+#endif
 #endif
 #include <mapnik/util/noncopyable.hpp>
 
@@ -159,7 +163,8 @@ public:
 
     shape_file() {}
 
-    shape_file(std::string  const& file_name) :
+    shape_file(std::string  const& file_name,
+               mapnik::mapped_access access = mapnik::mapped_access::normal) :
 #if defined(MAPNIK_MEMORY_MAPPED_FILE)
         file_()
 #elif defined (_WINDOWS)
@@ -170,7 +175,7 @@ public:
     {
 #if defined(MAPNIK_MEMORY_MAPPED_FILE)
         boost::optional<mapnik::mapped_region_ptr> memory =
-            mapnik::mapped_memory_cache::instance().find(file_name,true);
+            mapnik::mapped_memory_cache::instance().find(file_name, true, access);
 
         if (memory)
         {
@@ -181,6 +186,8 @@ public:
         {
             throw std::runtime_error("could not create file mapping for "+file_name);
         }
+#else
+        (void)access;
 #endif
     }
 
@@ -210,6 +217,23 @@ public:
 #endif
     }
 
+    // hint that the records between the two file offsets are about to be read
+    inline void will_need(std::uint64_t begin, std::uint64_t end)
+    {
+#if defined(MAPNIK_MEMORY_MAPPED_FILE) && !defined(_WINDOWS)
+        std::uint64_t size = mapped_region_->get_size();
+        if (begin >= size || end <= begin) return;
+        std::uint64_t page = static_cast<std::uint64_t>(boost::interprocess::mapped_region::get_page_size());
+        char * base = static_cast<char*>(mapped_region_->get_address());
+        std::uint64_t first = begin - (begin % page);
+        std::uint64_t last = std::min(end + page, size);
+        ::posix_madvise(base + first, last - first, POSIX_MADV_WILLNEED);
+#else
+        (void)begin;
+        (void)end;
+#endif
+    }
+
     inline int read_xdr_integer()
     {
         char b[4];
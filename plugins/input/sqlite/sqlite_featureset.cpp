@@ -159,3 +159,13 @@ feature_ptr sqlite_featureset::next()
 
     return feature_ptr();
 }
+
+std::size_t sqlite_featureset::next_batch(feature_ptr * features, std::size_t size)
+{
+    std::size_t count = 0;
+    while (count < size && (features[count] = sqlite_featureset::next()))
+    {
+        ++count;
+    }
+    return count;
+}
@@ -49,6 +49,7 @@ public:
                       bool using_subquery);
     virtual ~sqlite_featureset();
     mapnik::feature_ptr next();
+    std::size_t next_batch(mapnik::feature_ptr * features, std::size_t size);
 
 private:
     std::shared_ptr<sqlite_resultset> rs_;
@@ -43,6 +43,7 @@
 #include <mapnik/image_filter.hpp>
 #include <mapnik/image_any.hpp>
 #include <mapnik/make_unique.hpp>
+#include <mapnik/renderer_common/process_building_symbolizer.hpp>
 
 #pragma GCC diagnostic push
 #include <mapnik/warning_ignore_agg.hpp>
@@ -203,6 +204,7 @@ void agg_renderer<T0,T1>::start_map_processing(Map const& map)
 template <typename T0, typename T1>
 void agg_renderer<T0,T1>::end_map_processing(Map const& map)
 {
+    flush_batches();
     mapnik::demultiply_alpha(buffers_.top().get());
     MAPNIK_LOG_DEBUG(agg_renderer) << "agg_renderer: End map processing";
 }
@@ -210,6 +212,7 @@ void agg_renderer<T0,T1>::end_map_processing(Map const& map)
 template <typename T0, typename T1>
 void agg_renderer<T0,T1>::start_layer_processing(layer const& lay, box2d<double> const& query_extent)
 {
+    flush_batches();
     MAPNIK_LOG_DEBUG(agg_renderer) << "agg_renderer: Start processing layer=" << lay.name();
     MAPNIK_LOG_DEBUG(agg_renderer) << "agg_renderer: -- datasource=" << lay.datasource().get();
     MAPNIK_LOG_DEBUG(agg_renderer) << "agg_renderer: -- query_extent=" << query_extent;
@@ -220,6 +223,12 @@ void agg_renderer<T0,T1>::start_layer_processing(layer const& lay, box2d<double>
     }
 
     common_.query_extent_ = query_extent;
+    common_.label_anchors_.layer = lay.name();
+    common_.minimum_feature_size_ = lay.minimum_feature_size();
+    common_.minimum_feature_dot_ = lay.minimum_feature_dot();
+    common_.vertex_decimation_ = lay.vertex_decimation();
+    common_.polygon_batching_ = lay.polygon_batching();
+    common_.building_batching_ = lay.building_batching();
     boost::optional<box2d<double> > const& maximum_extent = lay.maximum_extent();
     if (maximum_extent)
     {
@@ -240,6 +249,7 @@ void agg_renderer<T0,T1>::start_layer_processing(layer const& lay, box2d<double>
 template <typename T0, typename T1>
 void agg_renderer<T0,T1>::end_layer_processing(layer const& lyr)
 {
+    flush_batches();
     MAPNIK_LOG_DEBUG(agg_renderer) << "agg_renderer: End layer processing";
 
     buffer_type & current_buffer = buffers_.top().get();
@@ -258,6 +268,7 @@ void agg_renderer<T0,T1>::end_layer_processing(layer const& lyr)
 template <typename T0, typename T1>
 void agg_renderer<T0,T1>::start_style_processing(feature_type_style const& st)
 {
+    flush_batches();
     MAPNIK_LOG_DEBUG(agg_renderer) << "agg_renderer: Start processing style";
 
     if (st.comp_op() || st.image_filters().size() > 0 || st.get_opacity() < 1)
@@ -310,6 +321,7 @@ void agg_renderer<T0,T1>::start_style_processing(feature_type_style const& st)
 template <typename T0, typename T1>
 void agg_renderer<T0,T1>::end_style_processing(feature_type_style const& st)
 {
+    flush_batches();
     buffer_type & current_buffer = buffers_.top().get();
     buffers_.pop();
     buffer_type & previous_buffer = buffers_.top().get();
@@ -547,6 +559,7 @@ void agg_renderer<T0,T1>::render_marker(pixel_position const& pos,
                                     double opacity,
                                     composite_mode_e comp_op)
 {
+    flush_batches();
     agg_render_marker_visitor<buffer_type> visitor(common_,
                                                    buffers_.top().get(),
                                                    ras_ptr,
@@ -559,6 +572,13 @@ void agg_renderer<T0,T1>::render_marker(pixel_position const& pos,
     util::apply_visitor(visitor, marker);
 }
 
+template <typename T0, typename T1>
+void agg_renderer<T0,T1>::flush_batches()
+{
+    flush_polygon_batch();
+    flush_building_batch();
+}
+
 template <typename T0, typename T1>
 bool agg_renderer<T0,T1>::painted()
 {
@@ -575,6 +595,7 @@ template <typename T0, typename T1>
 void agg_renderer<T0,T1>::debug_draw_box(box2d<double> const& box,
                                      double x, double y, double angle)
 {
+    flush_batches();
     buffer_type & current_buffer = buffers_.top().get();
     agg::rendering_buffer buf(current_buffer.bytes(),
                               current_buffer.width(),
@@ -624,6 +645,7 @@ void agg_renderer<T0,T1>::debug_draw_box(R& buf, box2d<double> const& box,
 template <typename T0, typename T1>
 void agg_renderer<T0,T1>::draw_geo_extent(box2d<double> const& extent, mapnik::color const& color)
 {
+    flush_batches();
     box2d<double> box = common_.t_.forward(extent);
     double x0 = box.minx();
     double x1 = box.maxx();
@@ -56,65 +56,150 @@ void agg_renderer<T0,T1>::process(building_symbolizer const& sym,
                                   mapnik::feature_impl & feature,
                                   proj_transform const& prj_trans)
 {
+    flush_polygon_batch();
+
+    value_double opacity = get<value_double,keys::fill_opacity>(sym,feature, common_.vars_);
+    color const& fill = get<color, keys::fill>(sym, feature, common_.vars_);
+    double gamma = get<value_double, keys::gamma>(sym, feature, common_.vars_);
+    gamma_method_enum gamma_method = get<gamma_method_enum, keys::gamma_method>(sym, feature, common_.vars_);
+    double height = get<double, keys::height>(sym, feature, common_.vars_) * common_.scale_factor_;
+    buffer_type & current_buffer = buffers_.top().get();
+
+    if (!common_.building_batching_)
+    {
+        // drawn right away, one pass per wall, in datasource order
+        using ren_base = agg::renderer_base<agg::pixfmt_rgba32_pre>;
+        using renderer = agg::renderer_scanline_aa_solid<ren_base>;
+
+        agg::rendering_buffer buf(current_buffer.bytes(), current_buffer.width(), current_buffer.height(), current_buffer.row_size());
+        agg::pixfmt_rgba32_pre pixf(buf);
+        ren_base renb(pixf);
+        unsigned r = fill.red();
+        unsigned g = fill.green();
+        unsigned b = fill.blue();
+        unsigned a = fill.alpha();
+        renderer ren(renb);
+        agg::scanline_u8 sl;
+
+        ras_ptr->reset();
+        if (gamma != gamma_ || gamma_method != gamma_method_)
+        {
+            set_gamma_method(ras_ptr, gamma, gamma_method);
+            gamma_method_ = gamma_method;
+            gamma_ = gamma;
+        }
+
+        render_building_symbolizer::apply(
+            feature, prj_trans, common_.t_, height,
+            [&,r,g,b,a,opacity](path_type const& faces)
+            {
+                vertex_adapter va(faces);
+                ras_ptr->add_path(va);
+                ren.color(agg::rgba8_pre(int(r*0.8), int(g*0.8), int(b*0.8), int(a * opacity)));
+                agg::render_scanlines(*ras_ptr, sl, ren);
+                this->ras_ptr->reset();
+            },
+            [&,r,g,b,a,opacity](path_type const& frame)
+            {
+                vertex_adapter va(frame);
+                agg::conv_stroke<vertex_adapter> stroke(va);
+                stroke.width(common_.scale_factor_);
+                stroke.miter_limit(common_.scale_factor_ / 2.0);
+                ras_ptr->add_path(stroke);
+                ren.color(agg::rgba8_pre(int(r*0.8), int(g*0.8), int(b*0.8), int(a * opacity)));
+                agg::render_scanlines(*ras_ptr, sl, ren);
+                ras_ptr->reset();
+            },
+            [&,r,g,b,a,opacity](render_building_symbolizer::roof_type & roof)
+            {
+                ras_ptr->add_path(roof);
+                ren.color(agg::rgba8_pre(r, g, b, int(a * opacity)));
+                agg::render_scanlines(*ras_ptr, sl, ren);
+            });
+        return;
+    }
+
+    if (!building_batch_.geometry)
+    {
+        building_batch_.geometry = std::make_unique<building_geometry>();
+    }
+    else if (!building_batch_.geometry->empty() &&
+             (building_batch_.gamma != gamma ||
+              building_batch_.gamma_method != gamma_method ||
+              building_batch_.buffer != &current_buffer))
+    {
+        flush_building_batch();
+    }
+    building_batch_.gamma = gamma;
+    building_batch_.gamma_method = gamma_method;
+    building_batch_.buffer = &current_buffer;
+
+    // faces are only extruded here, drawing happens in flush_building_batch()
+    render_building_symbolizer::apply(
+        feature, prj_trans, common_.t_, height, fill.rgba(), opacity, *building_batch_.geometry);
+}
+
+template <typename T0,typename T1>
+void agg_renderer<T0,T1>::flush_building_batch()
+{
+    if (!building_batch_.geometry || building_batch_.geometry->empty()) return;
+    building_geometry & buildings = *building_batch_.geometry;
+
     using ren_base = agg::renderer_base<agg::pixfmt_rgba32_pre>;
     using renderer = agg::renderer_scanline_aa_solid<ren_base>;
 
-    buffer_type & current_buffer = buffers_.top().get();
+    buffer_type & current_buffer = *building_batch_.buffer;
     agg::rendering_buffer buf(current_buffer.bytes(), current_buffer.width(), current_buffer.height(), current_buffer.row_size());
     agg::pixfmt_rgba32_pre pixf(buf);
     ren_base renb(pixf);
-
-    value_double opacity = get<value_double,keys::fill_opacity>(sym,feature, common_.vars_);
-    color const& fill = get<color, keys::fill>(sym, feature, common_.vars_);
-    unsigned r=fill.red();
-    unsigned g=fill.green();
-    unsigned b=fill.blue();
-    unsigned a=fill.alpha();
     renderer ren(renb);
     agg::scanline_u8 sl;
 
-    ras_ptr->reset();
-    double gamma = get<value_double, keys::gamma>(sym, feature, common_.vars_);
-    gamma_method_enum gamma_method = get<gamma_method_enum, keys::gamma_method>(sym, feature, common_.vars_);
-    if (gamma != gamma_ || gamma_method != gamma_method_)
+    if (building_batch_.gamma != gamma_ || building_batch_.gamma_method != gamma_method_)
     {
-        set_gamma_method(ras_ptr, gamma, gamma_method);
-        gamma_method_ = gamma_method;
-        gamma_ = gamma;
+        set_gamma_method(ras_ptr, building_batch_.gamma, building_batch_.gamma_method);
+        gamma_method_ = building_batch_.gamma_method;
+        gamma_ = building_batch_.gamma;
     }
 
-    double height = get<double, keys::height>(sym, feature, common_.vars_) * common_.scale_factor_;
+    // three passes per building, walls and outlines all at once
+    buildings.sort_back_to_front();
+    for (auto const& building : buildings.buildings())
+    {
+        color fill(building.fill);
+        unsigned r = fill.red();
+        unsigned g = fill.green();
+        unsigned b = fill.blue();
+        unsigned a = fill.alpha();
+        double opacity = building.opacity;
 
-    render_building_symbolizer::apply(
-        feature, prj_trans, common_.t_, height,
-        [&,r,g,b,a,opacity](path_type const& faces)
-        {
-            vertex_adapter va(faces);
-            ras_ptr->add_path(va);
-            ren.color(agg::rgba8_pre(int(r*0.8), int(g*0.8), int(b*0.8), int(a * opacity)));
-            agg::render_scanlines(*ras_ptr, sl, ren);
-            this->ras_ptr->reset();
-        },
-        [&,r,g,b,a,opacity](path_type const& frame)
-        {
-            vertex_adapter va(frame);
-            agg::conv_stroke<vertex_adapter> stroke(va);
-            stroke.width(common_.scale_factor_);
-            stroke.miter_limit(common_.scale_factor_ / 2.0);
-            ras_ptr->add_path(stroke);
-            ren.color(agg::rgba8_pre(int(r*0.8), int(g*0.8), int(b*0.8), int(a * opacity)));
-            agg::render_scanlines(*ras_ptr, sl, ren);
-            ras_ptr->reset();
-        },
-        [&,r,g,b,a,opacity](render_building_symbolizer::roof_type & roof)
-        {
-            ras_ptr->add_path(roof);
-            ren.color(agg::rgba8_pre(r, g, b, int(a * opacity)));
-            agg::render_scanlines(*ras_ptr, sl, ren);
-        });
+        ras_ptr->reset();
+        ras_ptr->filling_rule(agg::fill_non_zero);
+        auto walls = buildings.walls(building);
+        ras_ptr->add_path(walls);
+        ren.color(agg::rgba8_pre(int(r*0.8), int(g*0.8), int(b*0.8), int(a * opacity)));
+        agg::render_scanlines(*ras_ptr, sl, ren);
+
+        ras_ptr->reset();
+        auto frame = buildings.frame(building);
+        agg::conv_stroke<building_geometry::path> stroke(frame);
+        stroke.width(common_.scale_factor_);
+        stroke.miter_limit(common_.scale_factor_ / 2.0);
+        ras_ptr->add_path(stroke);
+        agg::render_scanlines(*ras_ptr, sl, ren);
+
+        ras_ptr->reset();
+        ras_ptr->filling_rule(agg::fill_even_odd);
+        auto roof = buildings.roof(building);
+        ras_ptr->add_path(roof);
+        ren.color(agg::rgba8_pre(r, g, b, int(a * opacity)));
+        agg::render_scanlines(*ras_ptr, sl, ren);
+    }
+    buildings.clear();
 }
 
 template void agg_renderer<image_rgba8>::process(building_symbolizer const&,
                                               mapnik::feature_impl &,
                                               proj_transform const&);
+template void agg_renderer<image_rgba8>::flush_building_batch();
 }
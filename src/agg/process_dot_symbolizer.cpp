@@ -91,6 +91,7 @@ void agg_renderer<T0,T1>::process(dot_symbolizer const& sym,
                                   mapnik::feature_impl & feature,
                                   proj_transform const& prj_trans)
 {
+    flush_batches();
     double width = 0.0;
     double height = 0.0;
     bool has_width = has_key(sym,keys::width);
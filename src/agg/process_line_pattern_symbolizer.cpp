@@ -160,8 +160,6 @@ struct repeat_pattern : repeat_pattern_base
             converter_.set<dash_tag>();
         }
 
-        if (clip_) converter_.template set<clip_line_tag>();
-
         value_double offset = get<value_double, keys::offset>(sym_, feature_, common_.vars_);
         if (std::fabs(offset) > 0.0) converter_.template set<offset_transform_tag>();
 
@@ -241,7 +239,12 @@ private:
         pixf.comp_op(static_cast<agg::comp_op_e>(get<composite_mode_e, keys::comp_op>(sym_, feature_, common_.vars_)));
         typename Pattern::renderer_base ren_base(pixf);
 
-        if (pattern.clip_) pattern.converter_.template set<clip_line_tag>();
+        if (pattern.clip_)
+        {
+            clip_test clip_result = test_clip_envelope(pattern.clip_box_, feature_.envelope());
+            if (clip_result == clip_test::outside) return;
+            if (clip_result == clip_test::intersects) pattern.converter_.template set<clip_line_tag>();
+        }
         pattern.render(ren_base, ras_);
     }
 
@@ -258,6 +261,7 @@ void  agg_renderer<T0,T1>::process(line_pattern_symbolizer const& sym,
                                mapnik::feature_impl & feature,
                                proj_transform const& prj_trans)
 {
+    flush_batches();
     std::string filename = get<std::string, keys::file>(sym, feature, common_.vars_);
     if (filename.empty()) return;
     ras_ptr->reset();
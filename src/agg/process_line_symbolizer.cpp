@@ -30,6 +30,7 @@
 #include <mapnik/vertex_converters.hpp>
 #include <mapnik/vertex_processor.hpp>
 #include <mapnik/renderer_common/clipping_extent.hpp>
+#include <mapnik/renderer_common/feature_size.hpp>
 #include <mapnik/renderer_common/apply_vertex_converter.hpp>
 #include <mapnik/geometry/geometry_type.hpp>
 
@@ -95,6 +96,16 @@ void agg_renderer<T0,T1>::process(line_symbolizer const& sym,
                               proj_transform const& prj_trans)
 
 {
+    flush_batches();
+    box2d<double> culled;
+    if (common_.minimum_feature_size_ > 0.0)
+    {
+        double stroke_extent = get<value_double, keys::stroke_width>(sym, feature, common_.vars_)
+            + 2.0 * std::fabs(get<value_double, keys::offset>(sym, feature, common_.vars_));
+        culled = culled_envelope(common_, sym, feature, prj_trans, stroke_extent * common_.scale_factor_);
+        if (culled.valid() && !common_.minimum_feature_dot_) return;
+    }
+
     color const& col = get<color, keys::stroke>(sym, feature, common_.vars_);
     unsigned r=col.red();
     unsigned g=col.green();
@@ -138,6 +149,20 @@ void agg_renderer<T0,T1>::process(line_symbolizer const& sym,
     value_double simplify_tolerance = get<value_double, keys::simplify_tolerance>(sym, feature, common_.vars_);
     value_double smooth = get<value_double, keys::smooth>(sym, feature, common_.vars_);
     line_rasterizer_enum rasterizer_e = get<line_rasterizer_enum, keys::line_rasterizer>(sym, feature, common_.vars_);
+
+    if (culled.valid())
+    {
+        using renderer_type = agg::renderer_scanline_aa_solid<renderer_base>;
+        add_culled_dot(*ras_ptr, culled, width * common_.scale_factor_);
+        renderer_type ren(renb);
+        ren.color(agg::rgba8_pre(r, g, b, int(a * opacity)));
+        agg::scanline_u8 sl;
+        ras_ptr->filling_rule(agg::fill_non_zero);
+        agg::render_scanlines(*ras_ptr, sl, ren);
+        return;
+    }
+
+    clip_test clip_result = clip_test::intersects;
     if (clip)
     {
         double pad_per_pixel = static_cast<double>(common_.query_extent_.width()/common_.width_);
@@ -146,6 +171,8 @@ void agg_renderer<T0,T1>::process(line_symbolizer const& sym,
         double padding = pad_per_pixel * pixels * common_.scale_factor_;
 
         clip_box.pad(padding);
+        clip_result = test_clip_envelope(clip_box, feature.envelope());
+        if (clip_result == clip_test::outside) return;
     }
 
     if (rasterizer_e == RASTERIZER_FAST)
@@ -159,11 +186,11 @@ void agg_renderer<T0,T1>::process(line_symbolizer const& sym,
         set_join_caps_aa(sym, ras, feature, common_.vars_);
 
         using vertex_converter_type = vertex_converter<clip_line_tag, clip_poly_tag, transform_tag,
-                                                       affine_transform_tag,
+                                                       affine_transform_tag, decimate_tag,
                                                        simplify_tag, smooth_tag,
                                                        offset_transform_tag>;
         vertex_converter_type converter(clip_box,sym,common_.t_,prj_trans,tr,feature,common_.vars_,common_.scale_factor_);
-        if (clip)
+        if (clip && clip_result == clip_test::intersects)
         {
             geometry::geometry_types type = geometry::geometry_type(feature.get_geometry());
             if (type == geometry::geometry_types::Polygon || type == geometry::geometry_types::MultiPolygon)
@@ -173,7 +200,9 @@ void agg_renderer<T0,T1>::process(line_symbolizer const& sym,
         }
         converter.set<transform_tag>(); // always transform
         if (std::fabs(offset) > 0.0) converter.set<offset_transform_tag>(); // parallel offset
+        converter.set_offset_buffers(*common_.offset_buffers_);
         converter.set<affine_transform_tag>(); // optional affine transform
+        if (common_.vertex_decimation_) converter.set<decimate_tag>(); // optional sub-pixel decimation
         if (simplify_tolerance > 0.0) converter.set<simplify_tag>(); // optional simplify converter
         if (smooth > 0.0) converter.set<smooth_tag>(); // optional smooth converter
 
@@ -185,12 +214,12 @@ void agg_renderer<T0,T1>::process(line_symbolizer const& sym,
     else
     {
         using vertex_converter_type = vertex_converter<clip_line_tag, clip_poly_tag, transform_tag,
-                                                       affine_transform_tag,
+                                                       affine_transform_tag, decimate_tag,
                                                        simplify_tag, smooth_tag,
                                                        offset_transform_tag,
                                                        dash_tag, stroke_tag>;
         vertex_converter_type converter(clip_box, sym,common_.t_,prj_trans,tr,feature,common_.vars_,common_.scale_factor_);
-        if (clip)
+        if (clip && clip_result == clip_test::intersects)
         {
             geometry::geometry_types type = geometry::geometry_type(feature.get_geometry());
             if (type == geometry::geometry_types::Polygon || type == geometry::geometry_types::MultiPolygon)
@@ -200,7 +229,9 @@ void agg_renderer<T0,T1>::process(line_symbolizer const& sym,
         }
         converter.set<transform_tag>(); // always transform
         if (std::fabs(offset) > 0.0) converter.set<offset_transform_tag>(); // parallel offset
+        converter.set_offset_buffers(*common_.offset_buffers_);
         converter.set<affine_transform_tag>(); // optional affine transform
+        if (common_.vertex_decimation_) converter.set<decimate_tag>(); // optional sub-pixel decimation
         if (simplify_tolerance > 0.0) converter.set<simplify_tag>(); // optional simplify converter
         if (smooth > 0.0) converter.set<smooth_tag>(); // optional smooth converter
         if (has_key(sym, keys::stroke_dasharray))
@@ -37,6 +37,7 @@
 #include <mapnik/svg/svg_renderer_agg.hpp>
 #include <mapnik/svg/svg_path_adapter.hpp>
 #include <mapnik/renderer_common/render_pattern.hpp>
+#include <mapnik/renderer_common/clipping_extent.hpp>
 
 #pragma GCC diagnostic push
 #include <mapnik/warning_ignore_agg.hpp>
@@ -66,7 +67,8 @@ struct agg_renderer_process_visitor_p
                                    double & gamma,
                                    polygon_pattern_symbolizer const& sym,
                                    mapnik::feature_impl & feature,
-                                   proj_transform const& prj_trans)
+                                   proj_transform const& prj_trans,
+                                   clip_test clip_result)
     : common_(common),
         current_buffer_(current_buffer),
         ras_ptr_(ras_ptr),
@@ -74,7 +76,8 @@ struct agg_renderer_process_visitor_p
         gamma_(gamma),
         sym_(sym),
         feature_(feature),
-        prj_trans_(prj_trans) {}
+        prj_trans_(prj_trans),
+        clip_result_(clip_result) {}
 
     void operator() (marker_null const&) const {}
 
@@ -128,7 +131,10 @@ private:
         agg::pixfmt_rgba32_pre pixf_pattern(pattern_rbuf);
         pattern_type::img_source_type img_src(pixf_pattern);
 
-        if (prj_trans_.equal() && pattern.clip_) pattern.converter_.set<clip_poly_tag>();
+        if (prj_trans_.equal() && pattern.clip_ && clip_result_ == clip_test::intersects)
+        {
+            pattern.converter_.set<clip_poly_tag>();
+        }
 
         ras_ptr_->filling_rule(agg::fill_even_odd);
 
@@ -143,6 +149,7 @@ private:
     polygon_pattern_symbolizer const& sym_;
     mapnik::feature_impl & feature_;
     proj_transform const& prj_trans_;
+    clip_test clip_result_;
 };
 
 template <typename T0, typename T1>
@@ -150,8 +157,15 @@ void agg_renderer<T0,T1>::process(polygon_pattern_symbolizer const& sym,
                                   mapnik::feature_impl & feature,
                                   proj_transform const& prj_trans)
 {
+    flush_batches();
     std::string filename = get<std::string, keys::file>(sym, feature, common_.vars_);
     if (filename.empty()) return;
+    clip_test clip_result = clip_test::intersects;
+    if (prj_trans.equal() && get<value_bool, keys::clip>(sym, feature, common_.vars_))
+    {
+        clip_result = test_clip_envelope(clipping_extent(common_), feature.envelope());
+        if (clip_result == clip_test::outside) return;
+    }
     std::shared_ptr<mapnik::marker const> marker = marker_cache::instance().find(filename, true);
     agg_renderer_process_visitor_p<buffer_type> visitor(common_,
                                                         buffers_.top().get(),
@@ -160,7 +174,8 @@ void agg_renderer<T0,T1>::process(polygon_pattern_symbolizer const& sym,
                                                         gamma_,
                                                         sym,
                                                         feature,
-                                                        prj_trans);
+                                                        prj_trans,
+                                                        clip_result);
     util::apply_visitor(visitor, *marker);
 }
 
@@ -32,6 +32,7 @@
 #include <mapnik/vertex_converters.hpp>
 #include <mapnik/renderer_common/process_polygon_symbolizer.hpp>
 #include <mapnik/renderer_common/clipping_extent.hpp>
+#include <mapnik/renderer_common/feature_size.hpp>
 
 #pragma GCC diagnostic push
 #include <mapnik/warning_ignore_agg.hpp>
@@ -46,53 +47,165 @@
 
 namespace mapnik {
 
+namespace {
+
+// comp_op_adaptor_rgba_pre fixed to src-over: same arithmetic, but without
+// the per-span dispatch through the comp-op function table
+template <typename ColorT, typename Order>
+struct src_over_adaptor_rgba_pre
+{
+    using order_type = Order;
+    using color_type = ColorT;
+    using value_type = typename color_type::value_type;
+
+    static AGG_INLINE void blend_pix(unsigned, value_type* p,
+                                     unsigned cr, unsigned cg, unsigned cb,
+                                     unsigned ca,
+                                     unsigned cover)
+    {
+        agg::comp_op_rgba_src_over<ColorT, Order>::blend_pix(p, cr, cg, cb, ca, cover);
+    }
+};
+
+template <typename Blender, typename Rasterizer>
+void render_solid(Rasterizer & ras, agg::rendering_buffer & buf,
+                  agg::rgba8 const& fill, composite_mode_e comp_op)
+{
+    using pixfmt_comp_type = agg::pixfmt_custom_blend_rgba<Blender, agg::rendering_buffer>;
+    using renderer_base = agg::renderer_base<pixfmt_comp_type>;
+    using renderer_type = agg::renderer_scanline_aa_solid<renderer_base>;
+    pixfmt_comp_type pixf(buf);
+    pixf.comp_op(static_cast<agg::comp_op_e>(comp_op));
+    renderer_base renb(pixf);
+    renderer_type ren(renb);
+    ren.color(fill);
+    agg::scanline_u8 sl;
+    agg::render_scanlines(ras, sl, ren);
+}
+
+template <typename Rasterizer>
+void fill_polygon(Rasterizer & ras, agg::rendering_buffer & buf,
+                  color const& fill, double opacity, composite_mode_e comp_op)
+{
+    using color_type = agg::rgba8;
+    using order_type = agg::order_rgba;
+    color_type c = agg::rgba8_pre(fill.red(), fill.green(), fill.blue(), int(fill.alpha() * opacity));
+    if (comp_op == src_over)
+    {
+        render_solid<src_over_adaptor_rgba_pre<color_type, order_type>>(ras, buf, c, comp_op);
+    }
+    else
+    {
+        render_solid<agg::comp_op_adaptor_rgba_pre<color_type, order_type>>(ras, buf, c, comp_op);
+    }
+}
+
+// upper bound on features per batch, keeps the rasterizer well below its
+// cell block limit
+constexpr std::size_t max_polygon_batch_size = 256;
+
+}
+
 template <typename T0, typename T1>
 void agg_renderer<T0,T1>::process(polygon_symbolizer const& sym,
                               mapnik::feature_impl & feature,
                               proj_transform const& prj_trans)
 {
-    using vertex_converter_type = vertex_converter<clip_poly_tag,transform_tag,affine_transform_tag,simplify_tag,smooth_tag>;
+    using vertex_converter_type = vertex_converter<clip_poly_tag,transform_tag,affine_transform_tag,decimate_tag,simplify_tag,smooth_tag>;
+
+    flush_building_batch();
+    box2d<double> culled = culled_envelope(common_, sym, feature, prj_trans);
+    if (culled.valid() && !common_.minimum_feature_dot_) return;
 
-    ras_ptr->reset();
     double gamma = get<value_double>(sym, keys::gamma, feature, common_.vars_, 1.0);
     gamma_method_enum gamma_method = get<gamma_method_enum>(sym, keys::gamma_method, feature, common_.vars_, GAMMA_POWER);
-    if (gamma != gamma_ || gamma_method != gamma_method_)
+    composite_mode_e comp_op = get<composite_mode_e>(sym, keys::comp_op, feature, common_.vars_, src_over);
+    color const& fill = get<color, keys::fill>(sym, feature, common_.vars_);
+    double opacity = get<value_double, keys::fill_opacity>(sym, feature, common_.vars_);
+    buffer_type & current_buffer = buffers_.top().get();
+
+    // Batching is opt-in per layer (see layer::set_polygon_batching). Ring
+    // orientation is normalised in source coordinates, so a geometry
+    // transform which mirrors the feature can't take part in a batch, and
+    // neither can the (screen space) dot standing in for a culled feature.
+    bool batch = common_.polygon_batching_ && !culled.valid() &&
+        !has_key(sym, keys::geometry_transform);
+    bool extend = batch && polygon_batch_.size > 0 &&
+        polygon_batch_.size < max_polygon_batch_size &&
+        polygon_batch_.fill == fill.rgba() &&
+        polygon_batch_.opacity == opacity &&
+        polygon_batch_.gamma == gamma &&
+        polygon_batch_.gamma_method == gamma_method &&
+        polygon_batch_.comp_op == comp_op &&
+        polygon_batch_.buffer == &current_buffer;
+
+    if (!extend)
     {
-        set_gamma_method(ras_ptr, gamma, gamma_method);
-        gamma_method_ = gamma_method;
-        gamma_ = gamma;
+        flush_polygon_batch();
+        ras_ptr->reset();
+        if (gamma != gamma_ || gamma_method != gamma_method_)
+        {
+            set_gamma_method(ras_ptr, gamma, gamma_method);
+            gamma_method_ = gamma_method;
+            gamma_ = gamma;
+        }
+    }
+
+    box2d<double> clip_box = clipping_extent(common_);
+    if (batch)
+    {
+        if (!extend)
+        {
+            polygon_batch_.fill = fill.rgba();
+            polygon_batch_.opacity = opacity;
+            polygon_batch_.gamma = gamma;
+            polygon_batch_.gamma_method = gamma_method;
+            polygon_batch_.comp_op = comp_op;
+            polygon_batch_.buffer = &current_buffer;
+        }
+        ++polygon_batch_.size;
+        // paths are only added here, filling happens in flush_polygon_batch()
+        render_polygon_symbolizer<vertex_converter_type, geometry::oriented_polygon_vertex_adapter>(
+            sym, feature, prj_trans, common_, clip_box, *ras_ptr, [](color const&, double) {});
+        return;
     }
 
-    buffer_type & current_buffer = buffers_.top().get();
     agg::rendering_buffer buf(current_buffer.bytes(), current_buffer.width(), current_buffer.height(), current_buffer.row_size());
 
-    box2d<double> clip_box = clipping_extent(common_);
+    auto fill_func = [&](color const& fill_color, double fill_opacity) {
+        ras_ptr->filling_rule(agg::fill_even_odd);
+        fill_polygon(*ras_ptr, buf, fill_color, fill_opacity, comp_op);
+    };
+
+    if (culled.valid())
+    {
+        add_culled_dot(*ras_ptr, culled);
+        fill_func(fill, opacity);
+        return;
+    }
+
     render_polygon_symbolizer<vertex_converter_type>(
-        sym, feature, prj_trans, common_, clip_box, *ras_ptr,
-        [&](color const &fill, double opacity) {
-            unsigned r=fill.red();
-            unsigned g=fill.green();
-            unsigned b=fill.blue();
-            unsigned a=fill.alpha();
-            using color_type = agg::rgba8;
-            using order_type = agg::order_rgba;
-            using blender_type = agg::comp_op_adaptor_rgba_pre<color_type, order_type>; // comp blender
-            using pixfmt_comp_type = agg::pixfmt_custom_blend_rgba<blender_type, agg::rendering_buffer>;
-            using renderer_base = agg::renderer_base<pixfmt_comp_type>;
-            using renderer_type = agg::renderer_scanline_aa_solid<renderer_base>;
-            pixfmt_comp_type pixf(buf);
-            pixf.comp_op(static_cast<agg::comp_op_e>(get<composite_mode_e>(sym, keys::comp_op, feature, common_.vars_, src_over)));
-            renderer_base renb(pixf);
-            renderer_type ren(renb);
-            ren.color(agg::rgba8_pre(r, g, b, int(a * opacity)));
-            agg::scanline_u8 sl;
-            ras_ptr->filling_rule(agg::fill_even_odd);
-            agg::render_scanlines(*ras_ptr, sl, ren);
-        });
+        sym, feature, prj_trans, common_, clip_box, *ras_ptr, fill_func);
+}
+
+template <typename T0, typename T1>
+void agg_renderer<T0,T1>::flush_polygon_batch()
+{
+    if (polygon_batch_.size == 0) return;
+    polygon_batch_.size = 0;
+    buffer_type & current_buffer = *polygon_batch_.buffer;
+    agg::rendering_buffer buf(current_buffer.bytes(), current_buffer.width(), current_buffer.height(), current_buffer.row_size());
+    // rings are oriented consistently, so overlapping members of the batch
+    // are filled once and shared edges leave no anti-aliasing seam
+    ras_ptr->filling_rule(agg::fill_non_zero);
+    fill_polygon(*ras_ptr, buf, color(polygon_batch_.fill), polygon_batch_.opacity, polygon_batch_.comp_op);
+    // leave the rasterizer as a single polygon fill does
+    ras_ptr->filling_rule(agg::fill_even_odd);
 }
 
 template void agg_renderer<image_rgba8>::process(polygon_symbolizer const&,
                                               mapnik::feature_impl &,
                                               proj_transform const&);
+template void agg_renderer<image_rgba8>::flush_polygon_batch();
 
 }
@@ -37,6 +37,7 @@ void  agg_renderer<T0,T1>::process(shield_symbolizer const& sym,
                                    mapnik::feature_impl & feature,
                                    proj_transform const& prj_trans)
 {
+    flush_batches();
     box2d<double> clip_box = clipping_extent(common_);
     agg::trans_affine tr;
     auto transform = get_optional<transform_type>(sym, keys::geometry_transform);
@@ -46,7 +47,7 @@ void  agg_renderer<T0,T1>::process(shield_symbolizer const& sym,
         common_.width_, common_.height_,
         common_.scale_factor_,
         common_.t_, common_.font_manager_, *common_.detector_,
-        clip_box, tr);
+        clip_box, tr, &common_.label_anchors_);
 
     halo_rasterizer_enum halo_rasterizer = get<halo_rasterizer_enum>(sym, keys::halo_rasterizer, feature, common_.vars_, HALO_RASTERIZER_FULL);
     composite_mode_e comp_op = get<composite_mode_e>(sym, keys::comp_op, feature, common_.vars_, src_over);
@@ -187,6 +187,8 @@ source = Split(
     font_engine_freetype.cpp
     font_set.cpp
     function_call.cpp
+    instrumentation.cpp
+    task_scheduler.cpp
     gradient.cpp
     path_expression_grammar_x3.cpp
     parse_path.cpp
@@ -202,6 +204,8 @@ source = Split(
     image_util_png.cpp
     image_util_tiff.cpp
     image_util_webp.cpp
+    label_anchor_cache.cpp
+    lazy_datasource.cpp
     layer.cpp
     map.cpp
     load_map.cpp
@@ -362,6 +366,7 @@ source += Split(
     agg/process_markers_symbolizer.cpp
     agg/process_group_symbolizer.cpp
     agg/process_debug_symbolizer.cpp
+    pyramid_seeder.cpp
     """
     )
 
@@ -394,6 +399,15 @@ if env['GRID_RENDERER']:
     lib_env.Append(CPPDEFINES = '-DGRID_RENDERER')
     libmapnik_defines.append('-DGRID_RENDERER')
 
+# mapbox vector tile backend
+if env['MVT_RENDERER']:
+    source += Split(
+        """
+        mvt/mvt_renderer.cpp
+        """)
+    lib_env.Append(CPPDEFINES = '-DMVT_RENDERER')
+    libmapnik_defines.append('-DMVT_RENDERER')
+
 # https://github.com/mapnik/mapnik/issues/1438
 if env['SVG_RENDERER']: # svg backend
     source += Split(
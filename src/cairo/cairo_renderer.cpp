@@ -189,6 +189,7 @@ void cairo_renderer<T>::start_layer_processing(layer const& lay, box2d<double> c
         common_.detector_->clear();
     }
     common_.query_extent_ = query_extent;
+    common_.label_anchors_.layer = lay.name();
 
     if (lay.comp_op() || lay.get_opacity() < 1.0)
     {
@@ -124,7 +124,6 @@ struct warp_pattern : cairo_pattern_base
         converter_.template set<affine_transform_tag>();
         if (simplify_tolerance > 0.0) converter_.template set<simplify_tag>();
         if (smooth > 0.0) converter_.template set<smooth_tag>();
-        if (clip_) converter_.template set<clip_line_tag>();
     }
 
     box2d<double> clip_box() const
@@ -190,8 +189,6 @@ struct repeat_pattern : repeat_pattern_base
             converter_.template set<dash_tag>();
         }
 
-        if (clip_) converter_.template set<clip_line_tag>();
-
         value_double offset = get<value_double, keys::offset>(sym_, feature_, common_.vars_);
         if (std::fabs(offset) > 0.0) converter_.template set<offset_transform_tag>();
 
@@ -199,6 +196,17 @@ struct repeat_pattern : repeat_pattern_base
     }
 };
 
+// only clip lines crossing the clipping box; returns false if the
+// feature lies entirely outside and need not be rendered at all
+template <typename Pattern>
+bool setup_clip(Pattern & pattern, feature_impl const& feature)
+{
+    if (!pattern.clip_) return true;
+    clip_test clip_result = test_clip_envelope(pattern.clip_box_, feature.envelope());
+    if (clip_result == clip_test::intersects) pattern.converter_.template set<clip_line_tag>();
+    return clip_result != clip_test::outside;
+}
+
 }
 
 template <typename T>
@@ -220,13 +228,13 @@ void cairo_renderer<T>::process(line_pattern_symbolizer const& sym,
         case LINE_PATTERN_WARP:
         {
             warp_pattern pattern(*marker, common_, sym, feature, prj_trans);
-            pattern.render(context_);
+            if (setup_clip(pattern, feature)) pattern.render(context_);
             break;
         }
         case LINE_PATTERN_REPEAT:
         {
             repeat_pattern pattern(*marker, common_, sym, feature, prj_trans);
-            pattern.render(context_);
+            if (setup_clip(pattern, feature)) pattern.render(context_);
             break;
         }
         case line_pattern_enum_MAX:
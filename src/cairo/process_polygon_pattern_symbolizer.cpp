@@ -34,6 +34,7 @@
 #include <mapnik/marker_cache.hpp>
 #include <mapnik/renderer_common/apply_vertex_converter.hpp>
 #include <mapnik/renderer_common/pattern_alignment.hpp>
+#include <mapnik/renderer_common/clipping_extent.hpp>
 
 namespace mapnik
 {
@@ -44,6 +45,12 @@ void cairo_renderer<T>::process(polygon_pattern_symbolizer const& sym,
                                   proj_transform const& prj_trans)
 {
     std::string filename = get<std::string, keys::file>(sym, feature, common_.vars_);
+    clip_test clip_result = clip_test::intersects;
+    if (prj_trans.equal() && get<value_bool, keys::clip>(sym, feature, common_.vars_))
+    {
+        clip_result = test_clip_envelope(clipping_extent(common_), feature.envelope());
+        if (clip_result == clip_test::outside) return;
+    }
     std::shared_ptr<mapnik::marker const> marker = mapnik::marker_cache::instance().find(filename,true);
     if (marker->is<mapnik::marker_null>()) return;
 
@@ -56,7 +63,10 @@ void cairo_renderer<T>::process(polygon_pattern_symbolizer const& sym,
 
     pattern_type pattern(*marker, common_, sym, feature, prj_trans);
 
-    if (prj_trans.equal() && pattern.clip_) pattern.converter_.set<clip_poly_tag>();
+    if (prj_trans.equal() && pattern.clip_ && clip_result == clip_test::intersects)
+    {
+        pattern.converter_.set<clip_poly_tag>();
+    }
 
     pattern.render(CAIRO_FILL_RULE_EVEN_ODD, context_);
 }
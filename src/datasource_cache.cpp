@@ -24,6 +24,7 @@
 #include <mapnik/debug.hpp>
 #include <mapnik/datasource.hpp>
 #include <mapnik/datasource_cache.hpp>
+#include <mapnik/instrumentation.hpp>
 #include <mapnik/config_error.hpp>
 #include <mapnik/params.hpp>
 #include <mapnik/plugin.hpp>
@@ -86,7 +87,7 @@ datasource_ptr datasource_cache::create(parameters const& params)
     // add scope to ensure lock is released asap
     {
 #ifdef MAPNIK_THREADSAFE
-        std::lock_guard<std::recursive_mutex> lock(instance_mutex_);
+        instrumentation::lock_guard<std::recursive_mutex> lock(instance_mutex_, instrumentation::lock_site::datasource_cache);
 #endif
         itr = plugins_.find(*type);
         if (itr == plugins_.end())
@@ -131,7 +132,7 @@ datasource_ptr datasource_cache::create(parameters const& params)
 std::string datasource_cache::plugin_directories()
 {
 #ifdef MAPNIK_THREADSAFE
-    std::lock_guard<std::recursive_mutex> lock(instance_mutex_);
+    instrumentation::lock_guard<std::recursive_mutex> lock(instance_mutex_, instrumentation::lock_site::datasource_cache);
 #endif
     return boost::algorithm::join(plugin_directories_,", ");
 }
@@ -145,7 +146,7 @@ std::vector<std::string> datasource_cache::plugin_names()
 #endif
 
 #ifdef MAPNIK_THREADSAFE
-    std::lock_guard<std::recursive_mutex> lock(instance_mutex_);
+    instrumentation::lock_guard<std::recursive_mutex> lock(instance_mutex_, instrumentation::lock_site::datasource_cache);
 #endif
 
     std::map<std::string,std::shared_ptr<PluginInfo> >::const_iterator itr;
@@ -160,7 +161,7 @@ std::vector<std::string> datasource_cache::plugin_names()
 bool datasource_cache::register_datasources(std::string const& dir, bool recurse)
 {
 #ifdef MAPNIK_THREADSAFE
-    std::lock_guard<std::recursive_mutex> lock(instance_mutex_);
+    instrumentation::lock_guard<std::recursive_mutex> lock(instance_mutex_, instrumentation::lock_site::datasource_cache);
 #endif
     if (!mapnik::util::exists(dir))
     {
@@ -208,7 +209,7 @@ bool datasource_cache::register_datasources(std::string const& dir, bool recurse
 bool datasource_cache::register_datasource(std::string const& filename)
 {
 #ifdef MAPNIK_THREADSAFE
-    std::lock_guard<std::recursive_mutex> lock(instance_mutex_);
+    instrumentation::lock_guard<std::recursive_mutex> lock(instance_mutex_, instrumentation::lock_site::datasource_cache);
 #endif
     try
     {
@@ -37,6 +37,9 @@
 
 // static plugin linkage
 #ifdef MAPNIK_STATIC_PLUGINS
+    #if defined(MAPNIK_STATIC_PLUGIN_COLUMNAR)
+        #include "input/columnar/columnar_datasource.hpp"
+    #endif
     #if defined(MAPNIK_STATIC_PLUGIN_CSV)
         #include "input/csv/csv_datasource.hpp"
     #endif
@@ -91,6 +94,9 @@ typedef datasource_ptr (*ds_generator_ptr)(parameters const& params);
 using datasource_map = std::unordered_map<std::string, ds_generator_ptr>;
 
 static datasource_map ds_map = boost::assign::map_list_of
+    #if defined(MAPNIK_STATIC_PLUGIN_COLUMNAR)
+        (std::string("columnar"), &ds_generator<columnar_datasource>)
+    #endif
     #if defined(MAPNIK_STATIC_PLUGIN_CSV)
         (std::string("csv"), &ds_generator<csv_datasource>)
     #endif
@@ -40,6 +40,10 @@
 #include <mapnik/svg/output/svg_renderer.hpp>
 #endif
 
+#if defined(MVT_RENDERER)
+#include <mapnik/mvt/mvt_renderer.hpp>
+#endif
+
 namespace mapnik
 {
 
@@ -55,6 +59,10 @@ template class MAPNIK_DECL feature_style_processor<svg_renderer<std::ostream_ite
 template class MAPNIK_DECL feature_style_processor<grid_renderer<grid> >;
 #endif
 
+#if defined(MVT_RENDERER)
+template class MAPNIK_DECL feature_style_processor<mvt_renderer>;
+#endif
+
 template class MAPNIK_DECL feature_style_processor<agg_renderer<image_rgba8> >;
 
 }
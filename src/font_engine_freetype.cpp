@@ -23,6 +23,7 @@
 // mapnik
 #include <mapnik/debug.hpp>
 #include <mapnik/font_engine_freetype.hpp>
+#include <mapnik/instrumentation.hpp>
 #include <mapnik/pixel_position.hpp>
 #include <mapnik/text/face.hpp>
 #include <mapnik/util/fs.hpp>
@@ -85,7 +86,7 @@ bool freetype_engine::register_font(std::string const& file_name)
 bool freetype_engine::register_font_impl(std::string const& file_name)
 {
 #ifdef MAPNIK_THREADSAFE
-    std::lock_guard<std::mutex> lock(mutex_);
+    instrumentation::lock_guard<std::mutex> lock(mutex_, instrumentation::lock_site::freetype_engine);
 #endif
     font_library library;
     return register_font_impl(file_name, library, global_font_file_mapping_);
@@ -172,7 +173,7 @@ bool freetype_engine::register_fonts(std::string const& dir, bool recurse)
 bool freetype_engine::register_fonts_impl(std::string const& dir, bool recurse)
 {
 #ifdef MAPNIK_THREADSAFE
-    std::lock_guard<std::mutex> lock(mutex_);
+    instrumentation::lock_guard<std::mutex> lock(mutex_, instrumentation::lock_site::freetype_engine);
 #endif
     font_library library;
     return register_fonts_impl(dir, library, global_font_file_mapping_, recurse);
@@ -366,7 +367,7 @@ face_ptr freetype_engine::create_face_impl(std::string const& family_name,
         if (file)
         {
 #ifdef MAPNIK_THREADSAFE
-            std::lock_guard<std::mutex> lock(mutex_);
+            instrumentation::lock_guard<std::mutex> lock(mutex_, instrumentation::lock_site::freetype_engine);
 #endif
             auto result = global_memory_fonts.emplace(itr->second.second, std::make_pair(file.data(),file.size()));
             FT_Face face;
@@ -116,6 +116,7 @@ void grid_renderer<T>::start_layer_processing(layer const& lay, box2d<double> co
         common_.detector_->clear();
     }
     common_.query_extent_ = query_extent;
+    common_.label_anchors_.layer = lay.name();
     boost::optional<box2d<double> > const& maximum_extent = lay.maximum_extent();
     if (maximum_extent)
     {
@@ -35,6 +35,7 @@
 #include <mapnik/vertex_processor.hpp>
 #include <mapnik/parse_path.hpp>
 #include <mapnik/renderer_common/apply_vertex_converter.hpp>
+#include <mapnik/renderer_common/clipping_extent.hpp>
 
 #pragma GCC diagnostic push
 #include <mapnik/warning_ignore_agg.hpp>
@@ -97,6 +98,7 @@ void grid_renderer<T>::process(line_pattern_symbolizer const& sym,
     }
 
     box2d<double> clipping_extent = common_.query_extent_;
+    clip_test clip_result = clip_test::intersects;
     if (clip)
     {
         double pad_per_pixel = static_cast<double>(common_.query_extent_.width()/common_.width_);
@@ -105,6 +107,8 @@ void grid_renderer<T>::process(line_pattern_symbolizer const& sym,
         double padding = pad_per_pixel * pixels * common_.scale_factor_;
 
         clipping_extent.pad(padding);
+        clip_result = test_clip_envelope(clipping_extent, feature.envelope());
+        if (clip_result == clip_test::outside) return;
     }
 
     // to avoid the complexity of using an agg pattern filter instead
@@ -123,7 +127,7 @@ void grid_renderer<T>::process(line_pattern_symbolizer const& sym,
                                                    simplify_tag,smooth_tag,
                                                    offset_transform_tag,stroke_tag>;
     vertex_converter_type converter(clipping_extent,line,common_.t_,prj_trans,tr,feature,common_.vars_,common_.scale_factor_);
-    if (clip) converter.set<clip_line_tag>();
+    if (clip && clip_result == clip_test::intersects) converter.set<clip_line_tag>();
     converter.set<transform_tag>(); // always transform
     if (std::fabs(offset) > 0.0) converter.set<offset_transform_tag>(); // parallel offset
     converter.set<affine_transform_tag>(); // optional affine transform
@@ -31,6 +31,7 @@
 #include <mapnik/vertex_converters.hpp>
 #include <mapnik/vertex_processor.hpp>
 #include <mapnik/renderer_common/apply_vertex_converter.hpp>
+#include <mapnik/renderer_common/clipping_extent.hpp>
 #include <mapnik/geometry/geometry_type.hpp>
 
 #pragma GCC diagnostic push
@@ -82,6 +83,7 @@ void grid_renderer<T>::process(line_symbolizer const& sym,
     double smooth = get<value_double>(sym, keys::smooth, feature, common_.vars_,false);
     bool has_dash = has_key(sym, keys::stroke_dasharray);
 
+    clip_test clip_result = clip_test::intersects;
     if (clip)
     {
         double pad_per_pixel = static_cast<double>(common_.query_extent_.width()/common_.width_);
@@ -90,6 +92,8 @@ void grid_renderer<T>::process(line_symbolizer const& sym,
         double padding = pad_per_pixel * pixels * common_.scale_factor_;
 
         clipping_extent.pad(padding);
+        clip_result = test_clip_envelope(clipping_extent, feature.envelope());
+        if (clip_result == clip_test::outside) return;
     }
     using vertex_converter_type = vertex_converter<clip_line_tag, clip_poly_tag, transform_tag,
                                                    affine_transform_tag,
@@ -98,7 +102,7 @@ void grid_renderer<T>::process(line_symbolizer const& sym,
                                                    dash_tag, stroke_tag>;
 
     vertex_converter_type converter(clipping_extent,sym,common_.t_,prj_trans,tr,feature,common_.vars_,common_.scale_factor_);
-    if (clip)
+    if (clip && clip_result == clip_test::intersects)
     {
         geometry::geometry_types type = geometry::geometry_type(feature.get_geometry());
         if (type == geometry::geometry_types::Polygon || type == geometry::geometry_types::MultiPolygon)
@@ -108,6 +112,7 @@ void grid_renderer<T>::process(line_symbolizer const& sym,
     }
     converter.set<transform_tag>(); // always transform
     if (std::fabs(offset) > 0.0) converter.set<offset_transform_tag>(); // parallel offset
+    converter.set_offset_buffers(*common_.offset_buffers_);
     converter.set<affine_transform_tag>(); // optional affine transform
     if (simplify_tolerance > 0.0) converter.set<simplify_tag>(); // optional simplify converter
     if (smooth > 0.0) converter.set<smooth_tag>(); // optional smooth converter
@@ -35,6 +35,7 @@
 #include <mapnik/marker_cache.hpp>
 #include <mapnik/parse_path.hpp>
 #include <mapnik/renderer_common/apply_vertex_converter.hpp>
+#include <mapnik/renderer_common/clipping_extent.hpp>
 
 #pragma GCC diagnostic push
 #include <mapnik/warning_ignore_agg.hpp>
@@ -68,6 +69,12 @@ void grid_renderer<T>::process(polygon_pattern_symbolizer const& sym,
     ras_ptr->reset();
 
     value_bool clip = get<value_bool, keys::clip>(sym, feature, common_.vars_);
+    clip_test clip_result = clip_test::intersects;
+    if (prj_trans.equal() && clip)
+    {
+        clip_result = test_clip_envelope(common_.query_extent_, feature.envelope());
+        if (clip_result == clip_test::outside) return;
+    }
     value_double simplify_tolerance = get<value_double, keys::simplify_tolerance>(sym, feature, common_.vars_);
     value_double smooth = get<value_double, keys::smooth>(sym, feature, common_.vars_);
 
@@ -86,7 +93,7 @@ void grid_renderer<T>::process(polygon_pattern_symbolizer const& sym,
 
     vertex_converter_type converter(common_.query_extent_,sym,common_.t_,prj_trans,tr,feature,common_.vars_,common_.scale_factor_);
 
-    if (prj_trans.equal() && clip) converter.set<clip_poly_tag>();
+    if (prj_trans.equal() && clip && clip_result == clip_test::intersects) converter.set<clip_poly_tag>();
     converter.set<transform_tag>(); //always transform
     converter.set<affine_transform_tag>();
     if (simplify_tolerance > 0.0) converter.set<simplify_tag>(); // optional simplify converter
@@ -0,0 +1,388 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2017 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+// mapnik
+#include <mapnik/instrumentation.hpp>
+
+// stl
+#include <iomanip>
+#include <ostream>
+#ifdef MAPNIK_INSTRUMENTATION
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#endif
+
+namespace mapnik { namespace instrumentation {
+
+char const* stage_name(stage s)
+{
+    switch (s)
+    {
+    case stage::other: return "other";
+    case stage::setup: return "setup";
+    case stage::query: return "query";
+    case stage::style: return "style";
+    case stage::composite: return "composite";
+    default: break;
+    }
+    return "unknown";
+}
+
+char const* lock_site_name(lock_site s)
+{
+    switch (s)
+    {
+    case lock_site::marker_cache: return "marker_cache";
+    case lock_site::mapped_memory_cache: return "mapped_memory_cache";
+    case lock_site::datasource_cache: return "datasource_cache";
+    case lock_site::freetype_engine: return "freetype_engine";
+    case lock_site::projection: return "projection";
+    case lock_site::pool: return "pool";
+    case lock_site::label_anchor_cache: return "label_anchor_cache";
+    case lock_site::lazy_datasource: return "lazy_datasource";
+    default: break;
+    }
+    return "unknown";
+}
+
+#ifdef MAPNIK_INSTRUMENTATION
+
+namespace {
+
+constexpr unsigned num_stages = static_cast<unsigned>(stage::count);
+constexpr unsigned num_lock_sites = static_cast<unsigned>(lock_site::count);
+
+std::atomic<bool> enabled_(false);
+
+struct atomic_stage_stats
+{
+    std::atomic<std::uint64_t> allocations;
+    std::atomic<std::uint64_t> bytes;
+};
+
+struct atomic_lock_stats
+{
+    std::atomic<std::uint64_t> acquisitions;
+    std::atomic<std::uint64_t> contended;
+    std::atomic<std::uint64_t> wait_ns;
+    std::atomic<std::uint64_t> max_wait_ns;
+};
+
+// zero initialised statics: safe to touch from operator new before
+// any dynamic initialisation has run. stage_totals holds the allocations
+// of threads that have exited.
+atomic_stage_stats stage_totals[num_stages];
+atomic_lock_stats lock_totals[num_lock_sites];
+
+// Allocations are counted per thread, per stage. Only the owning thread
+// writes its counters, with plain loads and stores, keeping operator new
+// free of atomic read-modify-writes; other threads read them through the
+// registry. reset() records the counts as a base instead of writing them.
+struct thread_counters
+{
+    thread_counters();
+    ~thread_counters();
+
+    unsigned current;
+    std::atomic<std::uint64_t> allocations[num_stages];
+    std::atomic<std::uint64_t> bytes[num_stages];
+    // counts at the last reset(), guarded by registry_mutex
+    std::uint64_t allocations_base[num_stages];
+    std::uint64_t bytes_base[num_stages];
+    // registry links, guarded by registry_mutex
+    thread_counters * prev;
+    thread_counters * next;
+};
+
+// counters of all running threads, constant initialised
+std::mutex registry_mutex;
+thread_counters * registry = nullptr;
+
+thread_counters::thread_counters()
+    : current(0),
+      prev(nullptr)
+{
+    for (unsigned i = 0; i < num_stages; ++i)
+    {
+        allocations[i].store(0, std::memory_order_relaxed);
+        bytes[i].store(0, std::memory_order_relaxed);
+        allocations_base[i] = 0;
+        bytes_base[i] = 0;
+    }
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    next = registry;
+    if (next) next->prev = this;
+    registry = this;
+}
+
+// set once this thread's counters are gone: allocations made by
+// thread_local destructors running after them are not counted
+thread_local bool counters_released = false;
+
+thread_counters::~thread_counters()
+{
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    for (unsigned i = 0; i < num_stages; ++i)
+    {
+        stage_totals[i].allocations.fetch_add(allocations[i].load(std::memory_order_relaxed) - allocations_base[i],
+                                              std::memory_order_relaxed);
+        stage_totals[i].bytes.fetch_add(bytes[i].load(std::memory_order_relaxed) - bytes_base[i],
+                                        std::memory_order_relaxed);
+    }
+    if (prev) prev->next = next;
+    else registry = next;
+    if (next) next->prev = prev;
+    counters_released = true;
+}
+
+thread_local thread_counters counters;
+
+inline void increment(std::atomic<std::uint64_t> & counter, std::uint64_t value)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+inline void count_allocation(std::size_t size)
+{
+    if (enabled_.load(std::memory_order_relaxed) && !counters_released)
+    {
+        thread_counters & c = counters;
+        increment(c.allocations[c.current], 1);
+        increment(c.bytes[c.current], size);
+    }
+}
+
+void * allocate(std::size_t size)
+{
+    count_allocation(size);
+    if (size == 0) size = 1;
+    for (;;)
+    {
+        void * ptr = std::malloc(size);
+        if (ptr) return ptr;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void * allocate_nothrow(std::size_t size) noexcept
+{
+    try
+    {
+        return allocate(size);
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+} // anonymous namespace
+
+void set_enabled(bool enabled)
+{
+    enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+bool enabled()
+{
+    return enabled_.load(std::memory_order_relaxed);
+}
+
+snapshot get_snapshot()
+{
+    snapshot snap;
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        for (unsigned i = 0; i < num_stages; ++i)
+        {
+            snap.stages[i].allocations = stage_totals[i].allocations.load(std::memory_order_relaxed);
+            snap.stages[i].bytes = stage_totals[i].bytes.load(std::memory_order_relaxed);
+        }
+        for (thread_counters const* c = registry; c != nullptr; c = c->next)
+        {
+            for (unsigned i = 0; i < num_stages; ++i)
+            {
+                snap.stages[i].allocations += c->allocations[i].load(std::memory_order_relaxed) - c->allocations_base[i];
+                snap.stages[i].bytes += c->bytes[i].load(std::memory_order_relaxed) - c->bytes_base[i];
+            }
+        }
+    }
+    for (unsigned i = 0; i < num_lock_sites; ++i)
+    {
+        snap.locks[i].acquisitions = lock_totals[i].acquisitions.load(std::memory_order_relaxed);
+        snap.locks[i].contended = lock_totals[i].contended.load(std::memory_order_relaxed);
+        snap.locks[i].wait_ns = lock_totals[i].wait_ns.load(std::memory_order_relaxed);
+        snap.locks[i].max_wait_ns = lock_totals[i].max_wait_ns.load(std::memory_order_relaxed);
+    }
+    return snap;
+}
+
+void reset()
+{
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        for (auto & totals : stage_totals)
+        {
+            totals.allocations.store(0, std::memory_order_relaxed);
+            totals.bytes.store(0, std::memory_order_relaxed);
+        }
+        for (thread_counters * c = registry; c != nullptr; c = c->next)
+        {
+            for (unsigned i = 0; i < num_stages; ++i)
+            {
+                c->allocations_base[i] = c->allocations[i].load(std::memory_order_relaxed);
+                c->bytes_base[i] = c->bytes[i].load(std::memory_order_relaxed);
+            }
+        }
+    }
+    for (auto & totals : lock_totals)
+    {
+        totals.acquisitions.store(0, std::memory_order_relaxed);
+        totals.contended.store(0, std::memory_order_relaxed);
+        totals.wait_ns.store(0, std::memory_order_relaxed);
+        totals.max_wait_ns.store(0, std::memory_order_relaxed);
+    }
+}
+
+namespace detail {
+
+stage enter_stage(stage s)
+{
+    if (counters_released) return stage::other;
+    stage previous = static_cast<stage>(counters.current);
+    counters.current = static_cast<unsigned>(s);
+    return previous;
+}
+
+void leave_stage(stage previous)
+{
+    if (counters_released) return;
+    counters.current = static_cast<unsigned>(previous);
+}
+
+void record_lock(lock_site site, bool contended, std::uint64_t wait_ns)
+{
+    auto & totals = lock_totals[static_cast<unsigned>(site)];
+    totals.acquisitions.fetch_add(1, std::memory_order_relaxed);
+    if (!contended) return;
+    totals.contended.fetch_add(1, std::memory_order_relaxed);
+    totals.wait_ns.fetch_add(wait_ns, std::memory_order_relaxed);
+    std::uint64_t max = totals.max_wait_ns.load(std::memory_order_relaxed);
+    while (wait_ns > max && !totals.max_wait_ns.compare_exchange_weak(max, wait_ns, std::memory_order_relaxed)) {}
+}
+
+} // namespace detail
+
+void report(std::ostream & out)
+{
+    snapshot snap = get_snapshot();
+    std::ios_base::fmtflags flags = out.flags();
+    out << std::fixed << std::setprecision(3);
+    for (unsigned i = 0; i < num_stages; ++i)
+    {
+        auto const& s = snap.stages[i];
+        if (s.allocations == 0) continue;
+        out << std::setw(10) << s.allocations << " allocs (" << std::setw(12) << s.bytes << " bytes)"
+            << " | stage " << stage_name(static_cast<stage>(i)) << std::endl;
+    }
+    for (unsigned i = 0; i < num_lock_sites; ++i)
+    {
+        auto const& l = snap.locks[i];
+        if (l.acquisitions == 0) continue;
+        out << std::setw(10) << l.wait_ns * 1e-6 << " ms wait (max " << l.max_wait_ns * 1e-6 << " ms, "
+            << l.contended << "/" << l.acquisitions << " contended)"
+            << " | lock " << lock_site_name(static_cast<lock_site>(i)) << std::endl;
+    }
+    out.flags(flags);
+}
+
+#else
+
+void report(std::ostream & out)
+{
+    out << "instrumentation not available (build with ENABLE_INSTRUMENTATION=True)" << std::endl;
+}
+
+#endif
+
+}}
+
+#ifdef MAPNIK_INSTRUMENTATION
+
+// Replacement global allocation functions, counting every heap allocation
+// made by the process while instrumentation is enabled.
+
+void * operator new(std::size_t size)
+{
+    return mapnik::instrumentation::allocate(size);
+}
+
+void * operator new[](std::size_t size)
+{
+    return mapnik::instrumentation::allocate(size);
+}
+
+void * operator new(std::size_t size, std::nothrow_t const&) noexcept
+{
+    return mapnik::instrumentation::allocate_nothrow(size);
+}
+
+void * operator new[](std::size_t size, std::nothrow_t const&) noexcept
+{
+    return mapnik::instrumentation::allocate_nothrow(size);
+}
+
+void operator delete(void * ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void * ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void * ptr, std::nothrow_t const&) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void * ptr, std::nothrow_t const&) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void * ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void * ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+#endif
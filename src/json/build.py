@@ -42,7 +42,9 @@ source = Split(
     geometry_from_geojson.cpp
     mapnik_feature_to_geojson.cpp
     mapnik_geometry_to_geojson.cpp
+    geojson_writer.cpp
     extract_bounding_boxes_x3.cpp
+    feature_builder.cpp
     """
     )
 
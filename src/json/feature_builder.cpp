@@ -0,0 +1,580 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2017 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+// mapnik
+#include <mapnik/json/feature_builder.hpp>
+#include <mapnik/json/json_tokenizer.hpp>
+#include <mapnik/json/json_value.hpp>
+#include <mapnik/json/attribute_value_visitor.hpp>
+#include <mapnik/geometry/geometry_types.hpp>
+#include <mapnik/geometry/correct.hpp>
+#include <mapnik/geometry/box2d.hpp>
+
+// stl
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace mapnik { namespace json {
+
+namespace {
+
+using mapnik::geometry::geometry_types;
+
+geometry_types to_geometry_type(std::string const& name)
+{
+    if (name == "Point") return geometry_types::Point;
+    else if (name == "LineString") return geometry_types::LineString;
+    else if (name == "Polygon") return geometry_types::Polygon;
+    else if (name == "MultiPoint") return geometry_types::MultiPoint;
+    else if (name == "MultiLineString") return geometry_types::MultiLineString;
+    else if (name == "MultiPolygon") return geometry_types::MultiPolygon;
+    else if (name == "GeometryCollection") return geometry_types::GeometryCollection;
+    throw std::runtime_error("Unknown GeoJSON geometry type: " + name);
+}
+
+class geojson_builder
+{
+public:
+    geojson_builder(char const* start, char const* end)
+        : tok_(start, end),
+          end_(end) {}
+
+    void read_feature(feature_impl & feature, mapnik::transcoder const& tr, std::set<std::string> const* names)
+    {
+        tok_.expect('{');
+        if (tok_.consume('}')) return;
+        do
+        {
+            tok_.read_string(key_);
+            tok_.expect(':');
+            if (key_ == "type")
+            {
+                tok_.read_string(str_);
+                if (str_ != "Feature") tok_.error("expected \"Feature\"");
+            }
+            else if (key_ == "geometry")
+            {
+                read_geometry(feature.get_geometry());
+            }
+            else if (key_ == "properties")
+            {
+                read_properties(feature, tr, names);
+            }
+            else
+            {
+                tok_.skip_value();
+            }
+        }
+        while (tok_.consume(','));
+        tok_.expect('}');
+    }
+
+    void read_geometry(mapnik::geometry::geometry<double> & geom)
+    {
+        if (tok_.consume_literal("null"))
+        {
+            geom = mapnik::geometry::geometry_empty();
+            return;
+        }
+        tok_.expect('{');
+        geometry_types type = geometry_types::Unknown;
+        mapnik::geometry::geometry_collection<double> collection;
+        char const* coordinates = nullptr;
+        bool has_coordinates = false;
+        if (!tok_.consume('}'))
+        {
+            do
+            {
+                tok_.read_string(key_);
+                tok_.expect(':');
+                if (key_ == "type")
+                {
+                    tok_.read_string(str_);
+                    type = to_geometry_type(str_);
+                }
+                else if (key_ == "coordinates")
+                {
+                    if (type != geometry_types::Unknown && type != geometry_types::GeometryCollection)
+                    {
+                        read_positions(geom, type);
+                        has_coordinates = true;
+                    }
+                    else
+                    {
+                        // type not known yet, come back once it is
+                        tok_.skip_whitespace();
+                        coordinates = tok_.position();
+                        tok_.skip_value();
+                    }
+                }
+                else if (key_ == "geometries")
+                {
+                    tok_.expect('[');
+                    if (!tok_.consume(']'))
+                    {
+                        do
+                        {
+                            mapnik::geometry::geometry<double> member;
+                            read_geometry(member);
+                            collection.push_back(std::move(member));
+                        }
+                        while (tok_.consume(','));
+                        tok_.expect(']');
+                    }
+                }
+                else
+                {
+                    tok_.skip_value();
+                }
+            }
+            while (tok_.consume(','));
+            tok_.expect('}');
+        }
+
+        if (type == geometry_types::GeometryCollection)
+        {
+            geom = std::move(collection);
+        }
+        else if (!has_coordinates)
+        {
+            if (type == geometry_types::Unknown || coordinates == nullptr)
+            {
+                tok_.error("expected GeoJSON geometry \"type\" and \"coordinates\"");
+            }
+            json_tokenizer next = tok_;
+            tok_ = json_tokenizer(coordinates, end_);
+            read_positions(geom, type);
+            tok_ = next;
+        }
+    }
+
+private:
+    void read_position(double & x, double & y)
+    {
+        tok_.expect('[');
+        x = tok_.read_double();
+        tok_.expect(',');
+        y = tok_.read_double();
+        while (tok_.consume(','))
+        {
+            tok_.read_double(); // ignore altitude etc
+        }
+        tok_.expect(']');
+    }
+
+    template <typename Points>
+    void read_points(Points & pts)
+    {
+        tok_.expect('[');
+        if (tok_.consume(']')) return;
+        do
+        {
+            double x, y;
+            read_position(x, y);
+            pts.emplace_back(x, y);
+        }
+        while (tok_.consume(','));
+        tok_.expect(']');
+    }
+
+    void read_rings(mapnik::geometry::polygon<double> & poly)
+    {
+        tok_.expect('[');
+        do
+        {
+            mapnik::geometry::linear_ring<double> ring;
+            read_points(ring);
+            poly.push_back(std::move(ring));
+        }
+        while (tok_.consume(','));
+        tok_.expect(']');
+    }
+
+    void read_positions(mapnik::geometry::geometry<double> & geom, geometry_types type)
+    {
+        switch (type)
+        {
+        case geometry_types::Point:
+        {
+            mapnik::geometry::point<double> pt;
+            read_position(pt.x, pt.y);
+            geom = std::move(pt);
+            break;
+        }
+        case geometry_types::LineString:
+        {
+            mapnik::geometry::line_string<double> line;
+            read_points(line);
+            geom = std::move(line);
+            break;
+        }
+        case geometry_types::Polygon:
+        {
+            mapnik::geometry::polygon<double> poly;
+            read_rings(poly);
+            geom = std::move(poly);
+            mapnik::geometry::correct(geom);
+            break;
+        }
+        case geometry_types::MultiPoint:
+        {
+            mapnik::geometry::multi_point<double> multi_point;
+            read_points(multi_point);
+            geom = std::move(multi_point);
+            break;
+        }
+        case geometry_types::MultiLineString:
+        {
+            mapnik::geometry::multi_line_string<double> multi_line;
+            tok_.expect('[');
+            do
+            {
+                mapnik::geometry::line_string<double> line;
+                read_points(line);
+                multi_line.push_back(std::move(line));
+            }
+            while (tok_.consume(','));
+            tok_.expect(']');
+            geom = std::move(multi_line);
+            break;
+        }
+        case geometry_types::MultiPolygon:
+        {
+            mapnik::geometry::multi_polygon<double> multi_poly;
+            tok_.expect('[');
+            do
+            {
+                mapnik::geometry::polygon<double> poly;
+                read_rings(poly);
+                multi_poly.push_back(std::move(poly));
+            }
+            while (tok_.consume(','));
+            tok_.expect(']');
+            geom = std::move(multi_poly);
+            mapnik::geometry::correct(geom);
+            break;
+        }
+        default:
+            tok_.error("unexpected GeoJSON geometry type");
+        }
+    }
+
+    void read_properties(feature_impl & feature, mapnik::transcoder const& tr, std::set<std::string> const* names)
+    {
+        if (tok_.consume_literal("null")) return;
+        tok_.expect('{');
+        if (tok_.consume('}')) return;
+        do
+        {
+            tok_.read_string(key_);
+            tok_.expect(':');
+            if (names != nullptr && names->find(key_) == names->end())
+            {
+                tok_.skip_value();
+            }
+            else
+            {
+                feature.put_new(key_, read_property(tr));
+            }
+        }
+        while (tok_.consume(','));
+        tok_.expect('}');
+    }
+
+    mapnik::value read_property(mapnik::transcoder const& tr)
+    {
+        switch (tok_.peek())
+        {
+        case '"':
+            tok_.read_string(str_);
+            return mapnik::value(tr.transcode(str_.data(), static_cast<std::int32_t>(str_.size())));
+        case '{':
+        case '[':
+        {
+            // nested values are kept as their JSON text
+            json_value val = read_value();
+            return util::apply_visitor(attribute_value_visitor(tr), val);
+        }
+        case 't':
+            if (!tok_.consume_literal("true")) tok_.error("invalid literal");
+            return mapnik::value(true);
+        case 'f':
+            if (!tok_.consume_literal("false")) tok_.error("invalid literal");
+            return mapnik::value(false);
+        case 'n':
+            if (!tok_.consume_literal("null")) tok_.error("invalid literal");
+            return mapnik::value(mapnik::value_null());
+        default:
+        {
+            value_integer integer;
+            double real;
+            if (tok_.read_number(integer, real)) return mapnik::value(integer);
+            return mapnik::value(real);
+        }
+        }
+    }
+
+    json_value read_value()
+    {
+        switch (tok_.peek())
+        {
+        case '"':
+        {
+            std::string str;
+            tok_.read_string(str);
+            return json_value(std::move(str));
+        }
+        case '{':
+        {
+            json_object object;
+            tok_.expect('{');
+            if (!tok_.consume('}'))
+            {
+                do
+                {
+                    std::string name;
+                    tok_.read_string(name);
+                    tok_.expect(':');
+                    object.emplace_back(std::move(name), read_value());
+                }
+                while (tok_.consume(','));
+                tok_.expect('}');
+            }
+            return json_value(std::move(object));
+        }
+        case '[':
+        {
+            json_array array;
+            tok_.expect('[');
+            if (!tok_.consume(']'))
+            {
+                do
+                {
+                    array.push_back(read_value());
+                }
+                while (tok_.consume(','));
+                tok_.expect(']');
+            }
+            return json_value(std::move(array));
+        }
+        case 't':
+            if (!tok_.consume_literal("true")) tok_.error("invalid literal");
+            return json_value(true);
+        case 'f':
+            if (!tok_.consume_literal("false")) tok_.error("invalid literal");
+            return json_value(false);
+        case 'n':
+            if (!tok_.consume_literal("null")) tok_.error("invalid literal");
+            return json_value(value_null());
+        default:
+        {
+            value_integer integer;
+            double real;
+            if (tok_.read_number(integer, real)) return json_value(integer);
+            return json_value(real);
+        }
+        }
+    }
+
+    json_tokenizer tok_;
+    char const* end_;
+    std::string key_;
+    std::string str_;
+};
+
+// bounding box of GeoJSON positions nested `level` arrays deep; as with
+// extract_bounding_boxes only exterior rings contribute to polygons
+template <typename Box>
+void positions_box(json_tokenizer & tok, Box & box, int level, bool include)
+{
+    if (level == 1)
+    {
+        tok.expect('[');
+        double x = tok.read_double();
+        tok.expect(',');
+        double y = tok.read_double();
+        while (tok.consume(',')) tok.read_double();
+        tok.expect(']');
+        if (include)
+        {
+            if (!box.valid()) box.init(x, y);
+            else box.expand_to_include(x, y);
+        }
+        return;
+    }
+    tok.expect('[');
+    if (tok.consume(']')) return;
+    std::size_t index = 0;
+    do
+    {
+        positions_box(tok, box, level - 1, include && (level != 3 || index == 0));
+        ++index;
+    }
+    while (tok.consume(','));
+    tok.expect(']');
+}
+
+// number of nested arrays in positions starting at `itr`, an empty innermost
+// array is a ring without points
+int positions_level(char const* itr, char const* end)
+{
+    int level = 0;
+    for (; itr != end; ++itr)
+    {
+        char c = *itr;
+        if (c == '[') ++level;
+        else if (c == ']') return level + 1;
+        else if (c != ' ' && c != '\n' && c != '\r' && c != '\t' && c != '\v' && c != '\f') break;
+    }
+    return level;
+}
+
+// Scan a single feature object for its "coordinates". Like the X3 bounding box
+// grammar this only tracks braces and strings rather than validating the
+// feature, which is left to the feature parser.
+template <typename Box>
+char const* feature_box(char const* itr, char const* end, Box & box)
+{
+    static char const coordinates[] = "\"coordinates\"";
+    static char const feature_collection[] = "\"FeatureCollection\"";
+    std::size_t depth = 0;
+    while (itr != end)
+    {
+        char c = *itr;
+        if (c == '{')
+        {
+            ++depth;
+            ++itr;
+        }
+        else if (c == '}')
+        {
+            ++itr;
+            if (--depth == 0) return itr;
+        }
+        else if (c == '"')
+        {
+            char const* str = itr++;
+            while (itr != end && *itr != '"')
+            {
+                if (*itr++ == '\\' && itr != end) ++itr;
+            }
+            if (itr == end) break;
+            ++itr;
+            std::size_t length = static_cast<std::size_t>(itr - str);
+            if (length == sizeof(feature_collection) - 1
+                && std::memcmp(str, feature_collection, length) == 0)
+            {
+                throw std::runtime_error("Unexpected nested FeatureCollection");
+            }
+            if (length == sizeof(coordinates) - 1
+                && std::memcmp(str, coordinates, length) == 0)
+            {
+                json_tokenizer tok(itr, end);
+                if (tok.consume(':') && tok.peek() == '[')
+                {
+                    int level = positions_level(tok.position(), end);
+                    positions_box(tok, box, level, true);
+                    itr = tok.position();
+                }
+            }
+        }
+        else
+        {
+            ++itr;
+        }
+    }
+    throw std::runtime_error("Unterminated GeoJSON feature");
+}
+
+} // anonymous ns
+
+void build_feature(char const* start, char const* end, feature_impl & feature,
+                   mapnik::transcoder const& tr, std::set<std::string> const* names)
+{
+    geojson_builder builder(start, end);
+    builder.read_feature(feature, tr, names);
+}
+
+void build_geometry(char const* start, char const* end, mapnik::geometry::geometry<double> & geom)
+{
+    geojson_builder builder(start, end);
+    builder.read_geometry(geom);
+}
+
+template <typename Boxes>
+void scan_bounding_boxes(char const*& start, char const* end, Boxes & boxes)
+{
+    using box_type = typename Boxes::value_type::first_type;
+    json_tokenizer tok(start, end);
+    std::string key;
+    tok.expect('{');
+    do
+    {
+        tok.read_string(key);
+        tok.expect(':');
+        if (key == "type")
+        {
+            tok.read_string(key);
+            if (key != "FeatureCollection") tok.error("expected \"FeatureCollection\"");
+        }
+        else if (key == "features")
+        {
+            tok.expect('[');
+            if (!tok.consume(']'))
+            {
+                do
+                {
+                    if (tok.peek() != '{') tok.error("expected GeoJSON Feature");
+                    char const* feature_start = tok.position();
+                    mapnik::box2d<double> box;
+                    char const* feature_end = feature_box(feature_start, end, box);
+                    if (box.valid())
+                    {
+                        boxes.emplace_back(box_type(box.minx(), box.miny(), box.maxx(), box.maxy()),
+                                           std::make_pair(static_cast<std::uint64_t>(feature_start - start),
+                                                          static_cast<std::uint64_t>(feature_end - feature_start)));
+                    }
+                    tok = json_tokenizer(feature_end, end);
+                }
+                while (tok.consume(','));
+                tok.expect(']');
+            }
+        }
+        else
+        {
+            tok.skip_value();
+        }
+    }
+    while (tok.consume(','));
+    tok.expect('}');
+    tok.skip_whitespace();
+    start = tok.position();
+}
+
+using boxes_type = std::vector<std::pair<mapnik::box2d<double>, std::pair<std::uint64_t, std::uint64_t>>>;
+using boxes_type_f = std::vector<std::pair<mapnik::box2d<float>, std::pair<std::uint64_t, std::uint64_t>>>;
+template void scan_bounding_boxes<boxes_type>(char const*&, char const*, boxes_type&);
+template void scan_bounding_boxes<boxes_type_f>(char const*&, char const*, boxes_type_f&);
+
+}}
@@ -0,0 +1,389 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2017 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+// mapnik
+#include <mapnik/json/geojson_writer.hpp>
+#include <mapnik/feature.hpp>
+#include <mapnik/value.hpp>
+#include <mapnik/unicode.hpp>
+#include <mapnik/util/conversions.hpp>
+// stl
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+
+namespace mapnik { namespace json {
+
+namespace {
+
+constexpr int max_exact_power = 22;
+// significant digits of the scaled value that fit exactly in a double
+constexpr unsigned max_fast_precision = 15;
+
+// 10^0 .. 10^22 are exactly representable as doubles
+constexpr double powers_of_ten[max_exact_power + 1] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+constexpr double negative_powers_of_ten[max_exact_power + 1] = {
+    1e-0, 1e-1, 1e-2, 1e-3, 1e-4, 1e-5, 1e-6, 1e-7, 1e-8, 1e-9, 1e-10, 1e-11,
+    1e-12, 1e-13, 1e-14, 1e-15, 1e-16, 1e-17, 1e-18, 1e-19, 1e-20, 1e-21, 1e-22
+};
+
+// writes the decimal digits of `val` backwards, ending at `end`
+char * format_unsigned(std::uint64_t val, char * end)
+{
+    do
+    {
+        *--end = static_cast<char>('0' + val % 10);
+        val /= 10;
+    }
+    while (val != 0);
+    return end;
+}
+
+// floor(log10(val)) for positive finite `val`, saturating just outside the
+// tabulated range
+int decimal_exponent(double val)
+{
+    int exponent = 0;
+    if (val >= 1.0)
+    {
+        while (exponent <= max_exact_power && val >= powers_of_ten[exponent]) ++exponent;
+        return exponent - 1;
+    }
+    while (exponent <= max_exact_power && val < negative_powers_of_ten[exponent]) ++exponent;
+    return -exponent;
+}
+
+// appends the significant `digits` in fixed notation, the first
+// `integral_digits` of them (which may be negative, or exceed their
+// count) in front of the decimal point
+void append_fixed(std::string & out, bool negative, char const* begin, char const* end,
+                  std::ptrdiff_t integral_digits)
+{
+    if (negative) out += '-';
+    std::ptrdiff_t count = end - begin;
+    if (integral_digits <= 0)
+    {
+        out += '0';
+        out += '.';
+        out.append(static_cast<std::size_t>(-integral_digits), '0');
+        out.append(begin, end);
+    }
+    else if (integral_digits >= count)
+    {
+        out.append(begin, end);
+        out.append(static_cast<std::size_t>(integral_digits - count), '0');
+    }
+    else
+    {
+        out.append(begin, begin + integral_digits);
+        out += '.';
+        out.append(begin + integral_digits, end);
+    }
+}
+
+void escape(std::string & out, std::string const& str)
+{
+    static const char hex[] = "0123456789abcdef";
+    out += '"';
+    auto begin = str.begin();
+    for (auto itr = begin; itr != str.end(); ++itr)
+    {
+        unsigned char c = static_cast<unsigned char>(*itr);
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+        out.append(begin, itr);
+        begin = itr + 1;
+        switch (c)
+        {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\b': out += "\\b"; break;
+        case '\f': out += "\\f"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            out += "\\u00";
+            out += hex[c >> 4];
+            out += hex[c & 0xf];
+        }
+    }
+    out.append(begin, str.end());
+    out += '"';
+}
+
+struct geometry_writer
+{
+    geometry_writer(geojson_writer & writer)
+        : writer_(writer),
+          out_(writer.output()) {}
+
+    void operator()(geometry::geometry_empty const&) const
+    {
+        out_ += "null";
+    }
+
+    void operator()(geometry::point<double> const& pt) const
+    {
+        out_ += "{\"type\":\"Point\",\"coordinates\":";
+        coordinates(pt);
+        out_ += '}';
+    }
+
+    void operator()(geometry::line_string<double> const& line) const
+    {
+        out_ += "{\"type\":\"LineString\",\"coordinates\":";
+        coordinates(line);
+        out_ += '}';
+    }
+
+    void operator()(geometry::polygon<double> const& poly) const
+    {
+        out_ += "{\"type\":\"Polygon\",\"coordinates\":";
+        coordinates(poly);
+        out_ += '}';
+    }
+
+    void operator()(geometry::multi_point<double> const& multi_pt) const
+    {
+        out_ += "{\"type\":\"MultiPoint\",\"coordinates\":";
+        coordinates(multi_pt);
+        out_ += '}';
+    }
+
+    void operator()(geometry::multi_line_string<double> const& multi_line) const
+    {
+        out_ += "{\"type\":\"MultiLineString\",\"coordinates\":";
+        coordinates(multi_line);
+        out_ += '}';
+    }
+
+    void operator()(geometry::multi_polygon<double> const& multi_poly) const
+    {
+        out_ += "{\"type\":\"MultiPolygon\",\"coordinates\":";
+        coordinates(multi_poly);
+        out_ += '}';
+    }
+
+    void operator()(geometry::geometry_collection<double> const& collection) const
+    {
+        out_ += "{\"type\":\"GeometryCollection\",\"geometries\":[";
+        bool first = true;
+        for (auto const& geom : collection)
+        {
+            if (first) first = false;
+            else out_ += ',';
+            util::apply_visitor(*this, geom);
+        }
+        out_ += "]}";
+    }
+
+    void coordinates(geometry::point<double> const& pt) const
+    {
+        out_ += '[';
+        writer_.write_number(pt.x);
+        out_ += ',';
+        writer_.write_number(pt.y);
+        out_ += ']';
+    }
+
+    // line strings, rings, polygons and the multi geometries are all
+    // (nested) sequences of points
+    template <typename Container>
+    void coordinates(Container const& container) const
+    {
+        out_ += '[';
+        bool first = true;
+        for (auto const& item : container)
+        {
+            if (first) first = false;
+            else out_ += ',';
+            coordinates(item);
+        }
+        out_ += ']';
+    }
+
+    geojson_writer & writer_;
+    std::string & out_;
+};
+
+struct value_writer
+{
+    value_writer(geojson_writer & writer, std::string & scratch)
+        : writer_(writer),
+          scratch_(scratch) {}
+
+    void operator()(value_null) const
+    {
+        writer_.output() += "null";
+    }
+
+    void operator()(value_bool val) const
+    {
+        writer_.output() += val ? "true" : "false";
+    }
+
+    void operator()(value_integer val) const
+    {
+        writer_.write_number(val);
+    }
+
+    // same formatting as value::to_string()
+    void operator()(value_double val) const
+    {
+        util::to_string(scratch_, val);
+        writer_.output() += scratch_;
+    }
+
+    void operator()(value_unicode_string const& val) const
+    {
+        to_utf8(val, scratch_);
+        writer_.write_string(scratch_);
+    }
+
+    geojson_writer & writer_;
+    std::string & scratch_;
+};
+
+}
+
+geojson_writer::geojson_writer(std::string & out, unsigned precision)
+    : out_(out),
+      precision_(std::max(1u, std::min(17u, precision))),
+      scratch_() {}
+
+void geojson_writer::write(feature_impl const& feature)
+{
+    out_ += "{\"type\":\"Feature\",\"id\":";
+    write_number(feature.id());
+    out_ += ",\"geometry\":";
+    write(feature.get_geometry());
+    out_ += ",\"properties\":";
+    write_properties(feature);
+    out_ += '}';
+}
+
+void geojson_writer::write(geometry::geometry<double> const& geom)
+{
+    util::apply_visitor(geometry_writer(*this), geom);
+}
+
+void geojson_writer::write(value const& val)
+{
+    util::apply_visitor(value_writer(*this, scratch_), val);
+}
+
+void geojson_writer::write_properties(feature_impl const& feature)
+{
+    out_ += '{';
+    bool first = true;
+    for (auto itr = feature.begin(), end = feature.end(); itr != end; ++itr)
+    {
+        // null properties are omitted
+        value const& val = std::get<1>(*itr);
+        if (val.is_null()) continue;
+        if (first) first = false;
+        else out_ += ',';
+        escape(out_, std::get<0>(*itr));
+        out_ += ':';
+        write(val);
+    }
+    out_ += '}';
+}
+
+void geojson_writer::write_number(double val)
+{
+    if (!std::isfinite(val))
+    {
+        // not representable in JSON
+        out_ += "null";
+        return;
+    }
+    if (val == 0.0)
+    {
+        out_ += '0';
+        return;
+    }
+    double abs = std::fabs(val);
+    int decimals = static_cast<int>(precision_) - 1 - decimal_exponent(abs);
+    if (decimals < 0 || decimals > max_exact_power || precision_ > max_fast_precision)
+    {
+        // let printf round, then spell its digits out in fixed notation
+        char buf[32];
+        int size = std::snprintf(buf, sizeof(buf), "%.*e", static_cast<int>(precision_) - 1, abs);
+        char * exponent = std::find(buf, buf + size, 'e');
+        char digits[24];
+        char * end = digits;
+        for (char * itr = buf; itr != exponent; ++itr)
+        {
+            if (*itr != '.') *end++ = *itr;
+        }
+        while (end - digits > 1 && *(end - 1) == '0') --end;
+        append_fixed(out_, val < 0, digits, end, std::atoi(exponent + 1) + 1);
+        return;
+    }
+    // the scaled value stays below 2^53, so its integral part is exact;
+    // only near a tie can the rounded product round the wrong way, then
+    // decide from the exact product
+    double scale = powers_of_ten[decimals];
+    double scaled = abs * scale;
+    double integral = std::floor(scaled);
+    double fraction = scaled - integral;
+    if (std::fabs(fraction - 0.5) <= scaled * std::numeric_limits<double>::epsilon())
+    {
+        fraction = std::fma(abs, scale, -integral);
+    }
+    std::uint64_t digits = static_cast<std::uint64_t>(integral) + (fraction >= 0.5 ? 1 : 0);
+    char buf[48];
+    char * end = buf + sizeof(buf);
+    char * begin = format_unsigned(digits, end);
+    // drop trailing zeros of the fraction
+    while (decimals > 0 && *(end - 1) == '0')
+    {
+        --end;
+        --decimals;
+    }
+    append_fixed(out_, val < 0, begin, end, (end - begin) - decimals);
+}
+
+void geojson_writer::write_number(value_integer val)
+{
+    char buf[24];
+    char * end = buf + sizeof(buf);
+    std::uint64_t abs = val < 0 ? 0 - static_cast<std::uint64_t>(val) : static_cast<std::uint64_t>(val);
+    char * begin = format_unsigned(abs, end);
+    if (val < 0) *--begin = '-';
+    out_.append(begin, end);
+}
+
+void geojson_writer::write_string(std::string const& str)
+{
+    escape(out_, str);
+}
+
+}}
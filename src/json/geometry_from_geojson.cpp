@@ -23,24 +23,17 @@
 
 // mapnik
 #include <mapnik/json/geometry_parser.hpp>
-#include <mapnik/json/json_grammar_config.hpp>
-#include <mapnik/json/feature_grammar_x3.hpp>
+#include <mapnik/json/feature_builder.hpp>
 
 namespace mapnik { namespace json {
 
 bool from_geojson(std::string const& json, mapnik::geometry::geometry<double> & geom)
 {
-    namespace x3 = boost::spirit::x3;
-    using space_type = mapnik::json::grammar::space_type;
-    auto grammar = mapnik::json::geometry_grammar();
     try
     {
         const char* start = json.c_str();
         const char* end = start + json.length();
-        if (!x3::phrase_parse(start, end, grammar, space_type(), geom))
-        {
-            throw std::runtime_error("Can't parser GeoJSON Geometry");
-        }
+        build_geometry(start, end, geom);
     }
     catch(...) { return false; }
 
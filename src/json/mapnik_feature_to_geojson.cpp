@@ -22,19 +22,14 @@
 
 // mapnik
 #include <mapnik/util/feature_to_geojson.hpp>
-#include <mapnik/json/feature_generator_grammar.hpp>
-
-// boost
-#include <boost/spirit/include/karma.hpp>
 
 namespace mapnik { namespace util {
 
-bool to_geojson(std::string & json, mapnik::feature_impl const& feature)
+bool to_geojson(std::string & json, mapnik::feature_impl const& feature, unsigned precision)
 {
-    using sink_type = std::back_insert_iterator<std::string>;
-    static const mapnik::json::feature_generator_grammar<sink_type, mapnik::feature_impl> grammar;
-    sink_type sink(json);
-    return boost::spirit::karma::generate(sink, grammar, feature);
+    mapnik::json::geojson_writer writer(json, precision);
+    writer.write(feature);
+    return true;
 }
 
 }}
@@ -22,16 +22,14 @@
 
 // mapnik
 #include <mapnik/util/geometry_to_geojson.hpp>
-#include <mapnik/json/geometry_generator_grammar.hpp>
 
 namespace mapnik { namespace util {
 
-bool to_geojson(std::string & json, mapnik::geometry::geometry<double> const& geom)
+bool to_geojson(std::string & json, mapnik::geometry::geometry<double> const& geom, unsigned precision)
 {
-    using sink_type = std::back_insert_iterator<std::string>;
-    static const mapnik::json::geometry_generator_grammar<sink_type, mapnik::geometry::geometry<double> > grammar;
-    sink_type sink(json);
-    return boost::spirit::karma::generate(sink, grammar, geom);
+    mapnik::json::geojson_writer writer(json, precision);
+    writer.write(geom);
+    return true;
 }
 
 }}
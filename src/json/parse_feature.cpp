@@ -21,41 +21,21 @@
  *****************************************************************************/
 
 #include <mapnik/json/parse_feature.hpp>
+#include <mapnik/json/feature_builder.hpp>
 #include <mapnik/json/json_grammar_config.hpp>
-#include <mapnik/json/feature_grammar_x3.hpp>
 
 namespace mapnik { namespace json {
 
 template <typename Iterator>
 void parse_feature(Iterator start, Iterator end, feature_impl& feature, mapnik::transcoder const& tr)
 {
-    namespace x3 = boost::spirit::x3;
-    using space_type = mapnik::json::grammar::space_type;
-#if BOOST_VERSION >= 106700
-    auto grammar = x3::with<mapnik::json::grammar::transcoder_tag>(tr)
-        [x3::with<mapnik::json::grammar::feature_tag>(feature)
-         [ mapnik::json::feature_grammar() ]];
-#else
-    auto grammar = x3::with<mapnik::json::grammar::transcoder_tag>(std::ref(tr))
-        [x3::with<mapnik::json::grammar::feature_tag>(std::ref(feature))
-         [ mapnik::json::feature_grammar() ]];
-#endif
-    if (!x3::phrase_parse(start, end, grammar, space_type()))
-    {
-        throw std::runtime_error("Can't parser GeoJSON Feature");
-    }
+    build_feature(start, end, feature, tr);
 }
 
 template <typename Iterator>
 void parse_geometry(Iterator start, Iterator end, feature_impl& feature)
 {
-    namespace x3 = boost::spirit::x3;
-    using space_type = mapnik::json::grammar::space_type;
-    auto grammar = mapnik::json::geometry_grammar();
-    if (!x3::phrase_parse(start, end, grammar, space_type(), feature.get_geometry()))
-    {
-        throw std::runtime_error("Can't parser GeoJSON Geometry");
-    }
+    build_geometry(start, end, feature.get_geometry());
 }
 
 using iterator_type = mapnik::json::grammar::iterator_type;
@@ -0,0 +1,151 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2017 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+// mapnik
+#include <mapnik/label_anchor_cache.hpp>
+#include <mapnik/instrumentation.hpp>
+#include <mapnik/geometry/interior.hpp>
+#include <mapnik/geometry/polylabel.hpp>
+
+// stl
+#include <functional>
+
+namespace mapnik {
+
+namespace {
+
+inline void hash_combine(std::size_t & seed, std::size_t value)
+{
+    seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+}
+
+label_anchor_cache::label_anchor_cache(std::size_t max_size)
+    : max_size_(max_size),
+      anchors_() {}
+
+std::size_t label_anchor_cache::key_hash::operator()(key_type const& key) const
+{
+    std::size_t seed = std::hash<std::string>()(key.layer);
+    hash_combine(seed, std::hash<value_integer>()(key.feature_id));
+    hash_combine(seed, key.geometry_hash);
+    hash_combine(seed, static_cast<std::size_t>(key.placement));
+    return seed;
+}
+
+std::size_t label_anchor_cache::hash(geometry::polygon<double> const& poly)
+{
+    std::hash<double> hasher;
+    std::size_t seed = poly.size();
+    for (auto const& ring : poly)
+    {
+        hash_combine(seed, ring.size());
+        for (auto const& pt : ring)
+        {
+            hash_combine(seed, hasher(pt.x));
+            hash_combine(seed, hasher(pt.y));
+        }
+    }
+    return seed;
+}
+
+bool label_anchor_cache::compute(label_placement_enum placement,
+                                 geometry::polygon<double> const& poly,
+                                 double scale_factor,
+                                 geometry::point<double> & pt)
+{
+    geometry::polygon<double> flipped(poly);
+    for (auto & ring : flipped)
+    {
+        for (auto & p : ring) p.y = -p.y;
+    }
+    bool found = false;
+    if (placement == INTERIOR_PLACEMENT)
+    {
+        found = geometry::interior(flipped, scale_factor, pt);
+    }
+    else if (placement == POLYLABEL_PLACEMENT)
+    {
+        double precision = geometry::polylabel_precision(flipped, scale_factor);
+        found = geometry::polylabel(flipped, precision, pt);
+    }
+    if (found) pt.y = -pt.y;
+    return found;
+}
+
+bool label_anchor_cache::anchor(key_type const& key,
+                                geometry::polygon<double> const& poly,
+                                double scale_factor,
+                                geometry::point<double> & pt)
+{
+    if (find(key, scale_factor, pt)) return true;
+    if (!compute(key.placement, poly, scale_factor, pt)) return false;
+    insert(key, scale_factor, pt);
+    return true;
+}
+
+bool label_anchor_cache::find(key_type const& key, double scale_factor, geometry::point<double> & pt) const
+{
+#ifdef MAPNIK_THREADSAFE
+    instrumentation::lock_guard<std::mutex> lock(mutex_, instrumentation::lock_site::label_anchor_cache);
+#endif
+    auto itr = anchors_.find(key);
+    // a smaller scale factor means a finer search
+    if (itr == anchors_.end() || itr->second.scale_factor > scale_factor) return false;
+    pt = itr->second.pt;
+    return true;
+}
+
+void label_anchor_cache::insert(key_type const& key, double scale_factor, geometry::point<double> const& pt)
+{
+#ifdef MAPNIK_THREADSAFE
+    instrumentation::lock_guard<std::mutex> lock(mutex_, instrumentation::lock_site::label_anchor_cache);
+#endif
+    auto itr = anchors_.find(key);
+    if (itr != anchors_.end())
+    {
+        if (scale_factor < itr->second.scale_factor) itr->second = entry{pt, scale_factor};
+    }
+    else if (max_size_ == 0 || anchors_.size() < max_size_)
+    {
+        anchors_.emplace(key, entry{pt, scale_factor});
+    }
+}
+
+std::size_t label_anchor_cache::size() const
+{
+#ifdef MAPNIK_THREADSAFE
+    instrumentation::lock_guard<std::mutex> lock(mutex_, instrumentation::lock_site::label_anchor_cache);
+#endif
+    return anchors_.size();
+}
+
+void label_anchor_cache::clear()
+{
+#ifdef MAPNIK_THREADSAFE
+    instrumentation::lock_guard<std::mutex> lock(mutex_, instrumentation::lock_site::label_anchor_cache);
+#endif
+    anchors_.clear();
+}
+
+}
@@ -41,6 +41,11 @@ layer::layer(std::string const& _name, std::string const& _srs)
       clear_label_cache_(false),
       cache_features_(false),
       group_by_(),
+      minimum_feature_size_(0.0),
+      minimum_feature_dot_(false),
+      vertex_decimation_(false),
+      polygon_batching_(false),
+      building_batching_(false),
       styles_(),
       layers_(),
       ds_(),
@@ -60,6 +65,11 @@ layer::layer(layer const& rhs)
       clear_label_cache_(rhs.clear_label_cache_),
       cache_features_(rhs.cache_features_),
       group_by_(rhs.group_by_),
+      minimum_feature_size_(rhs.minimum_feature_size_),
+      minimum_feature_dot_(rhs.minimum_feature_dot_),
+      vertex_decimation_(rhs.vertex_decimation_),
+      polygon_batching_(rhs.polygon_batching_),
+      building_batching_(rhs.building_batching_),
       styles_(rhs.styles_),
       layers_(rhs.layers_),
       ds_(rhs.ds_),
@@ -79,6 +89,11 @@ layer::layer(layer && rhs)
       clear_label_cache_(std::move(rhs.clear_label_cache_)),
       cache_features_(std::move(rhs.cache_features_)),
       group_by_(std::move(rhs.group_by_)),
+      minimum_feature_size_(std::move(rhs.minimum_feature_size_)),
+      minimum_feature_dot_(std::move(rhs.minimum_feature_dot_)),
+      vertex_decimation_(std::move(rhs.vertex_decimation_)),
+      polygon_batching_(std::move(rhs.polygon_batching_)),
+      building_batching_(std::move(rhs.building_batching_)),
       styles_(std::move(rhs.styles_)),
       layers_(std::move(rhs.layers_)),
       ds_(std::move(rhs.ds_)),
@@ -100,6 +115,11 @@ layer& layer::operator=(layer rhs)
     std::swap(this->clear_label_cache_, rhs.clear_label_cache_);
     std::swap(this->cache_features_, rhs.cache_features_);
     std::swap(this->group_by_, rhs.group_by_);
+    std::swap(this->minimum_feature_size_, rhs.minimum_feature_size_);
+    std::swap(this->minimum_feature_dot_, rhs.minimum_feature_dot_);
+    std::swap(this->vertex_decimation_, rhs.vertex_decimation_);
+    std::swap(this->polygon_batching_, rhs.polygon_batching_);
+    std::swap(this->building_batching_, rhs.building_batching_);
     std::swap(this->styles_, rhs.styles_);
     std::swap(this->ds_, rhs.ds_);
     std::swap(this->buffer_size_, rhs.buffer_size_);
@@ -120,6 +140,11 @@ bool layer::operator==(layer const& rhs) const
         (clear_label_cache_ == rhs.clear_label_cache_) &&
         (cache_features_ == rhs.cache_features_) &&
         (group_by_ == rhs.group_by_) &&
+        (minimum_feature_size_ == rhs.minimum_feature_size_) &&
+        (minimum_feature_dot_ == rhs.minimum_feature_dot_) &&
+        (vertex_decimation_ == rhs.vertex_decimation_) &&
+        (polygon_batching_ == rhs.polygon_batching_) &&
+        (building_batching_ == rhs.building_batching_) &&
         (styles_ == rhs.styles_) &&
         ((ds_ && rhs.ds_) ? *ds_ == *rhs.ds_ : ds_ == rhs.ds_) &&
         (buffer_size_ == rhs.buffer_size_) &&
@@ -301,6 +326,56 @@ std::string const& layer::group_by() const
     return group_by_;
 }
 
+void layer::set_minimum_feature_size(double size)
+{
+    minimum_feature_size_ = size;
+}
+
+double layer::minimum_feature_size() const
+{
+    return minimum_feature_size_;
+}
+
+void layer::set_minimum_feature_dot(bool dot)
+{
+    minimum_feature_dot_ = dot;
+}
+
+bool layer::minimum_feature_dot() const
+{
+    return minimum_feature_dot_;
+}
+
+void layer::set_vertex_decimation(bool decimation)
+{
+    vertex_decimation_ = decimation;
+}
+
+bool layer::vertex_decimation() const
+{
+    return vertex_decimation_;
+}
+
+void layer::set_polygon_batching(bool batching)
+{
+    polygon_batching_ = batching;
+}
+
+bool layer::polygon_batching() const
+{
+    return polygon_batching_;
+}
+
+void layer::set_building_batching(bool batching)
+{
+    building_batching_ = batching;
+}
+
+bool layer::building_batching() const
+{
+    return building_batching_;
+}
+
 void layer::set_comp_op(composite_mode_e comp_op)
 {
     comp_op_ = comp_op;
@@ -0,0 +1,135 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2017 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+// mapnik
+#include <mapnik/lazy_datasource.hpp>
+#include <mapnik/datasource_cache.hpp>
+#include <mapnik/instrumentation.hpp>
+#include <mapnik/layer.hpp>
+#include <mapnik/map.hpp>
+#include <mapnik/debug.hpp>
+
+// stl
+#include <vector>
+
+namespace mapnik {
+
+lazy_datasource::lazy_datasource(parameters const& params)
+    : datasource(params),
+      ds_() {}
+
+datasource_ptr lazy_datasource::get() const
+{
+#ifdef MAPNIK_THREADSAFE
+    instrumentation::lock_guard<std::mutex> lock(mutex_, instrumentation::lock_site::lazy_datasource);
+#endif
+    if (!ds_)
+    {
+        // concurrent queries wait here until the datasource is created
+        ds_ = datasource_cache::instance().create(params_);
+    }
+    return ds_;
+}
+
+bool lazy_datasource::initialized() const
+{
+#ifdef MAPNIK_THREADSAFE
+    instrumentation::lock_guard<std::mutex> lock(mutex_, instrumentation::lock_site::lazy_datasource);
+#endif
+    return ds_ != nullptr;
+}
+
+datasource::datasource_t lazy_datasource::type() const
+{
+    return get()->type();
+}
+
+processor_context_ptr lazy_datasource::get_context(feature_style_context_map & ctx) const
+{
+    return get()->get_context(ctx);
+}
+
+featureset_ptr lazy_datasource::features_with_context(query const& q, processor_context_ptr ctx) const
+{
+    return get()->features_with_context(q, ctx);
+}
+
+boost::optional<datasource_geometry_t> lazy_datasource::get_geometry_type() const
+{
+    return get()->get_geometry_type();
+}
+
+featureset_ptr lazy_datasource::features(query const& q) const
+{
+    return get()->features(q);
+}
+
+featureset_ptr lazy_datasource::features_at_point(coord2d const& pt, double tol) const
+{
+    return get()->features_at_point(pt, tol);
+}
+
+box2d<double> lazy_datasource::envelope() const
+{
+    return get()->envelope();
+}
+
+layer_descriptor lazy_datasource::get_descriptor() const
+{
+    return get()->get_descriptor();
+}
+
+namespace {
+
+void collect_lazy(std::vector<layer> const& layers, std::vector<std::shared_ptr<lazy_datasource>> & output)
+{
+    for (auto const& lyr : layers)
+    {
+        auto ds = std::dynamic_pointer_cast<lazy_datasource>(lyr.datasource());
+        if (ds) output.push_back(ds);
+        collect_lazy(lyr.layers(), output);
+    }
+}
+
+}
+
+std::future<void> warm_up_datasources(Map const& map)
+{
+    std::vector<std::shared_ptr<lazy_datasource>> datasources;
+    collect_lazy(map.layers(), datasources);
+    return std::async(std::launch::async, [datasources]()
+    {
+        for (auto const& ds : datasources)
+        {
+            try
+            {
+                ds->get();
+            }
+            catch (std::exception const& ex)
+            {
+                MAPNIK_LOG_ERROR(lazy_datasource) << "warm_up_datasources: " << ex.what();
+            }
+        }
+    });
+}
+
+}
@@ -34,6 +34,7 @@
 #include <mapnik/feature_type_style.hpp>
 #include <mapnik/layer.hpp>
 #include <mapnik/datasource_cache.hpp>
+#include <mapnik/lazy_datasource.hpp>
 #include <mapnik/font_engine_freetype.hpp>
 #include <mapnik/font_set.hpp>
 #include <mapnik/xml_loader.hpp>
@@ -743,6 +744,41 @@ void map_parser::parse_layer(Parent & parent, xml_node const& node)
             lyr.set_group_by(* group_by);
         }
 
+        optional<double> minimum_feature_size =
+            node.get_opt_attr<double>("minimum-feature-size");
+        if (minimum_feature_size)
+        {
+            lyr.set_minimum_feature_size(* minimum_feature_size);
+        }
+
+        optional<mapnik::boolean_type> minimum_feature_dot =
+            node.get_opt_attr<mapnik::boolean_type>("minimum-feature-dot");
+        if (minimum_feature_dot)
+        {
+            lyr.set_minimum_feature_dot(* minimum_feature_dot);
+        }
+
+        optional<mapnik::boolean_type> vertex_decimation =
+            node.get_opt_attr<mapnik::boolean_type>("vertex-decimation");
+        if (vertex_decimation)
+        {
+            lyr.set_vertex_decimation(* vertex_decimation);
+        }
+
+        optional<mapnik::boolean_type> polygon_batching =
+            node.get_opt_attr<mapnik::boolean_type>("polygon-batching");
+        if (polygon_batching)
+        {
+            lyr.set_polygon_batching(* polygon_batching);
+        }
+
+        optional<mapnik::boolean_type> building_batching =
+            node.get_opt_attr<mapnik::boolean_type>("building-batching");
+        if (building_batching)
+        {
+            lyr.set_building_batching(* building_batching);
+        }
+
         optional<int> buffer_size = node.get_opt_attr<int>("buffer-size");
         if (buffer_size)
         {
@@ -856,8 +892,22 @@ void map_parser::parse_layer(Parent & parent, xml_node const& node)
                 //now we are ready to create datasource
                 try
                 {
-                    std::shared_ptr<datasource> ds =
-                        datasource_cache::instance().create(params);
+                    std::shared_ptr<datasource> ds;
+                    if (*params.get<mapnik::boolean_type>("lazy", false))
+                    {
+                        // defer creating the datasource to the first query
+                        params.erase("lazy");
+                        if (!params.get<std::string>("type"))
+                        {
+                            throw config_error(std::string("Could not create datasource. Required ") +
+                                               "parameter 'type' is missing");
+                        }
+                        ds = std::make_shared<lazy_datasource>(params);
+                    }
+                    else
+                    {
+                        ds = datasource_cache::instance().create(params);
+                    }
                     lyr.set_datasource(ds);
                 }
                 catch (std::exception const& ex)
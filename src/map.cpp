@@ -35,6 +35,11 @@
 #include <mapnik/view_transform.hpp>
 #include <mapnik/filter_featureset.hpp>
 #include <mapnik/hit_test_filter.hpp>
+#include <mapnik/proj_strategy.hpp>
+#include <mapnik/view_strategy.hpp>
+#include <mapnik/geometry/transform.hpp>
+#include <mapnik/geometry/strategy.hpp>
+#include <mapnik/geometry/envelope.hpp>
 #include <mapnik/scale_denominator.hpp>
 #include <mapnik/config_error.hpp>
 #include <mapnik/config.hpp> // for PROJ_ENVELOPE_POINTS
@@ -43,6 +48,7 @@
 #include <mapnik/font_engine_freetype.hpp>
 
 // stl
+#include <algorithm>
 #include <stdexcept>
 
 namespace mapnik
@@ -75,7 +81,8 @@ Map::Map()
     extra_params_(),
     font_directory_(),
     font_file_mapping_(),
-    font_memory_cache_() {}
+    font_memory_cache_(),
+    label_anchor_cache_() {}
 
 Map::Map(int width,int height, std::string const& srs)
     : width_(width),
@@ -89,7 +96,8 @@ Map::Map(int width,int height, std::string const& srs)
       extra_params_(),
       font_directory_(),
       font_file_mapping_(),
-      font_memory_cache_() {}
+      font_memory_cache_(),
+      label_anchor_cache_() {}
 
 Map::Map(Map const& rhs)
     : width_(rhs.width_),
@@ -111,7 +119,8 @@ Map::Map(Map const& rhs)
       font_directory_(rhs.font_directory_),
       font_file_mapping_(rhs.font_file_mapping_),
       // on copy discard memory cache
-      font_memory_cache_() {}
+      font_memory_cache_(),
+      label_anchor_cache_(rhs.label_anchor_cache_) {}
 
 
 Map::Map(Map && rhs)
@@ -133,7 +142,8 @@ Map::Map(Map && rhs)
       extra_params_(std::move(rhs.extra_params_)),
       font_directory_(std::move(rhs.font_directory_)),
       font_file_mapping_(std::move(rhs.font_file_mapping_)),
-      font_memory_cache_(std::move(rhs.font_memory_cache_)) {}
+      font_memory_cache_(std::move(rhs.font_memory_cache_)),
+      label_anchor_cache_(std::move(rhs.label_anchor_cache_)) {}
 
 Map::~Map() {}
 
@@ -166,6 +176,7 @@ void swap (Map & lhs, Map & rhs)
     std::swap(lhs.font_file_mapping_,rhs.font_file_mapping_);
     // on assignment discard memory cache
     //std::swap(lhs.font_memory_cache_,rhs.font_memory_cache_);
+    std::swap(lhs.label_anchor_cache_, rhs.label_anchor_cache_);
 }
 
 bool Map::operator==(Map const& rhs) const
@@ -188,7 +199,7 @@ bool Map::operator==(Map const& rhs) const
         (extra_params_ == rhs.extra_params_) &&
         (font_directory_ == rhs.font_directory_) &&
         (font_file_mapping_ == rhs.font_file_mapping_);
-        // Note: we don't care about font_memory_cache in comparison
+        // Note: we don't care about font_memory_cache and label_anchor_cache in comparison
 }
 
 std::map<std::string,feature_type_style> const& Map::styles() const
@@ -756,6 +767,107 @@ featureset_ptr Map::query_map_point(unsigned index, double x, double y) const
     return query_point(index,x,y);
 }
 
+std::vector<point_query_hit> Map::query_map_points(std::vector<unsigned> const& layers,
+                                                   std::vector<coord2d> const& points,
+                                                   double tolerance) const
+{
+    if (!current_extent_.valid())
+    {
+        throw std::runtime_error("query_map_points: map extent is not initialized, you need to set a valid extent before querying");
+    }
+    std::vector<point_query_hit> hits;
+    if (points.empty()) return hits;
+
+    // points ordered by x so each candidate only visits the points around it
+    std::vector<std::size_t> order(points.size());
+    for (std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&points](std::size_t a, std::size_t b)
+              { return points[a].x < points[b].x; });
+
+    view_transform tr = transform();
+    box2d<double> map_box;
+    for (auto const& pt : points)
+    {
+        box2d<double> box(pt.x - tolerance, pt.y - tolerance, pt.x + tolerance, pt.y + tolerance);
+        box = tr.backward(box);
+        if (map_box.valid()) map_box.expand_to_include(box);
+        else map_box = box;
+    }
+    map_box.clip(current_extent_);
+    if (maximum_extent_) map_box.clip(*maximum_extent_);
+    if (!map_box.valid()) return hits;
+
+    mapnik::projection dest(srs_);
+    for (unsigned index : layers)
+    {
+        if (index >= layers_.size())
+        {
+            std::ostringstream s;
+            s << "Invalid layer index passed to query_map_points: '" << index << "'";
+            if (!layers_.empty()) s << " for map with " << layers_.size() << " layers(s)";
+            else s << " (map has no layers)";
+            throw std::out_of_range(s.str());
+        }
+        mapnik::layer const& layer = layers_[index];
+        mapnik::datasource_ptr ds = layer.datasource();
+        if (!ds) continue;
+        mapnik::projection source(layer.srs());
+        proj_transform prj_trans(source, dest);
+        box2d<double> layer_box = map_box;
+        if (!prj_trans.backward(layer_box, PROJ_ENVELOPE_POINTS))
+        {
+            std::ostringstream s;
+            s << "query_map_points: could not project query extent '" << map_box << "' into layer srs";
+            throw std::runtime_error(s.str());
+        }
+        // one query per layer, shared by all points
+        query q(layer_box);
+        for (auto const& attr : ds->get_descriptor().get_descriptors())
+        {
+            q.add_property_name(attr.get_name());
+        }
+        featureset_ptr fs = ds->features(q);
+        if (!fs) continue;
+
+        proj_strategy ps(prj_trans);
+        view_strategy vs(tr);
+        geometry::strategy_group<proj_strategy, view_strategy> to_screen(ps, vs);
+        for (feature_ptr feature = fs->next(); feature; feature = fs->next())
+        {
+            auto const& geom = feature->get_geometry();
+            if (geom.is<geometry::geometry_empty>()) continue;
+            geometry::geometry<double> screen_geom;
+            try
+            {
+                screen_geom = geometry::transform<double>(geom, to_screen);
+            }
+            catch (std::runtime_error const&)
+            {
+                continue; // not representable on screen
+            }
+            box2d<double> bbox = geometry::envelope(screen_geom);
+            if (!bbox.valid()) continue;
+            bbox.pad(tolerance);
+            auto itr = std::lower_bound(order.begin(), order.end(), bbox.minx(),
+                                        [&points](std::size_t i, double x) { return points[i].x < x; });
+            for (; itr != order.end() && points[*itr].x <= bbox.maxx(); ++itr)
+            {
+                coord2d const& pt = points[*itr];
+                if (pt.y < bbox.miny() || pt.y > bbox.maxy()) continue;
+                double distance = hit_distance(screen_geom, pt.x, pt.y);
+                if (distance <= tolerance)
+                {
+                    hits.push_back(point_query_hit{*itr, index, distance, feature});
+                }
+            }
+        }
+    }
+    std::stable_sort(hits.begin(), hits.end(), [](point_query_hit const& a, point_query_hit const& b)
+                     { return a.point < b.point || (a.point == b.point && a.distance < b.distance); });
+    MAPNIK_LOG_DEBUG(map) << "map: Query at " << points.size() << " points found " << hits.size() << " features";
+    return hits;
+}
+
 
 parameters const& Map::get_extra_parameters() const
 {
@@ -26,6 +26,7 @@
 #include <mapnik/debug.hpp>
 #include <mapnik/util/fs.hpp>
 #include <mapnik/mapped_memory_cache.hpp>
+#include <mapnik/instrumentation.hpp>
 
 #pragma GCC diagnostic push
 #include <mapnik/warning_ignore.hpp>
@@ -34,52 +35,189 @@
 #include <boost/interprocess/file_mapping.hpp>
 #pragma GCC diagnostic pop
 
+#if !defined(_WINDOWS)
+#include <sys/mman.h>
+#endif
+
 namespace mapnik
 {
 
 template class singleton<mapped_memory_cache, CreateStatic>;
 
+namespace {
+
+boost::interprocess::mapped_region::advice_types to_advice(mapped_access access)
+{
+    using region = boost::interprocess::mapped_region;
+    switch (access)
+    {
+    case mapped_access::random: return region::advice_random;
+    case mapped_access::sequential: return region::advice_sequential;
+    case mapped_access::will_need: return region::advice_willneed;
+    default: break;
+    }
+    return region::advice_normal;
+}
+
+void advise(boost::interprocess::mapped_region & region, mapped_access access, bool huge_pages)
+{
+    if (region.get_size() == 0) return;
+    if (access != mapped_access::normal && !region.advise(to_advice(access)))
+    {
+        MAPNIK_LOG_DEBUG(mapped_memory_cache) << "mapped_memory_cache: access advice not supported";
+    }
+#if defined(MADV_HUGEPAGE)
+    if (huge_pages)
+    {
+        ::madvise(region.get_address(), region.get_size(), MADV_HUGEPAGE);
+    }
+#else
+    (void)huge_pages;
+#endif
+}
+
+}
+
+mapped_memory_cache::mapped_memory_cache()
+    : cache_(),
+      lru_(),
+      max_size_(0),
+      huge_pages_(false),
+      stats_() {}
+
 void mapped_memory_cache::clear()
 {
 #ifdef MAPNIK_THREADSAFE
-    std::lock_guard<std::mutex> lock(mutex_);
+    instrumentation::lock_guard<std::mutex> lock(mutex_, instrumentation::lock_site::mapped_memory_cache);
 #endif
-    return cache_.clear();
+    cache_.clear();
+    lru_.clear();
+    stats_.size = 0;
+    stats_.bytes = 0;
 }
 
 bool mapped_memory_cache::insert(std::string const& uri, mapped_region_ptr mem)
 {
 #ifdef MAPNIK_THREADSAFE
-    std::lock_guard<std::mutex> lock(mutex_);
+    instrumentation::lock_guard<std::mutex> lock(mutex_, instrumentation::lock_site::mapped_memory_cache);
+#endif
+    return insert_impl(uri, mem);
+}
+
+bool mapped_memory_cache::remove(std::string const& uri)
+{
+#ifdef MAPNIK_THREADSAFE
+    instrumentation::lock_guard<std::mutex> lock(mutex_, instrumentation::lock_site::mapped_memory_cache);
+#endif
+    auto itr = cache_.find(uri);
+    if (itr == cache_.end()) return false;
+    stats_.bytes -= itr->second.size;
+    lru_.erase(itr->second.lru);
+    cache_.erase(itr);
+    stats_.size = cache_.size();
+    return true;
+}
+
+void mapped_memory_cache::set_max_size(std::size_t bytes)
+{
+#ifdef MAPNIK_THREADSAFE
+    instrumentation::lock_guard<std::mutex> lock(mutex_, instrumentation::lock_site::mapped_memory_cache);
 #endif
-    return cache_.emplace(uri,mem).second;
+    max_size_ = bytes;
+    evict();
+}
+
+std::size_t mapped_memory_cache::max_size() const
+{
+#ifdef MAPNIK_THREADSAFE
+    instrumentation::lock_guard<std::mutex> lock(mutex_, instrumentation::lock_site::mapped_memory_cache);
+#endif
+    return max_size_;
+}
+
+void mapped_memory_cache::set_huge_pages(bool huge_pages)
+{
+#ifdef MAPNIK_THREADSAFE
+    instrumentation::lock_guard<std::mutex> lock(mutex_, instrumentation::lock_site::mapped_memory_cache);
+#endif
+    huge_pages_ = huge_pages;
+}
+
+bool mapped_memory_cache::huge_pages() const
+{
+#ifdef MAPNIK_THREADSAFE
+    instrumentation::lock_guard<std::mutex> lock(mutex_, instrumentation::lock_site::mapped_memory_cache);
+#endif
+    return huge_pages_;
+}
+
+mapped_memory_cache::stats_type mapped_memory_cache::stats() const
+{
+#ifdef MAPNIK_THREADSAFE
+    instrumentation::lock_guard<std::mutex> lock(mutex_, instrumentation::lock_site::mapped_memory_cache);
+#endif
+    return stats_;
+}
+
+bool mapped_memory_cache::insert_impl(std::string const& uri, mapped_region_ptr const& region)
+{
+    auto itr = cache_.find(uri);
+    if (itr != cache_.end()) return false;
+    lru_.push_front(uri);
+    std::size_t size = region ? region->get_size() : 0;
+    cache_.emplace(uri, entry{region, size, lru_.begin()});
+    stats_.bytes += size;
+    stats_.size = cache_.size();
+    evict();
+    return true;
+}
+
+void mapped_memory_cache::evict()
+{
+    if (max_size_ == 0) return;
+    auto itr = lru_.end();
+    while (stats_.bytes > max_size_ && itr != lru_.begin())
+    {
+        --itr;
+        auto pos = cache_.find(*itr);
+        // pinned: still referenced by a featureset or reader
+        if (pos->second.region.use_count() > 1) continue;
+        stats_.bytes -= pos->second.size;
+        cache_.erase(pos);
+        itr = lru_.erase(itr);
+        ++stats_.evictions;
+    }
+    stats_.size = cache_.size();
 }
 
-boost::optional<mapped_region_ptr> mapped_memory_cache::find(std::string const& uri, bool update_cache)
+boost::optional<mapped_region_ptr> mapped_memory_cache::find(std::string const& uri, bool update_cache, mapped_access access)
 {
 #ifdef MAPNIK_THREADSAFE
-    std::lock_guard<std::mutex> lock(mutex_);
+    instrumentation::lock_guard<std::mutex> lock(mutex_, instrumentation::lock_site::mapped_memory_cache);
 #endif
 
-    using iterator_type = std::unordered_map<std::string, mapped_region_ptr>::const_iterator;
     boost::optional<mapped_region_ptr> result;
-    iterator_type itr = cache_.find(uri);
+    auto itr = cache_.find(uri);
     if (itr != cache_.end())
     {
-        result.reset(itr->second);
+        ++stats_.hits;
+        lru_.splice(lru_.begin(), lru_, itr->second.lru);
+        result.reset(itr->second.region);
         return result;
     }
 
+    ++stats_.misses;
     if (mapnik::util::exists(uri))
     {
         try
         {
             boost::interprocess::file_mapping mapping(uri.c_str(),boost::interprocess::read_only);
             mapped_region_ptr region(std::make_shared<boost::interprocess::mapped_region>(mapping,boost::interprocess::read_only));
+            advise(*region, access, huge_pages_);
             result.reset(region);
             if (update_cache)
             {
-                cache_.emplace(uri, *result);
+                insert_impl(uri, region);
             }
             return result;
         }
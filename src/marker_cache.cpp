@@ -24,6 +24,7 @@
 #include <mapnik/debug.hpp>
 #include <mapnik/marker.hpp>
 #include <mapnik/marker_cache.hpp>
+#include <mapnik/instrumentation.hpp>
 #include <mapnik/svg/svg_parser.hpp>
 #include <mapnik/svg/svg_storage.hpp>
 #include <mapnik/svg/svg_converter.hpp>
@@ -70,7 +71,7 @@ marker_cache::~marker_cache() {}
 void marker_cache::clear()
 {
 #ifdef MAPNIK_THREADSAFE
-    std::lock_guard<std::mutex> lock(mutex_);
+    instrumentation::lock_guard<std::mutex> lock(mutex_, instrumentation::lock_site::marker_cache);
 #endif
     auto itr = marker_cache_.begin();
     while(itr != marker_cache_.end())
@@ -110,7 +111,7 @@ bool marker_cache::insert_svg(std::string const& name, std::string const& svg_st
 bool marker_cache::insert_marker(std::string const& uri, mapnik::marker && path)
 {
 #ifdef MAPNIK_THREADSAFE
-    std::lock_guard<std::mutex> lock(mutex_);
+    instrumentation::lock_guard<std::mutex> lock(mutex_, instrumentation::lock_site::marker_cache);
 #endif
     return marker_cache_.emplace(uri,std::make_shared<mapnik::marker const>(std::move(path))).second;
 }
@@ -149,7 +150,7 @@ std::shared_ptr<mapnik::marker const> marker_cache::find(std::string const& uri,
     }
 
 #ifdef MAPNIK_THREADSAFE
-    std::lock_guard<std::mutex> lock(mutex_);
+    instrumentation::lock_guard<std::mutex> lock(mutex_, instrumentation::lock_site::marker_cache);
 #endif
     auto itr = marker_cache_.find(uri);
     if (itr != marker_cache_.end())
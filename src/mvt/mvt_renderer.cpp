@@ -0,0 +1,367 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2017 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+#if defined(MVT_RENDERER)
+
+// mapnik
+#include <mapnik/mvt/mvt_renderer.hpp>
+#include <mapnik/mvt/mvt_geometry_encoder.hpp>
+#include <mapnik/debug.hpp>
+#include <mapnik/feature.hpp>
+#include <mapnik/feature_kv_iterator.hpp>
+#include <mapnik/layer.hpp>
+#include <mapnik/map.hpp>
+#include <mapnik/request.hpp>
+#include <mapnik/symbolizer.hpp>
+#include <mapnik/unicode.hpp>
+#include <mapnik/vertex_converters.hpp>
+#include <mapnik/vertex_processor.hpp>
+#include <mapnik/renderer_common/apply_vertex_converter.hpp>
+#include <mapnik/geometry/geometry_type.hpp>
+
+#pragma GCC diagnostic push
+#include <mapnik/warning_ignore_agg.hpp>
+#include "agg_trans_affine.h"
+#pragma GCC diagnostic pop
+
+// protozero
+#include <protozero/pbf_writer.hpp>
+
+namespace mapnik {
+
+namespace {
+
+// vector_tile.proto field numbers
+enum tile_field : protozero::pbf_tag_type
+{
+    TILE_LAYERS = 3
+};
+
+enum layer_field : protozero::pbf_tag_type
+{
+    LAYER_NAME = 1,
+    LAYER_FEATURES = 2,
+    LAYER_KEYS = 3,
+    LAYER_VALUES = 4,
+    LAYER_EXTENT = 5,
+    LAYER_VERSION = 15
+};
+
+enum feature_field : protozero::pbf_tag_type
+{
+    FEATURE_ID = 1,
+    FEATURE_TAGS = 2,
+    FEATURE_TYPE = 3,
+    FEATURE_GEOMETRY = 4
+};
+
+enum value_field : protozero::pbf_tag_type
+{
+    VALUE_STRING = 1,
+    VALUE_DOUBLE = 3,
+    VALUE_UINT = 5,
+    VALUE_SINT = 6,
+    VALUE_BOOL = 7
+};
+
+struct value_encoder
+{
+    explicit value_encoder(protozero::pbf_writer & writer)
+        : writer_(writer) {}
+
+    void operator() (value_null) const {}
+
+    void operator() (value_bool val) const
+    {
+        writer_.add_bool(VALUE_BOOL, val);
+    }
+
+    void operator() (value_integer val) const
+    {
+        if (val < 0) writer_.add_sint64(VALUE_SINT, val);
+        else writer_.add_uint64(VALUE_UINT, static_cast<std::uint64_t>(val));
+    }
+
+    void operator() (value_double val) const
+    {
+        writer_.add_double(VALUE_DOUBLE, val);
+    }
+
+    void operator() (value_unicode_string const& val) const
+    {
+        std::string str;
+        to_utf8(val, str);
+        writer_.add_string(VALUE_STRING, str);
+    }
+
+    protozero::pbf_writer & writer_;
+};
+
+mvt::geom_type tile_geometry_type(geometry::geometry<double> const& geom)
+{
+    switch (geometry::geometry_type(geom))
+    {
+    case geometry::geometry_types::Point:
+    case geometry::geometry_types::MultiPoint:
+        return mvt::GEOM_POINT;
+    case geometry::geometry_types::LineString:
+    case geometry::geometry_types::MultiLineString:
+        return mvt::GEOM_LINESTRING;
+    case geometry::geometry_types::Polygon:
+    case geometry::geometry_types::MultiPolygon:
+        return mvt::GEOM_POLYGON;
+    default:
+        // empty geometries and collections, which may mix types
+        return mvt::GEOM_UNKNOWN;
+    }
+}
+
+}
+
+std::size_t mvt_renderer::value_hash::operator()(value const& val) const
+{
+    return std::hash<value>()(val);
+}
+
+bool mvt_renderer::value_equal::operator()(value const& lhs, value const& rhs) const
+{
+    // mapnik::value compares 1 and 1.0 equal, the tile must keep both
+    return lhs.which() == rhs.which() && lhs == rhs;
+}
+
+mvt_renderer::tile_layer::tile_layer(std::string const& _name)
+    : name(_name),
+      features(),
+      feature_count(0),
+      key_index(),
+      value_index(),
+      keys(),
+      values() {}
+
+mvt_renderer::mvt_renderer(Map const& m, std::string & output, double scale_factor)
+    : feature_style_processor<mvt_renderer>(m, scale_factor),
+      output_(output),
+      common_(m, attributes(), 0, 0, m.width(), m.height(), scale_factor),
+      tile_extent_(default_tile_extent),
+      simplify_tolerance_(0.0),
+      painted_(false),
+      buffer_size_(m.buffer_size()),
+      geometry_sym_(),
+      layers_(),
+      current_(nullptr),
+      layer_buffer_size_(0),
+      clipping_extent_(),
+      has_clipping_extent_(false),
+      first_style_(nullptr),
+      seen_features_() {}
+
+mvt_renderer::mvt_renderer(Map const& m, request const& req, attributes const& vars,
+                           std::string & output, double scale_factor)
+    : feature_style_processor<mvt_renderer>(m, scale_factor),
+      output_(output),
+      common_(m, req, vars, 0, 0, req.width(), req.height(), scale_factor),
+      tile_extent_(default_tile_extent),
+      simplify_tolerance_(0.0),
+      painted_(false),
+      buffer_size_(req.buffer_size()),
+      geometry_sym_(),
+      layers_(),
+      current_(nullptr),
+      layer_buffer_size_(0),
+      clipping_extent_(),
+      has_clipping_extent_(false),
+      first_style_(nullptr),
+      seen_features_() {}
+
+mvt_renderer::~mvt_renderer() {}
+
+void mvt_renderer::start_map_processing(Map const& m)
+{
+    MAPNIK_LOG_DEBUG(mvt_renderer) << "mvt_renderer: Start map processing bbox=" << m.get_current_extent();
+    layers_.clear();
+    geometry_sym_ = symbolizer_base();
+    put(geometry_sym_, keys::simplify_tolerance, simplify_tolerance_);
+}
+
+void mvt_renderer::end_map_processing(Map const&)
+{
+    protozero::pbf_writer tile(output_);
+    for (tile_layer const& lyr : layers_)
+    {
+        if (lyr.feature_count == 0) continue;
+        std::string data;
+        {
+            protozero::pbf_writer writer(data);
+            writer.add_uint32(LAYER_VERSION, 2);
+            writer.add_string(LAYER_NAME, lyr.name);
+        }
+        // Feature messages were encoded as they were processed
+        data += lyr.features;
+        {
+            protozero::pbf_writer writer(data);
+            for (std::string const& key : lyr.keys)
+            {
+                writer.add_string(LAYER_KEYS, key);
+            }
+            for (value const& val : lyr.values)
+            {
+                protozero::pbf_writer value_writer(writer, LAYER_VALUES);
+                util::apply_visitor(value_encoder(value_writer), val);
+            }
+            writer.add_uint32(LAYER_EXTENT, tile_extent_);
+        }
+        tile.add_message(TILE_LAYERS, data);
+    }
+    layers_.clear();
+    MAPNIK_LOG_DEBUG(mvt_renderer) << "mvt_renderer: End map processing";
+}
+
+void mvt_renderer::start_layer_processing(layer const& lay, box2d<double> const& query_extent)
+{
+    MAPNIK_LOG_DEBUG(mvt_renderer) << "mvt_renderer: Start processing layer=" << lay.name();
+    MAPNIK_LOG_DEBUG(mvt_renderer) << "mvt_renderer: query_extent = " << query_extent;
+
+    common_.query_extent_ = query_extent;
+    current_ = nullptr;
+    for (tile_layer & lyr : layers_)
+    {
+        if (lyr.name == lay.name()) current_ = &lyr;
+    }
+    if (current_ == nullptr)
+    {
+        layers_.emplace_back(lay.name());
+        current_ = &layers_.back();
+    }
+    boost::optional<int> layer_buffer_size = lay.buffer_size();
+    layer_buffer_size_ = layer_buffer_size ? *layer_buffer_size : buffer_size_;
+    has_clipping_extent_ = false;
+    first_style_ = nullptr;
+    seen_features_.clear();
+}
+
+void mvt_renderer::end_layer_processing(layer const&)
+{
+    MAPNIK_LOG_DEBUG(mvt_renderer) << "mvt_renderer: End layer processing";
+    current_ = nullptr;
+    seen_features_.clear();
+}
+
+void mvt_renderer::start_style_processing(feature_type_style const& st)
+{
+    if (first_style_ == nullptr || &st == first_style_)
+    {
+        // a new pass over the styles (per group-by value) replays new
+        // features, those of the previous pass may have been released
+        first_style_ = &st;
+        seen_features_.clear();
+    }
+}
+
+std::uint32_t mvt_renderer::key_index(std::string const& key)
+{
+    auto result = current_->key_index.emplace(key, static_cast<std::uint32_t>(current_->keys.size()));
+    if (result.second) current_->keys.push_back(key);
+    return result.first->second;
+}
+
+std::uint32_t mvt_renderer::value_index(value const& val)
+{
+    auto result = current_->value_index.emplace(val, static_cast<std::uint32_t>(current_->values.size()));
+    if (result.second) current_->values.push_back(val);
+    return result.first->second;
+}
+
+bool mvt_renderer::process(rule::symbolizers const& /*syms*/,
+                           mapnik::feature_impl & feature,
+                           proj_transform const& prj_trans)
+{
+    // one feature per layer, whatever the number of rules and styles
+    // matching it
+    if (current_ == nullptr || !seen_features_.insert(&feature).second) return true;
+
+    geometry::geometry<double> const& geom = feature.get_geometry();
+    mvt::geom_type type = tile_geometry_type(geom);
+    if (type == mvt::GEOM_UNKNOWN)
+    {
+        MAPNIK_LOG_DEBUG(mvt_renderer) << "mvt_renderer: Skipping feature " << feature.id()
+                                       << " without a single geometry type";
+        return true;
+    }
+
+    double pixel_size = common_.t_.extent().width() / common_.width_;
+    double buffer = layer_buffer_size_ * common_.scale_factor_;
+    if (!has_clipping_extent_)
+    {
+        clipping_extent_ = common_.t_.extent();
+        clipping_extent_.pad(buffer * pixel_size);
+        prj_trans.forward(clipping_extent_, PROJ_ENVELOPE_POINTS);
+        has_clipping_extent_ = true;
+    }
+
+    double scale = static_cast<double>(tile_extent_) / common_.width_;
+    box2d<double> point_clip(-buffer * scale, -buffer * scale,
+                             (common_.width_ + buffer) * scale, (common_.height_ + buffer) * scale);
+    mvt::geometry_encoder encoder(scale, point_clip);
+    encoder.begin(type);
+
+    using vertex_converter_type = vertex_converter<clip_line_tag, clip_poly_tag, transform_tag,
+                                                   simplify_tag>;
+    agg::trans_affine tr;
+    vertex_converter_type converter(clipping_extent_, geometry_sym_, common_.t_, prj_trans, tr,
+                                    feature, common_.vars_, common_.scale_factor_);
+    if (type == mvt::GEOM_POLYGON) converter.set<clip_poly_tag>();
+    else if (type == mvt::GEOM_LINESTRING) converter.set<clip_line_tag>();
+    converter.set<transform_tag>(); // always transform
+    if (simplify_tolerance_ > 0.0 && type != mvt::GEOM_POINT) converter.set<simplify_tag>();
+
+    using apply_vertex_converter_type = detail::apply_vertex_converter<vertex_converter_type, mvt::geometry_encoder>;
+    using vertex_processor_type = geometry::vertex_processor<apply_vertex_converter_type>;
+    apply_vertex_converter_type apply(converter, encoder);
+    mapnik::util::apply_visitor(vertex_processor_type(apply), geom);
+    if (!encoder.finish()) return true;
+
+    protozero::pbf_writer layer_writer(current_->features);
+    protozero::pbf_writer feature_writer(layer_writer, LAYER_FEATURES);
+    if (feature.id() >= 0)
+    {
+        feature_writer.add_uint64(FEATURE_ID, static_cast<std::uint64_t>(feature.id()));
+    }
+    {
+        protozero::packed_field_uint32 tags(feature_writer, FEATURE_TAGS);
+        for (auto itr = feature.begin(), end = feature.end(); itr != end; ++itr)
+        {
+            value const& val = std::get<1>(*itr);
+            if (val.is_null()) continue;
+            tags.add_element(key_index(std::get<0>(*itr)));
+            tags.add_element(value_index(val));
+        }
+    }
+    feature_writer.add_enum(FEATURE_TYPE, static_cast<std::int32_t>(encoder.type()));
+    feature_writer.add_packed_uint32(FEATURE_GEOMETRY, encoder.commands().begin(), encoder.commands().end());
+    ++current_->feature_count;
+    painted_ = true;
+    return true;
+}
+
+}
+
+#endif
@@ -24,6 +24,9 @@
 #include <mapnik/config_error.hpp>
 
 // stl
+#include <algorithm>
+#include <array>
+#include <limits>
 #include <sstream>
 #include <iomanip>
 #include <iterator>
@@ -51,19 +54,11 @@ bool rgba::mean_sort_cmp::operator() (const rgba& x, const rgba& y) const
 rgba_palette::rgba_palette(std::string const& pal, palette_type type)
     : colors_(0)
 {
-#ifdef USE_DENSE_HASH_MAP
-    color_hashmap_.set_empty_key(0);
-#endif
     parse(pal, type);
 }
 
 rgba_palette::rgba_palette()
-    : colors_(0)
-{
-#ifdef USE_DENSE_HASH_MAP
-    color_hashmap_.set_empty_key(0);
-#endif
-}
+    : colors_(0) {}
 
 bool rgba_palette::valid() const
 {
@@ -96,80 +91,218 @@ std::string rgba_palette::to_string() const
     return str.str();
 }
 
+namespace {
+
+inline int distance(rgba const& x, rgba const& y)
+{
+    int dr = x.r - y.r;
+    int dg = x.g - y.g;
+    int db = x.b - y.b;
+    int da = x.a - y.a;
+    return dr*dr + dg*dg + db*db + da*da;
+}
+
+}
+
 // return color index in returned earlier palette
 unsigned char rgba_palette::quantize(unsigned val) const
 {
+    if (colors_ <= 1 || val == 0) return 0;
+    if (cell_offsets_.empty()) return nearest(val);
+
+    rgba c(val);
+    unsigned cell = (c.r >> (8 - cell_bits))
+        | (c.g >> (8 - cell_bits)) << cell_bits
+        | (c.b >> (8 - cell_bits)) << (2 * cell_bits)
+        | (c.a >> (8 - cell_bits)) << (3 * cell_bits);
     unsigned char index = 0;
-    if (colors_ == 1 || val == 0) return index;
+    int dist = std::numeric_limits<int>::max();
+    bool tie = false;
+    for (std::uint32_t i = cell_offsets_[cell]; i < cell_offsets_[cell + 1]; ++i)
+    {
+        unsigned char candidate = cell_entries_[i];
+        int newdist = distance(sorted_pal_[candidate], c);
+        if (newdist < dist)
+        {
+            index = candidate;
+            dist = newdist;
+            tie = false;
+        }
+        else if (newdist == dist)
+        {
+            // duplicated palette colors resolve to the last entry; other
+            // ties depend on the search order of nearest()
+            if (dist == 0) index = candidate;
+            else tie = true;
+        }
+    }
+    return tie ? nearest(val) : index;
+}
 
-    rgba_hash_table::iterator it = color_hashmap_.find(val);
-    if (it != color_hashmap_.end())
+void rgba_palette::quantize_row(unsigned const* row, std::uint8_t * out, unsigned width) const
+{
+    unsigned prev = 0;
+    unsigned char index = quantize(prev);
+    for (unsigned x = 0; x < width; ++x)
     {
-        index = it->second;
+        // runs of the same color are common in rendered tiles
+        if (row[x] != prev)
+        {
+            prev = row[x];
+            index = quantize(prev);
+        }
+        out[x] = index;
     }
-    else
+}
+
+// exhaustive search around the mean-sorted position of the color
+unsigned char rgba_palette::nearest(unsigned val) const
+{
+    rgba c(val);
+    int dr, dg, db, da;
+    int dist, newdist;
+
+    // find closest match based on mean of r,g,b,a
+    std::vector<rgba>::const_iterator pit =
+        std::lower_bound(sorted_pal_.begin(), sorted_pal_.end(), c, rgba::mean_sort_cmp());
+    int poz = std::distance(sorted_pal_.begin(), pit);
+    if (poz == static_cast<int>(sorted_pal_.size())) poz--;
+
+    unsigned char index = poz;
+    dist = distance(sorted_pal_[poz], c);
+
+    // search neighbour positions in both directions for better match
+    for (int i = poz - 1; i >= 0; i--)
     {
-        rgba c(val);
-        int dr, dg, db, da;
-        int dist, newdist;
-
-        // find closest match based on mean of r,g,b,a
-        std::vector<rgba>::const_iterator pit =
-            std::lower_bound(sorted_pal_.begin(), sorted_pal_.end(), c, rgba::mean_sort_cmp());
-        index = std::distance(sorted_pal_.begin(),pit);
-        if (index == sorted_pal_.size()) index--;
-
-        dr = sorted_pal_[index].r - c.r;
-        dg = sorted_pal_[index].g - c.g;
-        db = sorted_pal_[index].b - c.b;
-        da = sorted_pal_[index].a - c.a;
-        dist = dr*dr + dg*dg + db*db + da*da;
-        int poz = index;
-
-        // search neighbour positions in both directions for better match
-        for (int i = poz - 1; i >= 0; i--)
+        dr = sorted_pal_[i].r - c.r;
+        dg = sorted_pal_[i].g - c.g;
+        db = sorted_pal_[i].b - c.b;
+        da = sorted_pal_[i].a - c.a;
+        // stop criteria based on properties of used sorting
+        if ((dr+db+dg+da) * (dr+db+dg+da) / 4 > dist)
         {
-            dr = sorted_pal_[i].r - c.r;
-            dg = sorted_pal_[i].g - c.g;
-            db = sorted_pal_[i].b - c.b;
-            da = sorted_pal_[i].a - c.a;
-            // stop criteria based on properties of used sorting
-            if ((dr+db+dg+da) * (dr+db+dg+da) / 4 > dist)
-            {
-                break;
-            }
-            newdist = dr*dr + dg*dg + db*db + da*da;
-            if (newdist < dist)
+            break;
+        }
+        newdist = dr*dr + dg*dg + db*db + da*da;
+        if (newdist < dist)
+        {
+            index = i;
+            dist = newdist;
+        }
+    }
+
+    for (unsigned i = poz + 1; i < sorted_pal_.size(); i++)
+    {
+        dr = sorted_pal_[i].r - c.r;
+        dg = sorted_pal_[i].g - c.g;
+        db = sorted_pal_[i].b - c.b;
+        da = sorted_pal_[i].a - c.a;
+        // stop criteria based on properties of used sorting
+        if ((dr+db+dg+da) * (dr+db+dg+da) / 4 > dist)
+        {
+            break;
+        }
+        newdist = dr*dr + dg*dg + db*db + da*da;
+        if (newdist < dist)
+        {
+            index = i;
+            dist = newdist;
+        }
+    }
+    return index;
+}
+
+// For every cell of the RGBA lattice record the palette entries that can be
+// the closest one to some color inside the cell: an entry qualifies when its
+// smallest possible distance to the cell does not exceed the largest
+// possible distance of the entry that bounds the cell best.
+void rgba_palette::build_lookup()
+{
+    cell_offsets_.clear();
+    cell_entries_.clear();
+    // entries are stored as 8 bit indices
+    if (colors_ <= 1 || colors_ > 256) return;
+
+    constexpr unsigned cells_per_channel = 1u << cell_bits;
+    constexpr unsigned cell_size = 256 / cells_per_channel;
+    constexpr unsigned cells = 1u << (4 * cell_bits);
+
+    // squared min/max channel distance of every entry to every cell slice,
+    // laid out as [channel][slice][entry]
+    std::vector<int> min_d(4 * cells_per_channel * colors_);
+    std::vector<int> max_d(min_d.size());
+    auto slice = [&](std::vector<int> & d, unsigned ch, unsigned s) {
+        return d.data() + (ch * cells_per_channel + s) * colors_;
+    };
+    for (unsigned i = 0; i < colors_; ++i)
+    {
+        rgba const& c = sorted_pal_[i];
+        int channels[4] = { c.r, c.g, c.b, c.a };
+        for (unsigned ch = 0; ch < 4; ++ch)
+        {
+            for (unsigned s = 0; s < cells_per_channel; ++s)
             {
-                index = i;
-                dist = newdist;
+                int lo = s * cell_size;
+                int hi = lo + cell_size - 1;
+                int v = channels[ch];
+                int near = v < lo ? lo - v : (v > hi ? v - hi : 0);
+                int far = std::max(v - lo, hi - v);
+                slice(min_d, ch, s)[i] = near * near;
+                slice(max_d, ch, s)[i] = far * far;
             }
         }
+    }
 
-        for (unsigned i = poz + 1; i < sorted_pal_.size(); i++)
+    // partial sums over the alpha, blue and green slices of the current cell
+    std::vector<int> min_ab(colors_), max_ab(colors_);
+    std::vector<int> min_abg(colors_), max_abg(colors_);
+    cell_offsets_.reserve(cells + 1);
+    cell_entries_.reserve(cells * 4);
+    cell_offsets_.push_back(0);
+    for (unsigned a = 0; a < cells_per_channel; ++a)
+    {
+        for (unsigned b = 0; b < cells_per_channel; ++b)
         {
-            dr = sorted_pal_[i].r - c.r;
-            dg = sorted_pal_[i].g - c.g;
-            db = sorted_pal_[i].b - c.b;
-            da = sorted_pal_[i].a - c.a;
-            // stop criteria based on properties of used sorting
-            if ((dr+db+dg+da) * (dr+db+dg+da) / 4 > dist)
+            int const* min_a = slice(min_d, 3, a);
+            int const* max_a = slice(max_d, 3, a);
+            int const* min_b = slice(min_d, 2, b);
+            int const* max_b = slice(max_d, 2, b);
+            for (unsigned i = 0; i < colors_; ++i)
             {
-                break;
+                min_ab[i] = min_a[i] + min_b[i];
+                max_ab[i] = max_a[i] + max_b[i];
             }
-            newdist = dr*dr + dg*dg + db*db + da*da;
-            if (newdist < dist)
+            for (unsigned g = 0; g < cells_per_channel; ++g)
             {
-                index = i;
-                dist = newdist;
+                int const* min_g = slice(min_d, 1, g);
+                int const* max_g = slice(max_d, 1, g);
+                for (unsigned i = 0; i < colors_; ++i)
+                {
+                    min_abg[i] = min_ab[i] + min_g[i];
+                    max_abg[i] = max_ab[i] + max_g[i];
+                }
+                for (unsigned r = 0; r < cells_per_channel; ++r)
+                {
+                    int const* min_r = slice(min_d, 0, r);
+                    int const* max_r = slice(max_d, 0, r);
+                    int bound = std::numeric_limits<int>::max();
+                    for (unsigned i = 0; i < colors_; ++i)
+                    {
+                        bound = std::min(bound, max_abg[i] + max_r[i]);
+                    }
+                    for (unsigned i = 0; i < colors_; ++i)
+                    {
+                        if (min_abg[i] + min_r[i] <= bound)
+                        {
+                            cell_entries_.push_back(static_cast<std::uint8_t>(i));
+                        }
+                    }
+                    cell_offsets_.push_back(static_cast<std::uint32_t>(cell_entries_.size()));
+                }
             }
         }
-
-        // Cache found index for the color c into the hashmap.
-        color_hashmap_[val] = index;
     }
-
-    return index;
+    cell_entries_.shrink_to_fit();
 }
 
 void rgba_palette::parse(std::string const& pal, palette_type type)
@@ -215,29 +348,20 @@ void rgba_palette::parse(std::string const& pal, palette_type type)
 
     colors_ = sorted_pal_.size();
 
-#ifdef USE_DENSE_HASH_MAP
-    color_hashmap_.resize((colors_*2));
-#endif
-    color_hashmap_.clear();
-
     // Sort palette for binary searching in quantization
     std::sort(sorted_pal_.begin(), sorted_pal_.end(), rgba::mean_sort_cmp());
 
-    // Insert all palette colors into the hashmap and into the palette vectors.
     for (unsigned i = 0; i < colors_; i++)
     {
         rgba c = sorted_pal_[i];
-        unsigned val = c.r | (c.g << 8) | (c.b << 16) | (c.a << 24);
-        if (val != 0)
-        {
-            color_hashmap_[val] = i;
-        }
         rgb_pal_.push_back(rgb(c));
         if (c.a < 0xFF)
         {
             alpha_pal_.push_back(c.a);
         }
     }
+
+    build_lookup();
 }
 
 } // namespace mapnik
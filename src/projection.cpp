@@ -22,6 +22,7 @@
 
 // mapnik
 #include <mapnik/projection.hpp>
+#include <mapnik/instrumentation.hpp>
 #include <mapnik/util/trim.hpp>
 #include <mapnik/well_known_srs.hpp>
 
@@ -119,7 +120,7 @@ void projection::init_proj4() const
         }
 #else
         #if defined(MAPNIK_THREADSAFE)
-        std::lock_guard<std::mutex> lock(mutex_);
+        instrumentation::lock_guard<std::mutex> lock(mutex_, instrumentation::lock_site::projection);
         #endif
         proj_ = pj_init_plus(params_.c_str());
         if (!proj_) throw proj_init_error(params_);
@@ -157,7 +158,7 @@ void projection::forward(double & x, double &y ) const
         throw std::runtime_error("projection::forward not supported unless proj4 is initialized");
     }
     #if defined(MAPNIK_THREADSAFE) && PJ_VERSION < 480
-    std::lock_guard<std::mutex> lock(mutex_);
+    instrumentation::lock_guard<std::mutex> lock(mutex_, instrumentation::lock_site::projection);
     #endif
     projUV p;
     p.u = x * DEG_TO_RAD;
@@ -184,7 +185,7 @@ void projection::inverse(double & x,double & y) const
     }
 
     #if defined(MAPNIK_THREADSAFE) && PJ_VERSION < 480
-    std::lock_guard<std::mutex> lock(mutex_);
+    instrumentation::lock_guard<std::mutex> lock(mutex_, instrumentation::lock_site::projection);
     #endif
     if (is_geographic_)
     {
@@ -206,7 +207,7 @@ projection::~projection()
 {
 #ifdef MAPNIK_USE_PROJ4
  #if defined(MAPNIK_THREADSAFE) && PJ_VERSION < 480
-    std::lock_guard<std::mutex> lock(mutex_);
+    instrumentation::lock_guard<std::mutex> lock(mutex_, instrumentation::lock_site::projection);
  #endif
     if (proj_)
     {
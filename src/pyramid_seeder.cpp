@@ -0,0 +1,342 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2017 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+// mapnik
+#include <mapnik/pyramid_seeder.hpp>
+#include <mapnik/agg_renderer.hpp>
+#include <mapnik/attribute_collector.hpp>
+#include <mapnik/datasource.hpp>
+#include <mapnik/feature.hpp>
+#include <mapnik/feature_layer_desc.hpp>
+#include <mapnik/layer.hpp>
+#include <mapnik/make_unique.hpp>
+#include <mapnik/map.hpp>
+#include <mapnik/projection.hpp>
+#include <mapnik/proj_transform.hpp>
+#include <mapnik/quad_tree.hpp>
+#include <mapnik/query.hpp>
+#include <mapnik/request.hpp>
+#include <mapnik/scale_denominator.hpp>
+#include <mapnik/util/featureset_buffer.hpp>
+#include <mapnik/util/trim.hpp>
+#include <mapnik/well_known_srs.hpp>
+
+// boost
+#include <boost/algorithm/string/predicate.hpp>
+
+// stl
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace mapnik {
+
+namespace {
+
+// tile extents are spherical mercator, so the map must be too
+bool is_web_mercator(std::string const& srs)
+{
+    std::string trimmed = util::trim_copy(srs);
+    auto known = is_well_known_srs(trimmed);
+    return known ? *known == G_MERC : boost::algorithm::iequals(trimmed, "epsg:3857");
+}
+
+constexpr double merc_max_extent = 20037508.342789244;
+
+// Features a layer returned for one seeding band, indexed by envelope so
+// every tile only visits the features it intersects. Returns them in the
+// order the source datasource produced them.
+class cached_datasource : public datasource
+{
+public:
+    cached_datasource(datasource const& source, box2d<double> const& extent)
+        : datasource(source.params()),
+          type_(source.type()),
+          envelope_(source.envelope()),
+          geometry_type_(source.get_geometry_type()),
+          desc_(source.get_descriptor()),
+          features_(),
+          boxes_(),
+          index_(extent) {}
+
+    void push(feature_ptr const& feature)
+    {
+        box2d<double> box = feature->envelope();
+        if (!box.valid()) return;
+        index_.insert(features_.size(), box);
+        features_.push_back(feature);
+        boxes_.push_back(box);
+    }
+
+    std::size_t size() const
+    {
+        return features_.size();
+    }
+
+    datasource::datasource_t type() const
+    {
+        return type_;
+    }
+
+    featureset_ptr features(query const& q) const
+    {
+        return features_in_box(q.get_bbox());
+    }
+
+    featureset_ptr features_at_point(coord2d const& pt, double tol = 0) const
+    {
+        box2d<double> box(pt.x, pt.y, pt.x, pt.y);
+        box.pad(tol);
+        return features_in_box(box);
+    }
+
+    box2d<double> envelope() const
+    {
+        return envelope_;
+    }
+
+    boost::optional<datasource_geometry_t> get_geometry_type() const
+    {
+        return geometry_type_;
+    }
+
+    layer_descriptor get_descriptor() const
+    {
+        return desc_;
+    }
+
+private:
+    featureset_ptr features_in_box(box2d<double> const& box) const
+    {
+        std::vector<std::size_t> matches;
+        for (auto itr = index_.query_in_box(box), end = index_.query_end(); itr != end; ++itr)
+        {
+            std::size_t index = itr->get();
+            if (boxes_[index].intersects(box)) matches.push_back(index);
+        }
+        if (matches.empty())
+        {
+            return make_invalid_featureset();
+        }
+        std::sort(matches.begin(), matches.end());
+        auto fs = std::make_shared<featureset_buffer>();
+        for (std::size_t index : matches)
+        {
+            fs->push(features_[index]);
+        }
+        fs->prepare();
+        return fs;
+    }
+
+    datasource::datasource_t type_;
+    box2d<double> envelope_;
+    boost::optional<datasource_geometry_t> geometry_type_;
+    layer_descriptor desc_;
+    std::vector<feature_ptr> features_;
+    std::vector<box2d<double>> boxes_;
+    // query_in_box() reuses an internal result buffer
+    mutable quad_tree<std::size_t> index_;
+};
+
+// whether a datasource returns the same features for a region at every scale
+bool cacheable(datasource const& ds)
+{
+    if (ds.type() != datasource::Vector) return false;
+    static const char * scale_tokens[] = { "!scale_denominator!", "!pixel_width!", "!pixel_height!" };
+    parameters const& params = ds.params();
+    for (auto const& param : params)
+    {
+        boost::optional<std::string> str = params.get<std::string>(param.first);
+        if (!str) continue;
+        for (char const* token : scale_tokens)
+        {
+            if (str->find(token) != std::string::npos) return false;
+        }
+    }
+    return true;
+}
+
+}
+
+pyramid_seeder::pyramid_seeder(Map const& map, unsigned tile_size, double scale_factor)
+    : map_(map),
+      tile_size_(tile_size),
+      scale_factor_(scale_factor),
+      query_depth_(4),
+      vars_(),
+      queries_(0) {}
+
+box2d<double> pyramid_seeder::tile_extent(int z, int x, int y)
+{
+    double span = 2.0 * merc_max_extent / (1 << z);
+    double minx = -merc_max_extent + x * span;
+    double maxy = merc_max_extent - y * span;
+    return box2d<double>(minx, maxy - span, minx + span, maxy);
+}
+
+double pyramid_seeder::scale_denominator(int z) const
+{
+    return mapnik::scale_denominator(tile_extent(z, 0, 0).width() / tile_size_, false);
+}
+
+std::size_t pyramid_seeder::seed(int z, int x, int y, int minzoom, int maxzoom, callback_type const& callback)
+{
+    if (!is_web_mercator(map_.srs()))
+    {
+        throw std::runtime_error("pyramid_seeder: map srs must be EPSG:3857, got '" + map_.srs() + "'");
+    }
+    if (z < 0 || z > 30 || x < 0 || y < 0 || x >= (1 << z) || y >= (1 << z))
+    {
+        throw std::runtime_error("pyramid_seeder: invalid tile " + std::to_string(z) + "/"
+                                 + std::to_string(x) + "/" + std::to_string(y));
+    }
+    if (maxzoom > 30)
+    {
+        throw std::runtime_error("pyramid_seeder: maxzoom must not exceed 30");
+    }
+    return visit(z, x, y, std::max(z, minzoom), maxzoom, nullptr, callback);
+}
+
+std::size_t pyramid_seeder::visit(int z, int x, int y, int minzoom, int maxzoom,
+                                  Map * band_map, callback_type const& callback)
+{
+    std::unique_ptr<Map> band;
+    if (z >= minzoom && (z - minzoom) % static_cast<int>(query_depth_) == 0)
+    {
+        band = std::make_unique<Map>(map_);
+        make_band(*band, z, x, y, std::min(maxzoom, z + static_cast<int>(query_depth_) - 1));
+        band_map = band.get();
+    }
+    std::size_t count = 0;
+    if (z >= minzoom)
+    {
+        render(*band_map, z, x, y, callback);
+        ++count;
+    }
+    if (z < maxzoom)
+    {
+        for (int child = 0; child < 4; ++child)
+        {
+            count += visit(z + 1, 2 * x + (child & 1), 2 * y + (child >> 1),
+                           minzoom, maxzoom, band_map, callback);
+        }
+    }
+    return count;
+}
+
+void pyramid_seeder::make_band(Map & band_map, int z, int x, int y, int lastzoom)
+{
+    box2d<double> extent = tile_extent(z, x, y);
+    double res = extent.width() / tile_size_;
+    projection map_proj(map_.srs(), true);
+
+    for (layer & lyr : band_map.layers())
+    {
+        datasource_ptr ds = lyr.datasource();
+        if (!ds || !cacheable(*ds)) continue;
+
+        // attributes used by any rule active within the band
+        std::set<std::string> names;
+        attribute_collector collector(names);
+        bool visible = false;
+        for (int zoom = z; zoom <= lastzoom; ++zoom)
+        {
+            double scale_denom = scale_denominator(zoom) * scale_factor_;
+            if (!lyr.visible(scale_denom)) continue;
+            visible = true;
+            for (std::string const& style_name : lyr.styles())
+            {
+                boost::optional<feature_type_style const&> style = map_.find_style(style_name);
+                if (!style) continue;
+                for (rule const& r : style->get_rules())
+                {
+                    if (r.active(scale_denom)) collector(r);
+                }
+            }
+        }
+        if (!visible) continue;
+
+        // the coarsest tile of the band needs the widest buffer
+        boost::optional<int> const& layer_buffer_size = lyr.buffer_size();
+        box2d<double> query_ext(extent);
+        query_ext.pad(res * scale_factor_ * (layer_buffer_size ? *layer_buffer_size : map_.buffer_size()));
+        boost::optional<box2d<double>> const& maximum_extent = map_.maximum_extent();
+        if (maximum_extent)
+        {
+            query_ext.clip(*maximum_extent);
+        }
+
+        projection layer_proj(lyr.srs(), true);
+        proj_transform prj_trans(map_proj, layer_proj);
+        box2d<double> layer_ext = lyr.envelope();
+        if (!prj_trans.forward(query_ext, PROJ_ENVELOPE_POINTS))
+        {
+            continue; // leave it to the per tile queries
+        }
+        auto cache = std::make_shared<cached_datasource>(*ds, query_ext);
+        if (query_ext.intersects(layer_ext))
+        {
+            layer_ext.clip(query_ext);
+            query q(layer_ext, query::resolution_type(1.0 / res, 1.0 / res),
+                    scale_denominator(z) * scale_factor_, extent);
+            q.set_variables(vars_);
+            for (std::string const& name : names)
+            {
+                q.add_property_name(name);
+            }
+            if (!lyr.group_by().empty())
+            {
+                q.add_property_name(lyr.group_by());
+            }
+            q.set_filter_factor(collector.get_filter_factor());
+            ++queries_;
+            featureset_ptr fs = ds->features(q);
+            if (fs)
+            {
+                for (feature_ptr feature = fs->next(); feature; feature = fs->next())
+                {
+                    cache->push(feature);
+                }
+            }
+        }
+        lyr.set_datasource(cache);
+    }
+}
+
+void pyramid_seeder::render(Map & map, int z, int x, int y, callback_type const& callback) const
+{
+    // layers are queried for the map extent, not the request extent
+    box2d<double> extent = tile_extent(z, x, y);
+    map.resize(tile_size_, tile_size_);
+    map.zoom_to_box(extent);
+    image_rgba8 image(tile_size_, tile_size_);
+    request req(tile_size_, tile_size_, extent);
+    req.set_buffer_size(map.buffer_size());
+    agg_renderer<image_rgba8> ren(map, req, vars_, image, scale_factor_, 0, 0);
+    ren.apply(scale_denominator(z));
+    callback(z, x, y, image);
+}
+
+}
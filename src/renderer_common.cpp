@@ -22,6 +22,7 @@
 
 #include <mapnik/renderer_common.hpp>
 #include <mapnik/label_collision_detector.hpp>
+#include <mapnik/offset_converter.hpp>
 #include <mapnik/map.hpp>
 #include <mapnik/request.hpp>
 #include <mapnik/attribute.hpp>
@@ -40,7 +41,16 @@ renderer_common::renderer_common(renderer_common const& other)
       font_manager_(other.font_manager_),
       query_extent_(other.query_extent_),
       t_(other.t_),
-      detector_(other.detector_)
+      detector_(other.detector_),
+      minimum_feature_size_(other.minimum_feature_size_),
+      minimum_feature_dot_(other.minimum_feature_dot_),
+      vertex_decimation_(other.vertex_decimation_),
+      polygon_batching_(other.polygon_batching_),
+      building_batching_(other.building_batching_),
+      offset_buffers_(other.offset_buffers_),
+      group_cache_(other.group_cache_),
+      label_anchor_cache_(other.label_anchor_cache_),
+      label_anchors_(other.label_anchors_)
 {}
 
 renderer_common::renderer_common(Map const& map, unsigned width, unsigned height, double scale_factor,
@@ -56,8 +66,19 @@ renderer_common::renderer_common(Map const& map, unsigned width, unsigned height
      font_manager_(font_library_,map.get_font_file_mapping(),map.get_font_memory_cache()),
      query_extent_(),
      t_(t),
-     detector_(detector)
-{}
+     detector_(detector),
+     minimum_feature_size_(0.0),
+     minimum_feature_dot_(false),
+     vertex_decimation_(false),
+     polygon_batching_(false),
+     building_batching_(false),
+     offset_buffers_(std::make_shared<offset_converter_buffers>()),
+     group_cache_(),
+     label_anchor_cache_(map.get_label_anchor_cache()),
+     label_anchors_()
+{
+    label_anchors_.cache = label_anchor_cache_.get();
+}
 
 renderer_common::renderer_common(Map const &m, attributes const& vars, unsigned offset_x, unsigned offset_y,
                                  unsigned width, unsigned height, double scale_factor)
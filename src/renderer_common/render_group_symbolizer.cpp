@@ -30,96 +30,56 @@
 #include <mapnik/renderer_common/render_thunk_extractor.hpp>
 #include <mapnik/util/conversions.hpp>
 
+// stl
+#include <set>
+
 namespace mapnik {
 
-void render_group_symbolizer(group_symbolizer const& sym,
-                             feature_impl & feature,
-                             attributes const& vars,
-                             proj_transform const& prj_trans,
-                             box2d<double> const& clipping_extent,
-                             renderer_common & common,
-                             render_thunk_list_dispatch & render_thunks)
-{
-    // find all column names referenced in the group rules and symbolizers
-    std::set<std::string> columns;
-    group_attribute_collector column_collector(columns, false);
-    column_collector(sym);
+namespace {
 
+// run one combination of column values through the group rules and extract
+// the bounding boxes and render thunks of the matching sub symbolizers
+group_symbolizer_cache::layout evaluate_layout(group_symbolizer const& sym,
+                                               group_symbolizer_cache::columns const& columns,
+                                               std::vector<value> const& values,
+                                               proj_transform const& prj_trans,
+                                               box2d<double> const& clipping_extent,
+                                               renderer_common & common)
+{
+    group_symbolizer_cache::layout result;
     auto props = get<group_symbolizer_properties_ptr>(sym, keys::group_properties);
 
-    // create a new context for the sub features of this group
-    context_ptr sub_feature_ctx = std::make_shared<mapnik::context_type>();
-
-    // populate new context with column names referenced in the group rules and symbolizers
-    for (auto const& col_name : columns)
-    {
-        sub_feature_ctx->push(col_name);
-    }
-
-    // keep track of the sub features that we'll want to symbolize
-    // along with the group rules that they matched
-    std::vector< std::pair<group_rule_ptr, feature_ptr> > matches;
-
     // create a copied 'virtual' common renderer for processing sub feature symbolizers
     // create an empty detector for it, so we are sure we won't hit anything
     virtual_renderer_common virtual_renderer(common);
 
-    // keep track of which lists of render thunks correspond to
-    // entries in the group_layout_manager.
-    std::list<render_thunk_list> layout_thunks;
-
     // layout manager to store and arrange bboxes of matched features
     group_layout_manager layout_manager(props->get_layout());
     layout_manager.set_input_origin(common.width_ * 0.5, common.height_ * 0.5);
 
-    // run feature or sub feature through the group rules & symbolizers
+    // add a single point geometry at pixel origin
+    double x = common.width_ / 2.0, y = common.height_ / 2.0, z = 0.0;
+    common.t_.backward(&x, &y);
+    prj_trans.forward(x, y, z);
+    // note that we choose a point in the middle of the screen to
+    // try to ensure that we don't get edge artefacts due to any
+    // symbolizers with avoid-edges set: only the avoid-edges of
+    // the group symbolizer itself should matter.
+    geometry::point<double> origin_pt(x,y);
+
+    // run sub feature through the group rules & symbolizers
     // for each index value in the range
-    value_integer start = get<value_integer>(sym, keys::start_column);
-    value_integer end = start + get<value_integer>(sym, keys::num_columns);
-    for (value_integer col_idx = start; col_idx < end; ++col_idx)
+    auto value_itr = values.begin();
+    for (value_integer col_idx = columns.start; col_idx < columns.end; ++col_idx)
     {
         // create sub feature with indexed column values
-        feature_ptr sub_feature = feature_factory::create(sub_feature_ctx, col_idx);
-
-        // copy the necessary columns to sub feature
-        for(auto const& col_name : columns)
+        feature_ptr sub_feature = feature_factory::create(columns.context, col_idx);
+        for (auto const& col_name : columns.names)
         {
-            if (col_name.find('%') != std::string::npos)
-            {
-                if (col_name.size() == 1)
-                {
-                    // column name is '%' by itself, so give the index as the value
-                    sub_feature->put(col_name, col_idx);
-                }
-                else
-                {
-                    // indexed column
-                    std::string col_idx_str;
-                    if (mapnik::util::to_string(col_idx_str,col_idx))
-                    {
-                        std::string col_idx_name = col_name;
-                        boost::replace_all(col_idx_name, "%", col_idx_str);
-                        sub_feature->put(col_name, feature.get(col_idx_name));
-                    }
-                }
-            }
-            else
-            {
-                // non-indexed column
-                sub_feature->put(col_name, feature.get(col_name));
-            }
+            sub_feature->put(col_name, *value_itr++);
         }
-
-        // add a single point geometry at pixel origin
-        double x = common.width_ / 2.0, y = common.height_ / 2.0, z = 0.0;
-        common.t_.backward(&x, &y);
-        prj_trans.forward(x, y, z);
-        // note that we choose a point in the middle of the screen to
-        // try to ensure that we don't get edge artefacts due to any
-        // symbolizers with avoid-edges set: only the avoid-edges of
-        // the group symbolizer itself should matter.
-        geometry::point<double> origin_pt(x,y);
         sub_feature->set_geometry(origin_pt);
+
         // get the layout for this set of properties
         for (auto const& rule : props->get_rules())
         {
@@ -127,7 +87,7 @@ void render_group_symbolizer(group_symbolizer const& sym,
                                                *(rule->get_filter())).to_bool())
              {
                 // add matched rule and feature to the list of things to draw
-                matches.emplace_back(rule, sub_feature);
+                result.matches.emplace_back(rule, sub_feature);
 
                 // construct a bounding box around all symbolizers for the matched rule
                 box2d<double> bounds;
@@ -143,22 +103,16 @@ void render_group_symbolizer(group_symbolizer const& sym,
 
                 // add the bounding box to the layout manager
                 layout_manager.add_member_bound_box(bounds);
-                layout_thunks.emplace_back(std::move(thunks));
+                result.thunks.emplace_back(std::move(thunks));
                 break;
             }
         }
     }
 
-    // create a symbolizer helper
-    group_symbolizer_helper helper(sym, feature, vars, prj_trans,
-                                   common.width_, common.height_,
-                                   common.scale_factor_, common.t_,
-                                   *common.detector_, clipping_extent);
-
-    for (size_t i = 0; i < matches.size(); ++i)
+    for (std::size_t i = 0; i < result.matches.size(); ++i)
     {
-        group_rule_ptr match_rule = matches[i].first;
-        feature_ptr match_feature = matches[i].second;
+        group_rule_ptr const& match_rule = result.matches[i].first;
+        feature_ptr const& match_feature = result.matches[i].second;
         value_unicode_string rpt_key_value = "";
 
         // get repeat key from matched group rule
@@ -176,17 +130,168 @@ void render_group_symbolizer(group_symbolizer const& sym,
             rpt_key_value = util::apply_visitor(evaluate<feature_impl,value_type,attributes>(*match_feature,common.vars_),
                                                 *rpt_key_expr).to_unicode();
         }
-        helper.add_box_element(layout_manager.offset_box_at(i), rpt_key_value);
+        result.repeat_keys.push_back(std::move(rpt_key_value));
+        result.offsets.push_back(layout_manager.offset_at(i));
+        result.offset_boxes.push_back(layout_manager.offset_box_at(i));
+    }
+    return result;
+}
+
+}
+
+group_symbolizer_cache::columns const& group_symbolizer_cache::get_columns(group_symbolizer const& sym)
+{
+    auto itr = columns_.find(&sym);
+    if (itr != columns_.end())
+    {
+        return itr->second;
+    }
+
+    // find all column names referenced in the group rules and symbolizers
+    std::set<std::string> names;
+    group_attribute_collector column_collector(names, false);
+    column_collector(sym);
+
+    columns & result = columns_[&sym];
+    // create a new context for the sub features of this group
+    // populated with column names referenced in the group rules and symbolizers
+    result.context = std::make_shared<mapnik::context_type>();
+    for (auto const& col_name : names)
+    {
+        result.context->push(col_name);
+        result.names.push_back(col_name);
+    }
+    result.start = get<value_integer>(sym, keys::start_column);
+    result.end = result.start + get<value_integer>(sym, keys::num_columns);
+
+    // resolve the feature attribute read for each column and index
+    for (value_integer col_idx = result.start; col_idx < result.end; ++col_idx)
+    {
+        for (auto const& col_name : result.names)
+        {
+            if (col_name.find('%') == std::string::npos)
+            {
+                // non-indexed column
+                result.attributes.push_back(col_name);
+            }
+            else if (col_name.size() == 1)
+            {
+                // column name is '%' by itself, so give the index as the value
+                result.attributes.emplace_back();
+            }
+            else
+            {
+                // indexed column
+                std::string col_idx_str;
+                mapnik::util::to_string(col_idx_str, col_idx);
+                std::string col_idx_name = col_name;
+                boost::replace_all(col_idx_name, "%", col_idx_str);
+                result.attributes.push_back(std::move(col_idx_name));
+            }
+        }
+    }
+    return result;
+}
+
+group_symbolizer_cache::layout const* group_symbolizer_cache::find(key const& k) const
+{
+    auto itr = layouts_.find(k);
+    return itr != layouts_.end() ? &itr->second : nullptr;
+}
+
+group_symbolizer_cache::layout const& group_symbolizer_cache::insert(key && k, layout && l)
+{
+    if (layouts_.size() >= max_layouts)
+    {
+        layouts_.clear();
+    }
+    return layouts_.emplace(std::move(k), std::move(l)).first->second;
+}
+
+std::size_t group_symbolizer_cache::key_hash::operator()(key const& k) const
+{
+    std::size_t seed = std::hash<group_symbolizer const*>()(k.sym);
+    for (auto const& val : k.values)
+    {
+        seed ^= value_hash(val) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+    return seed;
+}
+
+bool group_symbolizer_cache::key_equal::operator()(key const& lhs, key const& rhs) const
+{
+    if (lhs.sym != rhs.sym || !(lhs.clipping_extent == rhs.clipping_extent) ||
+        lhs.values.size() != rhs.values.size())
+    {
+        return false;
+    }
+    for (std::size_t i = 0; i < lhs.values.size(); ++i)
+    {
+        // values of different types may compare equal, but render differently
+        if (lhs.values[i].which() != rhs.values[i].which() || !(lhs.values[i] == rhs.values[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void render_group_symbolizer(group_symbolizer const& sym,
+                             feature_impl & feature,
+                             attributes const& vars,
+                             proj_transform const& prj_trans,
+                             box2d<double> const& clipping_extent,
+                             renderer_common & common,
+                             render_thunk_list_dispatch & render_thunks)
+{
+    if (!common.group_cache_)
+    {
+        common.group_cache_ = std::make_shared<group_symbolizer_cache>();
+    }
+    group_symbolizer_cache & cache = *common.group_cache_;
+    group_symbolizer_cache::columns const& columns = cache.get_columns(sym);
+
+    // the values copied to the sub features identify the layout
+    group_symbolizer_cache::key key { &sym, clipping_extent, {} };
+    key.values.reserve(columns.attributes.size());
+    value_integer col_idx = columns.start;
+    std::size_t col = 0;
+    for (auto const& attribute : columns.attributes)
+    {
+        if (attribute.empty()) key.values.emplace_back(col_idx);
+        else key.values.push_back(feature.get(attribute));
+        if (++col == columns.names.size())
+        {
+            col = 0;
+            ++col_idx;
+        }
+    }
+
+    group_symbolizer_cache::layout const* layout = cache.find(key);
+    if (!layout)
+    {
+        auto result = evaluate_layout(sym, columns, key.values, prj_trans, clipping_extent, common);
+        layout = &cache.insert(std::move(key), std::move(result));
+    }
+
+    // create a symbolizer helper
+    group_symbolizer_helper helper(sym, feature, vars, prj_trans,
+                                   common.width_, common.height_,
+                                   common.scale_factor_, common.t_,
+                                   *common.detector_, clipping_extent);
+
+    for (std::size_t i = 0; i < layout->matches.size(); ++i)
+    {
+        helper.add_box_element(layout->offset_boxes[i], layout->repeat_keys[i]);
     }
 
     pixel_position_list const& positions = helper.get();
     for (pixel_position const& pos : positions)
     {
-        size_t layout_i = 0;
-        for (auto const& thunks : layout_thunks)
+        std::size_t layout_i = 0;
+        for (auto const& thunks : layout->thunks)
         {
-            pixel_position const& offset = layout_manager.offset_at(layout_i);
-            pixel_position render_offset = pos + offset;
+            pixel_position render_offset = pos + layout->offsets[layout_i];
             render_thunks.render_list(thunks, render_offset);
             ++layout_i;
         }
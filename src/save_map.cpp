@@ -23,6 +23,7 @@
 // mapnik
 #include <mapnik/rule.hpp>
 #include <mapnik/datasource.hpp>
+#include <mapnik/lazy_datasource.hpp>
 #include <mapnik/layer.hpp>
 #include <mapnik/feature_type_style.hpp>
 #include <mapnik/debug.hpp>
@@ -484,6 +485,13 @@ void serialize_datasource( ptree & layer_node, datasource_ptr datasource)
         param_node.put_value( p.second );
 
     }
+    if (std::dynamic_pointer_cast<lazy_datasource>(datasource))
+    {
+        ptree & param_node = datasource_node.push_back(
+            ptree::value_type("Parameter", ptree()))->second;
+        param_node.put("<xmlattr>.name", "lazy");
+        param_node.put_value("true");
+    }
 }
 
 void serialize_parameters( ptree & map_node, mapnik::parameters const& params)
@@ -565,6 +573,31 @@ void serialize_layer( ptree & map_node, layer const& lyr, bool explicit_defaults
         set_attr( layer_node, "group-by", lyr.group_by() );
     }
 
+    if ( lyr.minimum_feature_size() > 0.0 || explicit_defaults )
+    {
+        set_attr( layer_node, "minimum-feature-size", lyr.minimum_feature_size() );
+    }
+
+    if ( lyr.minimum_feature_dot() || explicit_defaults )
+    {
+        set_attr( layer_node, "minimum-feature-dot", lyr.minimum_feature_dot() );
+    }
+
+    if ( lyr.vertex_decimation() || explicit_defaults )
+    {
+        set_attr( layer_node, "vertex-decimation", lyr.vertex_decimation() );
+    }
+
+    if ( lyr.polygon_batching() || explicit_defaults )
+    {
+        set_attr( layer_node, "polygon-batching", lyr.polygon_batching() );
+    }
+
+    if ( lyr.building_batching() || explicit_defaults )
+    {
+        set_attr( layer_node, "building-batching", lyr.building_batching() );
+    }
+
     boost::optional<int> const& buffer_size = lyr.buffer_size();
     if ( buffer_size || explicit_defaults)
     {
@@ -0,0 +1,415 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2017 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+// mapnik
+#include <mapnik/task_scheduler.hpp>
+#include <mapnik/debug.hpp>
+#include <mapnik/make_unique.hpp>
+
+// stl
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace mapnik {
+
+struct task_scheduler::worker
+{
+    std::mutex mutex;
+    std::deque<task_type> tasks;
+    // other workers in stealing order
+    std::vector<unsigned> victims;
+    // cpus the thread is bound to, empty for no affinity
+    std::vector<int> cpus;
+    std::thread thread;
+};
+
+namespace {
+
+struct current_worker
+{
+    task_scheduler const* scheduler;
+    unsigned index;
+};
+
+thread_local current_worker current = { nullptr, 0 };
+
+void run_task(task_scheduler::task_type & task)
+{
+    try
+    {
+        task();
+    }
+    catch (std::exception const& ex)
+    {
+        MAPNIK_LOG_ERROR(task_scheduler) << "task_scheduler: task failed: " << ex.what();
+    }
+    catch (...)
+    {
+        MAPNIK_LOG_ERROR(task_scheduler) << "task_scheduler: task failed";
+    }
+}
+
+#ifdef MAPNIK_THREADSAFE
+#if defined(__linux__)
+
+// "0-3,8-11" -> 0 1 2 3 8 9 10 11
+std::vector<int> parse_cpulist(std::string const& list)
+{
+    std::vector<int> cpus;
+    std::istringstream in(list);
+    std::string range;
+    while (std::getline(in, range, ','))
+    {
+        std::size_t dash = range.find('-');
+        try
+        {
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+        }
+        catch (std::exception const&)
+        {
+            return std::vector<int>();
+        }
+    }
+    return cpus;
+}
+
+// cpus of every NUMA node with at least one cpu
+std::vector<std::vector<int>> numa_nodes()
+{
+    std::vector<std::vector<int>> nodes;
+    for (int node = 0; node < 256; ++node)
+    {
+        std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        std::string list;
+        if (!file || !std::getline(file, list)) continue;
+        std::vector<int> cpus = parse_cpulist(list);
+        if (!cpus.empty()) nodes.push_back(std::move(cpus));
+    }
+    return nodes;
+}
+
+void set_affinity(std::vector<int> const& cpus)
+{
+    if (cpus.empty()) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus)
+    {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+    }
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+    {
+        MAPNIK_LOG_WARN(task_scheduler) << "task_scheduler: could not set thread affinity";
+    }
+}
+
+#else
+
+std::vector<std::vector<int>> numa_nodes()
+{
+    return std::vector<std::vector<int>>();
+}
+
+void set_affinity(std::vector<int> const&) {}
+
+#endif
+#endif
+
+std::mutex global_mutex;
+task_scheduler::options global_options;
+std::unique_ptr<task_scheduler> global_scheduler;
+std::atomic<task_scheduler*> global_ptr(nullptr);
+
+}
+
+task_scheduler::task_scheduler(options const& opts)
+    : workers_(),
+      shared_mutex_(),
+      shared_queue_(),
+      queued_(0),
+      sleep_mutex_(),
+      sleep_cv_(),
+      stop_(false)
+{
+#ifdef MAPNIK_THREADSAFE
+    unsigned hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+    unsigned count = opts.threads > 0 ? opts.threads : hardware_threads;
+    std::vector<std::vector<int>> nodes;
+    if (opts.numa_aware) nodes = numa_nodes();
+    std::vector<std::size_t> node_of(count, 0);
+    workers_.reserve(count);
+    for (unsigned i = 0; i < count; ++i)
+    {
+        auto w = std::make_unique<worker>();
+        if (!nodes.empty())
+        {
+            // round robin over nodes, then over the cpus of each node
+            node_of[i] = i % nodes.size();
+            std::vector<int> const& cpus = nodes[node_of[i]];
+            if (opts.pin_threads) w->cpus.push_back(cpus[(i / nodes.size()) % cpus.size()]);
+            else w->cpus = cpus;
+        }
+        else if (opts.pin_threads)
+        {
+            w->cpus.push_back(static_cast<int>(i % hardware_threads));
+        }
+        workers_.push_back(std::move(w));
+    }
+    for (unsigned i = 0; i < count; ++i)
+    {
+        std::vector<unsigned> & victims = workers_[i]->victims;
+        for (unsigned k = 1; k < count; ++k)
+        {
+            unsigned j = (i + k) % count;
+            if (node_of[j] == node_of[i]) victims.push_back(j);
+        }
+        for (unsigned k = 1; k < count; ++k)
+        {
+            unsigned j = (i + k) % count;
+            if (node_of[j] != node_of[i]) victims.push_back(j);
+        }
+    }
+    for (unsigned i = 0; i < count; ++i)
+    {
+        workers_[i]->thread = std::thread(&task_scheduler::worker_loop, this, i);
+    }
+#else
+    (void)opts;
+#endif
+}
+
+task_scheduler::~task_scheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stop_ = true;
+    }
+    sleep_cv_.notify_all();
+    for (auto & w : workers_)
+    {
+        if (w->thread.joinable()) w->thread.join();
+    }
+    task_type task;
+    while (pop(task))
+    {
+        run_task(task);
+    }
+}
+
+void task_scheduler::submit(task_type task)
+{
+    if (workers_.empty())
+    {
+        run_task(task);
+        return;
+    }
+    if (current.scheduler == this)
+    {
+        worker & self = *workers_[current.index];
+        std::lock_guard<std::mutex> lock(self.mutex);
+        self.tasks.push_back(std::move(task));
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(shared_mutex_);
+        shared_queue_.push_back(std::move(task));
+    }
+    queued_.fetch_add(1);
+    {
+        // pairs with the predicate check of sleeping workers
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+    }
+    sleep_cv_.notify_one();
+}
+
+bool task_scheduler::pop(task_type & task)
+{
+    if (queued_.load() == 0) return false;
+    worker * self = current.scheduler == this ? workers_[current.index].get() : nullptr;
+    // own tasks newest first, everything else oldest first
+    if (self)
+    {
+        std::lock_guard<std::mutex> lock(self->mutex);
+        if (!self->tasks.empty())
+        {
+            task = std::move(self->tasks.back());
+            self->tasks.pop_back();
+            queued_.fetch_sub(1);
+            return true;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(shared_mutex_);
+        if (!shared_queue_.empty())
+        {
+            task = std::move(shared_queue_.front());
+            shared_queue_.pop_front();
+            queued_.fetch_sub(1);
+            return true;
+        }
+    }
+    std::size_t count = self ? self->victims.size() : workers_.size();
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        worker & victim = *workers_[self ? self->victims[i] : i];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty())
+        {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            queued_.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool task_scheduler::run_pending()
+{
+    task_type task;
+    if (!pop(task)) return false;
+    run_task(task);
+    return true;
+}
+
+#ifdef MAPNIK_THREADSAFE
+void task_scheduler::worker_loop(unsigned index)
+{
+    current.scheduler = this;
+    current.index = index;
+    set_affinity(workers_[index]->cpus);
+    while (true)
+    {
+        if (run_pending()) continue;
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        sleep_cv_.wait(lock, [this]() { return stop_ || queued_.load() > 0; });
+        if (stop_ && queued_.load() == 0) break;
+    }
+    current.scheduler = nullptr;
+}
+#endif
+
+task_scheduler & task_scheduler::global()
+{
+    task_scheduler * scheduler = global_ptr.load(std::memory_order_acquire);
+    if (scheduler == nullptr)
+    {
+        std::lock_guard<std::mutex> lock(global_mutex);
+        if (!global_scheduler)
+        {
+            global_scheduler = std::make_unique<task_scheduler>(global_options);
+            global_ptr.store(global_scheduler.get(), std::memory_order_release);
+        }
+        scheduler = global_scheduler.get();
+    }
+    return *scheduler;
+}
+
+void task_scheduler::configure_global(options const& opts)
+{
+    std::lock_guard<std::mutex> lock(global_mutex);
+    if (global_scheduler)
+    {
+        throw std::runtime_error("task_scheduler: global scheduler already created");
+    }
+    global_options = opts;
+}
+
+task_group::task_group(task_scheduler & scheduler)
+    : scheduler_(scheduler),
+      pending_(0),
+      error_(),
+      mutex_(),
+      done_() {}
+
+task_group::~task_group()
+{
+    try
+    {
+        wait();
+    }
+    catch (...) {}
+}
+
+void task_group::run(task_scheduler::task_type task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++pending_;
+    }
+    scheduler_.submit([this, task = std::move(task)]() {
+            std::exception_ptr error;
+            try
+            {
+                task();
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+            finished(error);
+        });
+}
+
+void task_group::finished(std::exception_ptr error)
+{
+    // notify while holding the lock: the group may be destroyed as soon as
+    // a waiter sees pending_ drop to zero
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (error && !error_) error_ = error;
+    if (--pending_ == 0) done_.notify_all();
+}
+
+void task_group::wait()
+{
+    while (true)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (pending_ == 0) break;
+        }
+        // help instead of blocking; this is what keeps nested waits from
+        // starving the pool
+        if (scheduler_.run_pending()) continue;
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait_for(lock, std::chrono::milliseconds(1), [this]() { return pending_ == 0; });
+    }
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::swap(error, error_);
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+}
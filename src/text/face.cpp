@@ -32,14 +32,24 @@ extern "C"
 #include FT_TRUETYPE_TABLES_H
 }
 
+#include <harfbuzz/hb.h>
+#include <harfbuzz/hb-ft.h>
+
 #pragma GCC diagnostic pop
 
+// stl
+#include <algorithm>
+#include <iterator>
+
 namespace mapnik
 {
 
 font_face::font_face(FT_Face face)
     : face_(face),
-      color_font_(init_color_font())
+      color_font_(init_color_font()),
+      coverage_(),
+      coverage_init_(false),
+      hb_font_(nullptr)
 {
 }
 
@@ -102,12 +112,62 @@ bool font_face::glyph_dimensions(glyph_info & glyph) const
     return true;
 }
 
+void font_face::init_coverage() const
+{
+    // consecutive code points of the charmap are merged into ranges
+    FT_UInt glyph_index = 0;
+    FT_ULong codepoint = FT_Get_First_Char(face_, &glyph_index);
+    while (glyph_index != 0)
+    {
+        if (!coverage_.empty() && coverage_.back().second + 1 == codepoint)
+        {
+            coverage_.back().second = static_cast<std::uint32_t>(codepoint);
+        }
+        else
+        {
+            coverage_.emplace_back(codepoint, codepoint);
+        }
+        codepoint = FT_Get_Next_Char(face_, codepoint, &glyph_index);
+    }
+    coverage_.shrink_to_fit();
+    coverage_init_ = true;
+}
+
+bool font_face::has_codepoint(std::uint32_t codepoint) const
+{
+    if (!coverage_init_) init_coverage();
+    auto itr = std::upper_bound(coverage_.begin(), coverage_.end(), codepoint,
+                                [](std::uint32_t cp, std::pair<std::uint32_t, std::uint32_t> const& range)
+                                {
+                                    return cp < range.first;
+                                });
+    return itr != coverage_.begin() && codepoint <= std::prev(itr)->second;
+}
+
+hb_font_t * font_face::hb_font()
+{
+    if (hb_font_ == nullptr)
+    {
+        // hb_ft_font_create takes the scale from the current size
+        set_unscaled_character_sizes();
+        hb_font_ = hb_ft_font_create(face_, nullptr);
+        // https://github.com/mapnik/test-data-visual/pull/25
+#if HB_VERSION_MAJOR > 0
+#if HB_VERSION_ATLEAST(1, 0 , 5)
+        hb_ft_font_set_load_flags(hb_font_, FT_LOAD_DEFAULT | FT_LOAD_NO_HINTING);
+#endif
+#endif
+    }
+    return hb_font_;
+}
+
 font_face::~font_face()
 {
     MAPNIK_LOG_DEBUG(font_face) <<
         "font_face: Clean up face \"" << family_name() <<
         " " << style_name() << "\"";
 
+    if (hb_font_) hb_font_destroy(hb_font_);
     FT_Done_Face(face_);
 }
 
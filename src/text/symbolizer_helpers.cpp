@@ -46,6 +46,10 @@
 #include <mapnik/grid_vertex_converter.hpp>
 #include <mapnik/proj_strategy.hpp>
 #include <mapnik/view_strategy.hpp>
+#include <mapnik/label_anchor_cache.hpp>
+
+// stl
+#include <cmath>
 
 namespace mapnik {
 namespace geometry {
@@ -201,7 +205,8 @@ base_symbolizer_helper::base_symbolizer_helper(
         proj_transform const& prj_trans,
         unsigned width, unsigned height, double scale_factor,
         view_transform const& t,
-        box2d<double> const& query_extent)
+        box2d<double> const& query_extent,
+        label_anchor_context const* anchors)
     : sym_(sym),
       feature_(feature),
       vars_(vars),
@@ -210,6 +215,7 @@ base_symbolizer_helper::base_symbolizer_helper(
       dims_(0, 0, width, height),
       query_extent_(query_extent),
       scale_factor_(scale_factor),
+      anchors_(anchors),
       info_ptr_(mapnik::get<text_placements_ptr>(sym_, keys::text_placements_)->get_placement_info(scale_factor,feature_,vars_)),
       text_props_(evaluate_text_properties(info_ptr_->properties,feature_,vars_))
 {
@@ -326,28 +332,10 @@ void base_symbolizer_helper::initialize_points() const
             else if (type == geometry::geometry_types::Polygon)
             {
                 auto const& poly = util::get<geometry::polygon<double>>(geom);
-                proj_transform backwart_transform(prj_trans_.dest(), prj_trans_.source());
-                view_strategy vs(t_);
-                proj_strategy ps(backwart_transform);
-                using transform_group_type = geometry::strategy_group<proj_strategy, view_strategy>;
-                transform_group_type transform_group(ps, vs);
-                geometry::polygon<double> tranformed_poly(geometry::transform<double>(poly, transform_group));
-                if (how_placed == INTERIOR_PLACEMENT)
-                {
-                    geometry::point<double> pt;
-                    if (geometry::interior(tranformed_poly, scale_factor_, pt))
-                    {
-                        points_.emplace_back(pt.x, pt.y);
-                    }
-                }
-                else if (how_placed == POLYLABEL_PLACEMENT)
+                pixel_position pos;
+                if (polygon_anchor(poly, how_placed, pos))
                 {
-                    double precision = geometry::polylabel_precision(tranformed_poly, scale_factor_);
-                    geometry::point<double> pt;
-                    if (geometry::polylabel(tranformed_poly, precision, pt))
-                    {
-                        points_.emplace_back(pt.x, pt.y);
-                    }
+                    points_.push_back(pos);
                 }
                 continue;
             }
@@ -366,6 +354,51 @@ void base_symbolizer_helper::initialize_points() const
     point_itr_ = points_.begin();
 }
 
+bool base_symbolizer_helper::polygon_anchor(geometry::polygon<double> const& poly,
+                                            label_placement_enum how_placed,
+                                            pixel_position & pos) const
+{
+    if (how_placed != INTERIOR_PLACEMENT && how_placed != POLYLABEL_PLACEMENT) return false;
+    geometry::point<double> pt;
+    // Anchors found in map coordinates carry over to any view that only
+    // scales and translates them, i.e. as long as pixels are square.
+    if (anchors_ && anchors_->cache &&
+        std::abs(t_.scale_x() - t_.scale_y()) <= 1e-6 * std::abs(t_.scale_x()))
+    {
+        label_anchor_cache::key_type key{anchors_->layer, feature_.id(), label_anchor_cache::hash(poly), how_placed};
+        if (!anchors_->cache->find(key, scale_factor_, pt))
+        {
+            proj_transform backwart_transform(prj_trans_.dest(), prj_trans_.source());
+            proj_strategy ps(backwart_transform);
+            geometry::polygon<double> map_poly(geometry::transform<double>(poly, ps));
+            if (!label_anchor_cache::compute(how_placed, map_poly, scale_factor_, pt)) return false;
+            anchors_->cache->insert(key, scale_factor_, pt);
+        }
+        t_.forward(&pt.x, &pt.y);
+        pos = pixel_position(pt.x, pt.y);
+        return true;
+    }
+
+    proj_transform backwart_transform(prj_trans_.dest(), prj_trans_.source());
+    proj_strategy ps(backwart_transform);
+    view_strategy vs(t_);
+    using transform_group_type = geometry::strategy_group<proj_strategy, view_strategy>;
+    transform_group_type transform_group(ps, vs);
+    geometry::polygon<double> tranformed_poly(geometry::transform<double>(poly, transform_group));
+    bool found = false;
+    if (how_placed == INTERIOR_PLACEMENT)
+    {
+        found = geometry::interior(tranformed_poly, scale_factor_, pt);
+    }
+    else
+    {
+        double precision = geometry::polylabel_precision(tranformed_poly, scale_factor_);
+        found = geometry::polylabel(tranformed_poly, precision, pt);
+    }
+    if (found) pos = pixel_position(pt.x, pt.y);
+    return found;
+}
+
 template <typename FaceManagerT, typename DetectorT>
 text_symbolizer_helper::text_symbolizer_helper(
         text_symbolizer const& sym,
@@ -375,8 +408,9 @@ text_symbolizer_helper::text_symbolizer_helper(
         unsigned width, unsigned height, double scale_factor,
         view_transform const& t, FaceManagerT & font_manager,
         DetectorT &detector, box2d<double> const& query_extent,
-        agg::trans_affine const& affine_trans)
-    : base_symbolizer_helper(sym, feature, vars, prj_trans, width, height, scale_factor, t, query_extent),
+        agg::trans_affine const& affine_trans,
+        label_anchor_context const* anchors)
+    : base_symbolizer_helper(sym, feature, vars, prj_trans, width, height, scale_factor, t, query_extent, anchors),
       finder_(feature, vars, detector, dims_, *info_ptr_, font_manager, scale_factor),
     adapter_(finder_,false),
     converter_(query_extent_, sym_, t, prj_trans, affine_trans, feature, vars, scale_factor)
@@ -524,8 +558,9 @@ text_symbolizer_helper::text_symbolizer_helper(
         proj_transform const& prj_trans,
         unsigned width, unsigned height, double scale_factor,
         view_transform const& t, FaceManagerT & font_manager,
-        DetectorT & detector, box2d<double> const& query_extent, agg::trans_affine const& affine_trans)
-    : base_symbolizer_helper(sym, feature, vars, prj_trans, width, height, scale_factor, t, query_extent),
+        DetectorT & detector, box2d<double> const& query_extent, agg::trans_affine const& affine_trans,
+        label_anchor_context const* anchors)
+    : base_symbolizer_helper(sym, feature, vars, prj_trans, width, height, scale_factor, t, query_extent, anchors),
       finder_(feature, vars, detector, dims_, *info_ptr_, font_manager, scale_factor),
       adapter_(finder_,true),
       converter_(query_extent_, sym_, t, prj_trans, affine_trans, feature, vars, scale_factor)
@@ -625,7 +660,8 @@ template text_symbolizer_helper::text_symbolizer_helper(
     face_manager_freetype & font_manager,
     label_collision_detector4 &detector,
     box2d<double> const& query_extent,
-    agg::trans_affine const&);
+    agg::trans_affine const&,
+    label_anchor_context const*);
 
 template text_symbolizer_helper::text_symbolizer_helper(
     shield_symbolizer const& sym,
@@ -639,5 +675,6 @@ template text_symbolizer_helper::text_symbolizer_helper(
     face_manager_freetype & font_manager,
     label_collision_detector4 &detector,
     box2d<double> const& query_extent,
-    agg::trans_affine const&);
+    agg::trans_affine const&,
+    label_anchor_context const*);
 } //namespace
@@ -251,7 +251,7 @@ tiff_reader<T>::tiff_reader(std::string const& filename)
 
 #if defined(MAPNIK_MEMORY_MAPPED_FILE)
      boost::optional<mapnik::mapped_region_ptr> memory =
-         mapnik::mapped_memory_cache::instance().find(filename,true);
+         mapnik::mapped_memory_cache::instance().find(filename, true, mapnik::mapped_access::random);
 
      if (memory)
      {
@@ -24,6 +24,7 @@
 #include <mapnik/geometry.hpp>
 #include <mapnik/geometry/geometry_types.hpp>
 #include <mapnik/vertex.hpp>
+#include <mapnik/util/is_clockwise.hpp>
 
 namespace mapnik { namespace geometry {
 
@@ -165,6 +166,82 @@ geometry_types polygon_vertex_adapter<T>::type () const
     return geometry_types::Polygon;
 }
 
+// oriented polygon adapter
+template <typename T>
+oriented_polygon_vertex_adapter<T>::oriented_polygon_vertex_adapter(polygon<T> const& poly)
+    : poly_(poly),
+      rings_itr_(0),
+      current_index_(0),
+      end_index_(0),
+      reversed_(false),
+      start_loop_(true)
+{
+    start_ring();
+}
+
+template <typename T>
+void oriented_polygon_vertex_adapter<T>::rewind(unsigned) const
+{
+    rings_itr_ = 0;
+    start_ring();
+}
+
+template <typename T>
+void oriented_polygon_vertex_adapter<T>::start_ring() const
+{
+    current_index_ = 0;
+    start_loop_ = true;
+    if (rings_itr_ < poly_.size())
+    {
+        linear_ring<T> const& ring = poly_[rings_itr_];
+        end_index_ = ring.size();
+        // exterior ring counter-clockwise, interior rings clockwise
+        reversed_ = end_index_ > 2 && (util::is_clockwise(ring) != (rings_itr_ > 0));
+    }
+    else
+    {
+        end_index_ = 0;
+        reversed_ = false;
+    }
+}
+
+template <typename T>
+unsigned oriented_polygon_vertex_adapter<T>::vertex(coordinate_type * x, coordinate_type * y) const
+{
+    while (rings_itr_ < poly_.size())
+    {
+        if (current_index_ < end_index_)
+        {
+            std::size_t index = reversed_ ? end_index_ - 1 - current_index_ : current_index_;
+            ++current_index_;
+            point<T> const& coord = poly_[rings_itr_][index];
+            *x = coord.x;
+            *y = coord.y;
+            if (start_loop_)
+            {
+                start_loop_ = false;
+                return mapnik::SEG_MOVETO;
+            }
+            if (current_index_ == end_index_)
+            {
+                *x = 0;
+                *y = 0;
+                return mapnik::SEG_CLOSE;
+            }
+            return mapnik::SEG_LINETO;
+        }
+        ++rings_itr_;
+        start_ring();
+    }
+    return mapnik::SEG_END;
+}
+
+template <typename T>
+geometry_types oriented_polygon_vertex_adapter<T>::type () const
+{
+    return geometry_types::Polygon;
+}
+
 // ring adapter
 template <typename T>
 ring_vertex_adapter<T>::ring_vertex_adapter(linear_ring<T> const& ring)
@@ -213,6 +290,7 @@ geometry_types ring_vertex_adapter<T>::type () const
 template struct point_vertex_adapter<double>;
 template struct line_string_vertex_adapter<double>;
 template struct polygon_vertex_adapter<double>;
+template struct oriented_polygon_vertex_adapter<double>;
 template struct ring_vertex_adapter<double>;
 
 }}
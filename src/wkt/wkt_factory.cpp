@@ -22,26 +22,347 @@
 
 // mapnik
 #include <mapnik/wkt/wkt_factory.hpp>
-#include <mapnik/wkt/wkt_grammar_x3.hpp>
+#include <mapnik/util/decimal.hpp>
+
+// stl
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <utility>
 
 namespace mapnik {
 
-bool from_wkt(std::string const& wkt, mapnik::geometry::geometry<double> & geom)
+namespace {
+
+struct wkt_error : std::runtime_error
+{
+    wkt_error() : std::runtime_error("malformed WKT") {}
+};
+
+// Single pass WKT reader mirroring wkt_grammar_x3_def.hpp: keywords are
+// matched case-insensitively, numbers follow Spirit's double_ (including
+// `.5`, `5.`, nan and inf) and anything that the grammar rejects after a
+// keyword is a hard error.
+class wkt_reader
+{
+public:
+    wkt_reader(char const* start, char const* end)
+        : cur_(start), end_(end) {}
+
+    bool read(geometry::geometry<double> & geom)
+    {
+        if (!read_geometry(geom)) return false;
+        skip_whitespace();
+        return cur_ == end_;
+    }
+
+private:
+    void skip_whitespace()
+    {
+        while (cur_ != end_ && (*cur_ == ' ' || (*cur_ >= '\t' && *cur_ <= '\r'))) ++cur_;
+    }
+
+    // case-insensitive match of an upper case keyword at the current position
+    bool match(char const* kw)
+    {
+        char const* itr = cur_;
+        for (; *kw != '\0'; ++kw, ++itr)
+        {
+            if (itr == end_ || (*itr & ~0x20) != *kw) return false;
+        }
+        cur_ = itr;
+        return true;
+    }
+
+    bool keyword(char const* kw)
+    {
+        skip_whitespace();
+        return match(kw);
+    }
+
+    bool consume(char c)
+    {
+        skip_whitespace();
+        if (cur_ != end_ && *cur_ == c)
+        {
+            ++cur_;
+            return true;
+        }
+        return false;
+    }
+
+    bool peek(char c)
+    {
+        skip_whitespace();
+        return cur_ != end_ && *cur_ == c;
+    }
+
+    void expect(char c)
+    {
+        if (!consume(c)) throw wkt_error();
+    }
+
+    void expect_empty()
+    {
+        if (!keyword("EMPTY")) throw wkt_error();
+    }
+
+    bool special_value(double & value)
+    {
+        char const* itr = cur_;
+        bool negative = false;
+        if (itr != end_ && (*itr == '-' || *itr == '+')) negative = (*itr++ == '-');
+        char const* save = cur_;
+        cur_ = itr;
+        if (match("NAN"))
+        {
+            // optional trailing `(...)`, as accepted by double_
+            if (cur_ != end_ && *cur_ == '(')
+            {
+                char const* close = cur_;
+                while (++close != end_ && *close != ')') {}
+                if (close == end_)
+                {
+                    cur_ = save;
+                    return false;
+                }
+                cur_ = close + 1;
+            }
+            value = negative ? -std::numeric_limits<double>::quiet_NaN()
+                : std::numeric_limits<double>::quiet_NaN();
+            return true;
+        }
+        if (match("INF"))
+        {
+            match("INITY");
+            value = negative ? -std::numeric_limits<double>::infinity()
+                : std::numeric_limits<double>::infinity();
+            return true;
+        }
+        cur_ = save;
+        return false;
+    }
+
+    double read_double()
+    {
+        skip_whitespace();
+        char const* begin = cur_;
+        util::decimal num;
+        double value;
+        if (util::scan_decimal(cur_, end_, num, true))
+        {
+            if (!util::decimal_to_double(num, begin, cur_, value)) throw wkt_error();
+            return value;
+        }
+        if (!special_value(value)) throw wkt_error();
+        return value;
+    }
+
+    // number of comma separated elements up to the `)` closing the list
+    // that starts at the current position; used to reserve exact sizes
+    std::size_t count_elements() const
+    {
+        std::size_t count = 1;
+        int depth = 0;
+        for (char const* itr = cur_; itr != end_; ++itr)
+        {
+            char c = *itr;
+            if (c == ',' && depth == 0) ++count;
+            else if (c == '(') ++depth;
+            else if (c == ')' && depth-- == 0) break;
+        }
+        return count;
+    }
+
+    geometry::point<double> read_point()
+    {
+        double x = read_double();
+        double y = read_double();
+        return geometry::point<double>(x, y);
+    }
+
+    // '(' x y, x y ... ')'
+    template <typename Points>
+    bool read_positions(Points & points)
+    {
+        if (!consume('(')) return false;
+        points.reserve(count_elements());
+        do
+        {
+            points.push_back(read_point());
+        }
+        while (consume(','));
+        expect(')');
+        return true;
+    }
+
+    // '(' ring, ring ... ')'
+    bool read_rings(geometry::polygon<double> & poly)
+    {
+        if (!consume('(')) return false;
+        do
+        {
+            geometry::linear_ring<double> ring;
+            if (!read_positions(ring)) throw wkt_error();
+            poly.push_back(std::move(ring));
+        }
+        while (consume(','));
+        expect(')');
+        return true;
+    }
+
+    // '(' (x y), (x y) ... ')' or '(' x y, x y ... ')'
+    bool read_points(geometry::multi_point<double> & points)
+    {
+        if (!consume('(')) return false;
+        points.reserve(count_elements());
+        if (peek('('))
+        {
+            do
+            {
+                expect('(');
+                points.push_back(read_point());
+                expect(')');
+            }
+            while (consume(','));
+        }
+        else
+        {
+            do
+            {
+                points.push_back(read_point());
+            }
+            while (consume(','));
+        }
+        expect(')');
+        return true;
+    }
+
+    bool read_lines(geometry::multi_line_string<double> & lines)
+    {
+        if (!consume('(')) return false;
+        do
+        {
+            geometry::line_string<double> line;
+            if (!read_positions(line)) throw wkt_error();
+            lines.push_back(std::move(line));
+        }
+        while (consume(','));
+        expect(')');
+        return true;
+    }
+
+    bool read_polygons(geometry::multi_polygon<double> & polygons)
+    {
+        if (!consume('(')) return false;
+        do
+        {
+            geometry::polygon<double> poly;
+            if (!read_rings(poly)) throw wkt_error();
+            polygons.push_back(std::move(poly));
+        }
+        while (consume(','));
+        expect(')');
+        return true;
+    }
+
+    bool read_geometries(geometry::geometry_collection<double> & collection)
+    {
+        if (!consume('(')) return false;
+        if (consume(')')) return true;
+        collection.reserve(count_elements());
+        do
+        {
+            geometry::geometry<double> geom;
+            if (!read_geometry(geom)) throw wkt_error();
+            collection.push_back(std::move(geom));
+        }
+        while (consume(','));
+        expect(')');
+        return true;
+    }
+
+    // false when no geometry keyword matches, throws on malformed bodies
+    bool read_geometry(geometry::geometry<double> & geom)
+    {
+        if (keyword("POINT"))
+        {
+            if (consume('('))
+            {
+                geometry::point<double> pt = read_point();
+                expect(')');
+                geom = pt;
+            }
+            else
+            {
+                expect_empty();
+                geom = geometry::geometry_empty();
+            }
+        }
+        else if (keyword("LINESTRING"))
+        {
+            geometry::line_string<double> line;
+            if (!read_positions(line)) expect_empty();
+            geom = std::move(line);
+        }
+        else if (keyword("POLYGON"))
+        {
+            geometry::polygon<double> poly;
+            if (!read_rings(poly)) expect_empty();
+            geom = std::move(poly);
+        }
+        else if (keyword("MULTIPOINT"))
+        {
+            geometry::multi_point<double> points;
+            if (!read_points(points)) expect_empty();
+            geom = std::move(points);
+        }
+        else if (keyword("MULTILINESTRING"))
+        {
+            geometry::multi_line_string<double> lines;
+            if (!read_lines(lines)) expect_empty();
+            geom = std::move(lines);
+        }
+        else if (keyword("MULTIPOLYGON"))
+        {
+            geometry::multi_polygon<double> polygons;
+            if (!read_polygons(polygons)) expect_empty();
+            geom = std::move(polygons);
+        }
+        else if (keyword("GEOMETRYCOLLECTION"))
+        {
+            geometry::geometry_collection<double> collection;
+            if (!read_geometries(collection)) expect_empty();
+            geom = std::move(collection);
+        }
+        else
+        {
+            return false;
+        }
+        return true;
+    }
+
+    char const* cur_;
+    char const* end_;
+};
+
+}
+
+bool from_wkt(char const* start, char const* end, mapnik::geometry::geometry<double> & geom)
 {
-    using namespace boost::spirit;
-    x3::ascii::space_type space;
-    std::string::const_iterator itr = wkt.begin();
-    std::string::const_iterator end =  wkt.end();
-    bool result;
     try
     {
-        result  = x3::phrase_parse(itr, end, wkt_grammar(), space, geom);
+        return wkt_reader(start, end).read(geom);
     }
-    catch (x3::expectation_failure<std::string::const_iterator> const& ex)
+    catch (wkt_error const&)
     {
         return false;
     }
-    return result && itr==end;
+}
+
+bool from_wkt(std::string const& wkt, mapnik::geometry::geometry<double> & geom)
+{
+    return from_wkt(wkt.data(), wkt.data() + wkt.size(), geom);
 }
 
 }
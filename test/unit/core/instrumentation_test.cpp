@@ -0,0 +1,131 @@
+#include "catch.hpp"
+
+#include <mapnik/instrumentation.hpp>
+
+#include <array>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+TEST_CASE("instrumentation") {
+
+SECTION("lock_guard") {
+
+    std::mutex mutex;
+    {
+        mapnik::instrumentation::lock_guard<std::mutex> lock(mutex, mapnik::instrumentation::lock_site::pool);
+        CHECK(!mutex.try_lock());
+    }
+    CHECK(mutex.try_lock());
+    mutex.unlock();
+}
+
+#ifdef MAPNIK_INSTRUMENTATION
+
+SECTION("counts allocations per stage") {
+
+    using namespace mapnik::instrumentation;
+    // kept outside the scopes, so the allocations cannot be optimised away
+    std::unique_ptr<std::vector<char>> ptr;
+    std::unique_ptr<int> other;
+    reset();
+    set_enabled(true);
+    {
+        stage_scope scope(stage::query);
+        ptr = std::make_unique<std::vector<char>>(1024);
+        {
+            stage_scope inner(stage::style);
+            other = std::make_unique<int>(1);
+        }
+    }
+    set_enabled(false);
+    snapshot snap = get_snapshot();
+    auto const& query = snap.stages[static_cast<unsigned>(stage::query)];
+    auto const& style = snap.stages[static_cast<unsigned>(stage::style)];
+    CHECK(query.allocations == 2);
+    CHECK(query.bytes >= 1024);
+    CHECK(style.allocations == 1);
+    CHECK(style.bytes == sizeof(int));
+}
+
+SECTION("counts allocations of running threads") {
+
+    using namespace mapnik::instrumentation;
+    reset();
+    set_enabled(true);
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool allocated = false;
+    bool resumed = false;
+    // outlive the worker, so the allocations cannot be optimised away
+    std::unique_ptr<std::array<char, 4096>> first;
+    std::unique_ptr<int> second;
+    std::thread worker([&] {
+        {
+            stage_scope scope(stage::query);
+            first = std::make_unique<std::array<char, 4096>>();
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        allocated = true;
+        cv.notify_one();
+        cv.wait(lock, [&] { return resumed; });
+        stage_scope scope(stage::query);
+        second = std::make_unique<int>(1);
+    });
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&] { return allocated; });
+    }
+
+    // seen while the worker is still running
+    auto query = get_snapshot().stages[static_cast<unsigned>(stage::query)];
+    CHECK(query.allocations == 1);
+    CHECK(query.bytes == 4096);
+
+    reset();
+    query = get_snapshot().stages[static_cast<unsigned>(stage::query)];
+    CHECK(query.allocations == 0);
+    CHECK(query.bytes == 0);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        resumed = true;
+    }
+    cv.notify_one();
+    worker.join();
+    set_enabled(false);
+
+    // kept after the worker exited, counted from the reset
+    query = get_snapshot().stages[static_cast<unsigned>(stage::query)];
+    CHECK(query.allocations == 1);
+    CHECK(query.bytes == sizeof(int));
+}
+
+SECTION("records lock acquisitions") {
+
+    using namespace mapnik::instrumentation;
+    reset();
+    set_enabled(true);
+    std::mutex mutex;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i)
+    {
+        threads.emplace_back([&mutex] {
+            for (int j = 0; j < 1000; ++j)
+            {
+                lock_guard<std::mutex> lock(mutex, lock_site::marker_cache);
+            }
+        });
+    }
+    for (auto & t : threads) t.join();
+    set_enabled(false);
+    auto const& stats = get_snapshot().locks[static_cast<unsigned>(lock_site::marker_cache)];
+    CHECK(stats.acquisitions == 4000);
+    CHECK(stats.contended <= stats.acquisitions);
+    CHECK(stats.max_wait_ns <= stats.wait_ns);
+}
+
+#endif
+}
@@ -0,0 +1,71 @@
+#include "catch.hpp"
+
+#include <mapnik/mapped_memory_cache.hpp>
+#include <mapnik/util/fs.hpp>
+
+#pragma GCC diagnostic push
+#include <mapnik/warning_ignore.hpp>
+#include <boost/filesystem/operations.hpp>
+#pragma GCC diagnostic pop
+
+#include <fstream>
+#include <string>
+
+#if defined(MAPNIK_MEMORY_MAPPED_FILE)
+
+TEST_CASE("mapped_memory_cache") {
+
+SECTION("evicts least recently used unpinned files") {
+
+    std::string directory_name("/tmp/mapnik-tests/");
+    boost::filesystem::create_directories(directory_name);
+    std::string files[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        files[i] = directory_name + "mapped-memory-cache-" + std::to_string(i);
+        std::ofstream file(files[i]);
+        file << std::string(10000, 'x');
+    }
+
+    auto & cache = mapnik::mapped_memory_cache::instance();
+    cache.clear();
+    auto before = cache.stats();
+    cache.set_max_size(25000);
+
+    auto pinned = cache.find(files[0], true, mapnik::mapped_access::random);
+    REQUIRE(pinned);
+    CHECK(cache.find(files[1], true, mapnik::mapped_access::will_need));
+    CHECK(cache.find(files[2], true));
+
+    // files[0] is still referenced, files[1] goes
+    auto stats = cache.stats();
+    CHECK(stats.misses - before.misses == 3);
+    CHECK(stats.evictions - before.evictions == 1);
+    CHECK(stats.size == 2);
+    CHECK(stats.bytes == 20000);
+
+    pinned = boost::none;
+    CHECK(cache.find(files[2]));
+    CHECK(cache.find(files[3], true));
+    stats = cache.stats();
+    CHECK(stats.hits - before.hits == 1);
+    CHECK(stats.evictions - before.evictions == 2);
+    CHECK(stats.size == 2);
+
+    // files[0] was the least recently used
+    CHECK(cache.remove(files[2]));
+    CHECK(cache.remove(files[3]));
+    CHECK(!cache.remove(files[0]));
+    CHECK(cache.stats().bytes == 0);
+
+    cache.set_max_size(0);
+    cache.clear();
+    for (auto const& file : files)
+    {
+        mapnik::util::remove(file);
+    }
+}
+
+}
+
+#endif
@@ -0,0 +1,91 @@
+#include "catch.hpp"
+
+#include <mapnik/task_scheduler.hpp>
+
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+TEST_CASE("task_scheduler") {
+
+SECTION("parallel_for") {
+
+    mapnik::task_scheduler::options opts;
+    opts.threads = 4;
+    mapnik::task_scheduler scheduler(opts);
+    std::vector<int> values(10000, 0);
+    mapnik::parallel_for(scheduler, 0, values.size(), 64,
+        [&values](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) values[i] += static_cast<int>(i);
+        });
+    std::vector<int> expected(values.size());
+    std::iota(expected.begin(), expected.end(), 0);
+    CHECK(values == expected);
+}
+
+SECTION("nested groups do not deadlock") {
+
+    // a single worker and more outer tasks than workers, every one of them
+    // waiting for tasks of its own
+    mapnik::task_scheduler::options opts;
+    opts.threads = 1;
+    mapnik::task_scheduler scheduler(opts);
+    std::atomic<int> count(0);
+    mapnik::task_group outer(scheduler);
+    for (int i = 0; i < 8; ++i)
+    {
+        outer.run([&scheduler, &count]() {
+                mapnik::task_group inner(scheduler);
+                for (int j = 0; j < 8; ++j)
+                {
+                    inner.run([&count]() { ++count; });
+                }
+                inner.wait();
+            });
+    }
+    outer.wait();
+    CHECK(count == 64);
+}
+
+SECTION("exceptions") {
+
+    mapnik::task_scheduler::options opts;
+    opts.threads = 2;
+    mapnik::task_scheduler scheduler(opts);
+    std::atomic<int> count(0);
+    mapnik::task_group group(scheduler);
+    group.run([]() { throw std::runtime_error("failed"); });
+    group.run([&count]() { ++count; });
+    CHECK_THROWS_AS(group.wait(), std::runtime_error);
+    CHECK(count == 1);
+    // reusable after an error
+    group.run([&count]() { ++count; });
+    CHECK_NOTHROW(group.wait());
+    CHECK(count == 2);
+}
+
+SECTION("submit") {
+
+    std::atomic<int> count(0);
+    {
+        mapnik::task_scheduler::options opts;
+        opts.threads = 2;
+        opts.pin_threads = true;
+        mapnik::task_scheduler scheduler(opts);
+        for (int i = 0; i < 100; ++i)
+        {
+            scheduler.submit([&count]() { ++count; });
+        }
+    }
+    // queued tasks run before the scheduler is destroyed
+    CHECK(count == 100);
+}
+
+SECTION("global") {
+
+    CHECK(&mapnik::task_scheduler::global() == &mapnik::task_scheduler::global());
+    CHECK_THROWS(mapnik::task_scheduler::configure_global(mapnik::task_scheduler::options()));
+}
+
+}
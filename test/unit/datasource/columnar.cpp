@@ -0,0 +1,266 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2017 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+#include "catch.hpp"
+#include "ds_test_util.hpp"
+#include "../../../plugins/input/columnar/columnar_writer.hpp"
+
+#include <mapnik/unicode.hpp>
+#include <mapnik/datasource.hpp>
+#include <mapnik/datasource_cache.hpp>
+#include <mapnik/feature_factory.hpp>
+#include <mapnik/geometry.hpp>
+#include <mapnik/geometry/envelope.hpp>
+#include <mapnik/util/fs.hpp>
+
+#pragma GCC diagnostic push
+#include <mapnik/warning_ignore.hpp>
+#include <boost/filesystem/operations.hpp>
+#pragma GCC diagnostic pop
+
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+
+namespace {
+
+// roads with a class, an optional name and a length; every tenth is a
+// multi line string
+void add_features(mapnik::columnar::columnar_writer & writer, std::size_t count)
+{
+    mapnik::transcoder tr("utf-8");
+    auto ctx = std::make_shared<mapnik::context_type>();
+    ctx->push("class");
+    ctx->push("name");
+    ctx->push("length");
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<double> coord(-1000.0, 1000.0);
+    static const char * classes[] = { "motorway", "primary", "residential" };
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        mapnik::feature_ptr feature(mapnik::feature_factory::create(ctx, static_cast<mapnik::value_integer>(i + 1)));
+        double x = coord(gen);
+        double y = coord(gen);
+        mapnik::geometry::line_string<double> line;
+        line.emplace_back(x, y);
+        line.emplace_back(x + 10, y + 5);
+        if (i % 10 == 0)
+        {
+            mapnik::geometry::multi_line_string<double> multi;
+            multi.push_back(line);
+            multi.emplace_back();
+            multi.back().emplace_back(x - 5, y);
+            multi.back().emplace_back(x - 5, y - 20);
+            feature->set_geometry(std::move(multi));
+        }
+        else
+        {
+            feature->set_geometry(std::move(line));
+        }
+        feature->put("class", tr.transcode(classes[i % 3]));
+        if (i % 2 == 0) feature->put("name", tr.transcode(("Street " + std::to_string(i)).c_str()));
+        feature->put("length", static_cast<mapnik::value_integer>(i * 10));
+        CHECK(writer.add(*feature));
+    }
+}
+
+std::shared_ptr<mapnik::columnar::columnar_file> write_to_memory(mapnik::columnar::columnar_writer const& writer)
+{
+    std::ostringstream out;
+    writer.write(out);
+    std::string data = out.str();
+    // 8 byte aligned, as a mapping would be
+    auto buffer = std::make_shared<std::vector<std::uint64_t>>((data.size() + 7) / 8);
+    std::memcpy(buffer->data(), data.data(), data.size());
+    return std::make_shared<mapnik::columnar::columnar_file>(buffer,
+                                                             reinterpret_cast<char const*>(buffer->data()),
+                                                             data.size());
+}
+
+}
+
+TEST_CASE("columnar") {
+
+    SECTION("round trip")
+    {
+        mapnik::columnar::columnar_writer writer(4);
+        add_features(writer, 500);
+        auto file = write_to_memory(writer);
+        REQUIRE(file->size() == 500);
+        REQUIRE(file->columns() == 3);
+
+        std::map<mapnik::value_integer, std::uint64_t> by_id;
+        for (std::uint64_t i = 0; i < file->size(); ++i)
+        {
+            by_id.emplace(file->id(i), i);
+        }
+        REQUIRE(by_id.size() == 500);
+
+        std::uint32_t name_col = 0, class_col = 0, length_col = 0;
+        for (std::uint32_t col = 0; col < file->columns(); ++col)
+        {
+            if (file->column_name(col) == "name") name_col = col;
+            else if (file->column_name(col) == "class") class_col = col;
+            else if (file->column_name(col) == "length") length_col = col;
+        }
+        CHECK(file->column(class_col).type == mapnik::columnar::column_type::string);
+        CHECK(file->column(class_col).dictionary_size == 3);
+        CHECK(file->column(length_col).type == mapnik::columnar::column_type::integer);
+
+        for (auto const& kv : by_id)
+        {
+            std::uint64_t i = kv.second;
+            std::size_t n = static_cast<std::size_t>(kv.first - 1);
+            CHECK(file->integer(length_col, i) == static_cast<std::int64_t>(n * 10));
+            CHECK(file->is_null(name_col, i) == (n % 2 != 0));
+            if (n % 2 == 0)
+            {
+                auto name = file->string(name_col, i);
+                CHECK(std::string(name.first, name.second) == "Street " + std::to_string(n));
+            }
+            auto geom = file->get_geometry(i);
+            if (n % 10 == 0)
+            {
+                REQUIRE(geom.is<mapnik::geometry::multi_line_string<double>>());
+                CHECK(geom.get<mapnik::geometry::multi_line_string<double>>().size() == 2);
+            }
+            else
+            {
+                REQUIRE(geom.is<mapnik::geometry::line_string<double>>());
+                CHECK(geom.get<mapnik::geometry::line_string<double>>().size() == 2);
+            }
+        }
+
+        // tree query matches a scan of the feature boxes
+        mapnik::box2d<double> query_box(-100, -300, 250, 50);
+        std::vector<std::uint64_t> result;
+        file->query(query_box, result);
+        std::vector<std::uint64_t> expected;
+        for (std::uint64_t i = 0; i < file->size(); ++i)
+        {
+            if (mapnik::geometry::envelope(file->get_geometry(i)).intersects(query_box)) expected.push_back(i);
+        }
+        CHECK(!expected.empty());
+        CHECK(result == expected);
+    }
+
+    SECTION("corrupt file")
+    {
+        mapnik::columnar::columnar_writer writer;
+        add_features(writer, 10);
+        std::ostringstream out;
+        writer.write(out);
+        std::string data = out.str();
+        std::vector<std::uint64_t> buffer((data.size() + 7) / 8);
+        std::memcpy(buffer.data(), data.data(), data.size());
+        char const* ptr = reinterpret_cast<char const*>(buffer.data());
+        CHECK_THROWS(mapnik::columnar::columnar_file(nullptr, ptr, data.size() - 8));
+        CHECK_THROWS(mapnik::columnar::columnar_file(nullptr, ptr + 8, data.size() - 8));
+
+        // geometry types out of range
+        auto & head = *reinterpret_cast<mapnik::columnar::header *>(buffer.data());
+        head.geometry_type = 9;
+        CHECK_THROWS(mapnik::columnar::columnar_file(nullptr, ptr, data.size()));
+        head.geometry_type = mapnik::datasource_geometry_t::LineString;
+        char * types = reinterpret_cast<char *>(buffer.data()) + head.types;
+        types[3] = 42;
+        mapnik::columnar::columnar_file file(nullptr, ptr, data.size());
+        CHECK_NOTHROW(file.get_geometry(2));
+        CHECK_THROWS(file.get_geometry(3));
+        types[3] = static_cast<char>(mapnik::geometry::geometry_types::GeometryCollection);
+        CHECK_THROWS(file.get_geometry(3));
+    }
+
+    std::string columnar_plugin("./plugins/input/columnar.input");
+    if (mapnik::util::exists(columnar_plugin))
+    {
+        SECTION("datasource")
+        {
+            std::string directory_name("/tmp/mapnik-tests/");
+            boost::filesystem::create_directories(directory_name);
+            std::string filename = directory_name + "roads.mcol";
+            {
+                mapnik::columnar::columnar_writer writer;
+                add_features(writer, 100);
+                std::ofstream out(filename, std::ios::binary);
+                writer.write(out);
+            }
+            mapnik::parameters params;
+            params["type"] = "columnar";
+            params["file"] = filename;
+            auto ds = mapnik::datasource_cache::instance().create(params);
+            REQUIRE(ds != nullptr);
+            CHECK(ds->type() == mapnik::datasource::datasource_t::Vector);
+            CHECK(*ds->get_geometry_type() == mapnik::datasource_geometry_t::LineString);
+            auto fields = ds->get_descriptor().get_descriptors();
+            require_field_names(fields, {"class", "length", "name"});
+            require_field_types(fields, {mapnik::String, mapnik::Integer, mapnik::String});
+            CHECK(count_features(all_features(ds)) == 100);
+            mapnik::util::remove(filename);
+        }
+
+        SECTION("unknown geometry types")
+        {
+            std::string directory_name("/tmp/mapnik-tests/");
+            boost::filesystem::create_directories(directory_name);
+            mapnik::columnar::columnar_writer writer;
+            add_features(writer, 10);
+            std::ostringstream out;
+            writer.write(out);
+            std::string data = out.str();
+            mapnik::columnar::header head;
+            std::memcpy(&head, data.data(), sizeof(head));
+
+            // files are mapped once per name, so each corruption gets its own
+            std::string feature_type_file = directory_name + "roads-feature-type.mcol";
+            {
+                std::string corrupt = data;
+                corrupt[head.types + 5] = 42;
+                std::ofstream file(feature_type_file, std::ios::binary);
+                file << corrupt;
+            }
+            std::string layer_type_file = directory_name + "roads-layer-type.mcol";
+            {
+                std::string corrupt = data;
+                corrupt[offsetof(mapnik::columnar::header, geometry_type)] = 9;
+                std::ofstream file(layer_type_file, std::ios::binary);
+                file << corrupt;
+            }
+
+            mapnik::parameters params;
+            params["type"] = "columnar";
+            params["file"] = feature_type_file;
+            auto ds = mapnik::datasource_cache::instance().create(params);
+            REQUIRE(ds != nullptr);
+            CHECK_THROWS_AS(count_features(all_features(ds)), mapnik::datasource_exception);
+
+            params["file"] = layer_type_file;
+            CHECK_THROWS_AS(mapnik::datasource_cache::instance().create(params), mapnik::datasource_exception);
+            mapnik::util::remove(feature_type_file);
+            mapnik::util::remove(layer_type_file);
+        }
+    }
+}
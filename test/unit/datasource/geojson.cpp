@@ -33,6 +33,7 @@
 #include <mapnik/util/fs.hpp>
 #include <cstdlib>
 #include <algorithm>
+#include <fstream>
 #include <cctype>
 #include <locale>
 #include <boost/optional/optional_io.hpp>
@@ -547,6 +548,82 @@ TEST_CASE("geojson") {
             }
         }
 
+        SECTION("GeoJSON properties beyond the sampled features")
+        {
+            // only the first feature is sampled for the descriptor (a, b)
+            std::string filename("/tmp/mapnik-geojson-unsampled-properties.json");
+            {
+                std::ofstream out(filename);
+                out << R"({"type":"FeatureCollection","features":[)"
+                    << R"({"type":"Feature","geometry":{"type":"Point","coordinates":[1,1]},"properties":{"a":1,"b":"x"}},)"
+                    << R"({"type":"Feature","geometry":{"type":"Point","coordinates":[2,2]},"properties":{"a":2,"b":"y","c":true}})"
+                    << "]}";
+            }
+            if (mapnik::util::exists(filename + ".index"))
+            {
+                mapnik::util::remove(filename + ".index");
+            }
+
+            for (auto create_index : { true, false })
+            {
+                if (create_index)
+                {
+                    int ret = create_disk_index(filename);
+                    int ret_posix = (ret >> 8) & 0x000000ff;
+                    INFO(ret);
+                    INFO(ret_posix);
+                    CHECK(mapnik::util::exists(filename + ".index"));
+                }
+
+                mapnik::parameters params;
+                params["type"] = "geojson";
+                params["file"] = filename;
+                params["cache_features"] = false;
+                params["num_features_to_query"] = 1;
+                auto ds = mapnik::datasource_cache::instance().create(params);
+                REQUIRE(ds != nullptr);
+                auto fields = ds->get_descriptor().get_descriptors();
+                REQUIRE(fields.size() == 2);
+
+                auto last_feature = [](mapnik::featureset_ptr features) {
+                    mapnik::feature_ptr feature, last;
+                    while ((feature = features->next())) last = feature;
+                    return last;
+                };
+
+                // all the described properties: nothing is filtered out
+                mapnik::query all(ds->envelope());
+                for (auto const& field : fields)
+                {
+                    all.add_property_name(field.get_name());
+                }
+                auto feature = last_feature(ds->features(all));
+                REQUIRE(feature != nullptr);
+                CHECK(feature->get("a") == mapnik::value_integer(2));
+                CHECK(feature->get("c") == mapnik::value_bool(true));
+
+                feature = last_feature(ds->features_at_point(mapnik::coord2d(2, 2), 0.5));
+                REQUIRE(feature != nullptr);
+                CHECK(feature->get("c") == mapnik::value_bool(true));
+
+                // a subset: only the requested properties are decoded
+                mapnik::query subset(ds->envelope());
+                subset.add_property_name("a");
+                feature = last_feature(ds->features(subset));
+                REQUIRE(feature != nullptr);
+                CHECK(feature->get("a") == mapnik::value_integer(2));
+                CHECK(feature->get("b").is_null());
+                CHECK(feature->get("c").is_null());
+
+                // cleanup
+                if (create_index && mapnik::util::exists(filename + ".index"))
+                {
+                    mapnik::util::remove(filename + ".index");
+                }
+            }
+            mapnik::util::remove(filename);
+        }
+
         SECTION("GeoJSON ensure mapnik::datasource_cache::instance().create() throws on malformed input")
         {
             mapnik::parameters params;
@@ -0,0 +1,91 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2017 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+#include "catch.hpp"
+#include "ds_test_util.hpp"
+
+#include <mapnik/lazy_datasource.hpp>
+#include <mapnik/datasource_cache.hpp>
+#include <mapnik/load_map.hpp>
+#include <mapnik/layer.hpp>
+#include <mapnik/map.hpp>
+#include <mapnik/util/fs.hpp>
+
+TEST_CASE("lazy datasource") {
+
+    SECTION("load_map defers creation")
+    {
+        std::string xml =
+            "<Map>"
+            "<Layer name=\"points\">"
+            "<Datasource>"
+            "<Parameter name=\"type\">no_such_plugin</Parameter>"
+            "<Parameter name=\"lazy\">true</Parameter>"
+            "</Datasource>"
+            "</Layer>"
+            "</Map>";
+        mapnik::Map map(256, 256);
+        REQUIRE_NOTHROW(mapnik::load_map_string(map, xml, true));
+        REQUIRE(map.layers().size() == 1);
+        auto ds = std::dynamic_pointer_cast<mapnik::lazy_datasource>(map.layers()[0].datasource());
+        REQUIRE(ds != nullptr);
+        CHECK(!ds->params().get<std::string>("lazy"));
+        CHECK(!ds->initialized());
+        // errors surface on the first query and creation is retried
+        CHECK_THROWS(ds->envelope());
+        CHECK_THROWS(ds->envelope());
+        CHECK(!ds->initialized());
+    }
+
+    std::string geojson_plugin("./plugins/input/geojson.input");
+    if (mapnik::util::exists(geojson_plugin))
+    {
+        SECTION("first query creates the datasource")
+        {
+            mapnik::parameters params;
+            params["type"] = "geojson";
+            params["inline"] = "{\"type\":\"FeatureCollection\",\"features\":[{\"type\":\"Feature\","
+                               "\"properties\":{},\"geometry\":{\"type\":\"Point\",\"coordinates\":[1,2]}}]}";
+            auto ds = std::make_shared<mapnik::lazy_datasource>(params);
+            CHECK(!ds->initialized());
+            CHECK(count_features(all_features(ds)) == 1);
+            CHECK(ds->initialized());
+            CHECK(ds->get() == ds->get());
+        }
+
+        SECTION("warm up")
+        {
+            mapnik::parameters params;
+            params["type"] = "geojson";
+            params["inline"] = "{\"type\":\"FeatureCollection\",\"features\":[{\"type\":\"Feature\","
+                               "\"properties\":{},\"geometry\":{\"type\":\"Point\",\"coordinates\":[1,2]}}]}";
+            auto ds = std::make_shared<mapnik::lazy_datasource>(params);
+            mapnik::Map map(256, 256);
+            mapnik::layer lyr("points");
+            lyr.set_datasource(ds);
+            map.add_layer(lyr);
+            auto done = mapnik::warm_up_datasources(map);
+            done.wait();
+            CHECK(ds->initialized());
+        }
+    }
+}
@@ -27,6 +27,38 @@
 #include <mapnik/datasource.hpp>
 #include <mapnik/memory_datasource.hpp>
 #include <mapnik/datasource_cache.hpp>
+#include <mapnik/feature_factory.hpp>
+#include <mapnik/filter_featureset.hpp>
+
+#include <array>
+#include <vector>
+
+namespace {
+
+struct even_id_filter
+{
+    bool pass(mapnik::feature_impl const& feature) const
+    {
+        return feature.id() % 2 == 0;
+    }
+};
+
+std::vector<mapnik::value_integer> batch_ids(mapnik::featureset_ptr const& fs)
+{
+    std::vector<mapnik::value_integer> ids;
+    std::array<mapnik::feature_ptr, mapnik::featureset_batch_size> batch;
+    while (std::size_t size = fs->next_batch(batch.data(), batch.size()))
+    {
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            REQUIRE(batch[i]);
+            ids.push_back(batch[i]->id());
+        }
+    }
+    return ids;
+}
+
+}
 
 
 TEST_CASE("memory datasource") {
@@ -43,4 +75,34 @@ TEST_CASE("memory datasource") {
             CHECK(false); // shouldn't get here
         }
     }
+
+    SECTION("batched featureset")
+    {
+        mapnik::parameters params;
+        auto ds = std::make_shared<mapnik::memory_datasource>(params);
+        auto ctx = std::make_shared<mapnik::context_type>();
+        for (mapnik::value_integer id = 1; id <= 150; ++id)
+        {
+            mapnik::feature_ptr feature(mapnik::feature_factory::create(ctx, id));
+            feature->set_geometry(mapnik::geometry::point<double>(id, id));
+            ds->push(feature);
+        }
+
+        std::vector<mapnik::value_integer> ids;
+        auto fs = all_features(ds);
+        while (auto f = fs->next())
+        {
+            ids.push_back(f->id());
+        }
+        REQUIRE(ids.size() == 150);
+        CHECK(batch_ids(all_features(ds)) == ids);
+
+        auto filtered = std::make_shared<mapnik::filter_featureset<even_id_filter>>(all_features(ds), even_id_filter());
+        auto even = batch_ids(filtered);
+        REQUIRE(even.size() == 75);
+        for (auto id : even)
+        {
+            CHECK(id % 2 == 0);
+        }
+    }
 }
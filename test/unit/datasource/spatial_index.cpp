@@ -84,4 +84,39 @@ TEST_CASE("spatial_index")
         REQUIRE(results[3] == 2);
         REQUIRE(results.size() == 4);
     }
+
+    SECTION("mapnik::quad_tree<T>::bulk_insert")
+    {
+        using value_type = std::int32_t;
+        using item_type = std::pair<value_type, mapnik::box2d<double>>;
+        mapnik::box2d<double> extent(0,0,100,100);
+        std::vector<item_type> items;
+        for (int i = 0; i < 10000; ++i)
+        {
+            double x = (i * 7919) % 97;
+            double y = (i * 104729) % 89;
+            double size = 0.1 + (i % 11);
+            items.emplace_back(i, mapnik::box2d<double>(x, y, x + size, y + size));
+        }
+        mapnik::quad_tree<value_type> tree0(extent);
+        for (auto const& item : items) tree0.insert(item.first, item.second);
+        tree0.trim();
+
+        auto extract = [](item_type const& item) -> item_type const& { return item; };
+        for (unsigned num_threads : {1u, 4u})
+        {
+            mapnik::quad_tree<value_type> tree1(extent);
+            tree1.bulk_insert(items, extract, num_threads);
+            tree1.trim();
+            REQUIRE(tree1.count() == tree0.count());
+            REQUIRE(tree1.count_items() == tree0.count_items());
+
+            // serialised trees must be byte-identical
+            std::ostringstream out0(std::ios::binary);
+            std::ostringstream out1(std::ios::binary);
+            tree0.write(out0);
+            tree1.write(out1);
+            REQUIRE(out0.str() == out1.str());
+        }
+    }
 }
@@ -0,0 +1,130 @@
+#include "catch.hpp"
+
+#include <mapnik/map.hpp>
+#include <mapnik/layer.hpp>
+#include <mapnik/memory_datasource.hpp>
+#include <mapnik/feature.hpp>
+#include <mapnik/feature_factory.hpp>
+#include <mapnik/geometry.hpp>
+#include <mapnik/hit_test_filter.hpp>
+
+namespace {
+
+std::shared_ptr<mapnik::memory_datasource> prepare_datasource()
+{
+    mapnik::parameters params;
+    params["type"] = "memory";
+    auto ds = std::make_shared<mapnik::memory_datasource>(params);
+    auto ctx = std::make_shared<mapnik::context_type>();
+
+    // square with a hole
+    mapnik::geometry::polygon<double> poly;
+    mapnik::geometry::linear_ring<double> exterior;
+    exterior.emplace_back(0, 0);
+    exterior.emplace_back(100, 0);
+    exterior.emplace_back(100, 100);
+    exterior.emplace_back(0, 100);
+    exterior.emplace_back(0, 0);
+    poly.push_back(std::move(exterior));
+    mapnik::geometry::linear_ring<double> hole;
+    hole.emplace_back(40, 40);
+    hole.emplace_back(40, 60);
+    hole.emplace_back(60, 60);
+    hole.emplace_back(60, 40);
+    hole.emplace_back(40, 40);
+    poly.push_back(std::move(hole));
+    mapnik::feature_ptr feature(mapnik::feature_factory::create(ctx, 1));
+    feature->set_geometry(std::move(poly));
+    ds->push(feature);
+
+    // line along the top of the square
+    mapnik::geometry::line_string<double> line;
+    line.emplace_back(0, 102);
+    line.emplace_back(200, 102);
+    feature = mapnik::feature_factory::create(ctx, 2);
+    feature->set_geometry(std::move(line));
+    ds->push(feature);
+
+    feature = mapnik::feature_factory::create(ctx, 3);
+    feature->set_geometry(mapnik::geometry::point<double>(150, 150));
+    ds->push(feature);
+    return ds;
+}
+
+std::vector<mapnik::value_integer> ids(std::vector<mapnik::point_query_hit> const& hits, std::size_t point)
+{
+    std::vector<mapnik::value_integer> result;
+    for (auto const& hit : hits)
+    {
+        if (hit.point == point) result.push_back(hit.feature->id());
+    }
+    return result;
+}
+
+}
+
+TEST_CASE("query_map_points") {
+
+SECTION("hit distance") {
+    mapnik::geometry::geometry<double> pt(mapnik::geometry::point<double>(3, 4));
+    CHECK(mapnik::hit_distance(pt, 0, 0) == Approx(5.0));
+    mapnik::geometry::line_string<double> line;
+    line.emplace_back(0, 0);
+    line.emplace_back(10, 0);
+    CHECK(mapnik::hit_distance(line, 5, 2) == Approx(2.0));
+    mapnik::geometry::polygon<double> poly;
+    mapnik::geometry::linear_ring<double> ring;
+    ring.emplace_back(0, 0);
+    ring.emplace_back(10, 0);
+    ring.emplace_back(10, 10);
+    ring.emplace_back(0, 10);
+    poly.push_back(std::move(ring));
+    CHECK(mapnik::hit_distance(poly, 5, 5) == 0.0);
+    // polygons only count from inside, however close the point
+    CHECK(mapnik::hit_distance(poly, 12, 5) > 1e300);
+    CHECK(mapnik::hit_distance(poly, 10.001, 5) > 1e300);
+    mapnik::geometry::multi_polygon<double> multi;
+    multi.push_back(poly);
+    CHECK(mapnik::hit_distance(multi, 5, 5) == 0.0);
+    CHECK(mapnik::hit_distance(multi, 12, 5) > 1e300);
+    CHECK(mapnik::hit_distance(mapnik::geometry::geometry_empty(), 0, 0) > 1e300);
+}
+
+SECTION("batch") {
+    // 1 pixel per map unit, y pointing down on screen
+    mapnik::Map map(256, 256);
+    mapnik::layer lyr("layer");
+    lyr.set_datasource(prepare_datasource());
+    map.add_layer(lyr);
+    map.zoom_to_box(mapnik::box2d<double>(0, 0, 256, 256));
+
+    std::vector<mapnik::coord2d> points;
+    points.emplace_back(20, 256 - 20);   // inside the polygon
+    points.emplace_back(50, 256 - 50);   // inside the hole
+    points.emplace_back(20, 256 - 99.5); // inside the polygon, 2.5px from the line
+    points.emplace_back(151, 256 - 150); // next to the point
+    points.emplace_back(250, 256 - 250); // nothing
+    points.emplace_back(101.5, 256 - 50); // 1.5px outside the polygon
+    auto hits = map.query_map_points({0}, points, 3.0);
+
+    CHECK(ids(hits, 0) == std::vector<mapnik::value_integer>({1}));
+    CHECK(ids(hits, 1).empty());
+    // nearest first: inside the polygon beats the line
+    CHECK(ids(hits, 2) == std::vector<mapnik::value_integer>({1, 2}));
+    CHECK(ids(hits, 3) == std::vector<mapnik::value_integer>({3}));
+    CHECK(ids(hits, 4).empty());
+    CHECK(ids(hits, 5).empty());
+    for (auto const& hit : hits)
+    {
+        CHECK(hit.layer == 0);
+        CHECK(hit.distance <= 3.0);
+    }
+
+    // smaller tolerance misses the point
+    hits = map.query_map_points({0}, points, 0.5);
+    CHECK(ids(hits, 3).empty());
+
+    CHECK_THROWS(map.query_map_points({1}, points));
+}
+
+}
@@ -2,9 +2,13 @@
 #include "catch.hpp"
 
 #include <mapnik/palette.hpp>
+#include <algorithm>
 #include <fstream>
+#include <random>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <vector>
 #include <cerrno>
 
 std::string get_file_contents(std::string const& filename)
@@ -20,6 +24,19 @@ std::string get_file_contents(std::string const& filename)
   throw(errno);
 }
 
+namespace {
+
+int color_distance(mapnik::rgba const& x, mapnik::rgba const& y)
+{
+    int dr = x.r - y.r;
+    int dg = x.g - y.g;
+    int db = x.b - y.b;
+    int da = x.a - y.a;
+    return dr*dr + dg*dg + db*db + da*da;
+}
+
+}
+
 TEST_CASE("palette")
 {
 
@@ -87,4 +104,67 @@ SECTION("rgba palette - act pal_256")
 
 } // END SECTION
 
+SECTION("rgba palette - quantize finds the closest color")
+{
+    std::mt19937 gen(42);
+    for (unsigned size : { 2u, 16u, 100u, 256u })
+    {
+        std::string str;
+        for (unsigned i = 0; i < size * 4; ++i) str.push_back(static_cast<char>(gen() & 0xff));
+        mapnik::rgba_palette pal(str, mapnik::rgba_palette::PALETTE_RGBA);
+        std::vector<mapnik::rgba> colors;
+        for (unsigned i = 0; i < size; ++i)
+        {
+            colors.emplace_back(str[4 * i], str[4 * i + 1], str[4 * i + 2], str[4 * i + 3]);
+        }
+        std::sort(colors.begin(), colors.end(), mapnik::rgba::mean_sort_cmp());
+
+        std::vector<unsigned> row(4096);
+        for (unsigned & val : row) val = gen() | 1;
+        // palette colors map onto themselves
+        for (unsigned i = 0; i < size; ++i)
+        {
+            row[i] = colors[i].r | colors[i].g << 8 | colors[i].b << 16 | colors[i].a << 24;
+        }
+        std::vector<std::uint8_t> indices(row.size());
+        pal.quantize_row(row.data(), indices.data(), row.size());
+        unsigned mismatches = 0;
+        for (std::size_t x = 0; x < row.size(); ++x)
+        {
+            mapnik::rgba c(row[x]);
+            int best = color_distance(colors[0], c);
+            for (auto const& color : colors) best = std::min(best, color_distance(color, c));
+            unsigned char index = pal.quantize(row[x]);
+            if (index != indices[x] || color_distance(colors[index], c) != best) ++mismatches;
+        }
+        CHECK(mismatches == 0);
+    }
+} // END SECTION
+
+SECTION("rgba palette - concurrent quantize")
+{
+    std::mt19937 gen(7);
+    std::string str;
+    for (unsigned i = 0; i < 256 * 3; ++i) str.push_back(static_cast<char>(gen() & 0xff));
+    mapnik::rgba_palette pal(str, mapnik::rgba_palette::PALETTE_RGB);
+    std::vector<unsigned> row(1 << 16);
+    for (unsigned & val : row) val = gen();
+    std::vector<std::uint8_t> expected(row.size());
+    pal.quantize_row(row.data(), expected.data(), row.size());
+
+    std::vector<std::vector<std::uint8_t>> results(4, std::vector<std::uint8_t>(row.size()));
+    std::vector<std::thread> threads;
+    for (auto & result : results)
+    {
+        threads.emplace_back([&pal, &row, &result] {
+            for (std::size_t x = 0; x < row.size(); ++x) result[x] = pal.quantize(row[x]);
+        });
+    }
+    for (auto & t : threads) t.join();
+    for (auto const& result : results)
+    {
+        CHECK(result == expected);
+    }
+} // END SECTION
+
 } // END TEST CASE
@@ -0,0 +1,166 @@
+#include "catch.hpp"
+
+#include <mapnik/renderer_common/process_building_symbolizer.hpp>
+
+#include <vector>
+
+namespace {
+
+// closed ring in screen coordinates, as emitted by the polygon adapters
+struct ring_path
+{
+    ring_path(std::vector<mapnik::vertex2d> const& points)
+        : points_(points), index_(0) {}
+
+    void rewind(unsigned) { index_ = 0; }
+
+    unsigned vertex(double * x, double * y)
+    {
+        if (index_ > points_.size()) return mapnik::SEG_END;
+        if (index_ == points_.size())
+        {
+            ++index_;
+            *x = *y = 0;
+            return mapnik::SEG_CLOSE;
+        }
+        auto const& pt = points_[index_++];
+        *x = pt.x;
+        *y = pt.y;
+        return index_ == 1 ? mapnik::SEG_MOVETO : mapnik::SEG_LINETO;
+    }
+
+    std::vector<mapnik::vertex2d> points_;
+    std::size_t index_;
+};
+
+ring_path square(double x, double y, double size, bool clockwise)
+{
+    std::vector<mapnik::vertex2d> points;
+    points.emplace_back(x, y, 0);
+    if (clockwise) points.emplace_back(x, y + size, 0);
+    else points.emplace_back(x + size, y, 0);
+    points.emplace_back(x + size, y + size, 0);
+    if (clockwise) points.emplace_back(x + size, y, 0);
+    else points.emplace_back(x, y + size, 0);
+    return ring_path(points);
+}
+
+// signed area of every closed sub-path
+std::vector<double> areas(mapnik::building_geometry::path path)
+{
+    std::vector<double> result;
+    std::vector<mapnik::vertex2d> ring;
+    double x, y;
+    path.rewind(0);
+    for (unsigned cmd = path.vertex(&x, &y); cmd != mapnik::SEG_END; cmd = path.vertex(&x, &y))
+    {
+        if (cmd == mapnik::SEG_CLOSE)
+        {
+            double area = 0.0;
+            for (std::size_t i = 0; i < ring.size(); ++i)
+            {
+                auto const& p0 = ring[i];
+                auto const& p1 = ring[(i + 1) % ring.size()];
+                area += p0.x * p1.y - p1.x * p0.y;
+            }
+            result.push_back(area / 2);
+            ring.clear();
+        }
+        else
+        {
+            ring.emplace_back(x, y, cmd);
+        }
+    }
+    return result;
+}
+
+unsigned count(mapnik::building_geometry::path path, unsigned command)
+{
+    unsigned result = 0;
+    double x, y;
+    path.rewind(0);
+    for (unsigned cmd = path.vertex(&x, &y); cmd != mapnik::SEG_END; cmd = path.vertex(&x, &y))
+    {
+        if (cmd == command) ++result;
+    }
+    return result;
+}
+
+}
+
+TEST_CASE("building_geometry") {
+
+SECTION("walls") {
+    for (bool clockwise : { false, true })
+    {
+        mapnik::building_geometry buildings;
+        auto footprint = square(10, 10, 20, clockwise);
+        buildings.add(footprint, 5.0, 0xff0000ff, 1.0);
+        REQUIRE(buildings.buildings().size() == 1);
+        auto const& building = buildings.buildings().front();
+        CHECK(building.depth == 30.0);
+
+        // one quad per edge, all wound the same way
+        auto walls = areas(buildings.walls(building));
+        REQUIRE(walls.size() == 4);
+        for (double area : walls)
+        {
+            CHECK(area <= 0.0);
+        }
+        CHECK(walls[0] + walls[1] + walls[2] + walls[3] == Approx(-2 * 20 * 5.0));
+
+        // open outline per wall
+        CHECK(count(buildings.frame(building), mapnik::SEG_MOVETO) == 4);
+        CHECK(count(buildings.frame(building), mapnik::SEG_CLOSE) == 0);
+
+        // roof is the footprint lifted by the height
+        auto roof = buildings.roof(building);
+        double x, y;
+        CHECK(roof.vertex(&x, &y) == mapnik::SEG_MOVETO);
+        CHECK(x == 10.0);
+        CHECK(y == 5.0);
+    }
+}
+
+SECTION("walls of a slanted footprint") {
+    for (bool reversed : { false, true })
+    {
+        std::vector<mapnik::vertex2d> points;
+        points.emplace_back(0, 0, 0);
+        points.emplace_back(30, 10, 0);
+        points.emplace_back(10, 25, 0);
+        if (reversed) std::swap(points[1], points[2]);
+        ring_path footprint(points);
+        mapnik::building_geometry buildings;
+        buildings.add(footprint, 8.0, 0xff0000ff, 1.0);
+        REQUIRE(buildings.buildings().size() == 1);
+        auto walls = areas(buildings.walls(buildings.buildings().front()));
+        REQUIRE(walls.size() == 3);
+        // each wall covers the width of its base edge times the height
+        for (double area : walls)
+        {
+            CHECK(area < 0.0);
+        }
+        CHECK(walls[0] + walls[1] + walls[2] == Approx(-2 * 30 * 8.0));
+    }
+}
+
+SECTION("back to front") {
+    mapnik::building_geometry buildings;
+    auto front = square(0, 100, 10, false);
+    auto back = square(0, 0, 10, false);
+    auto middle = square(50, 50, 10, false);
+    buildings.add(front, 5.0, 1, 1.0);
+    buildings.add(back, 5.0, 2, 1.0);
+    buildings.add(middle, 5.0, 3, 1.0);
+    buildings.sort_back_to_front();
+    REQUIRE(buildings.buildings().size() == 3);
+    CHECK(buildings.buildings()[0].fill == 2);
+    CHECK(buildings.buildings()[1].fill == 3);
+    CHECK(buildings.buildings()[2].fill == 1);
+
+    buildings.clear();
+    CHECK(buildings.empty());
+}
+
+}
@@ -13,6 +13,8 @@
 #include <mapnik/value/types.hpp>
 #include <mapnik/symbolizer.hpp>
 #include <mapnik/geometry/geometry_type.hpp>
+#include <mapnik/query.hpp>
+#include <mapnik/util/arena.hpp>
 
 struct rendering_result
 {
@@ -142,6 +144,37 @@ std::shared_ptr<mapnik::memory_datasource> prepare_datasource()
     return datasource;
 }
 
+// records the arena each query carries
+class arena_datasource : public mapnik::memory_datasource
+{
+public:
+    arena_datasource(std::vector<mapnik::util::arena_ptr> & arenas)
+        : mapnik::memory_datasource(prepare_params()),
+          arenas_(arenas)
+    {
+        mapnik::context_ptr ctx = std::make_shared<mapnik::context_type>();
+        mapnik::feature_ptr feature(mapnik::feature_factory::create(ctx, 1));
+        feature->set_geometry(mapnik::geometry::point<double>(1, 2));
+        push(feature);
+    }
+
+    virtual mapnik::featureset_ptr features(mapnik::query const& q) const
+    {
+        arenas_.push_back(q.get_arena());
+        return mapnik::memory_datasource::features(q);
+    }
+
+private:
+    static mapnik::parameters prepare_params()
+    {
+        mapnik::parameters params;
+        params["type"] = "memory";
+        return params;
+    }
+
+    std::vector<mapnik::util::arena_ptr> & arenas_;
+};
+
 mapnik::Map prepare_map()
 {
     mapnik::Map map(256, 256);
@@ -189,6 +222,38 @@ SECTION("test_renderer") {
     REQUIRE(mapnik::geometry::geometry_type(result.geometries[1]) == mapnik::geometry::geometry_types::LineString);
 }
 
+SECTION("test_renderer - queries carry the renderer's arena") {
+
+    mapnik::Map map(prepare_map());
+    std::vector<mapnik::util::arena_ptr> arenas;
+    for (char const* name : { "first", "second" })
+    {
+        mapnik::layer lyr(name);
+        lyr.set_datasource(std::make_shared<arena_datasource>(arenas));
+        lyr.add_style("lines");
+        map.add_layer(lyr);
+    }
+
+    rendering_result result;
+    {
+        test_renderer renderer(map, result);
+        renderer.apply();
+    }
+    REQUIRE(arenas.size() == 2);
+    REQUIRE(arenas[0]);
+    CHECK(arenas[0] == arenas[1]);
+
+    // each renderer brings its own
+    {
+        test_renderer renderer(map, result);
+        renderer.apply();
+    }
+    REQUIRE(arenas.size() == 4);
+    REQUIRE(arenas[2]);
+    CHECK(arenas[2] == arenas[3]);
+    CHECK(arenas[2] != arenas[0]);
+}
+
 SECTION("test_renderer - apply() with single layer") {
 
     mapnik::Map map(prepare_map());
@@ -0,0 +1,192 @@
+#include "catch.hpp"
+
+#include <mapnik/renderer_common/render_group_symbolizer.hpp>
+#include <mapnik/group/group_layout.hpp>
+#include <mapnik/group/group_rule.hpp>
+#include <mapnik/group/group_symbolizer_properties.hpp>
+#include <mapnik/feature.hpp>
+#include <mapnik/feature_factory.hpp>
+#include <mapnik/expression.hpp>
+#include <mapnik/map.hpp>
+#include <mapnik/projection.hpp>
+#include <mapnik/proj_transform.hpp>
+#include <mapnik/symbolizer.hpp>
+
+#include <limits>
+#include <vector>
+
+namespace {
+
+// flattened output of the render thunks, in the order they are dispatched
+struct thunk_recorder : mapnik::render_thunk_list_dispatch
+{
+    std::vector<double> output;
+
+    virtual void operator()(mapnik::vector_marker_render_thunk const& thunk)
+    {
+        agg::trans_affine const& tr = thunk.tr_;
+        output.insert(output.end(), { 0.0, offset_.x, offset_.y,
+                                      tr.sx, tr.shy, tr.shx, tr.sy, tr.tx, tr.ty,
+                                      thunk.opacity_ });
+    }
+
+    virtual void operator()(mapnik::raster_marker_render_thunk const&)
+    {
+        output.push_back(1.0);
+    }
+
+    virtual void operator()(mapnik::text_render_thunk const&)
+    {
+        output.push_back(2.0);
+    }
+};
+
+// two columns of markers sized by `size%`, columns with a size <= 0 are skipped
+mapnik::group_symbolizer make_symbolizer()
+{
+    mapnik::markers_symbolizer marker;
+    mapnik::put(marker, mapnik::keys::width, mapnik::parse_expression("[size%]"));
+    mapnik::put(marker, mapnik::keys::height, mapnik::parse_expression("[size%]"));
+    auto rule = std::make_shared<mapnik::group_rule>(mapnik::parse_expression("[size%] > 0"));
+    rule->append(marker);
+
+    auto props = std::make_shared<mapnik::group_symbolizer_properties>();
+    props->set_layout(mapnik::simple_row_layout(2.0));
+    props->add_rule(rule);
+
+    mapnik::group_symbolizer sym;
+    mapnik::put(sym, mapnik::keys::group_properties, props);
+    mapnik::put(sym, mapnik::keys::start_column, mapnik::value_integer(1));
+    mapnik::put(sym, mapnik::keys::num_columns, mapnik::value_integer(2));
+    mapnik::put(sym, mapnik::keys::allow_overlap, true);
+    return sym;
+}
+
+mapnik::feature_ptr make_feature(mapnik::value const& size1, mapnik::value const& size2,
+                                 mapnik::value_integer other)
+{
+    auto ctx = std::make_shared<mapnik::context_type>();
+    mapnik::feature_ptr feature(mapnik::feature_factory::create(ctx, 1));
+    feature->put_new("size1", size1);
+    feature->put_new("size2", size2);
+    feature->put_new("other", other);
+    feature->set_geometry(mapnik::geometry::point<double>(128, 128));
+    return feature;
+}
+
+struct fixture
+{
+    mapnik::Map map;
+    mapnik::attributes vars;
+    mapnik::projection proj;
+    mapnik::proj_transform prj_trans;
+    mapnik::box2d<double> clipping_extent;
+
+    fixture()
+        : map(256, 256),
+          vars(),
+          proj(map.srs(), true),
+          prj_trans(proj, proj),
+          clipping_extent(0, 0, 256, 256)
+    {
+        map.zoom_to_box(clipping_extent);
+    }
+
+    std::vector<double> render(mapnik::group_symbolizer const& sym,
+                               mapnik::feature_impl & feature,
+                               mapnik::renderer_common & common)
+    {
+        thunk_recorder recorder;
+        mapnik::render_group_symbolizer(sym, feature, vars, prj_trans, clipping_extent, common, recorder);
+        return recorder.output;
+    }
+
+    mapnik::group_symbolizer_cache::layout const* find(mapnik::group_symbolizer const& sym,
+                                                       mapnik::renderer_common const& common,
+                                                       mapnik::value const& size1,
+                                                       mapnik::value const& size2) const
+    {
+        REQUIRE(common.group_cache_);
+        return common.group_cache_->find({ &sym, clipping_extent, { size1, size2 } });
+    }
+};
+
+}
+
+TEST_CASE("group_symbolizer_cache") {
+
+fixture f;
+mapnik::group_symbolizer sym = make_symbolizer();
+
+SECTION("cache hit renders like an uncached render") {
+    mapnik::renderer_common common(f.map, f.vars, 0, 0, 256, 256, 1.0);
+    auto feature = make_feature(mapnik::value_integer(4), mapnik::value_integer(6), 1);
+    auto first = f.render(sym, *feature, common);
+    REQUIRE(!first.empty());
+    auto const* layout = f.find(sym, common, mapnik::value_integer(4), mapnik::value_integer(6));
+    REQUIRE(layout != nullptr);
+    CHECK(layout->matches.size() == 2);
+
+    // same values on another feature: served from the cache
+    auto same = make_feature(mapnik::value_integer(4), mapnik::value_integer(6), 2);
+    auto cached = f.render(sym, *same, common);
+    CHECK(f.find(sym, common, mapnik::value_integer(4), mapnik::value_integer(6)) == layout);
+
+    mapnik::renderer_common fresh(f.map, f.vars, 0, 0, 256, 256, 1.0);
+    auto uncached = f.render(sym, *same, fresh);
+    CHECK(cached == uncached);
+    CHECK(cached == first);
+}
+
+SECTION("keyed on the referenced properties") {
+    mapnik::renderer_common common(f.map, f.vars, 0, 0, 256, 256, 1.0);
+    auto small = make_feature(mapnik::value_integer(4), mapnik::value_integer(6), 1);
+    auto large = make_feature(mapnik::value_integer(4), mapnik::value_integer(10), 1);
+    auto small_out = f.render(sym, *small, common);
+    auto large_out = f.render(sym, *large, common);
+    CHECK(small_out != large_out);
+
+    auto const* small_layout = f.find(sym, common, mapnik::value_integer(4), mapnik::value_integer(6));
+    auto const* large_layout = f.find(sym, common, mapnik::value_integer(4), mapnik::value_integer(10));
+    REQUIRE(small_layout != nullptr);
+    REQUIRE(large_layout != nullptr);
+    CHECK(small_layout != large_layout);
+
+    // a different value type is a different key, even if it compares equal
+    CHECK(f.find(sym, common, mapnik::value_double(4), mapnik::value_integer(6)) == nullptr);
+    // as is another symbolizer
+    mapnik::group_symbolizer other_sym = make_symbolizer();
+    CHECK(common.group_cache_->find({ &other_sym, f.clipping_extent,
+                                      { mapnik::value_integer(4), mapnik::value_integer(6) } }) == nullptr);
+
+    // properties the group does not reference share the layout
+    auto other = make_feature(mapnik::value_integer(4), mapnik::value_integer(6), 42);
+    CHECK(f.render(sym, *other, common) == small_out);
+    CHECK(f.find(sym, common, mapnik::value_integer(4), mapnik::value_integer(6)) == small_layout);
+
+    // skipped columns are part of the key too
+    auto skipped = make_feature(mapnik::value_integer(4), mapnik::value_integer(0), 1);
+    auto skipped_out = f.render(sym, *skipped, common);
+    auto const* skipped_layout = f.find(sym, common, mapnik::value_integer(4), mapnik::value_integer(0));
+    REQUIRE(skipped_layout != nullptr);
+    CHECK(skipped_layout->matches.size() == 1);
+    CHECK(skipped_out.size() < small_out.size());
+}
+
+SECTION("NaN values always miss") {
+    mapnik::renderer_common common(f.map, f.vars, 0, 0, 256, 256, 1.0);
+    mapnik::value nan(std::numeric_limits<mapnik::value_double>::quiet_NaN());
+    auto feature = make_feature(mapnik::value_integer(4), nan, 1);
+    auto first = f.render(sym, *feature, common);
+    CHECK(f.find(sym, common, mapnik::value_integer(4), nan) == nullptr);
+
+    // rendering again evaluates the layout again, with the same result
+    auto second = f.render(sym, *feature, common);
+    CHECK(f.find(sym, common, mapnik::value_integer(4), nan) == nullptr);
+    CHECK(first == second);
+
+    mapnik::renderer_common fresh(f.map, f.vars, 0, 0, 256, 256, 1.0);
+    CHECK(f.render(sym, *feature, fresh) == first);
+}
+
+}
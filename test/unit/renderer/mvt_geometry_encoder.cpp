@@ -0,0 +1,131 @@
+#include "catch.hpp"
+
+#include <mapnik/mvt/mvt_geometry_encoder.hpp>
+
+#include <vector>
+
+namespace {
+
+// path of sub-paths in screen coordinates
+struct test_path
+{
+    void move_to(double x, double y) { vertices_.push_back({x, y, mapnik::SEG_MOVETO}); }
+    void line_to(double x, double y) { vertices_.push_back({x, y, mapnik::SEG_LINETO}); }
+    void close() { vertices_.push_back({0, 0, mapnik::SEG_CLOSE}); }
+
+    void rewind(unsigned) { index_ = 0; }
+
+    unsigned vertex(double * x, double * y)
+    {
+        if (index_ >= vertices_.size()) return mapnik::SEG_END;
+        auto const& v = vertices_[index_++];
+        *x = v.x;
+        *y = v.y;
+        return v.cmd;
+    }
+
+    struct vertex_type
+    {
+        double x;
+        double y;
+        unsigned cmd;
+    };
+
+    std::vector<vertex_type> vertices_;
+    std::size_t index_ = 0;
+};
+
+const mapnik::box2d<double> clip(-64, -64, 4160, 4160);
+
+}
+
+TEST_CASE("mvt geometry_encoder") {
+
+SECTION("zigzag") {
+    CHECK(mapnik::mvt::zigzag(0) == 0);
+    CHECK(mapnik::mvt::zigzag(-1) == 1);
+    CHECK(mapnik::mvt::zigzag(1) == 2);
+    CHECK(mapnik::mvt::zigzag(-2) == 3);
+    CHECK(mapnik::mvt::command_integer(mapnik::mvt::CMD_MOVE_TO, 1) == 9);
+    CHECK(mapnik::mvt::command_integer(mapnik::mvt::CMD_LINE_TO, 3) == 26);
+    CHECK(mapnik::mvt::command_integer(mapnik::mvt::CMD_CLOSE_PATH, 1) == 15);
+}
+
+SECTION("points") {
+    // examples from the specification
+    mapnik::mvt::geometry_encoder encoder(1.0, clip);
+    encoder.begin(mapnik::mvt::GEOM_POINT);
+    test_path path;
+    path.move_to(5, 7);
+    encoder.add_path(path);
+    test_path other;
+    other.move_to(3, 2);
+    encoder.add_path(other);
+    test_path outside;
+    outside.move_to(5000, 2);
+    encoder.add_path(outside);
+    REQUIRE(encoder.finish());
+    std::vector<std::uint32_t> expected = { 17, 10, 14, 3, 9 };
+    CHECK(encoder.commands() == expected);
+}
+
+SECTION("lines are snapped and deduplicated") {
+    // scale 2: screen (1,1) is tile (2,2)
+    mapnik::mvt::geometry_encoder encoder(2.0, clip);
+    encoder.begin(mapnik::mvt::GEOM_LINESTRING);
+    test_path path;
+    path.move_to(1, 1);
+    path.line_to(1.1, 1.1);
+    path.line_to(1, 5);
+    path.line_to(4, 5);
+    path.move_to(0.1, 0.1);
+    path.line_to(0.2, 0.2);
+    encoder.add_path(path);
+    REQUIRE(encoder.finish());
+    std::vector<std::uint32_t> expected = { 9, 4, 4, 18, 0, 16, 12, 0 };
+    CHECK(encoder.commands() == expected);
+}
+
+SECTION("polygon winding") {
+    mapnik::mvt::geometry_encoder encoder(1.0, clip);
+    encoder.begin(mapnik::mvt::GEOM_POLYGON);
+    // exterior counter-clockwise on screen, hole clockwise: both reversed;
+    // the hole starts relative to the last point of the exterior
+    test_path path;
+    path.move_to(0, 0);
+    path.line_to(0, 10);
+    path.line_to(10, 10);
+    path.line_to(10, 0);
+    path.line_to(0, 0);
+    path.close();
+    path.move_to(2, 2);
+    path.line_to(8, 2);
+    path.line_to(8, 8);
+    path.line_to(2, 8);
+    path.close();
+    encoder.add_path(path);
+    REQUIRE(encoder.finish());
+    std::vector<std::uint32_t> expected = {
+        9, 0, 0, 26, 20, 0, 0, 20, 19, 0, 15,
+        9, 4, 15, 26, 0, 12, 12, 0, 0, 11, 15 };
+    CHECK(encoder.commands() == expected);
+}
+
+SECTION("collapsed rings") {
+    mapnik::mvt::geometry_encoder encoder(1.0, clip);
+    encoder.begin(mapnik::mvt::GEOM_POLYGON);
+    // exterior collapses, so does the polygon
+    test_path path;
+    path.move_to(0, 0);
+    path.line_to(0.2, 0.1);
+    path.line_to(0.1, 0.3);
+    path.close();
+    path.move_to(2, 2);
+    path.line_to(8, 2);
+    path.line_to(8, 8);
+    path.close();
+    encoder.add_path(path);
+    CHECK(!encoder.finish());
+}
+
+}
@@ -0,0 +1,245 @@
+#include "catch.hpp"
+
+#if defined(MVT_RENDERER)
+
+#include <mapnik/mvt/mvt_renderer.hpp>
+#include <mapnik/memory_datasource.hpp>
+#include <mapnik/feature.hpp>
+#include <mapnik/feature_factory.hpp>
+#include <mapnik/expression.hpp>
+#include <mapnik/map.hpp>
+#include <mapnik/layer.hpp>
+#include <mapnik/rule.hpp>
+#include <mapnik/symbolizer.hpp>
+#include <mapnik/unicode.hpp>
+
+#include <protozero/pbf_reader.hpp>
+
+#include <string>
+#include <vector>
+
+namespace {
+
+struct decoded_layer
+{
+    std::string name;
+    std::uint32_t version = 0;
+    std::uint32_t extent = 0;
+    std::vector<std::string> keys;
+    std::size_t values = 0;
+    std::vector<std::uint32_t> types;
+    std::vector<std::vector<std::uint32_t>> geometries;
+};
+
+std::vector<decoded_layer> decode(std::string const& buffer)
+{
+    std::vector<decoded_layer> layers;
+    protozero::pbf_reader tile(buffer);
+    while (tile.next(3))
+    {
+        decoded_layer result;
+        protozero::pbf_reader layer = tile.get_message();
+        while (layer.next())
+        {
+            switch (layer.tag())
+            {
+            case 1: result.name = layer.get_string(); break;
+            case 3: result.keys.push_back(layer.get_string()); break;
+            case 4: ++result.values; layer.skip(); break;
+            case 5: result.extent = layer.get_uint32(); break;
+            case 15: result.version = layer.get_uint32(); break;
+            case 2:
+            {
+                protozero::pbf_reader feature = layer.get_message();
+                while (feature.next())
+                {
+                    if (feature.tag() == 3)
+                    {
+                        result.types.push_back(feature.get_enum());
+                    }
+                    else if (feature.tag() == 4)
+                    {
+                        auto range = feature.get_packed_uint32();
+                        result.geometries.emplace_back(range.begin(), range.end());
+                    }
+                    else
+                    {
+                        feature.skip();
+                    }
+                }
+                break;
+            }
+            default: layer.skip();
+            }
+        }
+        layers.push_back(std::move(result));
+    }
+    return layers;
+}
+
+mapnik::Map prepare_map()
+{
+    mapnik::parameters params;
+    params["type"] = "memory";
+    auto ds = std::make_shared<mapnik::memory_datasource>(params);
+    mapnik::context_ptr ctx = std::make_shared<mapnik::context_type>();
+    ctx->push("name");
+    ctx->push("lanes");
+    mapnik::transcoder tr("utf-8");
+    {
+        mapnik::feature_ptr feature(mapnik::feature_factory::create(ctx, 1));
+        mapnik::geometry::line_string<double> line;
+        line.emplace_back(0, 0);
+        line.emplace_back(50, 50);
+        line.emplace_back(100, 50);
+        feature->set_geometry(std::move(line));
+        feature->put("name", tr.transcode("main street"));
+        feature->put("lanes", mapnik::value_integer(2));
+        ds->push(feature);
+    }
+    {
+        mapnik::feature_ptr feature(mapnik::feature_factory::create(ctx, 2));
+        mapnik::geometry::polygon<double> poly;
+        mapnik::geometry::linear_ring<double> ring;
+        ring.emplace_back(10, 10);
+        ring.emplace_back(10, 40);
+        ring.emplace_back(40, 40);
+        ring.emplace_back(40, 10);
+        ring.emplace_back(10, 10);
+        poly.push_back(std::move(ring));
+        feature->set_geometry(std::move(poly));
+        feature->put("name", tr.transcode("park"));
+        ds->push(feature);
+    }
+    {
+        // filtered out by the style
+        mapnik::feature_ptr feature(mapnik::feature_factory::create(ctx, 3));
+        feature->set_geometry(mapnik::geometry::point<double>(20, 20));
+        feature->put("name", tr.transcode("hidden"));
+        ds->push(feature);
+    }
+
+    mapnik::Map map(256, 256);
+    mapnik::feature_type_style style;
+    {
+        mapnik::rule r;
+        r.set_filter(mapnik::parse_expression("[name] != 'hidden'"));
+        r.append(mapnik::line_symbolizer());
+        style.add_rule(std::move(r));
+    }
+    {
+        // matches the same features again
+        mapnik::rule r;
+        r.set_filter(mapnik::parse_expression("[name] = 'park'"));
+        r.append(mapnik::polygon_symbolizer());
+        style.add_rule(std::move(r));
+    }
+    map.insert_style("style", std::move(style));
+    mapnik::layer lyr("features");
+    lyr.set_datasource(ds);
+    lyr.add_style("style");
+    map.add_layer(lyr);
+    map.zoom_to_box(mapnik::box2d<double>(0, 0, 100, 100));
+    return map;
+}
+
+}
+
+TEST_CASE("mvt_renderer") {
+
+SECTION("encodes matched features") {
+    mapnik::Map map = prepare_map();
+    std::string buffer;
+    mapnik::mvt_renderer ren(map, buffer);
+    ren.apply();
+    REQUIRE(!buffer.empty());
+    auto layers = decode(buffer);
+    REQUIRE(layers.size() == 1);
+    auto const& layer = layers.front();
+    CHECK(layer.name == "features");
+    CHECK(layer.version == 2);
+    CHECK(layer.extent == 4096);
+    REQUIRE(layer.types.size() == 2);
+    CHECK(layer.types[0] == 2);
+    CHECK(layer.types[1] == 3);
+    CHECK(layer.keys.size() == 2);
+    CHECK(layer.values == 3);
+    // y axis points down in tile coordinates
+    std::vector<std::uint32_t> line = { 9, 0, 8192, 18, 4096, 4095, 4096, 0 };
+    CHECK(layer.geometries[0] == line);
+    std::vector<std::uint32_t> polygon = { 9, 820, 7372, 26, 0, 2455, 2456, 0, 0, 2456, 15 };
+    CHECK(layer.geometries[1] == polygon);
+}
+
+SECTION("tile extent") {
+    mapnik::Map map = prepare_map();
+    std::string buffer;
+    mapnik::mvt_renderer ren(map, buffer);
+    ren.set_tile_extent(256);
+    ren.apply();
+    auto layers = decode(buffer);
+    REQUIRE(layers.size() == 1);
+    CHECK(layers.front().extent == 256);
+    std::vector<std::uint32_t> line = { 9, 0, 512, 18, 256, 255, 256, 0 };
+    CHECK(layers.front().geometries[0] == line);
+}
+
+SECTION("several styles") {
+    mapnik::Map map = prepare_map();
+    mapnik::feature_type_style style;
+    mapnik::rule r;
+    r.append(mapnik::line_symbolizer());
+    style.add_rule(std::move(r));
+    map.insert_style("everything", std::move(style));
+    map.get_layer(0).add_style("everything");
+    for (bool cache_features : { false, true })
+    {
+        INFO("cache-features=" << cache_features);
+        map.get_layer(0).set_cache_features(cache_features);
+        std::string buffer;
+        mapnik::mvt_renderer ren(map, buffer);
+        ren.apply();
+        CHECK(ren.painted());
+        auto layers = decode(buffer);
+        REQUIRE(layers.size() == 1);
+        // line, park and the point only the second style matches, once each
+        CHECK(layers.front().types == std::vector<std::uint32_t>({ 2, 3, 1 }));
+    }
+}
+
+SECTION("features sharing an id") {
+    mapnik::parameters params;
+    params["type"] = "memory";
+    auto ds = std::make_shared<mapnik::memory_datasource>(params);
+    mapnik::context_ptr ctx = std::make_shared<mapnik::context_type>();
+    for (int i = 0; i < 3; ++i)
+    {
+        mapnik::feature_ptr feature(mapnik::feature_factory::create(ctx, 7));
+        feature->set_geometry(mapnik::geometry::point<double>(10 + 20 * i, 10));
+        ds->push(feature);
+    }
+    mapnik::Map map(256, 256);
+    mapnik::feature_type_style style;
+    mapnik::rule r;
+    r.append(mapnik::markers_symbolizer());
+    style.add_rule(std::move(r));
+    map.insert_style("points", std::move(style));
+    mapnik::layer lyr("points");
+    lyr.set_datasource(ds);
+    lyr.add_style("points");
+    map.add_layer(lyr);
+    map.zoom_to_box(mapnik::box2d<double>(0, 0, 100, 100));
+
+    std::string buffer;
+    mapnik::mvt_renderer ren(map, buffer);
+    CHECK(!ren.painted());
+    ren.apply();
+    CHECK(ren.painted());
+    auto layers = decode(buffer);
+    REQUIRE(layers.size() == 1);
+    CHECK(layers.front().types == std::vector<std::uint32_t>({ 1, 1, 1 }));
+}
+
+}
+
+#endif
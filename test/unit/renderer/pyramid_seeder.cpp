@@ -0,0 +1,160 @@
+#include "catch.hpp"
+
+#include <mapnik/pyramid_seeder.hpp>
+#include <mapnik/agg_renderer.hpp>
+#include <mapnik/memory_datasource.hpp>
+#include <mapnik/feature.hpp>
+#include <mapnik/feature_factory.hpp>
+#include <mapnik/expression.hpp>
+#include <mapnik/image_util.hpp>
+#include <mapnik/map.hpp>
+#include <mapnik/layer.hpp>
+#include <mapnik/rule.hpp>
+#include <mapnik/request.hpp>
+#include <mapnik/symbolizer.hpp>
+#include <mapnik/scale_denominator.hpp>
+#include <mapnik/well_known_srs.hpp>
+
+#include <map>
+#include <tuple>
+
+namespace {
+
+std::shared_ptr<mapnik::memory_datasource> prepare_datasource()
+{
+    mapnik::parameters params;
+    params["type"] = "memory";
+    auto ds = std::make_shared<mapnik::memory_datasource>(params);
+    mapnik::context_ptr ctx = std::make_shared<mapnik::context_type>();
+    ctx->push("kind");
+    mapnik::value_integer id = 0;
+    for (int i = -4; i < 4; ++i)
+    {
+        for (int j = -4; j < 4; ++j)
+        {
+            double x = i * 4e6 + 1e6;
+            double y = j * 4e6 + 1e6;
+            mapnik::geometry::polygon<double> poly;
+            mapnik::geometry::linear_ring<double> ring;
+            ring.emplace_back(x, y);
+            ring.emplace_back(x + 2e6, y);
+            ring.emplace_back(x + 2e6, y + 2e6);
+            ring.emplace_back(x, y + 2e6);
+            ring.emplace_back(x, y);
+            poly.push_back(std::move(ring));
+            mapnik::feature_ptr feature(mapnik::feature_factory::create(ctx, ++id));
+            feature->put("kind", mapnik::value_integer(id % 2));
+            feature->set_geometry(std::move(poly));
+            ds->push(feature);
+        }
+    }
+    return ds;
+}
+
+mapnik::Map prepare_map()
+{
+    mapnik::Map map(256, 256, "epsg:3857");
+    mapnik::feature_type_style style;
+    {
+        mapnik::rule r;
+        r.set_filter(mapnik::parse_expression("[kind] = 1"));
+        mapnik::polygon_symbolizer sym;
+        mapnik::put(sym, mapnik::keys::fill, mapnik::color(200, 0, 0));
+        r.append(std::move(sym));
+        style.add_rule(std::move(r));
+    }
+    {
+        // only drawn from z1 onwards
+        mapnik::rule r;
+        r.set_max_scale(mapnik::scale_denominator(2 * 20037508.342789244 / 256, false) / 1.5);
+        mapnik::line_symbolizer sym;
+        mapnik::put(sym, mapnik::keys::stroke_width, 3.0);
+        r.append(std::move(sym));
+        style.add_rule(std::move(r));
+    }
+    map.insert_style("squares", std::move(style));
+    mapnik::layer lyr("squares", "epsg:3857");
+    lyr.set_datasource(prepare_datasource());
+    lyr.add_style("squares");
+    map.add_layer(lyr);
+    return map;
+}
+
+mapnik::image_rgba8 render_tile(mapnik::Map map, int z, int x, int y)
+{
+    mapnik::box2d<double> extent = mapnik::pyramid_seeder::tile_extent(z, x, y);
+    map.zoom_to_box(extent);
+    mapnik::image_rgba8 image(256, 256);
+    mapnik::request req(256, 256, extent);
+    req.set_buffer_size(map.buffer_size());
+    mapnik::attributes vars;
+    mapnik::agg_renderer<mapnik::image_rgba8> ren(map, req, vars, image, 1.0, 0, 0);
+    ren.apply(mapnik::scale_denominator(req.extent().width() / 256, false));
+    return image;
+}
+
+}
+
+TEST_CASE("pyramid_seeder") {
+
+SECTION("tile extent") {
+    auto world = mapnik::pyramid_seeder::tile_extent(0, 0, 0);
+    CHECK(world.minx() == Approx(-20037508.342789244));
+    CHECK(world.maxy() == Approx(20037508.342789244));
+    auto tile = mapnik::pyramid_seeder::tile_extent(1, 1, 0);
+    CHECK(tile.minx() == Approx(0.0));
+    CHECK(tile.miny() == Approx(0.0));
+    CHECK(tile.maxx() == Approx(20037508.342789244));
+}
+
+SECTION("matches per tile rendering") {
+    mapnik::Map map = prepare_map();
+    mapnik::pyramid_seeder seeder(map);
+    seeder.set_query_depth(2);
+    std::map<std::tuple<int, int, int>, mapnik::image_rgba8> tiles;
+    std::size_t count = seeder.seed(0, 0, 0, 0, 3,
+        [&](int z, int x, int y, mapnik::image_rgba8 const& image) {
+            tiles.emplace(std::make_tuple(z, x, y), image);
+        });
+    CHECK(count == 1 + 4 + 16 + 64);
+    CHECK(tiles.size() == count);
+    // one query at z0 and one per z2 tile
+    CHECK(seeder.queries() == 1 + 16);
+    for (auto const& tile : tiles)
+    {
+        int z, x, y;
+        std::tie(z, x, y) = tile.first;
+        INFO(z << "/" << x << "/" << y);
+        CHECK(mapnik::compare(render_tile(map, z, x, y), tile.second) == 0);
+    }
+}
+
+SECTION("minzoom") {
+    mapnik::Map map = prepare_map();
+    mapnik::pyramid_seeder seeder(map);
+    std::size_t count = seeder.seed(0, 0, 0, 2, 2,
+        [](int z, int, int, mapnik::image_rgba8 const&) {
+            CHECK(z == 2);
+        });
+    CHECK(count == 16);
+    CHECK(seeder.queries() == 16);
+    CHECK_THROWS(seeder.seed(1, 2, 0, 1, 2, [](int, int, int, mapnik::image_rgba8 const&) {}));
+}
+
+SECTION("requires web mercator") {
+    mapnik::Map map = prepare_map();
+    map.set_srs("epsg:4326");
+    mapnik::pyramid_seeder seeder(map);
+    std::size_t count = 0;
+    CHECK_THROWS_AS(seeder.seed(0, 0, 0, 0, 1,
+        [&](int, int, int, mapnik::image_rgba8 const&) { ++count; }), std::runtime_error);
+    CHECK(count == 0);
+    CHECK(seeder.queries() == 0);
+
+    map.set_srs(mapnik::MAPNIK_GMERC_PROJ);
+    mapnik::pyramid_seeder merc_seeder(map);
+    CHECK(merc_seeder.seed(0, 0, 0, 0, 0,
+        [](int, int, int, mapnik::image_rgba8 const&) {}) == 1);
+}
+
+}
@@ -0,0 +1,143 @@
+#include "catch.hpp"
+
+// mapnik
+#include <mapnik/json/feature_builder.hpp>
+#include <mapnik/json/json_tokenizer.hpp>
+#include <mapnik/feature_factory.hpp>
+#include <mapnik/geometry/box2d.hpp>
+#include <mapnik/unicode.hpp>
+// stl
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+mapnik::feature_ptr build(std::string const& json, std::set<std::string> const* names = nullptr)
+{
+    static const mapnik::transcoder tr("utf8");
+    auto ctx = std::make_shared<mapnik::context_type>();
+    mapnik::feature_ptr feature(mapnik::feature_factory::create(ctx, 1));
+    mapnik::json::build_feature(json.c_str(), json.c_str() + json.size(), *feature, tr, names);
+    return feature;
+}
+
+bool geometry_ok(std::string const& json)
+{
+    mapnik::geometry::geometry<double> geom;
+    try
+    {
+        mapnik::json::build_geometry(json.c_str(), json.c_str() + json.size(), geom);
+    }
+    catch (std::exception const&)
+    {
+        return false;
+    }
+    return true;
+}
+
+}
+
+TEST_CASE("feature_builder") {
+
+SECTION("numbers") {
+    for (auto const& str : { "0", "-0.5", "1.1", "123456.789", "-179.99999999999997",
+                             "1e22", "1.7976931348623157e308", "4.9e-324", "0.000001234" })
+    {
+        std::string json(str);
+        mapnik::json::json_tokenizer tok(json.c_str(), json.c_str() + json.size());
+        double val = 0;
+        CHECK(mapnik::util::string2double(json, val));
+        CHECK(tok.read_double() == val);
+    }
+    std::string json("-42, 1.0");
+    mapnik::json::json_tokenizer tok(json.c_str(), json.c_str() + json.size());
+    mapnik::value_integer integer = 0;
+    double real = 0;
+    CHECK(tok.read_number(integer, real));
+    CHECK(integer == -42);
+    CHECK(tok.consume(','));
+    CHECK(!tok.read_number(integer, real));
+    CHECK(real == 1.0);
+}
+
+SECTION("feature") {
+    auto feature = build(R"({"properties": {"name": "Québec", "int": 1, "double": 1.5, "bool": false, "null": null,)"
+                         R"( "array": [1, "two", {"three": 3}], "object": {}},)"
+                         R"( "geometry": {"coordinates": [[[0, 0], [0, 10], [10, 10], [10, 0], [0, 0]]], "type": "Polygon"},)"
+                         R"( "id": 42, "type": "Feature"})");
+    mapnik::transcoder tr("utf8");
+    CHECK(feature->get("name") == tr.transcode("Québec"));
+    CHECK(feature->get("int") == mapnik::value_integer(1));
+    CHECK(feature->get("double") == mapnik::value_double(1.5));
+    CHECK(feature->get("bool") == mapnik::value_bool(false));
+    CHECK(feature->get("null").is_null());
+    CHECK(feature->get("array") == tr.transcode("[1,\"two\",{\"three\":3}]"));
+    CHECK(feature->get("object") == tr.transcode("{}"));
+    auto const& geom = feature->get_geometry();
+    REQUIRE(geom.is<mapnik::geometry::polygon<double>>());
+    auto const& poly = geom.get<mapnik::geometry::polygon<double>>();
+    REQUIRE(poly.size() == 1);
+    CHECK(poly.front().size() == 5);
+    CHECK(feature->envelope() == mapnik::box2d<double>(0, 0, 10, 10));
+}
+
+SECTION("property filtering") {
+    std::set<std::string> names = { "name" };
+    auto feature = build(R"({"type": "Feature", "geometry": null, "properties": {"name": "a", "skipped": {"deep": [1, 2]}}})", &names);
+    CHECK(feature->has_key("name"));
+    CHECK(!feature->has_key("skipped"));
+    CHECK(feature->context()->size() == 1);
+}
+
+SECTION("invalid features") {
+    for (auto const& json : { R"({"type": "FeatureCollection", "features": []})",
+                              R"({"type": "Point", "coordinates": [1, 2]})",
+                              R"({"type": "Feature", "properties": {"a": 1,}})",
+                              R"({"type": "Feature", "properties": {"a": [1, 2}}})",
+                              R"({"type": "Feature", "properties": {"a": "unterminated}})" })
+    {
+        CHECK_THROWS(build(json));
+    }
+}
+
+SECTION("geometries") {
+    for (auto const& json : { R"({"type": "Point", "coordinates": [1, 2, 3]})",
+                              R"({"coordinates": [[1, 2], [3, 4]], "type": "LineString"})",
+                              R"({"type": "MultiPolygon", "coordinates": [[[[0, 0], [1, 1], [1, 0], [0, 0]]]]})",
+                              R"({"type": "GeometryCollection", "geometries": [{"type": "Point", "coordinates": [1, 2]}]})",
+                              "null" })
+    {
+        CHECK(geometry_ok(json));
+    }
+    for (auto const& json : { R"({"type": "Point", "coordinates": []})",
+                              R"({"type": "Polygon", "coordinates": [[[]]]})",
+                              R"({"type": "Polygon", "coordinates": []})",
+                              R"({"type": "Circle", "coordinates": [1, 2]})",
+                              R"({"coordinates": [1, 2]})" })
+    {
+        CHECK(!geometry_ok(json));
+    }
+}
+
+SECTION("bounding boxes") {
+    std::string json = R"({"type": "FeatureCollection", "features": [)"
+        R"({"type": "Feature", "properties": {"text": "}{\""}, "geometry": {"type": "Point", "coordinates": [1, 2]}},)"
+        R"({"type": "Feature", "properties": {}, "geometry": null},)"
+        R"({"type": "Feature", "geometry": {"type": "Polygon", "coordinates": [[[0, 0], [0, 10], [10, 10], [0, 0]], [[-5, -5], [20, 20]]]}})"
+        "]}\n";
+    using boxes_type = std::vector<std::pair<mapnik::box2d<double>, std::pair<std::uint64_t, std::uint64_t>>>;
+    boxes_type boxes;
+    char const* start = json.c_str();
+    char const* itr = start;
+    mapnik::json::scan_bounding_boxes(itr, start + json.size(), boxes);
+    CHECK(itr == start + json.size());
+    // features without geometry are skipped and holes don't contribute
+    REQUIRE(boxes.size() == 2);
+    CHECK(boxes[0].first == mapnik::box2d<double>(1, 2, 1, 2));
+    CHECK(boxes[1].first == mapnik::box2d<double>(0, 0, 10, 10));
+    auto feature = build(json.substr(boxes[0].second.first, boxes[0].second.second));
+    CHECK(feature->get("text") == mapnik::transcoder("utf8").transcode("}{\""));
+}
+
+}
@@ -0,0 +1,112 @@
+#include "catch.hpp"
+
+// mapnik
+#include <mapnik/json/geojson_writer.hpp>
+#include <mapnik/json/geometry_parser.hpp>
+#include <mapnik/util/feature_to_geojson.hpp>
+#include <mapnik/util/geometry_to_geojson.hpp>
+#include <mapnik/feature_factory.hpp>
+#include <mapnik/unicode.hpp>
+// stl
+#include <string>
+
+namespace {
+
+std::string number(double val, unsigned precision = mapnik::json::geojson_default_precision)
+{
+    std::string out;
+    mapnik::json::geojson_writer writer(out, precision);
+    writer.write_number(val);
+    return out;
+}
+
+}
+
+TEST_CASE("geojson_writer") {
+
+SECTION("numbers") {
+    CHECK(number(0.0) == "0");
+    CHECK(number(-0.0) == "0");
+    CHECK(number(30.0) == "30");
+    CHECK(number(-10.0) == "-10");
+    CHECK(number(0.1) == "0.1");
+    CHECK(number(0.05) == "0.05");
+    CHECK(number(0.00001) == "0.00001");
+    CHECK(number(123456.789) == "123456.789");
+    CHECK(number(-179.99999999999997) == "-180");
+    CHECK(number(3.141592653589793) == "3.14159265358979");
+    CHECK(number(1e22) == "10000000000000000000000");
+    CHECK(number(-2.5e-30) == "-0.0000000000000000000000000000025");
+    CHECK(number(1.0 / 0.0) == "null");
+    CHECK(number(mapnik::value_integer(-42)) == "-42");
+}
+
+SECTION("precision") {
+    CHECK(number(3.141592653589793, 3) == "3.14");
+    CHECK(number(3.141592653589793, 6) == "3.14159");
+    CHECK(number(-0.000123456, 2) == "-0.00012");
+    CHECK(number(1234567.0, 3) == "1230000");
+    CHECK(number(0.30000000000000004, 17) == "0.30000000000000004");
+    CHECK(number(0.1, 17) == "0.10000000000000001");
+    CHECK(number(9.9996, 4) == "10");
+
+    std::string json;
+    mapnik::geometry::geometry<double> pt(mapnik::geometry::point<double>(12.3456789, -98.7654321));
+    CHECK(mapnik::util::to_geojson(json, pt, 5));
+    CHECK(json == "{\"type\":\"Point\",\"coordinates\":[12.346,-98.765]}");
+}
+
+SECTION("geometries") {
+    auto geometries =
+        {
+            "null",
+            "{\"type\":\"Point\",\"coordinates\":[30,10]}",
+            "{\"type\":\"LineString\",\"coordinates\":[[30,10],[10,30],[40,40.5]]}",
+            "{\"type\":\"LineString\",\"coordinates\":[]}",
+            "{\"type\":\"Polygon\",\"coordinates\":[[[35,10],[45,45],[15,40],[10,20],[35,10]],[[20,30],[35,35],[30,20],[20,30]]]}",
+            "{\"type\":\"Polygon\",\"coordinates\":[[]]}",
+            "{\"type\":\"MultiPoint\",\"coordinates\":[[10,40],[40,30]]}",
+            "{\"type\":\"MultiLineString\",\"coordinates\":[[[10,10],[20,20]],[[40,40],[30,30]]]}",
+            "{\"type\":\"MultiPolygon\",\"coordinates\":[[[[30,20],[45,40],[10,40],[30,20]]],[[[15,5],[40,10],[10,20],[15,5]]]]}",
+            "{\"type\":\"GeometryCollection\",\"geometries\":[{\"type\":\"Point\",\"coordinates\":[4,6]},{\"type\":\"LineString\",\"coordinates\":[[4,6],[7,10]]}]}"
+        };
+    for (std::string const& in : geometries)
+    {
+        mapnik::geometry::geometry<double> geom;
+        REQUIRE(mapnik::json::from_geojson(in, geom));
+        std::string out;
+        CHECK(mapnik::util::to_geojson(out, geom));
+        CHECK(out == in);
+    }
+}
+
+SECTION("feature") {
+    mapnik::transcoder tr("utf-8");
+    mapnik::context_ptr ctx = std::make_shared<mapnik::context_type>();
+    ctx->push("name");
+    ctx->push("height");
+    ctx->push("open");
+    ctx->push("ratio");
+    ctx->push("missing");
+    mapnik::feature_ptr feature(mapnik::feature_factory::create(ctx, 7));
+    feature->put("name", tr.transcode("Caf\xc3\xa9 \"Au\" \\ Lait\n\x01"));
+    feature->put("height", mapnik::value_integer(12));
+    feature->put("open", true);
+    feature->put("ratio", 0.25);
+    feature->set_geometry(mapnik::geometry::point<double>(1.5, -2));
+
+    std::string json;
+    CHECK(mapnik::util::to_geojson(json, *feature));
+    CHECK(json == "{\"type\":\"Feature\",\"id\":7,"
+                  "\"geometry\":{\"type\":\"Point\",\"coordinates\":[1.5,-2]},"
+                  "\"properties\":{\"height\":12,"
+                  "\"name\":\"Caf\xc3\xa9 \\\"Au\\\" \\\\ Lait\\n\\u0001\","
+                  "\"open\":true,\"ratio\":0.25}}");
+
+    // appends, so several features can share one buffer
+    std::string::size_type size = json.size();
+    CHECK(mapnik::util::to_geojson(json, *feature));
+    CHECK(json.size() == 2 * size);
+}
+
+}
@@ -0,0 +1,200 @@
+#include "catch.hpp"
+
+// mapnik
+#include <mapnik/wkt/wkt_factory.hpp>
+#include <mapnik/wkt/wkt_grammar_x3.hpp>
+#include <mapnik/util/geometry_to_wkt.hpp>
+#include <mapnik/geometry/geometry_type.hpp>
+// stl
+#include <random>
+#include <string>
+
+namespace {
+
+// reference result from the Spirit X3 grammar
+bool from_wkt_x3(std::string const& wkt, mapnik::geometry::geometry<double> & geom)
+{
+    namespace x3 = boost::spirit::x3;
+    std::string::const_iterator itr = wkt.begin();
+    std::string::const_iterator end = wkt.end();
+    try
+    {
+        bool result = x3::phrase_parse(itr, end, mapnik::wkt_grammar(), x3::ascii::space, geom);
+        return result && itr == end;
+    }
+    catch (x3::expectation_failure<std::string::const_iterator> const&)
+    {
+        return false;
+    }
+}
+
+void check_same(std::string const& wkt)
+{
+    INFO(wkt);
+    mapnik::geometry::geometry<double> geom;
+    mapnik::geometry::geometry<double> expected;
+    bool result = mapnik::from_wkt(wkt, geom);
+    REQUIRE(result == from_wkt_x3(wkt, expected));
+    if (!result) return;
+    CHECK(mapnik::geometry::geometry_type(geom) == mapnik::geometry::geometry_type(expected));
+    std::string out, expected_out;
+    CHECK(mapnik::util::to_wkt(out, geom) == mapnik::util::to_wkt(expected_out, expected));
+    CHECK(out == expected_out);
+}
+
+class wkt_fuzzer
+{
+public:
+    explicit wkt_fuzzer(unsigned seed)
+        : gen_(seed) {}
+
+    std::string geometry(int depth = 0)
+    {
+        static const char * keywords[] = { "POINT", "linestring", "Polygon", "MULTIPOINT",
+                                           "MultiLineString", "MULTIPOLYGON", "GEOMETRYCOLLECTION" };
+        int kind = random(7);
+        std::string wkt = std::string(keywords[kind]) + space();
+        if (random(8) == 0) return wkt + "EMPTY";
+        switch (kind)
+        {
+        case 0: return wkt + "(" + number() + " " + number() + ")";
+        case 1: return wkt + positions();
+        case 2: return wkt + list([&] { return positions(); });
+        case 3: return random(2) ? wkt + positions()
+                : wkt + list([&] { return "(" + number() + " " + number() + ")"; });
+        case 4: return wkt + list([&] { return positions(); });
+        case 5: return wkt + list([&] { return list([&] { return positions(); }); });
+        default:
+            if (depth > 2 || random(5) == 0) return wkt + "()";
+            return wkt + list([&] { return geometry(depth + 1); });
+        }
+    }
+
+    std::string mutate(std::string wkt)
+    {
+        static const char alphabet[] = "(), .-+eE0123456789PMLNY\t";
+        if (wkt.empty()) return wkt;
+        std::size_t pos = random(static_cast<int>(wkt.size()));
+        char c = alphabet[random(sizeof(alphabet) - 1)];
+        switch (random(4))
+        {
+        case 0: wkt.erase(pos, 1); break;
+        case 1: wkt.insert(pos, 1, c); break;
+        case 2: wkt[pos] = c; break;
+        default: wkt.resize(pos); break;
+        }
+        return wkt;
+    }
+
+    int random(int n)
+    {
+        return std::uniform_int_distribution<int>(0, n - 1)(gen_);
+    }
+
+private:
+    std::string number()
+    {
+        static const char * numbers[] = { "1", "-2.5", ".5", "5.", "1e3", "1e", "+3", "0", "1.5E-2",
+                                          "12345678901234567890123", "0.1", "-1234.5678e-3",
+                                          "9007199254740993", "1.2.3", "inf", "-Infinity" };
+        return numbers[random(16)];
+    }
+
+    std::string space()
+    {
+        static const char * spaces[] = { "", " ", "  ", "\t", "\n" };
+        return spaces[random(5)];
+    }
+
+    std::string positions()
+    {
+        int count = 1 + random(4);
+        std::string wkt = "(" + space();
+        for (int i = 0; i < count; ++i)
+        {
+            if (i > 0) wkt += "," + space();
+            wkt += number() + " " + number();
+        }
+        return wkt + space() + ")";
+    }
+
+    template <typename Element>
+    std::string list(Element element)
+    {
+        int count = 1 + random(3);
+        std::string wkt = "(";
+        for (int i = 0; i < count; ++i)
+        {
+            if (i > 0) wkt += ",";
+            wkt += element();
+        }
+        return wkt + ")";
+    }
+
+    std::mt19937 gen_;
+};
+
+}
+
+TEST_CASE("wkt reader") {
+
+SECTION("geometries") {
+    mapnik::geometry::geometry<double> geom;
+    REQUIRE(mapnik::from_wkt("POINT(1 2)", geom));
+    REQUIRE(geom.is<mapnik::geometry::point<double>>());
+    CHECK(geom.get<mapnik::geometry::point<double>>().x == 1.0);
+    CHECK(geom.get<mapnik::geometry::point<double>>().y == 2.0);
+
+    REQUIRE(mapnik::from_wkt(" polygon ((0 0, 10 0, 10 10, 0 0), (1 1, 2 1, 2 2, 1 1)) ", geom));
+    REQUIRE(geom.is<mapnik::geometry::polygon<double>>());
+    auto const& poly = geom.get<mapnik::geometry::polygon<double>>();
+    REQUIRE(poly.size() == 2);
+    CHECK(poly[0].size() == 4);
+    CHECK(poly[0].capacity() == 4);
+    CHECK(poly[1][2].x == 2.0);
+
+    REQUIRE(mapnik::from_wkt("MULTIPOINT((1 2),(3 4))", geom));
+    REQUIRE(geom.is<mapnik::geometry::multi_point<double>>());
+    CHECK(geom.get<mapnik::geometry::multi_point<double>>().size() == 2);
+
+    REQUIRE(mapnik::from_wkt("GEOMETRYCOLLECTION(POINT(1 2),LINESTRING EMPTY,GEOMETRYCOLLECTION())", geom));
+    REQUIRE(geom.is<mapnik::geometry::geometry_collection<double>>());
+    CHECK(geom.get<mapnik::geometry::geometry_collection<double>>().size() == 3);
+
+    REQUIRE(mapnik::from_wkt("POINT EMPTY", geom));
+    CHECK(geom.is<mapnik::geometry::geometry_empty>());
+
+    CHECK(!mapnik::from_wkt("", geom));
+    CHECK(!mapnik::from_wkt("POINT(1)", geom));
+    CHECK(!mapnik::from_wkt("POINT(1 2) POINT(3 4)", geom));
+    CHECK(!mapnik::from_wkt("LINESTRING(1 2,)", geom));
+    CHECK(!mapnik::from_wkt("MULTIPOINT((1 2),3 4)", geom));
+    CHECK(!mapnik::from_wkt("TRIANGLE((0 0,1 0,0 1,0 0))", geom));
+}
+
+SECTION("same as x3 grammar") {
+    for (auto const& wkt : { "POINT(1-2)", "POINT(1.2.3)", "POINT(.5 5.)", "POINT(1e 2)",
+                             "POINTEMPTY", "point(nan(abc) -inf)", "POINT(inf inity)", "POINT(- 5 1)",
+                             "MULTIPOINT(1 2,3 4)", "MULTIPOINT ( ( 1 2 ) )", "MULTIPOINT ()",
+                             "MULTIPOLYGON(((0 0,1 1,2 2)),((5 5,6 6,7 7),(1 1,2 2,3 3)))",
+                             "GEOMETRYCOLLECTION(POINT(1 2),)", "LINESTRING(1 2 3 4)",
+                             "POINT(0.1 123456789012345678901234567890)", "POINT(1e400 -1e-400)" })
+    {
+        check_same(wkt);
+    }
+}
+
+SECTION("fuzz") {
+    wkt_fuzzer fuzzer(99);
+    for (int i = 0; i < 20000; ++i)
+    {
+        std::string wkt = fuzzer.geometry();
+        for (int mutations = fuzzer.random(3); mutations > 0; --mutations)
+        {
+            wkt = fuzzer.mutate(wkt);
+        }
+        check_same(wkt);
+    }
+}
+
+}
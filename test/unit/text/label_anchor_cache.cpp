@@ -0,0 +1,116 @@
+#include "catch.hpp"
+
+#include <mapnik/label_anchor_cache.hpp>
+#include <mapnik/view_transform.hpp>
+#include <mapnik/geometry/interior.hpp>
+#include <mapnik/geometry/polylabel.hpp>
+
+namespace {
+
+// L-shaped polygon whose anchor is far from its centroid
+mapnik::geometry::polygon<double> l_shape(double x, double y, double size)
+{
+    mapnik::geometry::polygon<double> poly;
+    poly.emplace_back();
+    auto & ring = poly.front();
+    ring.emplace_back(x, y);
+    ring.emplace_back(x + size, y);
+    ring.emplace_back(x + size, y + size / 4);
+    ring.emplace_back(x + size / 4, y + size / 4);
+    ring.emplace_back(x + size / 4, y + size);
+    ring.emplace_back(x, y + size);
+    ring.emplace_back(x, y);
+    return poly;
+}
+
+mapnik::geometry::polygon<double> to_screen(mapnik::geometry::polygon<double> poly,
+                                            mapnik::view_transform const& t)
+{
+    for (auto & ring : poly)
+    {
+        for (auto & pt : ring) t.forward(&pt.x, &pt.y);
+    }
+    return poly;
+}
+
+}
+
+TEST_CASE("label_anchor_cache") {
+
+SECTION("anchors in map coordinates match screen space search") {
+    auto poly = l_shape(1000.0, 2000.0, 400.0);
+    for (double zoom : { 1.0, 4.0, 32.0 })
+    {
+        mapnik::box2d<double> extent(1000.0, 2000.0, 1000.0 + 400.0 / zoom, 2000.0 + 400.0 / zoom);
+        mapnik::view_transform t(256, 256, extent);
+        auto screen_poly = to_screen(poly, t);
+
+        mapnik::geometry::point<double> expected, pt;
+        REQUIRE(mapnik::geometry::interior(screen_poly, 1.0, expected));
+        REQUIRE(mapnik::label_anchor_cache::compute(mapnik::INTERIOR_PLACEMENT, poly, 1.0, pt));
+        t.forward(&pt.x, &pt.y);
+        CHECK(pt.x == Approx(expected.x));
+        CHECK(pt.y == Approx(expected.y));
+
+        double precision = mapnik::geometry::polylabel_precision(screen_poly, 1.0);
+        REQUIRE(mapnik::geometry::polylabel(screen_poly, precision, expected));
+        REQUIRE(mapnik::label_anchor_cache::compute(mapnik::POLYLABEL_PLACEMENT, poly, 1.0, pt));
+        t.forward(&pt.x, &pt.y);
+        CHECK(pt.x == Approx(expected.x));
+        CHECK(pt.y == Approx(expected.y));
+    }
+}
+
+SECTION("lookup") {
+    mapnik::label_anchor_cache cache;
+    auto poly = l_shape(0.0, 0.0, 100.0);
+    mapnik::label_anchor_cache::key_type key{"lakes", 7, mapnik::label_anchor_cache::hash(poly), mapnik::POLYLABEL_PLACEMENT};
+    mapnik::geometry::point<double> pt;
+    CHECK(!cache.find(key, 1.0, pt));
+
+    REQUIRE(cache.anchor(key, poly, 2.0, pt));
+    CHECK(cache.size() == 1);
+    // coarser searches reuse the anchor, finer ones do not
+    mapnik::geometry::point<double> cached;
+    CHECK(cache.find(key, 2.0, cached));
+    CHECK(cached.x == pt.x);
+    CHECK(cached.y == pt.y);
+    CHECK(cache.find(key, 4.0, cached));
+    CHECK(!cache.find(key, 1.0, cached));
+    REQUIRE(cache.anchor(key, poly, 1.0, pt));
+    CHECK(cache.size() == 1);
+    CHECK(cache.find(key, 1.0, cached));
+
+    // other layers, features, geometries and placements are separate entries
+    auto other = key;
+    other.layer = "parks";
+    CHECK(!cache.find(other, 4.0, cached));
+    other = key;
+    other.feature_id = 8;
+    CHECK(!cache.find(other, 4.0, cached));
+    other = key;
+    other.geometry_hash = mapnik::label_anchor_cache::hash(l_shape(0.0, 0.0, 101.0));
+    CHECK(other.geometry_hash != key.geometry_hash);
+    CHECK(!cache.find(other, 4.0, cached));
+    other = key;
+    other.placement = mapnik::INTERIOR_PLACEMENT;
+    CHECK(!cache.find(other, 4.0, cached));
+
+    cache.clear();
+    CHECK(cache.size() == 0);
+}
+
+SECTION("bounded size") {
+    mapnik::label_anchor_cache cache(1);
+    auto poly = l_shape(0.0, 0.0, 100.0);
+    mapnik::label_anchor_cache::key_type key{"lakes", 1, mapnik::label_anchor_cache::hash(poly), mapnik::INTERIOR_PLACEMENT};
+    mapnik::geometry::point<double> pt;
+    CHECK(cache.anchor(key, poly, 1.0, pt));
+    key.feature_id = 2;
+    // still computed, just not stored
+    CHECK(cache.anchor(key, poly, 1.0, pt));
+    CHECK(cache.size() == 1);
+    CHECK(!cache.find(key, 1.0, pt));
+}
+
+}
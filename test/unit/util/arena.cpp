@@ -0,0 +1,72 @@
+#include "catch.hpp"
+
+#include <mapnik/util/arena.hpp>
+#include <mapnik/feature_factory.hpp>
+
+// stl
+#include <algorithm>
+#include <vector>
+
+TEST_CASE("monotonic_arena") {
+
+SECTION("allocations are aligned and grow in blocks") {
+
+    mapnik::util::monotonic_arena arena(256);
+    void * p0 = arena.allocate(3, 1);
+    void * p1 = arena.allocate(sizeof(double), alignof(double));
+    CHECK(p0 != nullptr);
+    CHECK(reinterpret_cast<std::uintptr_t>(p1) % alignof(double) == 0);
+    CHECK(arena.blocks() == 1);
+    arena.allocate(1024);
+    CHECK(arena.blocks() == 2);
+    CHECK(arena.bytes_allocated() == 3 + sizeof(double) + 1024);
+}
+
+SECTION("features outlive featureset arena") {
+
+    mapnik::context_ptr ctx = std::make_shared<mapnik::context_type>();
+    ctx->push("name");
+    mapnik::feature_ptr feature;
+    {
+        auto arena = std::make_shared<mapnik::util::monotonic_arena>();
+        feature = mapnik::feature_factory::create(ctx, 1, arena);
+        CHECK(arena.use_count() > 1);
+        CHECK(arena->bytes_allocated() > 0);
+    }
+    feature->put("name", mapnik::value_integer(42));
+    CHECK(feature->id() == 1);
+    CHECK(feature->get("name") == mapnik::value_integer(42));
+    CHECK(mapnik::feature_factory::create(ctx, 2, mapnik::util::arena_ptr()) != nullptr);
+}
+
+SECTION("streaming features keeps memory bounded") {
+
+    mapnik::context_ptr ctx = std::make_shared<mapnik::context_type>();
+    ctx->push("name");
+    auto arena = std::make_shared<mapnik::util::monotonic_arena>(4096);
+    std::size_t max_blocks = 0;
+    for (mapnik::value_integer i = 0; i < 100000; ++i)
+    {
+        // a featureset hands out one feature at a time, the renderer drops it
+        mapnik::feature_ptr feature = mapnik::feature_factory::create(ctx, i, arena);
+        feature->put("name", i);
+        max_blocks = std::max(max_blocks, arena->blocks());
+    }
+    CHECK(arena->live() == 0);
+    CHECK(max_blocks == 1);
+    CHECK(arena->bytes_allocated() < 4096);
+
+    // memory is only rewound once nothing is alive
+    std::vector<mapnik::feature_ptr> kept;
+    for (mapnik::value_integer i = 0; i < 1000; ++i)
+    {
+        kept.push_back(mapnik::feature_factory::create(ctx, i, arena));
+    }
+    CHECK(arena->live() == 1000);
+    CHECK(arena->blocks() > 1);
+    for (auto const& feature : kept) CHECK(feature->get("name").is_null());
+    kept.clear();
+    mapnik::feature_factory::create(ctx, 1, arena);
+    CHECK(arena->blocks() == 1);
+}
+}
@@ -5,6 +5,7 @@
 #include <mapnik/util/conversions.hpp>
 #include <mapnik/util/trim.hpp>
 #include <mapnik/path.hpp>
+#include <mapnik/renderer_common/clipping_extent.hpp>
 
 #pragma GCC diagnostic push
 #include <mapnik/warning_ignore.hpp>
@@ -115,4 +116,22 @@ SECTION("lines") {
 
 }
 
+SECTION("envelope test") {
+
+    mapnik::box2d<double> clip_box(0, 0, 100, 100);
+    CHECK(mapnik::test_clip_envelope(clip_box, {10, 10, 90, 90}) == mapnik::clip_test::inside);
+    CHECK(mapnik::test_clip_envelope(clip_box, {0, 0, 100, 100}) == mapnik::clip_test::inside);
+    CHECK(mapnik::test_clip_envelope(clip_box, {50, 50, 150, 90}) == mapnik::clip_test::intersects);
+    CHECK(mapnik::test_clip_envelope(clip_box, {-10, -10, 110, 110}) == mapnik::clip_test::intersects);
+    CHECK(mapnik::test_clip_envelope(clip_box, {101, 0, 200, 100}) == mapnik::clip_test::outside);
+    CHECK(mapnik::test_clip_envelope(clip_box, mapnik::box2d<double>()) == mapnik::clip_test::outside);
+
+    // contained geometries pass through the clipper unchanged,
+    // so skipping it must not alter the output
+    mapnik::path_type path;
+    parse_geom(path, "10 10 1,50 90 2,90 10 2");
+    mapnik::vertex_adapter va(path);
+    REQUIRE(clip_line(clip_box, path) == dump_path(va));
+}
+
 }
@@ -0,0 +1,58 @@
+#include "catch.hpp"
+#include "fake_path.hpp"
+
+// mapnik
+#include <mapnik/decimate_converter.hpp>
+
+namespace decimate_test {
+
+TEST_CASE("decimate converter") {
+
+SECTION("empty") {
+    fake_path path = {};
+    mapnik::decimate_converter<fake_path> c(path);
+    double x, y;
+    REQUIRE(c.vertex(&x, &y) == mapnik::SEG_END);
+}
+
+SECTION("drops vertices within one cell but keeps sub-path ends") {
+    fake_path path = { 0, 0, 0.1, 0.1, 0.2, 0.05, 5, 5, 5.1, 5.1 };
+    mapnik::decimate_converter<fake_path> c(path);
+    double x, y;
+    REQUIRE(c.vertex(&x, &y) == mapnik::SEG_MOVETO);
+    REQUIRE(x == 0);
+    REQUIRE(y == 0);
+    REQUIRE(c.vertex(&x, &y) == mapnik::SEG_LINETO);
+    REQUIRE(x == 5);
+    REQUIRE(y == 5);
+    REQUIRE(c.vertex(&x, &y) == mapnik::SEG_LINETO);
+    REQUIRE(x == 5.1);
+    REQUIRE(y == 5.1);
+    REQUIRE(c.vertex(&x, &y) == mapnik::SEG_END);
+}
+
+SECTION("cell size") {
+    fake_path path = { 0, 0, 0.5, 0, 1.5, 0, 2.5, 0 };
+    mapnik::decimate_converter<fake_path> c(path);
+    c.set_cell_size(2.0);
+    double x, y;
+    REQUIRE(c.vertex(&x, &y) == mapnik::SEG_MOVETO);
+    REQUIRE(c.vertex(&x, &y) == mapnik::SEG_LINETO);
+    REQUIRE(x == 2.5);
+    REQUIRE(c.vertex(&x, &y) == mapnik::SEG_END);
+
+    c.rewind(0);
+    c.set_cell_size(0.25);
+    REQUIRE(c.vertex(&x, &y) == mapnik::SEG_MOVETO);
+    REQUIRE(c.vertex(&x, &y) == mapnik::SEG_LINETO);
+    REQUIRE(x == 0.5);
+    REQUIRE(c.vertex(&x, &y) == mapnik::SEG_LINETO);
+    REQUIRE(x == 1.5);
+    REQUIRE(c.vertex(&x, &y) == mapnik::SEG_LINETO);
+    REQUIRE(x == 2.5);
+    REQUIRE(c.vertex(&x, &y) == mapnik::SEG_END);
+}
+
+}
+
+}
@@ -7,7 +7,10 @@
 #include <mapnik/util/math.hpp>
 
 // stl
+#include <cmath>
 #include <iostream>
+#include <utility>
+#include <vector>
 
 namespace offset_test {
 
@@ -235,6 +238,197 @@ void test_s_shaped_curve(double const &offset) {
     }
 }
 
+struct expected_vertex
+{
+    unsigned cmd;
+    double x;
+    double y;
+};
+
+fake_path make_path(std::vector<double> const& coords, bool closed)
+{
+    fake_path path(coords);
+    if (closed)
+    {
+        path.vertices_.emplace_back(0, 0, mapnik::SEG_CLOSE);
+    }
+    path.rewind(0);
+    return path;
+}
+
+template <typename Converter>
+void check_vertices(Converter & converter, std::vector<expected_vertex> const& expected)
+{
+    double x, y;
+    for (auto const& v : expected)
+    {
+        REQUIRE(converter.vertex(&x, &y) == v.cmd);
+        CHECK(x == Approx(v.x).epsilon(1e-9));
+        CHECK(y == Approx(v.y).epsilon(1e-9));
+    }
+    REQUIRE(converter.vertex(&x, &y) == mapnik::SEG_END);
+}
+
+// Output of the offset_converter, printed to 12 digits. Outside turns are
+// rounded with arcs of pi/16 steps; the other vertices match the angle
+// based implementation (atan2/sin/cos per joint) it replaced, except for
+// the exact reversals of doubling_back, where that one took the side from
+// the rounding of atan2.
+
+std::vector<expected_vertex> const open_positive = {
+    { mapnik::SEG_MOVETO, 0, 2 },
+    { mapnik::SEG_LINETO, 8, 2 },
+    { mapnik::SEG_LINETO, 8, 10 },
+    { mapnik::SEG_LINETO, 8.03842943919, 10.390180644 },
+    { mapnik::SEG_LINETO, 8.15224093498, 10.7653668647 },
+    { mapnik::SEG_LINETO, 8.33706077539, 11.111140466 },
+    { mapnik::SEG_LINETO, 8.58578643763, 11.4142135624 },
+    { mapnik::SEG_LINETO, 8.88885953396, 11.6629392246 },
+    { mapnik::SEG_LINETO, 9.105572809, 11.788854382 },
+    { mapnik::SEG_LINETO, 19.105572809, 16.788854382 },
+    { mapnik::SEG_LINETO, 19.4717471541, 16.9289761354 },
+    { mapnik::SEG_LINETO, 19.8582219598, 16.9949684176 },
+    { mapnik::SEG_LINETO, 20.2501452161, 16.9842951824 },
+    { mapnik::SEG_LINETO, 20.632455532, 16.8973665961 },
+    { mapnik::SEG_LINETO, 20.9904609365, 16.7375232756 },
+    { mapnik::SEG_LINETO, 21.3104034827, 16.51090791 },
+    { mapnik::SEG_LINETO, 21.4142135624, 16.4142135624 },
+    { mapnik::SEG_LINETO, 31.4142135624, 6.41421356237 },
+};
+
+std::vector<expected_vertex> const open_negative = {
+    { mapnik::SEG_MOVETO, 0, -2 },
+    { mapnik::SEG_LINETO, 10, -2 },
+    { mapnik::SEG_LINETO, 10.390180644, -1.96157056081 },
+    { mapnik::SEG_LINETO, 10.7653668647, -1.84775906502 },
+    { mapnik::SEG_LINETO, 11.111140466, -1.66293922461 },
+    { mapnik::SEG_LINETO, 11.4142135624, -1.41421356237 },
+    { mapnik::SEG_LINETO, 11.6629392246, -1.11114046604 },
+    { mapnik::SEG_LINETO, 11.847759065, -0.76536686473 },
+    { mapnik::SEG_LINETO, 11.9615705608, -0.390180644032 },
+    { mapnik::SEG_LINETO, 12, 0 },
+    { mapnik::SEG_LINETO, 12, 8.7639320225 },
+    { mapnik::SEG_LINETO, 19.6050939018, 12.5664789734 },
+    { mapnik::SEG_LINETO, 28.5857864376, 3.58578643763 },
+};
+
+std::vector<expected_vertex> const closed_positive = {
+    { mapnik::SEG_MOVETO, 1, 1 },
+    { mapnik::SEG_LINETO, 9, 1 },
+    { mapnik::SEG_LINETO, 9, 9 },
+    { mapnik::SEG_LINETO, 1, 9 },
+    { mapnik::SEG_CLOSE, 0, 0 },
+};
+
+std::vector<expected_vertex> const closed_negative = {
+    { mapnik::SEG_MOVETO, 0, -1 },
+    { mapnik::SEG_LINETO, 10, -1 },
+    { mapnik::SEG_LINETO, 10.195090322, -0.980785280403 },
+    { mapnik::SEG_LINETO, 10.3826834324, -0.923879532511 },
+    { mapnik::SEG_LINETO, 10.555570233, -0.831469612303 },
+    { mapnik::SEG_LINETO, 10.7071067812, -0.707106781187 },
+    { mapnik::SEG_LINETO, 10.8314696123, -0.55557023302 },
+    { mapnik::SEG_LINETO, 10.9238795325, -0.382683432365 },
+    { mapnik::SEG_LINETO, 10.9807852804, -0.195090322016 },
+    { mapnik::SEG_LINETO, 11, 0 },
+    { mapnik::SEG_LINETO, 11, 10 },
+    { mapnik::SEG_LINETO, 10.9807852804, 10.195090322 },
+    { mapnik::SEG_LINETO, 10.9238795325, 10.3826834324 },
+    { mapnik::SEG_LINETO, 10.8314696123, 10.555570233 },
+    { mapnik::SEG_LINETO, 10.7071067812, 10.7071067812 },
+    { mapnik::SEG_LINETO, 10.555570233, 10.8314696123 },
+    { mapnik::SEG_LINETO, 10.3826834324, 10.9238795325 },
+    { mapnik::SEG_LINETO, 10.195090322, 10.9807852804 },
+    { mapnik::SEG_LINETO, 10, 11 },
+    { mapnik::SEG_LINETO, 0, 11 },
+    { mapnik::SEG_LINETO, -0.195090322016, 10.9807852804 },
+    { mapnik::SEG_LINETO, -0.382683432365, 10.9238795325 },
+    { mapnik::SEG_LINETO, -0.55557023302, 10.8314696123 },
+    { mapnik::SEG_LINETO, -0.707106781187, 10.7071067812 },
+    { mapnik::SEG_LINETO, -0.831469612303, 10.555570233 },
+    { mapnik::SEG_LINETO, -0.923879532511, 10.3826834324 },
+    { mapnik::SEG_LINETO, -0.980785280403, 10.195090322 },
+    { mapnik::SEG_LINETO, -1, 10 },
+    { mapnik::SEG_LINETO, -1, 0 },
+    { mapnik::SEG_LINETO, -0.980785280403, -0.195090322016 },
+    { mapnik::SEG_LINETO, -0.923879532511, -0.382683432365 },
+    { mapnik::SEG_LINETO, -0.831469612303, -0.55557023302 },
+    { mapnik::SEG_LINETO, -0.707106781187, -0.707106781187 },
+    { mapnik::SEG_LINETO, -0.55557023302, -0.831469612303 },
+    { mapnik::SEG_LINETO, -0.382683432365, -0.923879532511 },
+    { mapnik::SEG_LINETO, -0.195090322016, -0.980785280403 },
+    { mapnik::SEG_CLOSE, 0, 0 },
+};
+
+std::vector<expected_vertex> const zero_length_positive = {
+    { mapnik::SEG_MOVETO, 0, 1 },
+    { mapnik::SEG_LINETO, 9, 1 },
+    { mapnik::SEG_LINETO, 9, 11 },
+    { mapnik::SEG_LINETO, 10, 11 },
+    { mapnik::SEG_LINETO, 20, 11 },
+};
+
+std::vector<expected_vertex> const zero_length_negative = {
+    { mapnik::SEG_MOVETO, 0, -1 },
+    { mapnik::SEG_LINETO, 10, -1 },
+    { mapnik::SEG_LINETO, 11, -1 },
+    { mapnik::SEG_LINETO, 11, 9 },
+    { mapnik::SEG_LINETO, 20, 9 },
+};
+
+std::vector<expected_vertex> const spike_positive = {
+    { mapnik::SEG_MOVETO, 0, 1 },
+    { mapnik::SEG_LINETO, 9, 1 },
+    { mapnik::SEG_LINETO, 10, 11 },
+    { mapnik::SEG_LINETO, 11, 1 },
+    { mapnik::SEG_LINETO, 20, 1 },
+};
+
+std::vector<expected_vertex> const spike_negative = {
+    { mapnik::SEG_MOVETO, 0, -1 },
+    { mapnik::SEG_LINETO, 10, -1 },
+    { mapnik::SEG_LINETO, 10.195090322, -0.980785280403 },
+    { mapnik::SEG_LINETO, 10.3826834324, -0.923879532511 },
+    { mapnik::SEG_LINETO, 10.555570233, -0.831469612303 },
+    { mapnik::SEG_LINETO, 10.7071067812, -0.707106781187 },
+    { mapnik::SEG_LINETO, 10.8314696123, -0.55557023302 },
+    { mapnik::SEG_LINETO, 10.9238795325, -0.382683432365 },
+    { mapnik::SEG_LINETO, 10.9807852804, -0.195090322016 },
+    { mapnik::SEG_LINETO, 11, 0 },
+    { mapnik::SEG_LINETO, 10, 9 },
+    { mapnik::SEG_LINETO, 9, 0 },
+    { mapnik::SEG_LINETO, 9.0192147196, -0.195090322016 },
+    { mapnik::SEG_LINETO, 9.07612046749, -0.382683432365 },
+    { mapnik::SEG_LINETO, 9.1685303877, -0.55557023302 },
+    { mapnik::SEG_LINETO, 9.29289321881, -0.707106781187 },
+    { mapnik::SEG_LINETO, 9.44442976698, -0.831469612303 },
+    { mapnik::SEG_LINETO, 9.61731656763, -0.923879532511 },
+    { mapnik::SEG_LINETO, 9.80490967798, -0.980785280403 },
+    { mapnik::SEG_LINETO, 10, -1 },
+    { mapnik::SEG_LINETO, 20, -1 },
+};
+
+std::vector<expected_vertex> const doubling_back_positive = {
+    { mapnik::SEG_MOVETO, -24.7845250393, -47.0937219058 },
+    { mapnik::SEG_LINETO, 28.5401419596, -26.4262046178 },
+    { mapnik::SEG_CLOSE, 0, 0 },
+};
+
+std::vector<expected_vertex> const doubling_back_negative = {
+    { mapnik::SEG_MOVETO, -25.7845250393, -47.4813008341 },
+    { mapnik::SEG_LINETO, 27.5401419596, -26.8137835461 },
+    { mapnik::SEG_CLOSE, 0, 0 },
+};
+
+void check_output(std::vector<double> const& coords, bool closed, double offset,
+                               std::vector<expected_vertex> const& expected)
+{
+    fake_path path = make_path(coords, closed);
+    mapnik::offset_converter<fake_path> converter(path);
+    converter.set_offset(offset);
+    check_vertices(converter, expected);
+}
+
 } // END NS
 
 TEST_CASE("offset converter") {
@@ -382,4 +576,96 @@ SECTION("offsect converter does not skip SEG_MOVETO or SEG_CLOSE vertices") {
     CHECK(close_count == 2);
 }
 
+SECTION("joints") {
+    std::vector<double> const open = { 0, 0, 10, 0, 10, 10, 20, 15, 30, 5 };
+    offset_test::check_output(open, false, 2.0, offset_test::open_positive);
+    offset_test::check_output(open, false, -2.0, offset_test::open_negative);
+
+    std::vector<double> const square = { 0, 0, 10, 0, 10, 10, 0, 10 };
+    offset_test::check_output(square, true, 1.0, offset_test::closed_positive);
+    offset_test::check_output(square, true, -1.0, offset_test::closed_negative);
+
+    // repeated vertices make zero-length segments
+    std::vector<double> const zero_length = { 0, 0, 10, 0, 10, 0, 10, 10, 10, 10, 20, 10 };
+    offset_test::check_output(zero_length, false, 1.0, offset_test::zero_length_positive);
+    offset_test::check_output(zero_length, false, -1.0, offset_test::zero_length_negative);
+
+    // the line turns back on itself at (10, 10)
+    std::vector<double> const spike = { 0, 0, 10, 0, 10, 10, 10, 0, 20, 0 };
+    offset_test::check_output(spike, false, 1.0, offset_test::spike_positive);
+    offset_test::check_output(spike, false, -1.0, offset_test::spike_negative);
+
+    // ring of two vertices, the joints are exact reversals
+    std::vector<double> const doubling_back = { -25.284525039284386, -47.287511369974027,
+                                                28.040141959618254, -26.619994081944593 };
+    offset_test::check_output(doubling_back, true, 0.5, offset_test::doubling_back_positive);
+    offset_test::check_output(doubling_back, true, -0.5, offset_test::doubling_back_negative);
+}
+
+SECTION("outside turns are rounded in pi/16 steps") {
+    // a 90, a 135 and a 170 degree turn, all on the outside of the offset
+    std::vector<double> const coords = { -10, 0, 10, 0, 10, -10, 0, 0, 10, -7.002075382 };
+    std::vector<std::pair<double, double>> const joints = { { 10, 0 }, { 10, -10 }, { 0, 0 } };
+    double const offset = 1.5;
+    fake_path path = offset_test::make_path(coords, false);
+    mapnik::offset_converter<fake_path> converter(path);
+    converter.set_offset(offset);
+
+    std::vector<std::pair<double, double>> output;
+    double x, y;
+    while (converter.vertex(&x, &y) != mapnik::SEG_END)
+    {
+        output.emplace_back(x, y);
+    }
+
+    std::size_t arc_vertices = 0;
+    for (auto const& joint : joints)
+    {
+        // the vertices at the offset distance from the joint form its arc
+        std::vector<std::pair<double, double>> arc;
+        for (auto const& v : output)
+        {
+            double dx = v.first - joint.first;
+            double dy = v.second - joint.second;
+            if (std::abs(std::sqrt(dx * dx + dy * dy) - offset) < 1e-9)
+            {
+                arc.emplace_back(dx, dy);
+            }
+        }
+        REQUIRE(arc.size() >= 3);
+        arc_vertices += arc.size();
+        for (std::size_t i = 1; i < arc.size(); ++i)
+        {
+            double cos_step = (arc[i - 1].first * arc[i].first +
+                               arc[i - 1].second * arc[i].second) / (offset * offset);
+            CHECK(cos_step >= std::cos(mapnik::util::pi / 16) - 1e-9);
+        }
+    }
+    // 8 steps for 90 degrees, 12 for 135 and 16 for 170, each with both ends
+    CHECK(arc_vertices == 9 + 13 + 17);
+}
+
+SECTION("reuse across rewind") {
+    fake_path path = offset_test::make_path({ 0, 0, 10, 0, 10, 10, 0, 10 }, true);
+    mapnik::offset_converter_buffers buffers;
+    mapnik::offset_converter<fake_path> converter(path);
+    converter.set_buffers(buffers);
+    converter.set_offset(-1.0);
+    offset_test::check_vertices(converter, offset_test::closed_negative);
+    converter.rewind(0);
+    offset_test::check_vertices(converter, offset_test::closed_negative);
+
+    converter.set_offset(1.0);
+    offset_test::check_vertices(converter, offset_test::closed_positive);
+
+    // the next feature's converter takes over the buffers
+    fake_path other = offset_test::make_path({ 0, 0, 10, 0, 10, 10, 20, 15, 30, 5 }, false);
+    mapnik::offset_converter<fake_path> other_converter(other);
+    other_converter.set_buffers(buffers);
+    other_converter.set_offset(2.0);
+    offset_test::check_vertices(other_converter, offset_test::open_positive);
+    other_converter.rewind(0);
+    offset_test::check_vertices(other_converter, offset_test::open_positive);
+}
+
 }
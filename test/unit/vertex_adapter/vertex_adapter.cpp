@@ -334,4 +334,92 @@ SECTION("polygon with empty interior ring") {
     REQUIRE( y == Approx(0) );
 }
 
+SECTION("oriented polygon") {
+    // clockwise exterior and counter-clockwise hole, both get reversed
+    mapnik::geometry::polygon<double> g;
+    g.emplace_back();
+    g.back().emplace_back(0,0);
+    g.back().emplace_back(0,10);
+    g.back().emplace_back(10,10);
+    g.back().emplace_back(10,0);
+    g.back().emplace_back(0,0);
+    mapnik::geometry::linear_ring<double> hole;
+    hole.emplace_back(2,2);
+    hole.emplace_back(8,2);
+    hole.emplace_back(8,8);
+    hole.emplace_back(2,8);
+    hole.emplace_back(2,2);
+    g.push_back(std::move(hole));
+
+    mapnik::geometry::oriented_polygon_vertex_adapter<double> va(g);
+    double x,y;
+    unsigned cmd;
+
+    // exterior ring
+    cmd = va.vertex(&x,&y);
+    REQUIRE( cmd == mapnik::SEG_MOVETO );
+    REQUIRE( x == 0 );
+    REQUIRE( y == 0 );
+
+    cmd = va.vertex(&x,&y);
+    REQUIRE( cmd == mapnik::SEG_LINETO );
+    REQUIRE( x == 10 );
+    REQUIRE( y == 0 );
+
+    cmd = va.vertex(&x,&y);
+    REQUIRE( cmd == mapnik::SEG_LINETO );
+    REQUIRE( x == 10 );
+    REQUIRE( y == 10 );
+
+    cmd = va.vertex(&x,&y);
+    REQUIRE( cmd == mapnik::SEG_LINETO );
+    REQUIRE( x == 0 );
+    REQUIRE( y == 10 );
+
+    cmd = va.vertex(&x,&y);
+    REQUIRE( cmd == mapnik::SEG_CLOSE );
+
+    // interior ring
+    cmd = va.vertex(&x,&y);
+    REQUIRE( cmd == mapnik::SEG_MOVETO );
+    REQUIRE( x == 2 );
+    REQUIRE( y == 2 );
+
+    cmd = va.vertex(&x,&y);
+    REQUIRE( cmd == mapnik::SEG_LINETO );
+    REQUIRE( x == 2 );
+    REQUIRE( y == 8 );
+
+    cmd = va.vertex(&x,&y);
+    REQUIRE( cmd == mapnik::SEG_LINETO );
+    REQUIRE( x == 8 );
+    REQUIRE( y == 8 );
+
+    cmd = va.vertex(&x,&y);
+    REQUIRE( cmd == mapnik::SEG_LINETO );
+    REQUIRE( x == 8 );
+    REQUIRE( y == 2 );
+
+    cmd = va.vertex(&x,&y);
+    REQUIRE( cmd == mapnik::SEG_CLOSE );
+
+    cmd = va.vertex(&x,&y);
+    REQUIRE( cmd == mapnik::SEG_END );
+
+    // correctly oriented rings are passed through unchanged
+    mapnik::geometry::polygon<double> g2;
+    g2.emplace_back();
+    g2.back().emplace_back(0,0);
+    g2.back().emplace_back(10,0);
+    g2.back().emplace_back(10,10);
+    g2.back().emplace_back(0,0);
+    mapnik::geometry::oriented_polygon_vertex_adapter<double> va2(g2);
+    cmd = va2.vertex(&x,&y);
+    REQUIRE( cmd == mapnik::SEG_MOVETO );
+    cmd = va2.vertex(&x,&y);
+    REQUIRE( cmd == mapnik::SEG_LINETO );
+    REQUIRE( x == 10 );
+    REQUIRE( y == 0 );
+}
+
 }
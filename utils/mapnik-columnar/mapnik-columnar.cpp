@@ -0,0 +1,176 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2017 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <mapnik/version.hpp>
+#include <mapnik/datasource.hpp>
+#include <mapnik/datasource_cache.hpp>
+#include <mapnik/params.hpp>
+#include <mapnik/query.hpp>
+#include <mapnik/timer.hpp>
+
+#include "columnar_writer.hpp"
+
+#pragma GCC diagnostic push
+#include <mapnik/warning_ignore.hpp>
+#include <boost/program_options.hpp>
+#pragma GCC diagnostic pop
+
+int main (int argc, char** argv)
+{
+    namespace po = boost::program_options;
+    bool verbose = false;
+    std::string plugins = "./plugins/input/";
+    std::string output;
+    std::vector<std::string> args;
+    mapnik::box2d<double> bbox;
+    bool use_bbox = false;
+    unsigned int node_size = 16;
+    po::variables_map vm;
+    try
+    {
+        po::options_description desc("Mapnik columnar format converter\n\n"
+                                     "Usage: mapnik-columnar [options] -o output.mcol key=value ...\n"
+                                     "where key=value are the parameters of the input datasource,\n"
+                                     "e.g. type=postgis dbname=gis table=roads");
+        desc.add_options()
+            ("help,h", "Produce usage message")
+            ("version,V","Print version string")
+            ("verbose,v","Verbose output")
+            ("output,o", po::value<std::string>(), "Output file")
+            ("plugins,p", po::value<std::string>(), "Directory of the input plugins (default ./plugins/input/)")
+            ("bbox,b", po::value<std::string>(), "Only convert features within bounding box: --bbox=minx,miny,maxx,maxy")
+            ("node-size,n", po::value<unsigned int>(), "Children per node of the spatial index (default 16)")
+            ("params", po::value<std::vector<std::string> >(), "Datasource parameters: key1=value1 ... keyN=valueN")
+            ;
+
+        po::positional_options_description p;
+        p.add("params",-1);
+        po::store(po::command_line_parser(argc, argv)
+                  .options(desc)
+                  .style(po::command_line_style::unix_style | po::command_line_style::allow_long_disguise)
+                  .positional(p)
+                  .run(), vm);
+        po::notify(vm);
+
+        if (vm.count("version"))
+        {
+            std::clog << "version " << MAPNIK_VERSION_STRING << std::endl;
+            return 1;
+        }
+        if (vm.count("help") || !vm.count("output") || !vm.count("params"))
+        {
+            std::clog << desc << std::endl;
+            return 1;
+        }
+        if (vm.count("verbose"))
+        {
+            verbose = true;
+        }
+        if (vm.count("plugins"))
+        {
+            plugins = vm["plugins"].as<std::string>();
+        }
+        if (vm.count("node-size"))
+        {
+            node_size = vm["node-size"].as<unsigned int>();
+        }
+        if (vm.count("bbox") && bbox.from_string(vm["bbox"].as<std::string>()))
+        {
+            use_bbox = true;
+        }
+        output = vm["output"].as<std::string>();
+        args = vm["params"].as<std::vector<std::string>>();
+    }
+    catch (std::exception const& ex)
+    {
+        std::clog << "Error: " << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    mapnik::parameters params;
+    for (auto const& arg : args)
+    {
+        std::size_t pos = arg.find('=');
+        if (pos == std::string::npos)
+        {
+            std::clog << "Error: expected key=value, got '" << arg << "'" << std::endl;
+            return EXIT_FAILURE;
+        }
+        params[arg.substr(0, pos)] = arg.substr(pos + 1);
+    }
+
+    try
+    {
+        mapnik::datasource_cache::instance().register_datasources(plugins);
+        mapnik::datasource_ptr ds = mapnik::datasource_cache::instance().create(params);
+        mapnik::query q(use_bbox ? bbox : ds->envelope());
+        for (auto const& attr : ds->get_descriptor().get_descriptors())
+        {
+            q.add_property_name(attr.get_name());
+        }
+
+        mapnik::columnar::columnar_writer writer(node_size);
+        std::size_t skipped = 0;
+        {
+            mapnik::progress_timer __stats__(std::clog, "read features");
+            mapnik::featureset_ptr fs = ds->features(q);
+            if (fs)
+            {
+                while (mapnik::feature_ptr feature = fs->next())
+                {
+                    if (!writer.add(*feature)) ++skipped;
+                }
+            }
+        }
+        if (verbose)
+        {
+            std::clog << "features: " << writer.size() << ", skipped (empty geometry or collection): " << skipped << std::endl;
+        }
+
+        std::ofstream out(output, std::ios::binary);
+        if (!out)
+        {
+            std::clog << "Error: could not open '" << output << "' for writing" << std::endl;
+            return EXIT_FAILURE;
+        }
+        {
+            mapnik::progress_timer __stats__(std::clog, "write " + output);
+            writer.write(out);
+        }
+        if (!out)
+        {
+            std::clog << "Error: could not write '" << output << "'" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    catch (std::exception const& ex)
+    {
+        std::clog << "Error: " << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
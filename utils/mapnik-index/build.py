@@ -28,6 +28,9 @@ Import ('plugin_base')
 
 program_env = plugin_base.Clone()
 
+if env['PLATFORM'] == 'Linux':
+    program_env.Append(LINKFLAGS='-pthread')
+
 source = Split(
     """
     mapnik-index.cpp
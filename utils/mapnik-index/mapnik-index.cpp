@@ -24,9 +24,15 @@
 #include <vector>
 #include <string>
 #include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
 #include <mapnik/version.hpp>
 #include <mapnik/util/fs.hpp>
 #include <mapnik/quad_tree.hpp>
+#include <mapnik/timer.hpp>
 #include <mapnik/util/spatial_index.hpp>
 
 #include "process_csv_file.hpp"
@@ -71,6 +77,8 @@ int main (int argc, char** argv)
     std::string manual_headers;
     mapnik::box2d<float> bbox;
     bool use_bbox = false;
+    unsigned int threads = 1;
+    unsigned int concurrency = 1;
     po::variables_map vm;
     try
     {
@@ -87,6 +95,8 @@ int main (int argc, char** argv)
             ("files",po::value<std::vector<std::string> >(),"Files to index: file1 file2 ...fileN")
             ("validate-features", "Validate GeoJSON features")
             ("bbox,b", po::value<std::string>(), "Only index features within bounding box: --bbox=minx,miny,maxx,maxy")
+            ("threads,t", po::value<unsigned int>(), "Worker threads used to build each index (default 1)")
+            ("concurrency,c", po::value<unsigned int>(), "Number of files indexed concurrently (default 1)")
             ;
 
         po::positional_options_description p;
@@ -144,6 +154,14 @@ int main (int argc, char** argv)
         {
             use_bbox = true;
         }
+        if (vm.count("threads"))
+        {
+            threads = std::max(1u, vm["threads"].as<unsigned int>());
+        }
+        if (vm.count("concurrency"))
+        {
+            concurrency = std::max(1u, vm["concurrency"].as<unsigned int>());
+        }
     }
     catch (std::exception const& ex)
     {
@@ -178,66 +196,95 @@ int main (int argc, char** argv)
     using box_type = mapnik::box2d<float>;
     using item_type = std::pair<box_type, std::pair<std::uint64_t, std::uint64_t>>;
 
-    for (auto const& filename : files_to_process)
+    std::mutex log_mutex;
+    struct log_flusher
     {
+        log_flusher(std::ostringstream & log, std::mutex & mutex)
+            : log_(log), mutex_(mutex) {}
+        ~log_flusher()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::clog << log_.str() << std::flush;
+        }
+        std::ostringstream & log_;
+        std::mutex & mutex_;
+    };
+    auto index_file = [&](std::string const& filename) -> bool
+    {
+        // collect the output of each file, timings included, and write it in
+        // one go so that files indexed concurrently do not interleave
+        std::ostringstream log;
+        log_flusher flush_log(log, log_mutex);
         if (!mapnik::util::exists(filename))
         {
-            std::clog << "Error : file " << filename << " does not exist" << std::endl;
-            continue;
+            log << "Error : file " << filename << " does not exist" << std::endl;
+            return true;
         }
 
         std::vector<item_type> boxes;
         box_type extent;
-        if (mapnik::detail::is_csv(filename))
         {
-            std::clog << "processing '" << filename << "' as CSV\n";
-            auto result = mapnik::detail::process_csv_file(boxes, filename, manual_headers, separator, quote);
-            if (!result.first)
+            mapnik::progress_timer __stats__(log, filename + ": scan");
+            if (mapnik::detail::is_csv(filename))
             {
-                std::clog << "Error: failed to process " << filename << std::endl;
-                return EXIT_FAILURE;
+                log << "processing '" << filename << "' as CSV\n";
+                auto result = mapnik::detail::process_csv_file(boxes, filename, manual_headers, separator, quote);
+                if (!result.first)
+                {
+                    log << "Error: failed to process " << filename << std::endl;
+                    return false;
+                }
+                extent = result.second;
             }
-            extent = result.second;
-        }
-        else if (mapnik::detail::is_geojson(filename))
-        {
-            std::clog << "processing '" << filename << "' as GeoJSON\n";
-            std::pair<bool,mapnik::box2d<float>> result;
-            result = mapnik::detail::process_geojson_file_x3(boxes, filename, validate_features, verbose);
-            if (!result.first)
+            else if (mapnik::detail::is_geojson(filename))
             {
-                std::clog << "Error: failed to process " << filename << std::endl;
-                return EXIT_FAILURE;
+                log << "processing '" << filename << "' as GeoJSON\n";
+                std::pair<bool,mapnik::box2d<float>> result;
+                result = mapnik::detail::process_geojson_file_x3(boxes, filename, validate_features, verbose);
+                if (!result.first)
+                {
+                    log << "Error: failed to process " << filename << std::endl;
+                    return false;
+                }
+                extent = result.second;
             }
-            extent = result.second;
         }
 
         if (extent.valid())
         {
             auto tree_extent = use_bbox ? bbox : extent;
-            std::clog << tree_extent << std::endl;
             mapnik::quad_tree<mapnik::util::index_record, mapnik::box2d<float>> tree(tree_extent, depth, ratio);
-            for (auto const& item : boxes)
             {
-                auto ext_f = std::get<0>(item);
-                if (use_bbox && !bbox.intersects(ext_f)) continue;
-                mapnik::util::index_record rec =
-                    {std::get<1>(item).first, std::get<1>(item).second, ext_f};
-                tree.insert(rec, ext_f);
+                mapnik::progress_timer __stats__(log, filename + ": build tree");
+                if (use_bbox)
+                {
+                    boxes.erase(std::remove_if(boxes.begin(), boxes.end(),
+                                               [&bbox](item_type const& item) { return !bbox.intersects(std::get<0>(item)); }),
+                                boxes.end());
+                }
+                tree.bulk_insert(boxes, [](item_type const& item)
+                                 {
+                                     auto ext_f = std::get<0>(item);
+                                     mapnik::util::index_record rec =
+                                         {std::get<1>(item).first, std::get<1>(item).second, ext_f};
+                                     return std::make_pair(rec, ext_f);
+                                 }, threads);
+                tree.trim();
             }
 
+            mapnik::progress_timer __stats__(log, filename + ": write index");
             std::fstream file((filename + ".index").c_str(),
                               std::ios::in | std::ios::out | std::ios::trunc | std::ios::binary);
             if (!file)
             {
-                std::clog << "cannot open index file for writing file \""
-                          << (filename + ".index") << "\"" << std::endl;
+                log << "cannot open index file for writing file \""
+                    << (filename + ".index") << "\"" << std::endl;
             }
             else
             {
-                tree.trim();
-                std::clog << "number nodes=" << tree.count() << std::endl;
-                std::clog << "number element=" << tree.count_items() << std::endl;
+                log << filename << " " << tree_extent << std::endl;
+                log << filename << " number nodes=" << tree.count() << std::endl;
+                log << filename << " number element=" << tree.count_items() << std::endl;
                 file.exceptions(std::ios::failbit | std::ios::badbit);
                 tree.write(file);
                 file.flush();
@@ -246,10 +293,39 @@ int main (int argc, char** argv)
         }
         else
         {
-            std::clog << "Invalid extent " << extent << std::endl;
-            return EXIT_FAILURE;
+            log << "Invalid extent " << extent << std::endl;
+            return false;
+        }
+        return true;
+    };
+
+    mapnik::progress_timer __stats__(std::clog, "total");
+    std::atomic<std::size_t> next_file(0);
+    std::atomic<bool> success(true);
+    auto worker = [&]() {
+        for (std::size_t i = next_file++; i < files_to_process.size() && success; i = next_file++)
+        {
+            try
+            {
+                if (!index_file(files_to_process[i])) success = false;
+            }
+            catch (std::exception const& ex)
+            {
+                std::lock_guard<std::mutex> lock(log_mutex);
+                std::clog << "Error: " << files_to_process[i] << " " << ex.what() << std::endl;
+                success = false;
+            }
         }
+    };
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < std::min<std::size_t>(concurrency, files_to_process.size()); ++i)
+    {
+        workers.emplace_back(worker);
     }
+    worker();
+    for (auto & w : workers) w.join();
+
+    if (!success) return EXIT_FAILURE;
     std::clog << "done!" << std::endl;
     return EXIT_SUCCESS;
 }
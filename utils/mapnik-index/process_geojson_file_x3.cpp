@@ -38,7 +38,7 @@
 #include <mapnik/json/geojson_grammar_x3.hpp>
 #include <mapnik/json/unicode_string_grammar_x3.hpp>
 #include <mapnik/json/positions_grammar_x3.hpp>
-#include <mapnik/json/extract_bounding_boxes_x3.hpp>
+#include <mapnik/json/feature_builder.hpp>
 
 namespace {
 
@@ -267,17 +267,11 @@ std::pair<bool,typename T::value_type::first_type> process_geojson_file_x3(T & b
     base_iterator_type itr = start; // make a copy to preserve `start` iterator state
     try
     {
-        mapnik::json::extract_bounding_boxes(itr, end, boxes);
-    }
-    catch (boost::spirit::x3::expectation_failure<base_iterator_type> const& ex)
-    {
-        std::clog << ex.what() << std::endl;
-        std::clog << "Expected: " << ex.which();
-        std::clog << " Got: \"" << std::string(ex.where(), ex.where() + 200) << '"' << std::endl;
-        return std::make_pair(false, extent);
+        mapnik::json::scan_bounding_boxes(itr, end, boxes);
     }
     catch (std::exception const& ex)
     {
+        if (verbose) std::clog << ex.what() << std::endl;
         std::clog << "mapnik-index (GeoJSON) : could not extract bounding boxes from : '" <<  filename <<  "'" << std::endl;
         return std::make_pair(false, extent);
     }
@@ -0,0 +1,328 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2017 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+#include "batch_render.hpp"
+
+#include <mapnik/agg_renderer.hpp>
+#include <mapnik/image.hpp>
+#include <mapnik/image_util.hpp>
+#include <mapnik/image_view.hpp>
+#include <mapnik/instrumentation.hpp>
+#include <mapnik/request.hpp>
+#include <mapnik/util/conversions.hpp>
+#include <mapnik/util/trim.hpp>
+#include <mapnik/well_known_srs.hpp>
+
+#pragma GCC diagnostic push
+#include <mapnik/warning_ignore.hpp>
+#include <boost/algorithm/string.hpp>
+#pragma GCC diagnostic pop
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+
+namespace mapnik { namespace detail {
+
+namespace {
+
+constexpr double merc_max_extent = 20037508.342789244;
+constexpr double pi = 3.14159265358979323846;
+
+using clock_type = std::chrono::steady_clock;
+
+double elapsed_ms(clock_type::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+}
+
+struct job
+{
+    mapnik::box2d<double> bbox;
+    unsigned width;
+    unsigned height;
+    // item plus pixel offset into the rendered (meta)tile
+    std::vector<std::tuple<batch_item, unsigned, unsigned>> tiles;
+};
+
+struct stats
+{
+    std::vector<double> latency;
+    double render = 0.0;
+    double encode = 0.0;
+    double write = 0.0;
+    std::size_t tiles = 0;
+    std::size_t bytes = 0;
+    std::size_t failures = 0;
+};
+
+// z/x/y tiles are laid out on the spherical mercator grid
+bool is_web_mercator(std::string const& srs)
+{
+    std::string trimmed = util::trim_copy(srs);
+    auto known = is_well_known_srs(trimmed);
+    return known ? *known == G_MERC : boost::algorithm::iequals(trimmed, "epsg:3857");
+}
+
+std::string file_extension(std::string const& format)
+{
+    std::string type = format.substr(0, format.find(':'));
+    if (boost::algorithm::starts_with(type, "png")) return "png";
+    if (boost::algorithm::starts_with(type, "jpeg")) return "jpg";
+    if (boost::algorithm::starts_with(type, "tif")) return "tif";
+    return type;
+}
+
+std::vector<job> make_jobs(mapnik::Map const& map, std::vector<batch_item> const& items,
+                           batch_options const& options)
+{
+    bool const tiles = std::any_of(items.begin(), items.end(),
+                                   [](batch_item const& item) { return item.is_tile(); });
+    if (tiles && !is_web_mercator(map.srs()))
+    {
+        throw std::runtime_error("batch render: z/x/y tiles need a map in EPSG:3857, got '" + map.srs() + "'");
+    }
+    std::vector<job> jobs;
+    std::map<std::tuple<int,int,int>, std::vector<batch_item>> metatiles;
+    unsigned const ts = options.tile_size;
+    int const m = static_cast<int>(std::max(1u, options.metatile));
+    for (auto const& item : items)
+    {
+        if (item.is_tile())
+        {
+            metatiles[std::make_tuple(item.z, item.x / m, item.y / m)].push_back(item);
+        }
+        else
+        {
+            double aspect = item.bbox.height() / item.bbox.width();
+            unsigned height = std::max(1u, static_cast<unsigned>(std::lround(ts * aspect)));
+            jobs.push_back({item.bbox, ts, height, {std::make_tuple(item, 0u, 0u)}});
+        }
+    }
+    for (auto const& kv : metatiles)
+    {
+        int z = std::get<0>(kv.first);
+        int num_tiles = 1 << z;
+        int x0 = std::get<1>(kv.first) * m;
+        int y0 = std::get<2>(kv.first) * m;
+        int cols = std::min(m, num_tiles - x0);
+        int rows = std::min(m, num_tiles - y0);
+        double span = 2.0 * merc_max_extent / num_tiles;
+        double minx = -merc_max_extent + x0 * span;
+        double maxy = merc_max_extent - y0 * span;
+        job j{mapnik::box2d<double>(minx, maxy - rows * span, minx + cols * span, maxy),
+                cols * ts, rows * ts, {}};
+        for (auto const& item : kv.second)
+        {
+            j.tiles.emplace_back(item, (item.x - x0) * ts, (item.y - y0) * ts);
+        }
+        jobs.push_back(std::move(j));
+    }
+    return jobs;
+}
+
+void render_job(mapnik::Map const& map, job const& j, batch_options const& options, stats & s)
+{
+    auto start = clock_type::now();
+    mapnik::image_rgba8 im(j.width, j.height);
+    mapnik::request req(j.width, j.height, j.bbox);
+    req.set_buffer_size(map.buffer_size());
+    mapnik::agg_renderer<mapnik::image_rgba8> ren(map, req, options.vars, im, options.scale_factor, 0, 0);
+    ren.apply();
+    s.render += elapsed_ms(start);
+
+    std::string extension = file_extension(options.format);
+    for (auto const& tile : j.tiles)
+    {
+        batch_item const& item = std::get<0>(tile);
+        auto encode_start = clock_type::now();
+        std::string buffer;
+        if (j.tiles.size() == 1 && !item.is_tile())
+        {
+            buffer = mapnik::save_to_string(im, options.format);
+        }
+        else
+        {
+            mapnik::image_view_rgba8 view(std::get<1>(tile), std::get<2>(tile),
+                                          options.tile_size, options.tile_size, im);
+            buffer = mapnik::save_to_string(view, options.format);
+        }
+        s.encode += elapsed_ms(encode_start);
+        s.bytes += buffer.size();
+        ++s.tiles;
+
+        if (!options.output_dir.empty())
+        {
+            auto write_start = clock_type::now();
+            std::ostringstream name;
+            name << options.output_dir << "/";
+            if (item.is_tile()) name << item.z << "_" << item.x << "_" << item.y;
+            else name << "bbox_" << item.bbox.minx() << "_" << item.bbox.miny() << "_"
+                      << item.bbox.maxx() << "_" << item.bbox.maxy();
+            name << "." << extension;
+            std::ofstream file(name.str().c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+            if (!file) throw std::runtime_error("cannot open " + name.str() + " for writing");
+            file.write(buffer.data(), buffer.size());
+            s.write += elapsed_ms(write_start);
+        }
+    }
+    s.latency.push_back(elapsed_ms(start));
+}
+
+double percentile(std::vector<double> const& sorted, double q)
+{
+    if (sorted.empty()) return 0.0;
+    std::size_t index = std::min(sorted.size() - 1, static_cast<std::size_t>(q * sorted.size()));
+    return sorted[index];
+}
+
+} // anonymous ns
+
+bool parse_batch_item(std::string const& spec, batch_item & item)
+{
+    std::string str = boost::algorithm::trim_copy(spec);
+    if (str.empty()) return false;
+    if (str.find('/') != std::string::npos)
+    {
+        std::vector<std::string> parts;
+        boost::algorithm::split(parts, str, boost::algorithm::is_any_of("/"));
+        if (parts.size() != 3) return false;
+        mapnik::value_integer z, x, y;
+        if (!mapnik::util::string2int(parts[0], z)
+            || !mapnik::util::string2int(parts[1], x)
+            || !mapnik::util::string2int(parts[2], y)) return false;
+        if (z < 0 || z > 30 || x < 0 || y < 0 || x >= (1 << z) || y >= (1 << z)) return false;
+        item.z = static_cast<int>(z);
+        item.x = static_cast<int>(x);
+        item.y = static_cast<int>(y);
+        return true;
+    }
+    item.z = -1;
+    return item.bbox.from_string(str) && item.bbox.valid() && item.bbox.width() > 0;
+}
+
+void tiles_in_bbox(int z, mapnik::box2d<double> const& lonlat, std::vector<batch_item> & items)
+{
+    int num_tiles = 1 << z;
+    auto tile_x = [num_tiles](double lon) {
+        int x = static_cast<int>(std::floor((lon + 180.0) / 360.0 * num_tiles));
+        return std::max(0, std::min(num_tiles - 1, x));
+    };
+    auto tile_y = [num_tiles](double lat) {
+        double rad = std::max(-85.0511287798, std::min(85.0511287798, lat)) * pi / 180.0;
+        int y = static_cast<int>(std::floor((1.0 - std::log(std::tan(rad) + 1.0 / std::cos(rad)) / pi) / 2.0 * num_tiles));
+        return std::max(0, std::min(num_tiles - 1, y));
+    };
+    int x0 = tile_x(lonlat.minx());
+    int x1 = tile_x(lonlat.maxx());
+    int y0 = tile_y(lonlat.maxy());
+    int y1 = tile_y(lonlat.miny());
+    for (int x = x0; x <= x1; ++x)
+    {
+        for (int y = y0; y <= y1; ++y)
+        {
+            batch_item item;
+            item.z = z;
+            item.x = x;
+            item.y = y;
+            items.push_back(item);
+        }
+    }
+}
+
+std::size_t render_batch(mapnik::Map const& map, std::vector<batch_item> const& items, batch_options const& options)
+{
+    std::vector<job> jobs = make_jobs(map, items, options);
+    unsigned num_threads = std::max(1u, std::min<unsigned>(options.threads, jobs.size()));
+    std::vector<stats> thread_stats(num_threads);
+    std::atomic<std::size_t> next_job(0);
+    std::mutex log_mutex;
+
+    instrumentation::reset();
+    instrumentation::set_enabled(true);
+    auto start = clock_type::now();
+    auto worker = [&](unsigned index) {
+        stats & s = thread_stats[index];
+        for (std::size_t i = next_job++; i < jobs.size(); i = next_job++)
+        {
+            try
+            {
+                render_job(map, jobs[i], options, s);
+            }
+            catch (std::exception const& ex)
+            {
+                ++s.failures;
+                std::lock_guard<std::mutex> lock(log_mutex);
+                std::clog << "Error rendering " << jobs[i].bbox << ": " << ex.what() << std::endl;
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < num_threads; ++i) workers.emplace_back(worker, i);
+    worker(0);
+    for (auto & w : workers) w.join();
+    double total_ms = elapsed_ms(start);
+    instrumentation::set_enabled(false);
+
+    stats total;
+    for (auto const& s : thread_stats)
+    {
+        total.latency.insert(total.latency.end(), s.latency.begin(), s.latency.end());
+        total.render += s.render;
+        total.encode += s.encode;
+        total.write += s.write;
+        total.tiles += s.tiles;
+        total.bytes += s.bytes;
+        total.failures += s.failures;
+    }
+    std::sort(total.latency.begin(), total.latency.end());
+
+    std::clog << std::fixed << std::setprecision(2);
+    std::clog << "rendered " << total.tiles << " tiles (" << jobs.size() << " jobs, metatile "
+              << options.metatile << ") with " << num_threads << " threads in " << total_ms << " ms\n";
+    std::clog << "throughput: " << (total_ms > 0 ? total.tiles * 1000.0 / total_ms : 0.0) << " tiles/s, "
+              << (total.tiles > 0 ? total.bytes / total.tiles : 0) << " bytes/tile (" << options.format << ")\n";
+    std::clog << "job latency (ms): p50=" << percentile(total.latency, 0.50)
+              << " p90=" << percentile(total.latency, 0.90)
+              << " p99=" << percentile(total.latency, 0.99)
+              << " max=" << (total.latency.empty() ? 0.0 : total.latency.back()) << "\n";
+    std::clog << "stage totals (ms, all threads): render=" << total.render
+              << " encode=" << total.encode
+              << " write=" << total.write << "\n";
+    if (total.failures > 0) std::clog << "failed jobs: " << total.failures << "\n";
+#ifdef MAPNIK_INSTRUMENTATION
+    instrumentation::report(std::clog);
+#endif
+    return total.failures;
+}
+
+}}
@@ -0,0 +1,70 @@
+/*****************************************************************************
+ *
+ * This file is part of Mapnik (c++ mapping toolkit)
+ *
+ * Copyright (C) 2017 Artem Pavlenko
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *****************************************************************************/
+
+#ifndef MAPNIK_UTILS_BATCH_RENDER_HPP
+#define MAPNIK_UTILS_BATCH_RENDER_HPP
+
+#include <mapnik/map.hpp>
+#include <mapnik/attribute.hpp>
+#include <mapnik/geometry/box2d.hpp>
+
+#include <string>
+#include <vector>
+
+namespace mapnik { namespace detail {
+
+struct batch_options
+{
+    unsigned threads = 1;
+    unsigned metatile = 1;
+    unsigned tile_size = 256;
+    double scale_factor = 1.0;
+    std::string format = "png8";
+    std::string output_dir;   // empty: encode only, nothing is written
+    mapnik::attributes vars;
+};
+
+// XYZ tile or arbitrary bbox (in map srs) to render
+struct batch_item
+{
+    int z = -1;
+    int x = 0;
+    int y = 0;
+    mapnik::box2d<double> bbox;
+    bool is_tile() const { return z >= 0; }
+};
+
+// parse "z/x/y" or "minx,miny,maxx,maxy"
+bool parse_batch_item(std::string const& spec, batch_item & item);
+
+// all tiles at zoom `z` intersecting a lon/lat bounding box
+void tiles_in_bbox(int z, mapnik::box2d<double> const& lonlat, std::vector<batch_item> & items);
+
+// render `items` against a shared, already loaded map and print throughput,
+// latency percentiles and per-stage timings to std::clog
+// throws std::runtime_error for z/x/y tiles unless the map is in web mercator
+// returns number of failed jobs
+std::size_t render_batch(mapnik::Map const& map, std::vector<batch_item> const& items, batch_options const& options);
+
+}}
+
+#endif // MAPNIK_UTILS_BATCH_RENDER_HPP
@@ -8,12 +8,16 @@ program_env = env.Clone()
 source = Split(
     """
     mapnik-render.cpp
+    batch_render.cpp
     """
     )
 
 program_env['CXXFLAGS'] = copy(env['LIBMAPNIK_CXXFLAGS'])
 program_env.Append(CPPDEFINES = env['LIBMAPNIK_DEFINES'])
 
+if env['PLATFORM'] == 'Linux':
+    program_env.Append(LINKFLAGS='-pthread')
+
 if env['HAS_CAIRO']:
     program_env.PrependUnique(CPPPATH=env['CAIRO_CPPPATHS'])
     program_env.Append(CPPDEFINES = '-DHAVE_CAIRO')
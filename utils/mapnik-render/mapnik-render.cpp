@@ -7,6 +7,10 @@
 #include <mapnik/unicode.hpp>
 #include <mapnik/datasource_cache.hpp>
 #include <mapnik/font_engine_freetype.hpp>
+#include <mapnik/timer.hpp>
+#include <mapnik/util/conversions.hpp>
+
+#include "batch_render.hpp"
 
 #pragma GCC diagnostic push
 #include <mapnik/warning_ignore.hpp>
@@ -15,6 +19,8 @@
 #pragma GCC diagnostic pop
 
 #include <string>
+#include <fstream>
+#include <iostream>
 
 int main (int argc,char** argv)
 {
@@ -27,6 +33,9 @@ int main (int argc,char** argv)
     std::string img_file;
     double scale_factor = 1;
     bool params_as_variables = false;
+    bool batch_mode = false;
+    std::vector<mapnik::detail::batch_item> batch_items;
+    mapnik::detail::batch_options batch_options;
     mapnik::logger logger;
     logger.set_severity(mapnik::logger::error);
 
@@ -42,6 +51,14 @@ int main (int argc,char** argv)
             ("img",po::value<std::string>(),"image to render")
             ("scale-factor",po::value<double>(),"scale factor for rendering")
             ("variables","make map parameters available as render-time variables")
+            ("batch",po::value<std::string>(),"batch mode: file listing z/x/y tiles or minx,miny,maxx,maxy boxes, one per line ('-' for stdin)")
+            ("zoom",po::value<std::string>(),"batch mode: zoom level or range (e.g. 10-12) of tiles to render")
+            ("bbox",po::value<std::string>(),"batch mode: lon/lat bounds of tiles rendered with --zoom (default: world)")
+            ("threads",po::value<unsigned>(),"batch mode: number of render threads (default 1)")
+            ("metatile",po::value<int>(),"batch mode: metatile size in tiles (default 1)")
+            ("tile-size",po::value<int>(),"batch mode: tile size in pixels (default 256)")
+            ("format",po::value<std::string>(),"batch mode: output format (default png8)")
+            ("output-dir",po::value<std::string>(),"batch mode: directory to write tiles to (default: encode only)")
             ;
 
         po::positional_options_description p;
@@ -83,11 +100,16 @@ int main (int argc,char** argv)
             return -1;
         }
 
+        if (vm.count("batch") || vm.count("zoom"))
+        {
+            batch_mode = true;
+        }
+
         if (vm.count("img"))
         {
             img_file=vm["img"].as<std::string>();
         }
-        else
+        else if (!batch_mode)
         {
             std::clog << "please provide an img as second argument!" << std::endl;
             return -1;
@@ -103,14 +125,109 @@ int main (int argc,char** argv)
             params_as_variables = true;
         }
 
-        mapnik::datasource_cache::instance().register_datasources("./plugins/input/");
-        mapnik::freetype_engine::register_fonts("./fonts",true);
+        if (batch_mode)
+        {
+            if (vm.count("threads")) batch_options.threads = vm["threads"].as<unsigned>();
+            // read as signed so that negative sizes are rejected instead of wrapping
+            if (vm.count("metatile"))
+            {
+                int metatile = vm["metatile"].as<int>();
+                if (metatile <= 0)
+                {
+                    std::clog << "--metatile must be a positive number of tiles" << std::endl;
+                    std::clog << desc << std::endl;
+                    return -1;
+                }
+                batch_options.metatile = static_cast<unsigned>(metatile);
+            }
+            if (vm.count("tile-size"))
+            {
+                int tile_size = vm["tile-size"].as<int>();
+                if (tile_size <= 0)
+                {
+                    std::clog << "--tile-size must be a positive number of pixels" << std::endl;
+                    std::clog << desc << std::endl;
+                    return -1;
+                }
+                batch_options.tile_size = static_cast<unsigned>(tile_size);
+            }
+            if (vm.count("format")) batch_options.format = vm["format"].as<std::string>();
+            if (vm.count("output-dir")) batch_options.output_dir = vm["output-dir"].as<std::string>();
+            batch_options.scale_factor = scale_factor;
+            if (vm.count("batch"))
+            {
+                std::string const& list = vm["batch"].as<std::string>();
+                std::ifstream file;
+                if (list != "-")
+                {
+                    file.open(list.c_str());
+                    if (!file)
+                    {
+                        std::clog << "cannot open batch file: " << list << std::endl;
+                        return -1;
+                    }
+                }
+                std::istream & in = (list == "-") ? std::cin : file;
+                std::string line;
+                while (std::getline(in, line))
+                {
+                    if (line.empty() || line[0] == '#') continue;
+                    mapnik::detail::batch_item item;
+                    if (!mapnik::detail::parse_batch_item(line, item))
+                    {
+                        std::clog << "invalid batch entry: " << line << std::endl;
+                        return -1;
+                    }
+                    batch_items.push_back(item);
+                }
+            }
+            if (vm.count("zoom"))
+            {
+                std::string zoom = vm["zoom"].as<std::string>();
+                int minzoom, maxzoom;
+                std::string::size_type dash = zoom.find('-');
+                if (!mapnik::util::string2int(zoom.substr(0, dash), minzoom)
+                    || !mapnik::util::string2int(dash == std::string::npos ? zoom : zoom.substr(dash + 1), maxzoom)
+                    || minzoom < 0 || maxzoom > 30 || minzoom > maxzoom)
+                {
+                    std::clog << "invalid zoom: " << zoom << std::endl;
+                    return -1;
+                }
+                mapnik::box2d<double> bounds(-180, -85.0511, 180, 85.0511);
+                if (vm.count("bbox") && !bounds.from_string(vm["bbox"].as<std::string>()))
+                {
+                    std::clog << "invalid bbox: " << vm["bbox"].as<std::string>() << std::endl;
+                    return -1;
+                }
+                for (int z = minzoom; z <= maxzoom; ++z)
+                {
+                    mapnik::detail::tiles_in_bbox(z, bounds, batch_items);
+                }
+            }
+            if (batch_items.empty())
+            {
+                std::clog << "nothing to render in batch mode" << std::endl;
+                return -1;
+            }
+        }
+
         mapnik::Map map(600,400);
-        mapnik::load_map(map,xml_file,true);
+        {
+            mapnik::progress_timer __stats__(std::clog, "register plugins");
+            mapnik::datasource_cache::instance().register_datasources("./plugins/input/");
+            if (!batch_mode) __stats__.discard();
+        }
+        {
+            mapnik::progress_timer __stats__(std::clog, "register fonts");
+            mapnik::freetype_engine::register_fonts("./fonts",true);
+            if (!batch_mode) __stats__.discard();
+        }
+        {
+            mapnik::progress_timer __stats__(std::clog, "load map");
+            mapnik::load_map(map,xml_file,true);
+            if (!batch_mode) __stats__.discard();
+        }
         map.zoom_all();
-        mapnik::image_rgba8 im(map.width(),map.height());
-        mapnik::request req(map.width(),map.height(),map.get_current_extent());
-        req.set_buffer_size(map.buffer_size());
         mapnik::attributes vars;
         if (params_as_variables)
         {
@@ -135,6 +252,15 @@ int main (int argc,char** argv)
                 }
             }
         }
+        if (batch_mode)
+        {
+            batch_options.vars = vars;
+            std::size_t failures = mapnik::detail::render_batch(map, batch_items, batch_options);
+            return failures > 0 ? -1 : 0;
+        }
+        mapnik::image_rgba8 im(map.width(),map.height());
+        mapnik::request req(map.width(),map.height(),map.get_current_extent());
+        req.set_buffer_size(map.buffer_size());
         mapnik::agg_renderer<mapnik::image_rgba8> ren(map,req,vars,im,scale_factor,0,0);
         ren.apply();
         mapnik::save_to_file(im,img_file);
@@ -29,6 +29,9 @@ Import ('plugin_base')
 
 program_env = plugin_base.Clone()
 
+if env['PLATFORM'] == 'Linux':
+    program_env.Append(LINKFLAGS='-pthread')
+
 source = Split(
     """
     shapeindex.cpp
@@ -21,11 +21,19 @@
  *****************************************************************************/
 
 #include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <iterator>
+#include <exception>
 #include <vector>
 #include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
 #include <mapnik/version.hpp>
 #include <mapnik/util/fs.hpp>
 #include <mapnik/quad_tree.hpp>
+#include <mapnik/timer.hpp>
 //#include <mapnik/util/spatial_index.hpp>
 #include <mapnik/geometry/envelope.hpp>
 #include "shapefile.hpp"
@@ -40,6 +48,295 @@
 const int DEFAULT_DEPTH = 8;
 const double DEFAULT_RATIO = 0.55;
 
+namespace {
+
+using item_type = std::pair<mapnik::detail::node, mapnik::box2d<float>>;
+
+std::mutex log_mutex;
+
+// Buffers output produced on a worker thread, e.g. by a progress_timer on
+// destruction, and writes it to std::clog in one go under log_mutex.
+struct locked_log
+{
+    ~locked_log()
+    {
+        std::lock_guard<std::mutex> lock(log_mutex);
+        std::clog << stream.str() << std::flush;
+    }
+    std::ostringstream stream;
+};
+
+struct options
+{
+    bool verbose = false;
+    bool index_parts = false;
+    unsigned int depth = DEFAULT_DEPTH;
+    double ratio = DEFAULT_RATIO;
+    unsigned int threads = 1;
+};
+
+inline mapnik::box2d<float> to_float(mapnik::box2d<double> const& box)
+{
+    return mapnik::box2d<float>{static_cast<float>(box.minx()),
+            static_cast<float>(box.miny()),
+            static_cast<float>(box.maxx()),
+            static_cast<float>(box.maxy())};
+}
+
+// scan shx records [first, last) collecting boxes of the referenced shapes
+void scan_records(std::string const& shapename_full, std::string const& shxname,
+                  int first, int last, options const& opts, std::vector<item_type> & items)
+{
+    using mapnik::box2d;
+    shape_file shp(shapename_full);
+    shape_file shx(shxname);
+    shx.seek(100 + first * 8);
+    for (int record = first; record < last && shx.is_good(); ++record)
+    {
+        int offset = shx.read_xdr_integer();
+        int shx_content_length = shx.read_xdr_integer();
+        box2d<double> item_ext;
+        shp.seek(offset * 2);
+        int record_number = shp.read_xdr_integer();
+        int shp_content_length = shp.read_xdr_integer();
+        if (shx_content_length != shp_content_length)
+        {
+            if (opts.verbose)
+            {
+                std::lock_guard<std::mutex> lock(log_mutex);
+                std::clog << "Content length mismatch for record number " << record_number << std::endl;
+            }
+            continue;
+        }
+        int shape_type = shp.read_ndr_integer();
+
+        if (shape_type == shape_io::shape_null) continue;
+
+        if (shape_type==shape_io::shape_point
+            || shape_type==shape_io::shape_pointm
+            || shape_type == shape_io::shape_pointz)
+        {
+            double x=shp.read_double();
+            double y=shp.read_double();
+            item_ext=box2d<double>(x,y,x,y);
+        }
+        else if (opts.index_parts &&
+                 (shape_type == shape_io::shape_polygon || shape_type == shape_io::shape_polygonm || shape_type == shape_io::shape_polygonz
+                  || shape_type == shape_io::shape_polyline || shape_type == shape_io::shape_polylinem || shape_type == shape_io::shape_polylinez))
+        {
+            shp.read_envelope(item_ext);
+            int num_parts = shp.read_ndr_integer();
+            int num_points = shp.read_ndr_integer();
+            std::vector<int> parts;
+            parts.resize(num_parts);
+            std::for_each(parts.begin(), parts.end(), [&](int & part) { part = shp.read_ndr_integer();});
+            for (int k = 0; k < num_parts; ++k)
+            {
+                int start = parts[k];
+                int end;
+                if (k == num_parts - 1) end = num_points;
+                else end = parts[k + 1];
+
+                mapnik::geometry::linear_ring<double> ring;
+                ring.reserve(end - start);
+                for (int j = start; j < end; ++j)
+                {
+                    double x = shp.read_double();
+                    double y = shp.read_double();
+                    ring.emplace_back(x, y);
+                }
+                item_ext = mapnik::geometry::envelope(ring);
+                if (item_ext.valid())
+                {
+                    if (opts.verbose)
+                    {
+                        std::lock_guard<std::mutex> lock(log_mutex);
+                        std::clog << "record number " << record_number << " box=" << item_ext << std::endl;
+                    }
+                    auto ext_f = to_float(item_ext);
+                    items.emplace_back(mapnik::detail::node(offset * 2, start, end, box2d<float>(ext_f)), ext_f);
+                }
+            }
+            item_ext = mapnik::box2d<double>(); //invalid
+        }
+        else
+        {
+            shp.read_envelope(item_ext);
+        }
+
+        if (item_ext.valid())
+        {
+            if (opts.verbose)
+            {
+                std::lock_guard<std::mutex> lock(log_mutex);
+                std::clog << "record number " << record_number << " box=" << item_ext << std::endl;
+            }
+            auto ext_f = to_float(item_ext);
+            items.emplace_back(mapnik::detail::node(offset * 2, -1, 0, box2d<float>(ext_f)), ext_f);
+        }
+    }
+}
+
+bool index_shapefile(std::string const& filename, options const& opts)
+{
+    using mapnik::box2d;
+    std::ostringstream log;
+    log << "processing " << filename << std::endl;
+    std::string shapename (filename);
+    boost::algorithm::ireplace_last(shapename,".shp","");
+    std::string shapename_full (shapename + ".shp");
+    std::string shxname(shapename + ".shx");
+    if (! mapnik::util::exists (shapename_full))
+    {
+        std::lock_guard<std::mutex> lock(log_mutex);
+        std::clog << "Error : file " << shapename_full << " does not exist" << std::endl;
+        return true;
+    }
+    if (! mapnik::util::exists(shxname))
+    {
+        std::lock_guard<std::mutex> lock(log_mutex);
+        std::clog << "Error : shapefile index file (*.shx) " << shxname << " does not exist" << std::endl;
+        return true;
+    }
+    shape_file shp (shapename_full);
+
+    if (! shp.is_open())
+    {
+        std::lock_guard<std::mutex> lock(log_mutex);
+        std::clog << "Error : cannot open " << shapename_full << std::endl;
+        return true;
+    }
+
+    shape_file shx (shxname);
+    if (!shx.is_open())
+    {
+        std::lock_guard<std::mutex> lock(log_mutex);
+        std::clog << "Error : cannot open " << shxname << std::endl;
+        return true;
+    }
+
+    int code = shx.read_xdr_integer(); //file_code == 9994
+    log << code << std::endl;
+    shx.skip(5*4);
+
+    int file_length=shx.read_xdr_integer();
+    int version=shx.read_ndr_integer();
+    int shape_type=shx.read_ndr_integer();
+    box2d<double> extent;
+    shx.read_envelope(extent);
+
+    log << "length=" << file_length << std::endl;
+    log << "version=" << version << std::endl;
+    log << "type=" << shape_type << std::endl;
+    log << "extent:" << extent << std::endl;
+    {
+        std::lock_guard<std::mutex> lock(log_mutex);
+        std::clog << log.str();
+    }
+
+    if (!extent.valid() || std::isnan(extent.width()) || std::isnan(extent.height()))
+    {
+        std::lock_guard<std::mutex> lock(log_mutex);
+        std::clog << "Invalid extent aborting..." << std::endl;
+        return false;
+    }
+
+    mapnik::quad_tree<mapnik::detail::node, mapnik::box2d<float> > tree(to_float(extent), opts.depth, opts.ratio);
+    std::vector<item_type> items;
+
+    if (shape_type != shape_io::shape_null)
+    {
+        locked_log timing;
+        mapnik::progress_timer __stats__(timing.stream, filename + ": scan");
+        // each shx record is 8 bytes (4 words) following the 100 byte header
+        int num_records = std::max(0, (file_length - 50) / 4);
+        unsigned num_threads = std::max(1u, std::min<unsigned>(opts.threads, num_records / 1024 + 1));
+        if (num_threads == 1)
+        {
+            scan_records(shapename_full, shxname, 0, num_records, opts, items);
+        }
+        else
+        {
+            std::vector<std::vector<item_type>> chunks(num_threads);
+            std::vector<std::thread> workers;
+            std::vector<std::exception_ptr> errors(num_threads);
+            int chunk_size = (num_records + num_threads - 1) / num_threads;
+            for (unsigned t = 0; t < num_threads; ++t)
+            {
+                int first = t * chunk_size;
+                int last = std::min(num_records, first + chunk_size);
+                workers.emplace_back([&, t, first, last]() {
+                        try
+                        {
+                            scan_records(shapename_full, shxname, first, last, opts, chunks[t]);
+                        }
+                        catch (...)
+                        {
+                            errors[t] = std::current_exception();
+                        }
+                    });
+            }
+            for (auto & w : workers) w.join();
+            for (auto const& error : errors)
+            {
+                if (error) std::rethrow_exception(error);
+            }
+            // concatenate in record order so the index is identical to a sequential run
+            std::size_t total = 0;
+            for (auto const& chunk : chunks) total += chunk.size();
+            items.reserve(total);
+            for (auto & chunk : chunks)
+            {
+                std::move(chunk.begin(), chunk.end(), std::back_inserter(items));
+            }
+        }
+    }
+
+    if (items.size() > 0)
+    {
+        {
+            locked_log timing;
+            mapnik::progress_timer __stats__(timing.stream, filename + ": build tree");
+            tree.bulk_insert(items, [](item_type const& item) -> item_type const& { return item; }, opts.threads);
+            tree.trim();
+        }
+        locked_log timing;
+        mapnik::progress_timer __stats__(timing.stream, filename + ": write index");
+#ifdef _WINDOWS
+        std::ofstream file(mapnik::utf8_to_utf16(shapename+".index").c_str(), std::ios::trunc | std::ios::binary);
+#else
+        std::ofstream file((shapename+".index").c_str(), std::ios::trunc | std::ios::binary);
+#endif
+        if (!file)
+        {
+            std::lock_guard<std::mutex> lock(log_mutex);
+            std::clog << "cannot open index file for writing file \""
+                      << (shapename+".index") << "\"" << std::endl;
+        }
+        else
+        {
+            {
+                std::lock_guard<std::mutex> lock(log_mutex);
+                std::clog << filename << " number shapes=" << items.size() << std::endl;
+                std::clog << filename << " number nodes=" << tree.count() << std::endl;
+            }
+            file.exceptions(std::ios::failbit | std::ios::badbit);
+            tree.write(file);
+            file.flush();
+            file.close();
+        }
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(log_mutex);
+        std::clog << "Failed to read any features from \"" << filename << "\"" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // anonymous ns
+
 #ifdef _WINDOWS
 #include <windows.h>
 int main ()
@@ -50,10 +347,8 @@ int main (int argc,char** argv)
     using namespace mapnik;
     namespace po = boost::program_options;
 
-    bool verbose=false;
-    bool index_parts = false;
-    unsigned int depth = DEFAULT_DEPTH;
-    double ratio = DEFAULT_RATIO;
+    options opts;
+    unsigned int concurrency = 1;
     std::vector<std::string> shape_files;
 
     try
@@ -66,6 +361,8 @@ int main (int argc,char** argv)
             ("verbose,v","verbose output")
             ("depth,d", po::value<unsigned int>(), "max tree depth\n(default 8)")
             ("ratio,r",po::value<double>(),"split ratio (default 0.55)")
+            ("threads,t",po::value<unsigned int>(),"worker threads used to scan and index each file (default 1)")
+            ("concurrency,c",po::value<unsigned int>(),"number of files indexed concurrently (default 1)")
             ("shape_files",po::value<std::vector<std::string> >(),"shape files to index: file1 file2 ...fileN")
             ;
 
@@ -96,19 +393,27 @@ int main (int argc,char** argv)
         }
         if (vm.count("verbose"))
         {
-            verbose = true;
+            opts.verbose = true;
         }
         if (vm.count("index-parts"))
         {
-            index_parts = true;
+            opts.index_parts = true;
         }
         if (vm.count("depth"))
         {
-            depth = vm["depth"].as<unsigned int>();
+            opts.depth = vm["depth"].as<unsigned int>();
         }
         if (vm.count("ratio"))
         {
-            ratio = vm["ratio"].as<double>();
+            opts.ratio = vm["ratio"].as<double>();
+        }
+        if (vm.count("threads"))
+        {
+            opts.threads = std::max(1u, vm["threads"].as<unsigned int>());
+        }
+        if (vm.count("concurrency"))
+        {
+            concurrency = std::max(1u, vm["concurrency"].as<unsigned int>());
         }
 
         if (vm.count("shape_files"))
@@ -122,202 +427,42 @@ int main (int argc,char** argv)
         return EXIT_FAILURE;
     }
 
-    std::clog << "max tree depth:" << depth << std::endl;
-    std::clog << "split ratio:" << ratio << std::endl;
+    std::clog << "max tree depth:" << opts.depth << std::endl;
+    std::clog << "split ratio:" << opts.ratio << std::endl;
 
     if (shape_files.size() == 0)
     {
         std::clog << "no shape files to index" << std::endl;
         return EXIT_FAILURE;
     }
-    for (auto const& filename : shape_files)
-    {
-        std::clog << "processing " << filename << std::endl;
-        std::string shapename (filename);
-        boost::algorithm::ireplace_last(shapename,".shp","");
-        std::string shapename_full (shapename + ".shp");
-        std::string shxname(shapename + ".shx");
-        if (! mapnik::util::exists (shapename_full))
-        {
-            std::clog << "Error : file " << shapename_full << " does not exist" << std::endl;
-            continue;
-        }
-        if (! mapnik::util::exists(shxname))
-        {
-            std::clog << "Error : shapefile index file (*.shx) " << shxname << " does not exist" << std::endl;
-            continue;
-        }
-        shape_file shp (shapename_full);
-
-        if (! shp.is_open())
-        {
-            std::clog << "Error : cannot open " << shapename_full << std::endl;
-            continue;
-        }
-
-        shape_file shx (shxname);
-        if (!shx.is_open())
-        {
-            std::clog << "Error : cannot open " << shxname << std::endl;
-            continue;
-        }
-
-        int code = shx.read_xdr_integer(); //file_code == 9994
-        std::clog << code << std::endl;
-        shx.skip(5*4);
-
-        int file_length=shx.read_xdr_integer();
-        int version=shx.read_ndr_integer();
-        int shape_type=shx.read_ndr_integer();
-        box2d<double> extent;
-        shx.read_envelope(extent);
-
-
-        std::clog << "length=" << file_length << std::endl;
-        std::clog << "version=" << version << std::endl;
-        std::clog << "type=" << shape_type << std::endl;
-        std::clog << "extent:" << extent << std::endl;
 
-        if (!extent.valid() || std::isnan(extent.width()) || std::isnan(extent.height()))
+    mapnik::progress_timer __stats__(std::clog, "total");
+    std::atomic<std::size_t> next_file(0);
+    std::atomic<bool> success(true);
+    auto worker = [&]() {
+        for (std::size_t i = next_file++; i < shape_files.size() && success; i = next_file++)
         {
-            std::clog << "Invalid extent aborting..." << std::endl;
-            return EXIT_FAILURE;
-        }
-        int pos = 50;
-        shx.seek(pos * 2);
-        mapnik::box2d<float> extent_f { static_cast<float>(extent.minx()),
-                static_cast<float>(extent.miny()),
-                static_cast<float>(extent.maxx()),
-                static_cast<float>(extent.maxy())};
-
-        mapnik::quad_tree<mapnik::detail::node, mapnik::box2d<float> > tree(extent_f, depth, ratio);
-        int count = 0;
-
-        if (shape_type != shape_io::shape_null)
-        {
-            while (shx.is_good() && pos <= file_length - 4)
-            {
-                int offset = shx.read_xdr_integer();
-                int shx_content_length = shx.read_xdr_integer();
-                pos += 4;
-                box2d<double> item_ext;
-                shp.seek(offset * 2);
-                int record_number = shp.read_xdr_integer();
-                int shp_content_length = shp.read_xdr_integer();
-                if (shx_content_length != shp_content_length)
-                {
-                    if (verbose)
-                    {
-                        std::clog << "Content length mismatch for record number " << record_number << std::endl;
-                    }
-                    continue;
-                }
-                shape_type = shp.read_ndr_integer();
-
-                if (shape_type == shape_io::shape_null) continue;
-
-                if (shape_type==shape_io::shape_point
-                    || shape_type==shape_io::shape_pointm
-                    || shape_type == shape_io::shape_pointz)
-                {
-                    double x=shp.read_double();
-                    double y=shp.read_double();
-                    item_ext=box2d<double>(x,y,x,y);
-                }
-                else if (index_parts &&
-                         (shape_type == shape_io::shape_polygon || shape_type == shape_io::shape_polygonm || shape_type == shape_io::shape_polygonz
-                          || shape_type == shape_io::shape_polyline || shape_type == shape_io::shape_polylinem || shape_type == shape_io::shape_polylinez))
-                {
-                    shp.read_envelope(item_ext);
-                    int num_parts = shp.read_ndr_integer();
-                    int num_points = shp.read_ndr_integer();
-                    std::vector<int> parts;
-                    parts.resize(num_parts);
-                    std::for_each(parts.begin(), parts.end(), [&](int & part) { part = shp.read_ndr_integer();});
-                    for (int k = 0; k < num_parts; ++k)
-                    {
-                        int start = parts[k];
-                        int end;
-                        if (k == num_parts - 1) end = num_points;
-                        else end = parts[k + 1];
-
-                        mapnik::geometry::linear_ring<double> ring;
-                        ring.reserve(end - start);
-                        for (int j = start; j < end; ++j)
-                        {
-                            double x = shp.read_double();
-                            double y = shp.read_double();
-                            ring.emplace_back(x, y);
-                        }
-                        item_ext = mapnik::geometry::envelope(ring);
-                        if (item_ext.valid())
-                        {
-                            if (verbose)
-                            {
-                                std::clog << "record number " << record_number << " box=" << item_ext << std::endl;
-                            }
-                            mapnik::box2d<float> ext_f {static_cast<float>(item_ext.minx()),
-                                    static_cast<float>(item_ext.miny()),
-                                    static_cast<float>(item_ext.maxx()),
-                                    static_cast<float>(item_ext.maxy())};
-                            tree.insert(mapnik::detail::node(offset * 2, start, end, std::move(ext_f)), ext_f);
-                            ++count;
-                        }
-                    }
-                    item_ext = mapnik::box2d<double>(); //invalid
-                }
-                else
-                {
-                    shp.read_envelope(item_ext);
-                }
-
-                if (item_ext.valid())
-                {
-                    if (verbose)
-                    {
-                        std::clog << "record number " << record_number << " box=" << item_ext << std::endl;
-                    }
-                    mapnik::box2d<float> ext_f {static_cast<float>(item_ext.minx()),
-                            static_cast<float>(item_ext.miny()),
-                            static_cast<float>(item_ext.maxx()),
-                            static_cast<float>(item_ext.maxy())};
-
-                    tree.insert(mapnik::detail::node(offset * 2, -1, 0, std::move(ext_f)), ext_f);
-                    ++count;
-                }
-            }
-        }
-
-        if (count > 0)
-        {
-            std::clog << " number shapes=" << count << std::endl;
-#ifdef _WINDOWS
-            std::ofstream file(mapnik::utf8_to_utf16(shapename+".index").c_str(), std::ios::trunc | std::ios::binary);
-#else
-            std::ofstream file((shapename+".index").c_str(), std::ios::trunc | std::ios::binary);
-#endif
-            if (!file)
+            try
             {
-                std::clog << "cannot open index file for writing file \""
-                          << (shapename+".index") << "\"" << std::endl;
+                if (!index_shapefile(shape_files[i], opts)) success = false;
             }
-            else
+            catch (std::exception const& ex)
             {
-                tree.trim();
-                std::clog << " number nodes=" << tree.count() << std::endl;
-                file.exceptions(std::ios::failbit | std::ios::badbit);
-                tree.write(file);
-                file.flush();
-                file.close();
+                std::lock_guard<std::mutex> lock(log_mutex);
+                std::clog << "Error: " << shape_files[i] << " " << ex.what() << std::endl;
+                success = false;
             }
         }
-        else
-        {
-            std::clog << "Failed to read any features from \"" << filename << "\"" << std::endl;
-            return EXIT_FAILURE;
-        }
+    };
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < std::min<std::size_t>(concurrency, shape_files.size()); ++i)
+    {
+        workers.emplace_back(worker);
     }
+    worker();
+    for (auto & w : workers) w.join();
 
+    if (!success) return EXIT_FAILURE;
     std::clog << "done!" << std::endl;
     return EXIT_SUCCESS;
 }